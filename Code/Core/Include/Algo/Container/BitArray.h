@@ -1,6 +1,33 @@
 #pragma once
 #include <CoreConfig.h>
 #include <CoreType.h>
+#include <Math/MathUtility.h>
+#include <Misc/Assert.h>
+#include <Memory/MemoryOps.h>
+
+// bulk kernels, over 64 bit words with sse2/avx2 picked at runtime
+namespace Fuko::Algo
+{
+	enum class EBitwiseOp : uint8
+	{
+		And,
+		Or,
+		Xor,
+		AndNot,		// Dst & ~Src
+	};
+
+	// Dst = Dst op Src for NumWords words
+	CORE_API void BitwiseWords(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op);
+
+	// popcount of NumWords words
+	CORE_API size_t CountSetBitsInWords(const uint32* Data, size_t NumWords);
+
+	// index of the first word not equal to SkipWord, NumWords if none
+	CORE_API size_t FindWordNotEqual(const uint32* Data, size_t NumWords, uint32 SkipWord);
+
+	// instruction set picked by runtime dispatch: "avx2", "sse2" or "scalar"
+	CORE_API const char* GetBitOpsIsa();
+}
 
 namespace Fuko::Algo
 {
@@ -37,28 +64,34 @@ namespace Fuko::Algo
 	}
 
 	template<typename SizeType>
-	FORCEINLINE SizeType FindBit(const uint32* Data, SizeType Num, bool Value)
+	FORCEINLINE SizeType FindBit(const uint32* Data, SizeType Num, bool Value, SizeType StartIndex = 0)
 	{
+		check(StartIndex >= 0);
+		if (StartIndex >= Num) return INDEX_NONE;
 		const SizeType DwordCount = CalculateNumWords(Num);
-		SizeType DwordIndex = 0;
+		SizeType DwordIndex = StartIndex >> NumBitsPerDWORDLogTwo;
 
 		// test to skip head 
 		const uint32 Test = Value ? EmptyMask : FullMask;
 
-		// skip head 
-		while (DwordIndex < DwordCount && Data[DwordIndex] == Test) ++DwordIndex;
-
-		// now find bit 
-		if (DwordIndex < DwordCount)
+		// bits of first word before StartIndex never match  
+		uint32 Bits = (Value ? Data[DwordIndex] : ~Data[DwordIndex]) & (FullMask << (StartIndex & PerDWORDMask));
+		if (Bits == 0)
 		{
-			// reserve for CountTrailingZeros
-			const uint32 Bits = Value ? (Data[DwordIndex]) : ~(Data[DwordIndex]);
-			check(Bits != 0);
-			const SizeType LowestBitIndex = Math::CountTrailingZeros(Bits) + (DwordIndex << NumBitsPerDWORDLogTwo);
-
-			if (LowestBitIndex < Num) return LowestBitIndex;
+			// skip head 
+			++DwordIndex;
+			if (DwordIndex < DwordCount && Data[DwordIndex] == Test)
+			{
+				DwordIndex += (SizeType)FindWordNotEqual(Data + DwordIndex, (size_t)(DwordCount - DwordIndex), Test);
+			}
+			if (DwordIndex >= DwordCount) return INDEX_NONE;
+			Bits = Value ? Data[DwordIndex] : ~Data[DwordIndex];
 		}
-		return INDEX_NONE;
+
+		// now find bit 
+		check(Bits != 0);
+		const SizeType LowestBitIndex = Math::CountTrailingZeros(Bits) + (DwordIndex << NumBitsPerDWORDLogTwo);
+		return LowestBitIndex < Num ? LowestBitIndex : INDEX_NONE;
 	}
 
 	template<typename SizeType>
@@ -66,16 +99,16 @@ namespace Fuko::Algo
 	{
 		const SizeType DwordCount = Algo::CalculateNumWords(Num);
 		SizeType DwordIndex = Math::DivideAndRoundDown(ConservativeStartIndex, (SizeType)NumBitsPerDWORD);
-		while (DwordIndex < DwordCount && Data[DwordIndex] == (uint32)-1)
+		if (DwordIndex < DwordCount && Data[DwordIndex] == FullMask)
 		{
-			++DwordIndex;
+			DwordIndex += (SizeType)FindWordNotEqual(Data + DwordIndex, (size_t)(DwordCount - DwordIndex), FullMask);
 		}
 
 		if (DwordIndex < DwordCount)
 		{
 			const uint32 Bits = ~(Data[DwordIndex]);
 			check(Bits != 0);
-			const uint32 LowestBit = (Bits) & (-(int32)Bits);
+			const uint32 LowestBit = Bits & (0u - Bits);
 			const SizeType LowestBitIndex = Math::CountTrailingZeros(Bits) + (DwordIndex << NumBitsPerDWORDLogTwo);
 			if (LowestBitIndex < Num)
 			{
@@ -87,6 +120,64 @@ namespace Fuko::Algo
 		return INDEX_NONE;
 	}
 
+	// set bits in [Index, Index + Num) 
+	template<typename SizeType>
+	FORCEINLINE SizeType CountSetBits(const uint32* Data, SizeType Index, SizeType Num)
+	{
+		check(Index >= 0 && Num >= 0);
+		if (Num == 0) return 0;
+
+		const SizeType StartWord = Index >> NumBitsPerDWORDLogTwo;
+		const SizeType EndWord = (Index + Num - 1) >> NumBitsPerDWORDLogTwo;
+		const uint32 StartMask = FullMask << (Index & PerDWORDMask);
+		const uint32 EndMask = FullMask >> (PerDWORDMask - ((Index + Num - 1) & PerDWORDMask));
+
+		if (StartWord == EndWord) return (SizeType)Math::CountBits((uint64)(Data[StartWord] & StartMask & EndMask));
+
+		SizeType Count = (SizeType)Math::CountBits((uint64)(Data[StartWord] & StartMask));
+		Count += (SizeType)CountSetBitsInWords(Data + StartWord + 1, (size_t)(EndWord - StartWord - 1));
+		Count += (SizeType)Math::CountBits((uint64)(Data[EndWord] & EndMask));
+		return Count;
+	}
+	template<typename SizeType>
+	FORCEINLINE SizeType CountSetBits(const uint32* Data, SizeType Num)
+	{
+		return CountSetBits(Data, (SizeType)0, Num);
+	}
+
+	// Dst = Dst op Src over the first DstNum bits, bits past SrcNum read as zero, unused bits of Dst last word are cleared
+	template<typename SizeType>
+	FORCEINLINE void BitwiseBits(uint32* Dst, SizeType DstNum, const uint32* Src, SizeType SrcNum, EBitwiseOp Op)
+	{
+		check(DstNum >= 0 && SrcNum >= 0);
+		if (DstNum == 0) return;
+
+		const SizeType Num = Math::Min(DstNum, SrcNum);
+		const SizeType FullWords = Num >> NumBitsPerDWORDLogTwo;
+		const SizeType DstWords = CalculateNumWords(DstNum);
+		BitwiseWords(Dst, Src, (size_t)FullWords, Op);
+
+		// partial word of the shorter one 
+		SizeType DoneWords = FullWords;
+		if (Num & PerDWORDMask)
+		{
+			const uint32 SrcWord = Src[FullWords] & GetLastWordMask(Num);
+			uint32& DstWord = Dst[FullWords];
+			switch (Op)
+			{
+			case EBitwiseOp::And: DstWord &= SrcWord; break;
+			case EBitwiseOp::Or: DstWord |= SrcWord; break;
+			case EBitwiseOp::Xor: DstWord ^= SrcWord; break;
+			case EBitwiseOp::AndNot: DstWord &= ~SrcWord; break;
+			}
+			++DoneWords;
+		}
+
+		// and with zero is the only op that touch the rest 
+		if (Op == EBitwiseOp::And && DoneWords < DstWords) SetWords(Dst + DoneWords, DstWords - DoneWords, false);
+		Dst[DstWords - 1] &= GetLastWordMask(DstNum);
+	}
+
 	template<typename SizeType>
 	FORCEINLINE SizeType FindLastBit(const uint32* Data, SizeType Num, bool Value)
 	{
@@ -175,11 +266,8 @@ namespace Fuko::Algo
 			{
 				*Data++ |= StartMask;
 				Count -= 2;	// exclude start and end 
-				while (Count != 0)
-				{
-					*Data++ = FullMask;
-					--Count;
-				}
+				SetWords(Data, Count, true);
+				Data += Count;
 				*Data |= EndMask;
 			}
 		}
@@ -194,11 +282,8 @@ namespace Fuko::Algo
 			{
 				*Data++ &= ~StartMask;
 				Count -= 2;	// exclude start and end 
-				while (Count != 0)
-				{
-					*Data++ = 0;
-					--Count;
-				}
+				SetWords(Data, Count, false);
+				Data += Count;
 				*Data &= ~EndMask;
 			}
 		}
@@ -0,0 +1,48 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Misc/Hash.h>
+
+// minimal perfect hash, PTHash style
+// keys are split into buckets by hash, each bucket get a pilot that move all of its keys to free slots at once
+// big buckets are placed first while the table is empty, the single key buckets fill the rest
+namespace Fuko::Algo
+{
+	// how a 64 bit key hash is spread to buckets and slots, build and lookup must agree, so it is saved with the table
+	struct PerfectHashLayout
+	{
+		// 60% of keys go to the first 30% of buckets
+		static constexpr uint32 DenseKeyThreshold = 0x9999999Au;
+
+		uint32	Num = 0;			// keys, the final slot of a key is in [0, Num)
+		uint32	TableSize = 0;		// slots searched by pilots, a little more than Num so the last buckets are found fast
+		uint32	BucketNum = 0;
+		uint32	DenseBucketNum = 0;
+
+		// high half pick dense or sparse buckets, low half pick the bucket
+		FORCEINLINE uint32 Bucket(uint64 Hash) const
+		{
+			const uint64 Low = (uint32)Hash;
+			return (uint32)(Hash >> 32) < DenseKeyThreshold
+				? (uint32)((Low * DenseBucketNum) >> 32)
+				: DenseBucketNum + (uint32)((Low * (BucketNum - DenseBucketNum)) >> 32);
+		}
+
+		// slot in [0, TableSize), the slots past Num are remapped to the free slots below it
+		static FORCEINLINE uint64 PilotHash(uint32 Pilot) { return MixHash64(Pilot * 0x9E3779B97F4A7C15ull + HashSecret[2]); }
+		FORCEINLINE uint32 Position(uint64 Hash, uint64 InPilotHash) const
+		{
+			return (uint32)(((MixHash64(Hash ^ InPilotHash) >> 32) * TableSize) >> 32);
+		}
+	};
+
+	// pilots are searched from 0 and almost all are small, 16 bit keep the pilot array small enough to stay in cache
+	using PerfectHashPilot = uint16;
+
+	// table and bucket sizes for Num keys
+	CORE_API PerfectHashLayout MakePerfectHashLayout(uint32 Num);
+
+	// Hashes must be unique, out arrays are sized BucketNum, TableSize - Num and Num
+	// OutSlots[i] is the final slot of Hashes[i], false when some bucket find no pilot, retry with hashes of another seed
+	CORE_API bool BuildPerfectHash(const uint64* Hashes, const PerfectHashLayout& Layout, PerfectHashPilot* OutPilots, uint32* OutRemap, uint32* OutSlots);
+}
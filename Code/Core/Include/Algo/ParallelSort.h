@@ -0,0 +1,142 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Math/MathUtility.h>
+#include <Algo/Sort.h>
+#include <Algo/StableSort.h>
+#include <Templates/Functor.h>
+#include <Templates/UtilityTemp.h>
+#include <Memory/MemoryPolicy.h>
+#include <JobSystem/JobSystem.h>
+
+// merge sort on job workers
+// chunks are sorted alone, then merged in rounds, every round is cut in as many equal output ranges as there are chunks
+// so the last rounds that merge only two or four big runs still keep every worker busy
+// kept out of the containers so they don't pull in the job system, call it with the container as the range
+namespace Fuko::Algo
+{
+	// below this chunks cost more to schedule than to sort
+	inline constexpr uint32 ParallelSortMinChunk = 16384;
+
+	namespace Impl
+	{
+		// how many of the first K merged elements come from A, equal elements of A go first
+		template<class T, class TSize, class TPred>
+		TSize MergeSplit(const T* A, TSize NumA, const T* B, TSize NumB, TSize K, TPred& Pred)
+		{
+			TSize Low = K > NumB ? K - NumB : 0;
+			TSize High = Math::Min(K, NumA);
+			while (Low < High)
+			{
+				const TSize Mid = Low + (High - Low) / 2;
+				// A[Mid] merge before B[K - Mid - 1], so more of A is taken
+				if (!Pred(B[K - Mid - 1], A[Mid])) Low = Mid + 1;
+				else High = Mid;
+			}
+			return Low;
+		}
+
+		template<bool bStable, class T, class TSize, class TPred>
+		void ParallelSort(Job::JobExecuter& Executer, T* First, TSize Num, TPred& Pred, uint32 ChunkNum)
+		{
+			if (Num < 2) return;
+			ChunkNum = ChunkNum ? ChunkNum : Executer.NumWorkers();
+			ChunkNum = Math::Max(1u, Math::Min(ChunkNum, (uint32)(Num / ParallelSortMinChunk)));
+			if (ChunkNum == 1 && !bStable)
+			{
+				IntroSort(First, Num, Pred);
+				return;
+			}
+
+			T* Buffer = (T*)MAlloc((size_t)Num * sizeof(T), alignof(T));
+			if (ChunkNum == 1)
+			{
+				MergeSort(First, Num, Buffer, Pred);
+				Free(Buffer);
+				return;
+			}
+
+			// chunk bounds, the output ranges of every round use the same bounds
+			auto Bound = [Num, ChunkNum](uint32 Chunk) { return (TSize)((uint64)Num * Chunk / ChunkNum); };
+
+			Job::JobBucket Bucket;
+			Job::Job Barrier = Bucket.PlaceHolder();
+			auto AddStage = [&](auto&& Func)
+			{
+				Job::Job Next = Bucket.PlaceHolder();
+				for (uint32 Chunk = 0; Chunk < ChunkNum; ++Chunk)
+				{
+					Bucket.Emplace([Func, Chunk] { Func(Chunk); }).Precede(Next).Depend(Barrier);
+				}
+				Barrier = Next;
+			};
+
+			AddStage([=, &Pred](uint32 Chunk)
+			{
+				const TSize Begin = Bound(Chunk);
+				if constexpr (bStable) MergeSort(First + Begin, Bound(Chunk + 1) - Begin, Buffer + Begin, Pred);
+				else IntroSort(First + Begin, Bound(Chunk + 1) - Begin, Pred);
+			});
+
+			// a round merge runs of Width chunks in pairs, an output range never cross a pair
+			T* Src = First;
+			T* Dst = Buffer;
+			for (uint32 Width = 1; Width < ChunkNum; Width <<= 1)
+			{
+				AddStage([=, &Pred](uint32 Chunk)
+				{
+					const uint32 Group = Chunk / (Width * 2) * (Width * 2);
+					const TSize Begin = Bound(Group);
+					const TSize Mid = Bound(Math::Min(Group + Width, ChunkNum));
+					const TSize End = Bound(Math::Min(Group + Width * 2, ChunkNum));
+					const T* A = Src + Begin;
+					const T* B = Src + Mid;
+					const TSize OutBegin = Bound(Chunk) - Begin;
+					const TSize OutEnd = Bound(Chunk + 1) - Begin;
+
+					const TSize BeginA = MergeSplit(A, Mid - Begin, B, End - Mid, OutBegin, Pred);
+					const TSize EndA = MergeSplit(A, Mid - Begin, B, End - Mid, OutEnd, Pred);
+					MergeTo(A + BeginA, EndA - BeginA, B + (OutBegin - BeginA), (OutEnd - EndA) - (OutBegin - BeginA), Dst + Begin + OutBegin, Pred);
+				});
+				Swap(Src, Dst);
+			}
+			if (Src != First)
+			{
+				AddStage([=](uint32 Chunk)
+				{
+					const TSize Begin = Bound(Chunk);
+					Memcpy(First + Begin, Src + Begin, (size_t)(Bound(Chunk + 1) - Begin) * sizeof(T));
+				});
+			}
+
+			std::future<void> Done;
+			Executer.Execute(Bucket).Future(Done);
+			Done.wait();
+			Free(Buffer);
+		}
+	}
+
+	// Pred must be safe to call from several threads, ChunkNum 0 means one chunk per worker of the executer
+	template<class T, class TSize, class TPred>
+	void ParallelSort(Job::JobExecuter& Executer, T* First, TSize Num, TPred&& Pred, uint32 ChunkNum = 0)
+	{
+		Impl::ParallelSort<false>(Executer, First, Num, Pred, ChunkNum);
+	}
+	template <typename TR, typename TPred = TLess<>>
+	FORCEINLINE auto ParallelSort(Job::JobExecuter& Executer, TR& Range, TPred&& Pred = TPred(), uint32 ChunkNum = 0) -> decltype(GetNum(Range), void())
+	{
+		Impl::ParallelSort<false>(Executer, GetData(Range), GetNum(Range), Pred, ChunkNum);
+	}
+
+	// stable, need a buffer of Num elements
+	template<class T, class TSize, class TPred>
+	void ParallelStableSort(Job::JobExecuter& Executer, T* First, TSize Num, TPred&& Pred, uint32 ChunkNum = 0)
+	{
+		Impl::ParallelSort<true>(Executer, First, Num, Pred, ChunkNum);
+	}
+	template <typename TR, typename TPred = TLess<>>
+	FORCEINLINE auto ParallelStableSort(Job::JobExecuter& Executer, TR& Range, TPred&& Pred = TPred(), uint32 ChunkNum = 0) -> decltype(GetNum(Range), void())
+	{
+		Impl::ParallelSort<true>(Executer, GetData(Range), GetNum(Range), Pred, ChunkNum);
+	}
+}
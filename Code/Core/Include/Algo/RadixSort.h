@@ -0,0 +1,100 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Algo/StableSort.h>
+#include <Memory/MemoryPolicy.h>
+#include <type_traits>
+
+// LSD radix sort, one byte per pass, stable
+// keys are integers, floats or enums, given directly or by a key function
+namespace Fuko::Algo
+{
+	// below this an insertion sort is faster than clearing the counters
+	inline constexpr uint32 RadixSortMinNum = 64;
+
+	namespace Impl
+	{
+		template<uint32 Size> struct TRadixUInt;
+		template<> struct TRadixUInt<1> { using Type = uint8; };
+		template<> struct TRadixUInt<2> { using Type = uint16; };
+		template<> struct TRadixUInt<4> { using Type = uint32; };
+		template<> struct TRadixUInt<8> { using Type = uint64; };
+
+		// key bits that compare unsigned in the same order as the key
+		// signed flip the sign bit, negative floats flip every bit, -0 sort before +0 and NaN go to the ends by their sign
+		template<typename K>
+		FORCEINLINE auto RadixBits(K Key)
+		{
+			if constexpr (std::is_enum_v<K>)
+			{
+				return RadixBits((std::underlying_type_t<K>)Key);
+			}
+			else
+			{
+				static_assert(std::is_arithmetic_v<K> && !std::is_same_v<K, bool>, "radix key must be integer, float or enum");
+				using UInt = typename TRadixUInt<sizeof(K)>::Type;
+				constexpr UInt SignBit = (UInt)1 << (sizeof(K) * 8 - 1);
+				UInt Bits;
+				memcpy(&Bits, &Key, sizeof(K));
+				if constexpr (std::is_floating_point_v<K>) return (UInt)(Bits & SignBit ? ~Bits : Bits | SignBit);
+				else if constexpr (std::is_signed_v<K>) return (UInt)(Bits ^ SignBit);
+				else return Bits;
+			}
+		}
+	}
+
+	// KeyOf(const T&) return the key, it is called once per element for counting and once per pass
+	template<typename T, typename TSize, typename TKeyFunc>
+	void RadixSort(T* First, TSize Num, TKeyFunc&& KeyOf)
+	{
+		using KeyType = std::decay_t<decltype(KeyOf(*First))>;
+		constexpr uint32 PassNum = sizeof(KeyType);
+
+		if (Num < RadixSortMinNum)
+		{
+			InsertionSort(First, Num, [&](const T& A, const T& B) { return Impl::RadixBits(KeyOf(A)) < Impl::RadixBits(KeyOf(B)); });
+			return;
+		}
+
+		// counters of every pass in one read
+		TSize Counts[PassNum][256] = {};
+		for (TSize i = 0; i < Num; ++i)
+		{
+			const auto Bits = Impl::RadixBits(KeyOf(First[i]));
+			for (uint32 Pass = 0; Pass < PassNum; ++Pass) ++Counts[Pass][(Bits >> (Pass * 8)) & 0xFF];
+		}
+
+		T* Src = First;
+		T* Dst = (T*)MAlloc((size_t)Num * sizeof(T), alignof(T));
+		T* Buffer = Dst;
+		for (uint32 Pass = 0; Pass < PassNum; ++Pass)
+		{
+			// every key has the same byte, nothing move
+			TSize* Count = Counts[Pass];
+			const auto FirstBits = Impl::RadixBits(KeyOf(Src[0]));
+			if (Count[(FirstBits >> (Pass * 8)) & 0xFF] == Num) continue;
+
+			TSize Offset = 0;
+			for (uint32 Digit = 0; Digit < 256; ++Digit)
+			{
+				const TSize DigitNum = Count[Digit];
+				Count[Digit] = Offset;
+				Offset += DigitNum;
+			}
+			for (TSize i = 0; i < Num; ++i)
+			{
+				const auto Bits = Impl::RadixBits(KeyOf(Src[i]));
+				Memcpy(Dst + Count[(Bits >> (Pass * 8)) & 0xFF]++, Src + i, sizeof(T));
+			}
+			Swap(Src, Dst);
+		}
+		if (Src != First) Memcpy(First, Src, (size_t)Num * sizeof(T));
+		Free(Buffer);
+	}
+
+	template<typename T, typename TSize>
+	void RadixSort(T* First, TSize Num)
+	{
+		RadixSort(First, Num, [](const T& Value) { return Value; });
+	}
+}
@@ -4,6 +4,7 @@
 #include <Algo/BinarySearch.h>
 #include <Algo/Rotate.h>
 #include <Templates/Functor.h>
+#include <Memory/MemoryOps.h>
 
 namespace Fuko::Algo
 {
@@ -30,6 +31,65 @@ namespace Fuko::Algo
 		}
 	}
 
+	// stable, for short runs, elements are relocated bitwise like the containers do
+	template<class T, class TSize, class TPred>
+	void InsertionSort(T* First, const TSize Num, TPred&& Pred)
+	{
+		for (TSize i = 1; i < Num; ++i)
+		{
+			if (!Pred(First[i], First[i - 1])) continue;
+			alignas(T) uint8 Hold[sizeof(T)];
+			Memcpy(Hold, First + i, sizeof(T));
+			TSize j = i - 1;
+			while (j > 0 && Pred(*(const T*)Hold, First[j - 1])) --j;
+			Memmove(First + j + 1, First + j, (size_t)(i - j) * sizeof(T));
+			Memcpy(First + j, Hold, sizeof(T));
+		}
+	}
+
+	namespace Impl
+	{
+		// merge two sorted ranges to Out, equal elements of A go first
+		template<class T, class TSize, class TPred>
+		void MergeTo(const T* A, TSize NumA, const T* B, TSize NumB, T* Out, TPred&& Pred)
+		{
+			const T* EndA = A + NumA;
+			const T* EndB = B + NumB;
+			while (A != EndA && B != EndB)
+			{
+				const T* Pick = Pred(*B, *A) ? B++ : A++;
+				Memcpy(Out++, Pick, sizeof(T));
+			}
+			Memcpy(Out, A, (size_t)(EndA - A) * sizeof(T));
+			Memcpy(Out + (EndA - A), B, (size_t)(EndB - B) * sizeof(T));
+		}
+	}
+
+	// stable, O(n log n) with a buffer of Num uninitialized elements, StableSort rotate instead and is much slower on big arrays
+	template<class T, class TSize, class TPred>
+	void MergeSort(T* First, const TSize Num, T* Buffer, TPred&& Pred)
+	{
+		constexpr TSize RunSize = 32;
+		for (TSize Start = 0; Start < Num; Start += RunSize)
+		{
+			InsertionSort(First + Start, Math::Min(RunSize, Num - Start), Pred);
+		}
+
+		T* Src = First;
+		T* Dst = Buffer;
+		for (TSize Width = RunSize; Width < Num; Width <<= 1)
+		{
+			for (TSize Start = 0; Start < Num; Start += Width << 1)
+			{
+				const TSize NumA = Math::Min(Width, Num - Start);
+				const TSize NumB = Math::Min(Width, Num - Start - NumA);
+				Impl::MergeTo(Src + Start, NumA, Src + Start + NumA, NumB, Dst + Start, Pred);
+			}
+			Swap(Src, Dst);
+		}
+		if (Src != First) Memcpy(First, Src, (size_t)Num * sizeof(T));
+	}
+
 	template<class T, class TSize, class TPred, int MinMergeSubgroupSize = 2>
 	void StableSort(T* First, const TSize Num, TPred&& Pred)
 	{
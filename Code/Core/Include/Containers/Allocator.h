@@ -3,8 +3,8 @@
 #include <CoreType.h>
 #include <Memory/MemoryPolicy.h>
 #include <Memory/MemoryOps.h>
-#include <corecrt_malloc.h>
 #include <Misc/Assert.h>
+#include <type_traits>
 
 // alloc template 
 namespace Fuko
@@ -103,7 +103,9 @@ namespace Fuko
 			{
 				Data = (T*)m_Allocator->TAlloc<T>(InMax);
 			}
-			return InMax;
+
+			// use the slack of the block, allocators not know the size return 0 
+			return Data ? Math::Max(InMax, (SizeType)(m_Allocator->Size(Data, alignof(T)) / sizeof(T))) : 0;
 		}
 		FORCEINLINE SizeType	FreeRaw(void*& Data, SizeType InAlign)
 		{
@@ -137,7 +139,7 @@ namespace Fuko
 		template<typename T>
 		FORCEINLINE SizeType	Free(T*& Data) 
 		{ 
-			_aligned_free(Data);
+			HeapFree(Data);
 			Data = nullptr;
 			return 0;
 		}
@@ -145,23 +147,25 @@ namespace Fuko
 		FORCEINLINE SizeType	Reserve(T*& Data, SizeType InMax)
 		{
 			if (Data)
-				Data = (T*)_aligned_realloc(Data, InMax * sizeof(T), alignof(T));
+				Data = (T*)HeapRealloc(Data, InMax * sizeof(T), alignof(T));
 			else
-				Data = (T*)_aligned_malloc(InMax * sizeof(T), alignof(T));
-			return InMax;
+				Data = (T*)HeapMAlloc(InMax * sizeof(T), alignof(T));
+
+			// report the usable size, so containers grow into the slack instead of realloc 
+			return Data ? (SizeType)(HeapMSize(Data, alignof(T)) / sizeof(T)) : 0;
 		}
 		FORCEINLINE SizeType	FreeRaw(void*& Data, SizeType InAlign)
 		{
-			_aligned_free(Data);
+			HeapFree(Data);
 			Data = nullptr;
 			return 0;
 		}
 		FORCEINLINE SizeType	ReserveRaw(void*& Data, SizeType InSize, SizeType InAlign)
 		{
 			if (Data)
-				Data = _aligned_realloc(Data, InSize, InAlign);
+				Data = HeapRealloc(Data, InSize, InAlign);
 			else
-				Data = _aligned_malloc(InSize, InAlign);
+				Data = HeapMAlloc(InSize, InAlign);
 			return InSize;
 		}
 	};
@@ -199,4 +203,122 @@ namespace Fuko
 		template<typename T>
 		FORCEINLINE SizeType	Reserve(T*& Data, SizeType InMax) { return ReserveRaw((void*&)Data, InMax * sizeof(T), alignof(T)) / sizeof(T); }
 	};
+}
+
+// inline allocator
+namespace Fuko
+{
+	// keep up to N elements inside the container, spill to Secondary past that
+	// containers get the real allocator by TElementAlloc<TInlineAlloc<N>, T>::Type
+	// such containers point into themselves, so they can't be bitwise relocated, don't put them in a reallocating container
+	template<int32 N, typename Secondary = PmrAlloc>
+	class TInlineAlloc
+	{
+		Secondary	m_Secondary;
+	public:
+		using SizeType = int32;
+		using USizeType = uint32;
+
+		FORCEINLINE TInlineAlloc(const Secondary& InSecondary = Secondary())
+			: m_Secondary(InSecondary)
+		{}
+		FORCEINLINE const Secondary& GetSecondary() const { return m_Secondary; }
+
+		template<typename T>
+		class ForElementType : public __DefaultChangePolicy<int32>
+		{
+			alignas(T) uint8	m_Inline[N * sizeof(T)];
+			Secondary			m_Secondary;
+
+			FORCEINLINE T* _InlineData() { return (T*)m_Inline; }
+		public:
+			using SizeType = int32;
+			using USizeType = uint32;
+			static constexpr bool bHasInlineStorage = true;
+
+			FORCEINLINE ForElementType(const TInlineAlloc& InAlloc = TInlineAlloc())
+				: m_Secondary(InAlloc.GetSecondary())
+			{}
+
+			// inline storage never travel with the allocator, containers relocate elements themselves
+			FORCEINLINE ForElementType(const ForElementType& Other)
+				: m_Secondary(Other.m_Secondary)
+			{}
+			FORCEINLINE ForElementType& operator=(const ForElementType& Other)
+			{
+				m_Secondary = Other.m_Secondary;
+				return *this;
+			}
+
+			FORCEINLINE bool IsInline(const void* Data) const { return Data == m_Inline; }
+
+			template<typename U>
+			FORCEINLINE SizeType	Free(U*& Data)
+			{
+				if constexpr (std::is_same_v<U, T>)
+				{
+					if (Data == _InlineData())
+					{
+						Data = nullptr;
+						return 0;
+					}
+				}
+				return m_Secondary.Free(Data);
+			}
+			template<typename U>
+			FORCEINLINE SizeType	Reserve(U*& Data, SizeType InMax)
+			{
+				if constexpr (std::is_same_v<U, T>)
+				{
+					T* InlineData = _InlineData();
+					if (InMax <= N)
+					{
+						// heap block is always larger than N, so InMax elements are readable
+						if (Data && Data != InlineData)
+						{
+							Memcpy(InlineData, Data, InMax * sizeof(T));
+							m_Secondary.Free(Data);
+						}
+						Data = InlineData;
+						return N;
+					}
+					if (Data == InlineData)
+					{
+						T* NewData = nullptr;
+						SizeType NewMax = m_Secondary.Reserve(NewData, InMax);
+						Memcpy(NewData, InlineData, N * sizeof(T));
+						Data = NewData;
+						return NewMax;
+					}
+				}
+				return m_Secondary.Reserve(Data, InMax);
+			}
+			FORCEINLINE SizeType	FreeRaw(void*& Data, SizeType InAlign) { return m_Secondary.FreeRaw(Data, InAlign); }
+			FORCEINLINE SizeType	ReserveRaw(void*& Data, SizeType InSize, SizeType InAlign) { return m_Secondary.ReserveRaw(Data, InSize, InAlign); }
+		};
+	};
+
+	// allocator a container of T really hold, allocator with ForElementType is rebind to T
+	template<typename Alloc, typename T, typename = void>
+	struct TElementAlloc
+	{
+		using Type = Alloc;
+	};
+	template<typename Alloc, typename T>
+	struct TElementAlloc<Alloc, T, std::void_t<typename Alloc::template ForElementType<T>>>
+	{
+		using Type = typename Alloc::template ForElementType<T>;
+	};
+
+	// whether the allocator may hand out storage inside itself
+	template<typename Alloc, typename = void>
+	struct THasInlineStorage
+	{
+		static constexpr bool Value = false;
+	};
+	template<typename Alloc>
+	struct THasInlineStorage<Alloc, std::void_t<decltype(Alloc::bHasInlineStorage)>>
+	{
+		static constexpr bool Value = Alloc::bHasInlineStorage;
+	};
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <Algo/Find.h>
 #include <Algo/Sort.h>
 #include <Algo/StableSort.h>
+#include <Algo/RadixSort.h>
 #include "ContainerFwd.h"
 
 // Array
@@ -18,8 +19,9 @@ namespace Fuko
 	class TArray
 	{
 		using SizeType = typename Alloc::USizeType;
+		using AllocType = typename TElementAlloc<Alloc, T>::Type;
 	protected:
-		Alloc		m_Allocator;
+		AllocType	m_Allocator;
 		T*			m_Data;
 		SizeType	m_Num;
 		SizeType	m_Max;
@@ -50,6 +52,27 @@ namespace Fuko
 		{
 			if (m_Max != NewMax) m_Max = m_Allocator.Reserve(m_Data, NewMax);
 		}
+		FORCEINLINE void _MoveToEmpty(TArray& Other)
+		{
+			// elements in other's inline storage can't be stolen, relocate them
+			if constexpr (THasInlineStorage<AllocType>::Value)
+			{
+				if (Other.m_Allocator.IsInline(Other.m_Data))
+				{
+					if (Other.m_Num) _ResizeTo(Other.m_Num);
+					RelocateConstructItems<T>(GetData(), Other.GetData(), Other.m_Num);
+					m_Num = Other.m_Num;
+					Other.m_Num = Other.m_Max = 0;
+					Other.m_Data = nullptr;
+					return;
+				}
+			}
+			m_Num = Other.m_Num;
+			m_Max = Other.m_Max;
+			m_Data = Other.m_Data;
+			Other.m_Num = Other.m_Max = 0;
+			Other.m_Data = nullptr;
+		}
 		template <typename T2>
 		void _CopyToEmpty(const T2* OtherData, SizeType OtherNum, SizeType ExtraSlack)
 		{
@@ -153,14 +176,12 @@ namespace Fuko
 		
 		// move construct 
 		FORCEINLINE TArray(TArray&& Other)
-			: m_Num(Other.m_Num)
-			, m_Data(Other.m_Data)
-			, m_Max(Other.m_Max)
+			: m_Num(0)
+			, m_Data(nullptr)
+			, m_Max(0)
 			, m_Allocator(std::move(Other.m_Allocator))
 		{
-			Other.m_Num = 0;
-			Other.m_Max = 0;
-			Other.m_Data = nullptr;
+			_MoveToEmpty(Other);
 		}
 	
 		// move assign operator 
@@ -170,15 +191,9 @@ namespace Fuko
 			
 			_FreeArray();
 
-			// copy info 
+			// copy info and invalidate other 
 			m_Allocator = std::move(Other.m_Allocator);
-			m_Num = Other.m_Num;
-			m_Max = Other.m_Max;
-			m_Data = Other.m_Data;
-
-			// invalidate other 
-			Other.m_Num = Other.m_Max = 0;
-			Other.m_Data = nullptr;
+			_MoveToEmpty(Other);
 			return *this;
 		}
 		
@@ -191,8 +206,8 @@ namespace Fuko
 		FORCEINLINE SizeType Num() const { return m_Num; }
 		FORCEINLINE SizeType Max() const { return m_Max; }
 		FORCEINLINE SizeType Slack() const { return m_Max - m_Num; }
-		FORCEINLINE const Alloc& GetAllocator() const { return m_Allocator; }
-		FORCEINLINE Alloc& GetAllocator() { return m_Allocator; }
+		FORCEINLINE const AllocType& GetAllocator() const { return m_Allocator; }
+		FORCEINLINE AllocType& GetAllocator() { return m_Allocator; }
 		FORCEINLINE bool IsEmpty() const { return m_Num == 0; }
 
 		// compare
@@ -585,7 +600,7 @@ namespace Fuko
 				DestructItems(HoleBegin, Count);
 				
 				// move memory 
-				RelocateConstructItems(HoleBegin, HoleEnd, Count);
+				RelocateConstructItems(HoleBegin, HoleEnd, m_Num - Index - Count);
 				m_Num -= Count;
 
 				if (bAllowShrinking) _ResizeShrink();
@@ -775,6 +790,10 @@ namespace Fuko
 		void Sort(TPred&& Pred = TPred()) { Algo::IntroSort(GetData(), Num(), std::forward<TPred>(Pred)); }
 		template<class TPred = TLess<T>>
 		void StableSort(TPred&& Pred = TPred()) { Algo::StableSort(GetData(), Num(), std::forward<TPred>(Pred)); }
+		// stable, integer, float or enum elements, or elements with such a key returned by KeyOf(const T&)
+		void RadixSort() { Algo::RadixSort(GetData(), Num()); }
+		template<class TKeyFunc>
+		void RadixSort(TKeyFunc&& KeyOf) { Algo::RadixSort(GetData(), Num(), std::forward<TKeyFunc>(KeyOf)); }
 
 		// support heap 
 		T& HeapTop() { return *m_Data; }
@@ -833,8 +852,8 @@ namespace Fuko
 }
 
 // TypeTraits
-template <typename T>
-struct TIsContiguousContainer<Fuko::TArray<T>>
+template <typename T, typename Alloc>
+struct TIsContiguousContainer<Fuko::TArray<T, Alloc>>
 {
 	enum { value = true };
 };
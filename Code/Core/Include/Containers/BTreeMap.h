@@ -0,0 +1,837 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include <Memory/MemoryOps.h>
+#include <Math/MathUtility.h>
+#include <Templates/Pair.h>
+#include <Templates/Functor.h>
+#include <Algo/BinarySearch.h>
+#include "Array.h"
+#include "SortedFlatMap.h"
+#include "Misc/Assert.h"
+#include "Misc/CpuInfo.h"
+#include "ContainerFwd.h"
+#if CPU_X86
+#include <emmintrin.h>
+#endif
+
+// btree element reference & range
+namespace Fuko
+{
+	// key and value live in different arrays of a leaf, iterator hand out references of both
+	template<typename KeyType, typename ValueType>
+	struct TBTreeRef
+	{
+		const KeyType&	Key;
+		ValueType&		Value;
+	};
+
+	// [First, Last) in key order
+	template<typename IteratorType>
+	struct TBTreeRange
+	{
+		IteratorType	First;
+		IteratorType	Last;
+
+		FORCEINLINE bool IsEmpty() const { return First == Last; }
+		FORCEINLINE IteratorType begin() const { return First; }
+		FORCEINLINE IteratorType end() const { return Last; }
+	};
+}
+
+// TBTreeMap
+namespace Fuko
+{
+	// in memory B+ tree, nodes are NodeBytes large so a search touch few cache lines per level
+	// keys and values of a leaf are stored apart, the search only scan keys, leaves are linked for range scan
+	template<typename KeyType, typename ValueType, typename Alloc, typename Compare, uint32 NodeBytes>
+	class TBTreeMap
+	{
+		static_assert(NodeBytes >= 128, "TBTreeMap node is too small");
+	public:
+		using ElementType = TPair<KeyType, ValueType>;
+		using ElementArrayType = TArray<ElementType, Alloc>;
+		using SizeType = typename Alloc::USizeType;
+	private:
+		static constexpr uint32 _Capacity(size_t Bytes, size_t EntryBytes) { return Bytes / EntryBytes < 4 ? 4 : (uint32)(Bytes / EntryBytes); }
+	public:
+		static constexpr uint32 LeafCapacity = _Capacity(NodeBytes - 3 * sizeof(void*), sizeof(KeyType) + sizeof(ValueType));
+		static constexpr uint32 InnerCapacity = _Capacity(NodeBytes - 2 * sizeof(void*), sizeof(KeyType) + sizeof(void*));
+		static constexpr uint32 MinLeafNum = LeafCapacity / 2;
+		static constexpr uint32 MinInnerNum = (InnerCapacity - 1) / 2;
+	private:
+		static constexpr uint32 NodeAlign = 64;
+		static constexpr uint32 MaxHeight = 32;
+
+		struct LeafNode
+		{
+			uint32		Num;
+			LeafNode*	Prev;
+			LeafNode*	Next;
+			alignas(KeyType) uint8		KeyStorage[sizeof(KeyType) * LeafCapacity];
+			alignas(ValueType) uint8	ValueStorage[sizeof(ValueType) * LeafCapacity];
+
+			FORCEINLINE KeyType* Keys() { return (KeyType*)KeyStorage; }
+			FORCEINLINE ValueType* Values() { return (ValueType*)ValueStorage; }
+		};
+		struct InnerNode
+		{
+			uint32		Num;		// key count, child count is Num + 1
+			alignas(KeyType) uint8		KeyStorage[sizeof(KeyType) * InnerCapacity];
+			void*		Children[InnerCapacity + 1];
+
+			FORCEINLINE KeyType* Keys() { return (KeyType*)KeyStorage; }
+		};
+
+		// the way down to a leaf, child Index of Node was taken
+		struct PathEntry
+		{
+			InnerNode*	Node;
+			uint32		Index;
+		};
+
+		Alloc		m_Allocator;
+		Compare		m_Less;
+		void*		m_Root;
+		LeafNode*	m_FirstLeaf;
+		LeafNode*	m_LastLeaf;
+		SizeType	m_Num;
+		uint32		m_Height;	// 0 when empty, 1 when root is a leaf
+	public:
+		// iterator in key order
+		template<bool bConst>
+		class TBaseIterator
+		{
+			friend class TBTreeMap;
+			using ItValueType = std::conditional_t<bConst, const ValueType, ValueType>;
+
+			LeafNode*	m_Leaf;
+			uint32		m_Index;
+		public:
+			FORCEINLINE TBaseIterator(LeafNode* InLeaf = nullptr, uint32 InIndex = 0) : m_Leaf(InLeaf), m_Index(InIndex) {}
+			FORCEINLINE operator TBaseIterator<true>() const { return TBaseIterator<true>(m_Leaf, m_Index); }
+
+			FORCEINLINE const KeyType& Key() const { return m_Leaf->Keys()[m_Index]; }
+			FORCEINLINE ItValueType& Value() const { return m_Leaf->Values()[m_Index]; }
+			FORCEINLINE TBTreeRef<KeyType, ItValueType> operator*() const { return { Key(), Value() }; }
+
+			FORCEINLINE TBaseIterator& operator++()
+			{
+				if (++m_Index == m_Leaf->Num)
+				{
+					m_Leaf = m_Leaf->Next;
+					m_Index = 0;
+				}
+				return *this;
+			}
+			FORCEINLINE explicit operator bool() const { return m_Leaf != nullptr; }
+			FORCEINLINE bool operator==(const TBaseIterator& Rhs) const { return m_Leaf == Rhs.m_Leaf && m_Index == Rhs.m_Index; }
+			FORCEINLINE bool operator!=(const TBaseIterator& Rhs) const { return !(*this == Rhs); }
+		};
+		using TIterator = TBaseIterator<false>;
+		using TConstIterator = TBaseIterator<true>;
+		using RangeType = TBTreeRange<TIterator>;
+		using ConstRangeType = TBTreeRange<TConstIterator>;
+	private:
+		//-----------------------------begin help function-----------------------------
+		FORCEINLINE LeafNode* _NewLeaf()
+		{
+			void* Memory = nullptr;
+			m_Allocator.ReserveRaw(Memory, sizeof(LeafNode), Math::Max(NodeAlign, (uint32)alignof(LeafNode)));
+			LeafNode* Leaf = (LeafNode*)Memory;
+			Leaf->Num = 0;
+			Leaf->Prev = Leaf->Next = nullptr;
+			return Leaf;
+		}
+		FORCEINLINE InnerNode* _NewInner()
+		{
+			void* Memory = nullptr;
+			m_Allocator.ReserveRaw(Memory, sizeof(InnerNode), Math::Max(NodeAlign, (uint32)alignof(InnerNode)));
+			InnerNode* Inner = (InnerNode*)Memory;
+			Inner->Num = 0;
+			return Inner;
+		}
+		FORCEINLINE void _FreeNode(void* Node, uint32 Align) { m_Allocator.FreeRaw(Node, Math::Max(NodeAlign, Align)); }
+		FORCEINLINE void _FreeLeaf(LeafNode* Leaf) { _FreeNode(Leaf, (uint32)alignof(LeafNode)); }
+		FORCEINLINE void _FreeInner(InnerNode* Inner) { _FreeNode(Inner, (uint32)alignof(InnerNode)); }
+
+		void _FreeTree(void* Node, uint32 Level)
+		{
+			if (Level == 1)
+			{
+				LeafNode* Leaf = (LeafNode*)Node;
+				DestructItems(Leaf->Keys(), Leaf->Num);
+				DestructItems(Leaf->Values(), Leaf->Num);
+				_FreeLeaf(Leaf);
+			}
+			else
+			{
+				InnerNode* Inner = (InnerNode*)Node;
+				for (uint32 i = 0; i <= Inner->Num; ++i) _FreeTree(Inner->Children[i], Level - 1);
+				DestructItems(Inner->Keys(), Inner->Num);
+				_FreeInner(Inner);
+			}
+		}
+		FORCEINLINE void _ResetRoot()
+		{
+			m_Root = nullptr;
+			m_FirstLeaf = m_LastLeaf = nullptr;
+			m_Num = 0;
+			m_Height = 0;
+		}
+		FORCEINLINE void _FreeAll()
+		{
+			if (m_Root) _FreeTree(m_Root, m_Height);
+			_ResetRoot();
+		}
+
+		// pull every key line of a node at once, the binary search then wait for one miss instead of a chain of them
+		// other targets skip the prefetch
+		FORCEINLINE static void _PrefetchKeys(const KeyType* Keys, uint32 Num)
+		{
+#if CPU_X86
+			for (size_t Offset = 0; Offset < Num * sizeof(KeyType); Offset += NodeAlign) _mm_prefetch((const char*)Keys + Offset, _MM_HINT_T0);
+#endif
+		}
+
+		// search in one node
+		FORCEINLINE uint32 _LowerBoundInNode(const KeyType* Keys, uint32 Num, const KeyType& Key) const
+		{
+			return Algo::Impl::LowerBoundInternal(Keys, Num, Key, NoMap(), m_Less);
+		}
+		FORCEINLINE uint32 _UpperBoundInNode(const KeyType* Keys, uint32 Num, const KeyType& Key) const
+		{
+			return Algo::Impl::UpperBoundInternal(Keys, Num, Key, NoMap(), m_Less);
+		}
+
+		// walk down to the leaf that may hold Key, record the way if OutPath given
+		FORCEINLINE LeafNode* _FindLeaf(const KeyType& Key, PathEntry* OutPath = nullptr) const
+		{
+			void* Node = m_Root;
+			for (uint32 Level = m_Height, Depth = 0; Level > 1; --Level, ++Depth)
+			{
+				InnerNode* Inner = (InnerNode*)Node;
+				_PrefetchKeys(Inner->Keys(), Inner->Num);
+				uint32 Index = _UpperBoundInNode(Inner->Keys(), Inner->Num, Key);
+				if (OutPath) OutPath[Depth] = { Inner, Index };
+				Node = Inner->Children[Index];
+			}
+			_PrefetchKeys(((LeafNode*)Node)->Keys(), ((LeafNode*)Node)->Num);
+			return (LeafNode*)Node;
+		}
+		FORCEINLINE TIterator _Normalize(LeafNode* Leaf, uint32 Index) const
+		{
+			return Index < Leaf->Num ? TIterator(Leaf, Index) : TIterator(Leaf->Next, 0);
+		}
+
+		// insert key and right child at key position Pos, node must have room
+		FORCEINLINE void _InnerInsert(InnerNode* Inner, uint32 Pos, KeyType&& Key, void* Child)
+		{
+			RelocateConstructItems(Inner->Keys() + Pos + 1, Inner->Keys() + Pos, Inner->Num - Pos);
+			RelocateConstructItems(Inner->Children + Pos + 2, Inner->Children + Pos + 1, Inner->Num - Pos);
+			new(Inner->Keys() + Pos) KeyType(std::move(Key));
+			Inner->Children[Pos + 1] = Child;
+			++Inner->Num;
+		}
+		// remove key at Pos and the child on its right
+		FORCEINLINE void _InnerRemove(InnerNode* Inner, uint32 Pos)
+		{
+			DestructItems(Inner->Keys() + Pos, 1);
+			RelocateConstructItems(Inner->Keys() + Pos, Inner->Keys() + Pos + 1, Inner->Num - Pos - 1);
+			RelocateConstructItems(Inner->Children + Pos + 1, Inner->Children + Pos + 2, Inner->Num - Pos - 1);
+			--Inner->Num;
+		}
+
+		// a child at Path[Depth - 1] split, push separator and new right node up, split inner nodes on the way
+		void _InsertSeparator(PathEntry* Path, uint32 Depth, KeyType Separator, void* RightChild)
+		{
+			while (Depth > 0)
+			{
+				--Depth;
+				InnerNode* Inner = Path[Depth].Node;
+				uint32 Pos = Path[Depth].Index;
+				if (Inner->Num < InnerCapacity)
+				{
+					_InnerInsert(Inner, Pos, std::move(Separator), RightChild);
+					return;
+				}
+
+				// split full node, middle key go up
+				constexpr uint32 Mid = InnerCapacity / 2;
+				InnerNode* Right = _NewInner();
+				KeyType Promote(std::move(Inner->Keys()[Mid]));
+				DestructItems(Inner->Keys() + Mid, 1);
+				Right->Num = InnerCapacity - Mid - 1;
+				RelocateConstructItems(Right->Keys(), Inner->Keys() + Mid + 1, Right->Num);
+				RelocateConstructItems(Right->Children, Inner->Children + Mid + 1, Right->Num + 1);
+				Inner->Num = Mid;
+
+				if (Pos <= Mid) _InnerInsert(Inner, Pos, std::move(Separator), RightChild);
+				else _InnerInsert(Right, Pos - Mid - 1, std::move(Separator), RightChild);
+
+				Separator = std::move(Promote);
+				RightChild = Right;
+			}
+
+			// root split, tree grow one level
+			InnerNode* Root = _NewInner();
+			new(Root->Keys()) KeyType(std::move(Separator));
+			Root->Children[0] = m_Root;
+			Root->Children[1] = RightChild;
+			Root->Num = 1;
+			m_Root = Root;
+			++m_Height;
+		}
+
+		template <typename InitKeyType, typename...InitValueType>
+		ValueType& _FindOrAddImpl(bool bReplace, InitKeyType&& Key, InitValueType&&...Value)
+		{
+			if (!m_Root)
+			{
+				m_Root = m_FirstLeaf = m_LastLeaf = _NewLeaf();
+				m_Height = 1;
+			}
+
+			PathEntry Path[MaxHeight];
+			LeafNode* Leaf = _FindLeaf(Key, Path);
+			uint32 Pos = _LowerBoundInNode(Leaf->Keys(), Leaf->Num, Key);
+			if (Pos < Leaf->Num && !m_Less(Key, Leaf->Keys()[Pos]))
+			{
+				if (bReplace) Leaf->Values()[Pos] = ValueType(std::forward<InitValueType>(Value)...);
+				return Leaf->Values()[Pos];
+			}
+
+			// split full leaf before insert, upper half go to a new right leaf
+			LeafNode* Right = nullptr;
+			if (Leaf->Num == LeafCapacity)
+			{
+				constexpr uint32 Mid = LeafCapacity / 2;
+				Right = _NewLeaf();
+				Right->Num = LeafCapacity - Mid;
+				RelocateConstructItems(Right->Keys(), Leaf->Keys() + Mid, Right->Num);
+				RelocateConstructItems(Right->Values(), Leaf->Values() + Mid, Right->Num);
+				Leaf->Num = Mid;
+
+				Right->Prev = Leaf;
+				Right->Next = Leaf->Next;
+				if (Leaf->Next) Leaf->Next->Prev = Right;
+				else m_LastLeaf = Right;
+				Leaf->Next = Right;
+
+				if (Pos > Mid)
+				{
+					Leaf = Right;
+					Pos -= Mid;
+				}
+			}
+
+			RelocateConstructItems(Leaf->Keys() + Pos + 1, Leaf->Keys() + Pos, Leaf->Num - Pos);
+			RelocateConstructItems(Leaf->Values() + Pos + 1, Leaf->Values() + Pos, Leaf->Num - Pos);
+			new(Leaf->Keys() + Pos) KeyType(std::forward<InitKeyType>(Key));
+			ValueType* Result = new(Leaf->Values() + Pos) ValueType(std::forward<InitValueType>(Value)...);
+			++Leaf->Num;
+			++m_Num;
+
+			if (Right) _InsertSeparator(Path, m_Height - 1, Right->Keys()[0], Right);
+			return *Result;
+		}
+
+		// fix an inner node with too few keys, borrow from a sibling or merge with it
+		void _RebalanceInner(PathEntry* Path, uint32 Depth)
+		{
+			for (;;)
+			{
+				InnerNode* Inner = Path[Depth].Node;
+				if (Depth == 0)
+				{
+					// root with one child, tree shrink one level
+					if (Inner->Num == 0)
+					{
+						m_Root = Inner->Children[0];
+						--m_Height;
+						_FreeInner(Inner);
+					}
+					return;
+				}
+				if (Inner->Num >= MinInnerNum) return;
+
+				InnerNode* Parent = Path[Depth - 1].Node;
+				uint32 Index = Path[Depth - 1].Index;
+				InnerNode* Left = Index > 0 ? (InnerNode*)Parent->Children[Index - 1] : nullptr;
+				InnerNode* Right = Index < Parent->Num ? (InnerNode*)Parent->Children[Index + 1] : nullptr;
+
+				// rotate through parent
+				if (Left && Left->Num > MinInnerNum)
+				{
+					RelocateConstructItems(Inner->Keys() + 1, Inner->Keys(), Inner->Num);
+					RelocateConstructItems(Inner->Children + 1, Inner->Children, Inner->Num + 1);
+					new(Inner->Keys()) KeyType(std::move(Parent->Keys()[Index - 1]));
+					Inner->Children[0] = Left->Children[Left->Num];
+					Parent->Keys()[Index - 1] = std::move(Left->Keys()[Left->Num - 1]);
+					DestructItems(Left->Keys() + Left->Num - 1, 1);
+					--Left->Num;
+					++Inner->Num;
+					return;
+				}
+				if (Right && Right->Num > MinInnerNum)
+				{
+					new(Inner->Keys() + Inner->Num) KeyType(std::move(Parent->Keys()[Index]));
+					Inner->Children[Inner->Num + 1] = Right->Children[0];
+					Parent->Keys()[Index] = std::move(Right->Keys()[0]);
+					DestructItems(Right->Keys(), 1);
+					RelocateConstructItems(Right->Keys(), Right->Keys() + 1, Right->Num - 1);
+					RelocateConstructItems(Right->Children, Right->Children + 1, Right->Num);
+					--Right->Num;
+					++Inner->Num;
+					return;
+				}
+
+				// merge right into left, separator come down between them
+				InnerNode* MergeLeft = Left ? Left : Inner;
+				InnerNode* MergeRight = Left ? Inner : Right;
+				uint32 SeparatorIndex = Left ? Index - 1 : Index;
+				new(MergeLeft->Keys() + MergeLeft->Num) KeyType(std::move(Parent->Keys()[SeparatorIndex]));
+				RelocateConstructItems(MergeLeft->Keys() + MergeLeft->Num + 1, MergeRight->Keys(), MergeRight->Num);
+				RelocateConstructItems(MergeLeft->Children + MergeLeft->Num + 1, MergeRight->Children, MergeRight->Num + 1);
+				MergeLeft->Num += MergeRight->Num + 1;
+				_FreeInner(MergeRight);
+				_InnerRemove(Parent, SeparatorIndex);
+				--Depth;
+			}
+		}
+
+		// fix a leaf with too few pairs
+		void _RebalanceLeaf(PathEntry* Path, uint32 Depth, LeafNode* Leaf)
+		{
+			if (Depth == 0)
+			{
+				if (Leaf->Num == 0)
+				{
+					_FreeLeaf(Leaf);
+					_ResetRoot();
+				}
+				return;
+			}
+			if (Leaf->Num >= MinLeafNum) return;
+
+			InnerNode* Parent = Path[Depth - 1].Node;
+			uint32 Index = Path[Depth - 1].Index;
+			LeafNode* Left = Index > 0 ? (LeafNode*)Parent->Children[Index - 1] : nullptr;
+			LeafNode* Right = Index < Parent->Num ? (LeafNode*)Parent->Children[Index + 1] : nullptr;
+
+			// borrow one pair, separator become the first key of the right one
+			if (Left && Left->Num > MinLeafNum)
+			{
+				RelocateConstructItems(Leaf->Keys() + 1, Leaf->Keys(), Leaf->Num);
+				RelocateConstructItems(Leaf->Values() + 1, Leaf->Values(), Leaf->Num);
+				--Left->Num;
+				RelocateConstructItems(Leaf->Keys(), Left->Keys() + Left->Num, 1);
+				RelocateConstructItems(Leaf->Values(), Left->Values() + Left->Num, 1);
+				++Leaf->Num;
+				Parent->Keys()[Index - 1] = Leaf->Keys()[0];
+				return;
+			}
+			if (Right && Right->Num > MinLeafNum)
+			{
+				RelocateConstructItems(Leaf->Keys() + Leaf->Num, Right->Keys(), 1);
+				RelocateConstructItems(Leaf->Values() + Leaf->Num, Right->Values(), 1);
+				++Leaf->Num;
+				--Right->Num;
+				RelocateConstructItems(Right->Keys(), Right->Keys() + 1, Right->Num);
+				RelocateConstructItems(Right->Values(), Right->Values() + 1, Right->Num);
+				Parent->Keys()[Index] = Right->Keys()[0];
+				return;
+			}
+
+			// merge right into left and unlink it
+			LeafNode* MergeLeft = Left ? Left : Leaf;
+			LeafNode* MergeRight = Left ? Leaf : Right;
+			RelocateConstructItems(MergeLeft->Keys() + MergeLeft->Num, MergeRight->Keys(), MergeRight->Num);
+			RelocateConstructItems(MergeLeft->Values() + MergeLeft->Num, MergeRight->Values(), MergeRight->Num);
+			MergeLeft->Num += MergeRight->Num;
+			MergeLeft->Next = MergeRight->Next;
+			if (MergeRight->Next) MergeRight->Next->Prev = MergeLeft;
+			else m_LastLeaf = MergeLeft;
+			_FreeLeaf(MergeRight);
+			_InnerRemove(Parent, Left ? Index - 1 : Index);
+			_RebalanceInner(Path, Depth - 1);
+		}
+
+		bool _RemoveImpl(const KeyType& Key, ValueType* OutRemovedValue)
+		{
+			if (!m_Root) return false;
+
+			PathEntry Path[MaxHeight];
+			LeafNode* Leaf = _FindLeaf(Key, Path);
+			uint32 Pos = _LowerBoundInNode(Leaf->Keys(), Leaf->Num, Key);
+			if (Pos == Leaf->Num || m_Less(Key, Leaf->Keys()[Pos])) return false;
+
+			if (OutRemovedValue) *OutRemovedValue = std::move(Leaf->Values()[Pos]);
+			DestructItems(Leaf->Keys() + Pos, 1);
+			DestructItems(Leaf->Values() + Pos, 1);
+			RelocateConstructItems(Leaf->Keys() + Pos, Leaf->Keys() + Pos + 1, Leaf->Num - Pos - 1);
+			RelocateConstructItems(Leaf->Values() + Pos, Leaf->Values() + Pos + 1, Leaf->Num - Pos - 1);
+			--Leaf->Num;
+			--m_Num;
+
+			_RebalanceLeaf(Path, m_Height - 1, Leaf);
+			return true;
+		}
+
+		// build from sorted unique pairs bottom up, every level is packed full and balanced
+		void _BuildSorted(ElementArrayType& Pairs)
+		{
+			_FreeAll();
+			const SizeType Num = Pairs.Num();
+			if (!Num) return;
+
+			// leaves, pairs are spread even so the last leaf never underflow
+			TArray<void*> Level;
+			TArray<const KeyType*> MinKeys;
+			{
+				const uint32 LeafNum = (uint32)((Num + LeafCapacity - 1) / LeafCapacity);
+				Level.Reserve(LeafNum);
+				MinKeys.Reserve(LeafNum);
+				ElementType* Source = Pairs.GetData();
+				LeafNode* Prev = nullptr;
+				for (uint32 i = 0; i < LeafNum; ++i)
+				{
+					LeafNode* Leaf = _NewLeaf();
+					Leaf->Num = Num / LeafNum + (i < Num % LeafNum ? 1 : 0);
+					for (uint32 j = 0; j < Leaf->Num; ++j, ++Source)
+					{
+						new(Leaf->Keys() + j) KeyType(std::move(Source->Key));
+						new(Leaf->Values() + j) ValueType(std::move(Source->Value));
+					}
+					Leaf->Prev = Prev;
+					if (Prev) Prev->Next = Leaf;
+					else m_FirstLeaf = Leaf;
+					Prev = Leaf;
+					Level.Add(Leaf);
+					MinKeys.Add(Leaf->Keys());
+				}
+				m_LastLeaf = Prev;
+				m_Height = 1;
+			}
+
+			// inner levels until one root left, separator is the min key of the right subtree
+			while (Level.Num() > 1)
+			{
+				const uint32 ChildNum = Level.Num();
+				const uint32 InnerNum = (ChildNum + InnerCapacity) / (InnerCapacity + 1);
+				uint32 Child = 0;
+				for (uint32 i = 0; i < InnerNum; ++i)
+				{
+					InnerNode* Inner = _NewInner();
+					uint32 Count = ChildNum / InnerNum + (i < ChildNum % InnerNum ? 1 : 0);
+					const KeyType* MinKey = MinKeys[Child];
+					Inner->Children[0] = Level[Child++];
+					for (uint32 j = 1; j < Count; ++j, ++Child)
+					{
+						new(Inner->Keys() + j - 1) KeyType(*MinKeys[Child]);
+						Inner->Children[j] = Level[Child];
+					}
+					Inner->Num = Count - 1;
+					Level[i] = Inner;
+					MinKeys[i] = MinKey;
+				}
+				Level.SetNum(InnerNum, false);
+				MinKeys.SetNum(InnerNum, false);
+				++m_Height;
+			}
+			m_Root = Level[0];
+			m_Num = Num;
+		}
+
+		// move all pairs out in key order and free the tree
+		void _DrainTo(ElementArrayType& OutPairs)
+		{
+			OutPairs.Reserve(OutPairs.Num() + m_Num);
+			for (LeafNode* Leaf = m_FirstLeaf; Leaf; Leaf = Leaf->Next)
+			{
+				for (uint32 i = 0; i < Leaf->Num; ++i) OutPairs.Emplace(std::move(Leaf->Keys()[i]), std::move(Leaf->Values()[i]));
+			}
+			_FreeAll();
+		}
+
+		// merge a sorted unique batch, large batch rebuild the tree in one pass, small batch is inserted one by one
+		void _MergeSorted(ElementArrayType& Batch)
+		{
+			if (Batch.IsEmpty()) return;
+			if (!m_Root)
+			{
+				_BuildSorted(Batch);
+				return;
+			}
+			if (Batch.Num() * 8 < m_Num)
+			{
+				for (ElementType& Pair : Batch) Emplace(std::move(Pair.Key), std::move(Pair.Value));
+				return;
+			}
+
+			ElementArrayType Old;
+			_DrainTo(Old);
+			ElementArrayType Merged;
+			Merged.Reserve(Old.Num() + Batch.Num());
+			SizeType i = 0, j = 0;
+			while (i < Old.Num() && j < Batch.Num())
+			{
+				if (m_Less(Old[i].Key, Batch[j].Key))
+				{
+					Merged.Add(std::move(Old[i++]));
+				}
+				else
+				{
+					if (!m_Less(Batch[j].Key, Old[i].Key)) ++i;
+					Merged.Add(std::move(Batch[j++]));
+				}
+			}
+			for (; i < Old.Num(); ++i) Merged.Add(std::move(Old[i]));
+			for (; j < Batch.Num(); ++j) Merged.Add(std::move(Batch[j]));
+			_BuildSorted(Merged);
+		}
+
+		void _CopyFrom(const TBTreeMap& Other)
+		{
+			ElementArrayType Pairs;
+			Pairs.Reserve(Other.m_Num);
+			for (LeafNode* Leaf = Other.m_FirstLeaf; Leaf; Leaf = Leaf->Next)
+			{
+				for (uint32 i = 0; i < Leaf->Num; ++i) Pairs.Emplace(Leaf->Keys()[i], Leaf->Values()[i]);
+			}
+			_BuildSorted(Pairs);
+		}
+		FORCEINLINE void _MoveFrom(TBTreeMap& Other)
+		{
+			m_Root = Other.m_Root;
+			m_FirstLeaf = Other.m_FirstLeaf;
+			m_LastLeaf = Other.m_LastLeaf;
+			m_Num = Other.m_Num;
+			m_Height = Other.m_Height;
+			Other._ResetRoot();
+		}
+		//------------------------------end help function------------------------------
+	public:
+		// construct
+		FORCEINLINE TBTreeMap(const Alloc& InAlloc = Alloc(), const Compare& InLess = Compare())
+			: m_Allocator(InAlloc)
+			, m_Less(InLess)
+			, m_Root(nullptr)
+			, m_FirstLeaf(nullptr)
+			, m_LastLeaf(nullptr)
+			, m_Num(0)
+			, m_Height(0)
+		{}
+		TBTreeMap(std::initializer_list<ElementType> InitList, const Alloc& InAlloc = Alloc(), const Compare& InLess = Compare())
+			: TBTreeMap(InAlloc, InLess)
+		{
+			ElementArrayType Pairs(InitList);
+			Build(std::move(Pairs));
+		}
+
+		// copy & move
+		TBTreeMap(const TBTreeMap& Other)
+			: TBTreeMap(Other.m_Allocator, Other.m_Less)
+		{
+			_CopyFrom(Other);
+		}
+		FORCEINLINE TBTreeMap(TBTreeMap&& Other)
+			: m_Allocator(std::move(Other.m_Allocator))
+			, m_Less(std::move(Other.m_Less))
+		{
+			_MoveFrom(Other);
+		}
+		TBTreeMap& operator=(const TBTreeMap& Other)
+		{
+			if (this == &Other) return *this;
+			_FreeAll();
+			m_Allocator = Other.m_Allocator;
+			m_Less = Other.m_Less;
+			_CopyFrom(Other);
+			return *this;
+		}
+		FORCEINLINE TBTreeMap& operator=(TBTreeMap&& Other)
+		{
+			if (this == &Other) return *this;
+			_FreeAll();
+			m_Allocator = std::move(Other.m_Allocator);
+			m_Less = std::move(Other.m_Less);
+			_MoveFrom(Other);
+			return *this;
+		}
+
+		// destruct
+		FORCEINLINE ~TBTreeMap() { _FreeAll(); }
+
+		// operators
+		FORCEINLINE void Empty() { _FreeAll(); }
+		FORCEINLINE void Reset() { _FreeAll(); }
+		FORCEINLINE SizeType Num() const { return m_Num; }
+		FORCEINLINE bool IsEmpty() const { return m_Num == 0; }
+		FORCEINLINE uint32 Height() const { return m_Height; }
+
+		// bulk load, replace all pairs, unsorted input is sorted once, the last pair of a key win
+		void Build(ElementArrayType&& Pairs)
+		{
+			SortUniquePairs(Pairs, m_Less);
+			_BuildSorted(Pairs);
+		}
+		void Build(const ElementType* Pairs, SizeType Count)
+		{
+			ElementArrayType Batch;
+			if (Count) Batch.Insert(Pairs, Count, 0);
+			Build(std::move(Batch));
+		}
+
+		// merge insert a batch, pairs of the batch replace existing values
+		void Merge(ElementArrayType&& Pairs)
+		{
+			SortUniquePairs(Pairs, m_Less);
+			_MergeSorted(Pairs);
+		}
+		void Merge(const ElementType* Pairs, SizeType Count)
+		{
+			if (!Count) return;
+			ElementArrayType Batch(Pairs, Count);
+			Merge(std::move(Batch));
+		}
+
+		// add, replace the value of an existing key
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, std::move(InValue)); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(std::move(InKey), InValue); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(std::move(InKey), std::move(InValue)); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey) { return Emplace(InKey); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey) { return Emplace(std::move(InKey)); }
+
+		// emplace
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& Emplace(InitKeyType&& InKey, InitValueType&&...InValue)
+		{
+			return _FindOrAddImpl(true, std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue)...);
+		}
+
+		// find or add
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key) { return _FindOrAddImpl(false, Key); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key) { return _FindOrAddImpl(false, std::move(Key)); }
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key, const ValueType& Value) { return _FindOrAddImpl(false, Key, Value); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key, ValueType&& Value) { return _FindOrAddImpl(false, std::move(Key), std::move(Value)); }
+
+		// remove
+		FORCEINLINE SizeType Remove(const KeyType& Key) { return _RemoveImpl(Key, nullptr) ? 1 : 0; }
+		FORCEINLINE bool RemoveAndCopyValue(const KeyType& Key, ValueType& OutRemovedValue) { return _RemoveImpl(Key, &OutRemovedValue); }
+		ValueType FindAndRemoveChecked(const KeyType& Key)
+		{
+			ValueType Result;
+			bool bRemoved = _RemoveImpl(Key, &Result);
+			check(bRemoved);
+			return Result;
+		}
+
+		// find
+		FORCEINLINE ValueType* Find(const KeyType& Key)
+		{
+			if (!m_Root) return nullptr;
+			LeafNode* Leaf = _FindLeaf(Key);
+			uint32 Pos = _LowerBoundInNode(Leaf->Keys(), Leaf->Num, Key);
+			return (Pos < Leaf->Num && !m_Less(Key, Leaf->Keys()[Pos])) ? Leaf->Values() + Pos : nullptr;
+		}
+		FORCEINLINE const ValueType* Find(const KeyType& Key) const { return const_cast<TBTreeMap*>(this)->Find(Key); }
+		FORCEINLINE ValueType& FindChecked(const KeyType& Key)
+		{
+			ValueType* Value = Find(Key);
+			check(Value != nullptr);
+			return *Value;
+		}
+		FORCEINLINE const ValueType& FindChecked(const KeyType& Key) const { return const_cast<TBTreeMap*>(this)->FindChecked(Key); }
+		FORCEINLINE ValueType FindRef(const KeyType& Key) const
+		{
+			const ValueType* Value = Find(Key);
+			return Value ? *Value : ValueType();
+		}
+		FORCEINLINE bool Contains(const KeyType& Key) const { return Find(Key) != nullptr; }
+
+		// ordered query, first pair with key not less than / greater than Key
+		FORCEINLINE TIterator LowerBound(const KeyType& Key)
+		{
+			if (!m_Root) return TIterator();
+			LeafNode* Leaf = _FindLeaf(Key);
+			return _Normalize(Leaf, _LowerBoundInNode(Leaf->Keys(), Leaf->Num, Key));
+		}
+		FORCEINLINE TIterator UpperBound(const KeyType& Key)
+		{
+			if (!m_Root) return TIterator();
+			LeafNode* Leaf = _FindLeaf(Key);
+			return _Normalize(Leaf, _UpperBoundInNode(Leaf->Keys(), Leaf->Num, Key));
+		}
+		FORCEINLINE TConstIterator LowerBound(const KeyType& Key) const { return const_cast<TBTreeMap*>(this)->LowerBound(Key); }
+		FORCEINLINE TConstIterator UpperBound(const KeyType& Key) const { return const_cast<TBTreeMap*>(this)->UpperBound(Key); }
+
+		// pairs with key in [Lower, Upper)
+		FORCEINLINE RangeType Range(const KeyType& Lower, const KeyType& Upper)
+		{
+			TIterator First = LowerBound(Lower);
+			return { First, m_Less(Lower, Upper) ? LowerBound(Upper) : First };
+		}
+		FORCEINLINE ConstRangeType Range(const KeyType& Lower, const KeyType& Upper) const
+		{
+			RangeType Result = const_cast<TBTreeMap*>(this)->Range(Lower, Upper);
+			return { Result.First, Result.Last };
+		}
+
+		// call Func(Key, Value) for keys in [Lower, Upper), scan leaves without iterator
+		template<typename TFunc>
+		void ForEachRange(const KeyType& Lower, const KeyType& Upper, TFunc&& Func)
+		{
+			if (!m_Root || !m_Less(Lower, Upper)) return;
+			LeafNode* Leaf = _FindLeaf(Lower);
+			uint32 Pos = _LowerBoundInNode(Leaf->Keys(), Leaf->Num, Lower);
+			for (; Leaf; Leaf = Leaf->Next, Pos = 0)
+			{
+				KeyType* Keys = Leaf->Keys();
+				ValueType* Values = Leaf->Values();
+				for (; Pos < Leaf->Num; ++Pos)
+				{
+					if (!m_Less(Keys[Pos], Upper)) return;
+					Func(Keys[Pos], Values[Pos]);
+				}
+			}
+		}
+		template<typename TFunc>
+		void ForEachRange(const KeyType& Lower, const KeyType& Upper, TFunc&& Func) const
+		{
+			const_cast<TBTreeMap*>(this)->ForEachRange(Lower, Upper, [&Func](const KeyType& Key, const ValueType& Value) { Func(Key, Value); });
+		}
+
+		// first & last pair
+		FORCEINLINE TIterator First() { return TIterator(m_FirstLeaf, 0); }
+		FORCEINLINE TIterator Last() { return m_LastLeaf ? TIterator(m_LastLeaf, m_LastLeaf->Num - 1) : TIterator(); }
+
+		// debug check, order, fill of every node, leaf links and count
+		void CheckInvariants() const
+		{
+			if (!m_Root)
+			{
+				check(m_Num == 0 && m_Height == 0 && !m_FirstLeaf && !m_LastLeaf);
+				return;
+			}
+			SizeType Count = 0;
+			LeafNode* Prev = nullptr;
+			for (LeafNode* Leaf = m_FirstLeaf; Leaf; Prev = Leaf, Leaf = Leaf->Next)
+			{
+				check(Leaf->Prev == Prev);
+				check(Leaf == m_Root || (Leaf->Num >= MinLeafNum && Leaf->Num <= LeafCapacity));
+				for (uint32 i = 1; i < Leaf->Num; ++i) check(m_Less(Leaf->Keys()[i - 1], Leaf->Keys()[i]));
+				if (Prev && Leaf->Num) check(m_Less(Prev->Keys()[Prev->Num - 1], Leaf->Keys()[0]));
+				Count += Leaf->Num;
+			}
+			check(Prev == m_LastLeaf && Count == m_Num);
+		}
+
+		// iterator
+		FORCEINLINE TIterator begin() { return TIterator(m_FirstLeaf, 0); }
+		FORCEINLINE TConstIterator begin() const { return TConstIterator(m_FirstLeaf, 0); }
+		FORCEINLINE TIterator end() { return TIterator(); }
+		FORCEINLINE TConstIterator end() const { return TConstIterator(); }
+	};
+}
@@ -145,80 +145,81 @@ namespace Fuko
 // Set Bit iterator
 namespace Fuko
 {
+	// keep the unvisited bits of the current word, ++ clear the lowest one and count trailing zeros
+	// empty words are skipped 4 at a time, so sparse arrays cost by words and set bits, not by bits
 	template<typename SizeType>
 	class TConstSetBitIterator
 	{
 		const uint32*	m_Data;
 		SizeType		m_Num;
-		SizeType		m_DWORDIndex;		// current bit index 
-		uint32			m_Mask;				// current bit mask
-		uint32			m_UnvisitedBitMask;	// mask to skip start bits 
-		SizeType		m_CurrentBitIndex;	// current reach bit index
+		SizeType		m_DWORDIndex;		// word of current bit
+		uint32			m_RemainingBits;	// unvisited set bits of current word, current bit included
+		SizeType		m_CurrentBitIndex;	// current set bit index, m_Num when done
 
 		void FindFirstSetBit()
 		{
-			const uint32*	ArrayData = m_Data;
-			const SizeType	ArrayNum = m_Num;
-			const SizeType	LastDWORDIndex = (ArrayNum - 1) / NumBitsPerDWORD;
-
-			// skip zero int32 
-			uint32 RemainingBitMask = ArrayData[m_DWORDIndex] & m_UnvisitedBitMask;
-			while (!RemainingBitMask)
+			if (!m_RemainingBits)
 			{
-				++m_DWORDIndex;
+				const SizeType NumWords = (m_Num + NumBitsPerDWORD - 1) >> NumBitsPerDWORDLogTwo;
+				const uint32* ArrayData = m_Data;
+				SizeType Word = m_DWORDIndex + 1;
+
+				// skip empty words
+				while (Word + 4 <= NumWords && (ArrayData[Word] | ArrayData[Word + 1] | ArrayData[Word + 2] | ArrayData[Word + 3]) == 0) Word += 4;
+				while (Word < NumWords && ArrayData[Word] == 0) ++Word;
 
-				// Out of bounds 
-				if (m_DWORDIndex > LastDWORDIndex)
+				// out of bounds
+				if (Word >= NumWords)
 				{
-					m_CurrentBitIndex = ArrayNum;
+					m_DWORDIndex = NumWords;
+					m_CurrentBitIndex = m_Num;
 					return;
 				}
-
-				RemainingBitMask = ArrayData[m_DWORDIndex];
-				m_UnvisitedBitMask = FullMask;
+				m_DWORDIndex = Word;
+				m_RemainingBits = ArrayData[Word];
 			}
 
-			// get bit mask
-			const uint32 NewRemainingBitMask = RemainingBitMask & (RemainingBitMask - 1);
-			m_Mask = NewRemainingBitMask ^ RemainingBitMask;
-
-			// If the Nth bit was the lowest set bit of BitMask, then this gives us N
-			m_CurrentBitIndex = (m_DWORDIndex + 1) * NumBitsPerDWORD - Math::CountLeadingZeros(m_Mask) - 1;
+			m_CurrentBitIndex = (m_DWORDIndex << NumBitsPerDWORDLogTwo) + (SizeType)Math::CountTrailingZeros(m_RemainingBits);
 
 			// out of bounds
-			if (m_CurrentBitIndex > ArrayNum) m_CurrentBitIndex = ArrayNum;
+			if (m_CurrentBitIndex > m_Num) m_CurrentBitIndex = m_Num;
+		}
+		FORCEINLINE void Init(SizeType StartIndex)
+		{
+			check(StartIndex >= 0 && StartIndex <= m_Num);
+			if (StartIndex == m_Num)
+			{
+				m_RemainingBits = 0;
+				return;
+			}
+			m_RemainingBits = m_Data[m_DWORDIndex] & (FullMask << (StartIndex & PerDWORDMask));
+			FindFirstSetBit();
 		}
 	public:
 		template<typename TAlloc>
 		TConstSetBitIterator(const TBitArray<TAlloc>& InArray, SizeType StartIndex = 0)
-			: m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
-			, m_Mask(1 << (StartIndex & PerDWORDMask))
-			, m_Data(InArray.GetData())
+			: m_Data(InArray.GetData())
 			, m_Num(InArray.Num())
-			, m_UnvisitedBitMask(FullMask << (StartIndex & PerDWORDMask))
+			, m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
 			, m_CurrentBitIndex(StartIndex)
 		{
-			check(StartIndex >= 0 && StartIndex <= m_Num);
-			if (StartIndex != m_Num) FindFirstSetBit();
+			Init(StartIndex);
 		}
 		TConstSetBitIterator(const uint32* Data,SizeType Num, SizeType StartIndex = 0)
-			: m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
-			, m_Mask(1 << (StartIndex & PerDWORDMask))
-			, m_Data(Data)
+			: m_Data(Data)
 			, m_Num(Num)
-			, m_UnvisitedBitMask(FullMask << (StartIndex & PerDWORDMask))
+			, m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
 			, m_CurrentBitIndex(StartIndex)
 		{
-			check(StartIndex >= 0 && StartIndex <= m_Num);
-			if (StartIndex != m_Num) FindFirstSetBit();
+			Init(StartIndex);
 		}
 
 		FORCEINLINE TConstSetBitIterator& operator++()
 		{
-			// skip current mask 
-			m_UnvisitedBitMask &= ~m_Mask;
+			// skip current bit
+			m_RemainingBits &= m_RemainingBits - 1;
 
-			// find next mask 
+			// find next bit
 			FindFirstSetBit();
 			return *this;
 		}
@@ -237,86 +238,83 @@ namespace Fuko
 		SizeType	m_NumA;
 		SizeType	m_NumB;
 
-		SizeType	m_DWORDIndex;		// current bit index 
-		uint32		m_Mask;				// current bit mask
-		uint32		m_UnvisitedBitMask;	// mask to skip start bits 
-		SizeType	m_CurrentBitIndex;	// current reach bit index
+		SizeType	m_DWORDIndex;		// word of current bit
+		uint32		m_RemainingBits;	// unvisited bits set in both arrays, current bit included
+		SizeType	m_CurrentBitIndex;	// current bit index, m_NumA when done
 
 		void FindFirstSetBit()
 		{
-			static const uint32 EmptyArrayData = 0;
-			const uint32* ArrayDataA = m_DataA ? m_DataA : &EmptyArrayData;
-			const uint32* ArrayDataB = m_DataB ? m_DataB : &EmptyArrayData;
-			const SizeType ArrayNum = m_NumA;
-			const SizeType LastDWORDIndex = (m_NumA - 1) / NumBitsPerDWORD;
-
-			// skip zero int32 
-			uint32 RemainingBitMask = ArrayDataA[m_DWORDIndex] & ArrayDataB[m_DWORDIndex] & m_UnvisitedBitMask;
-			while (!RemainingBitMask)
+			if (!m_RemainingBits)
 			{
-				m_DWORDIndex++;
+				const SizeType NumWords = (m_NumA + NumBitsPerDWORD - 1) >> NumBitsPerDWORDLogTwo;
+				SizeType Word = m_DWORDIndex + 1;
 
-				// out of bounds 
-				if (m_DWORDIndex > LastDWORDIndex)
+				// skip empty words
+				while (Word < NumWords && (m_DataA[Word] & m_DataB[Word]) == 0) ++Word;
+
+				// out of bounds
+				if (Word >= NumWords)
 				{
+					m_DWORDIndex = NumWords;
 					m_CurrentBitIndex = m_NumA;
 					return;
 				}
-				RemainingBitMask = ArrayDataA[m_DWORDIndex] & ArrayDataB[m_DWORDIndex];
-				m_UnvisitedBitMask = FullMask;
-			};
-
-			// get bit mask 
-			const uint32 NewRemainingBitMask = RemainingBitMask & (RemainingBitMask - 1);
-			m_Mask = NewRemainingBitMask ^ RemainingBitMask;
+				m_DWORDIndex = Word;
+				m_RemainingBits = m_DataA[Word] & m_DataB[Word];
+			}
 
-			// set current bit index 
-			m_CurrentBitIndex = (m_DWORDIndex + 1) * NumBitsPerDWORD - Math::CountLeadingZeros(m_Mask) - 1;
+			m_CurrentBitIndex = (m_DWORDIndex << NumBitsPerDWORDLogTwo) + (SizeType)Math::CountTrailingZeros(m_RemainingBits);
+			if (m_CurrentBitIndex > m_NumA) m_CurrentBitIndex = m_NumA;
+		}
+		FORCEINLINE void Init(SizeType StartIndex)
+		{
+			check(m_NumA == m_NumB);
+			check(StartIndex >= 0 && StartIndex <= m_NumA);
+			if (StartIndex == m_NumA)
+			{
+				m_RemainingBits = 0;
+				return;
+			}
+			m_RemainingBits = m_DataA[m_DWORDIndex] & m_DataB[m_DWORDIndex] & (FullMask << (StartIndex & PerDWORDMask));
+			FindFirstSetBit();
 		}
 	public:
-		template<typename TAllocA, template<typename> typename TAllocB>
+		template<typename TAllocA, typename TAllocB>
 		FORCEINLINE TConstDualSetBitIterator(
 			const TBitArray<TAllocA>& InArrayA,
 			const TBitArray<TAllocB>& InArrayB,
-			int32 StartIndex = 0)
-			: m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
-			, m_Mask(1 << (StartIndex & PerDWORDMask))
-			, m_DataA(InArrayA.GetData())
+			SizeType StartIndex = 0)
+			: m_DataA(InArrayA.GetData())
 			, m_DataB(InArrayB.GetData())
 			, m_NumA(InArrayA.Num())
 			, m_NumB(InArrayB.Num())
-			, m_UnvisitedBitMask(FullMask << (StartIndex & PerDWORDMask))
+			, m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
 			, m_CurrentBitIndex(StartIndex)
 		{
-			check(InArrayA.Num() == InArrayB.Num());
-			FindFirstSetBit();
+			Init(StartIndex);
 		}
 		FORCEINLINE TConstDualSetBitIterator(
 			const uint32* DataA,
 			SizeType	NumA,
 			const uint32* DataB,
 			SizeType	NumB,
-			int32 StartIndex = 0)
-			: m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
-			, m_Mask(1 << (StartIndex & PerDWORDMask))
-			, m_DataA(DataA)
+			SizeType StartIndex = 0)
+			: m_DataA(DataA)
 			, m_DataB(DataB)
 			, m_NumA(NumA)
 			, m_NumB(NumB)
-			, m_UnvisitedBitMask(FullMask << (StartIndex & PerDWORDMask))
+			, m_DWORDIndex(StartIndex >> NumBitsPerDWORDLogTwo)
 			, m_CurrentBitIndex(StartIndex)
 		{
-			check(InArrayA.Num() == InArrayB.Num());
-			FindFirstSetBit();
+			Init(StartIndex);
 		}
 
 		FORCEINLINE TConstDualSetBitIterator& operator++()
 		{
-			check(m_NumA == m_NumB);
-			// skip current mask 
-			m_UnvisitedBitMask &= ~m_Mask;
+			// skip current bit
+			m_RemainingBits &= m_RemainingBits - 1;
 
-			// find next mask 
+			// find next bit
 			FindFirstSetBit();
 			return *this;
 		}
@@ -359,6 +357,12 @@ namespace Fuko
 			// change max 
 			m_MaxBits = MaxDWORDs * NumBitsPerDWORD;
 		}
+		template<typename OtherAlloc>
+		FORCEINLINE TBitArray& _Bitwise(const TBitArray<OtherAlloc>& Other, Algo::EBitwiseOp Op)
+		{
+			Algo::BitwiseBits(GetData(), m_NumBits, Other.GetData(), (SizeType)Other.Num(), Op);
+			return *this;
+		}
 	private:
 		Alloc		m_Allocator;
 		uint32*		m_Data;
@@ -639,6 +643,11 @@ namespace Fuko
 
 		// find 
 		SizeType Find(bool bValue) const { return Algo::FindBit(GetData(), m_NumBits, bValue); }
+		SizeType FindNext(bool bValue, SizeType StartIndex) const
+		{
+			check(StartIndex >= 0 && StartIndex <= m_NumBits);
+			return Algo::FindBit(GetData(), m_NumBits, bValue, StartIndex);
+		}
 		SizeType FindLast(bool bValue) const { return Algo::FindLastBit(GetData(), m_NumBits, bValue); }
 
 		// find and set 
@@ -648,6 +657,30 @@ namespace Fuko
 		// contains 
 		FORCEINLINE bool Contains(bool bValue) const { return Find(bValue) != INDEX_NONE; }
 
+		// count 
+		SizeType CountSetBits() const { return Algo::CountSetBits(GetData(), m_NumBits); }
+		SizeType CountSetBits(SizeType Index, SizeType Num) const
+		{
+			check(Index >= 0 && Num >= 0 && Index + Num <= m_NumBits);
+			return Algo::CountSetBits(GetData(), Index, Num);
+		}
+
+		// bitwise with other array, Num() never change, bits past Other.Num() read as zero 
+		template<typename OtherAlloc>
+		TBitArray& BitwiseAnd(const TBitArray<OtherAlloc>& Other) { return _Bitwise(Other, Algo::EBitwiseOp::And); }
+		template<typename OtherAlloc>
+		TBitArray& BitwiseOr(const TBitArray<OtherAlloc>& Other) { return _Bitwise(Other, Algo::EBitwiseOp::Or); }
+		template<typename OtherAlloc>
+		TBitArray& BitwiseXor(const TBitArray<OtherAlloc>& Other) { return _Bitwise(Other, Algo::EBitwiseOp::Xor); }
+		template<typename OtherAlloc>
+		TBitArray& BitwiseAndNot(const TBitArray<OtherAlloc>& Other) { return _Bitwise(Other, Algo::EBitwiseOp::AndNot); }
+		template<typename OtherAlloc>
+		FORCEINLINE TBitArray& operator&=(const TBitArray<OtherAlloc>& Other) { return BitwiseAnd(Other); }
+		template<typename OtherAlloc>
+		FORCEINLINE TBitArray& operator|=(const TBitArray<OtherAlloc>& Other) { return BitwiseOr(Other); }
+		template<typename OtherAlloc>
+		FORCEINLINE TBitArray& operator^=(const TBitArray<OtherAlloc>& Other) { return BitwiseXor(Other); }
+
 		// set range 
 		FORCENOINLINE void SetRange(SizeType Index, SizeType Num, bool Value)
 		{
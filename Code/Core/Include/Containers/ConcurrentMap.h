@@ -0,0 +1,534 @@
+#pragma once
+#include "CoreConfig.h"
+#include "CoreType.h"
+#include "Templates/TypeTraits.h"
+#include "Templates/Align.h"
+#include "Misc/Assert.h"
+#include "Misc/Hash.h"
+#include "Math/MathUtility.h"
+#include "Map.h"
+#include "LockPolicy.h"
+#include <Memory/MemoryOps.h>
+#include <Memory/MemoryPolicy.h>
+#include "ContainerFwd.h"
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+// TConcurrentMap
+namespace Fuko
+{
+	// hash map shared by many threads, keys are spread over shards, each shard is an open addressing table behind its own lock
+	// writers take the shard lock, readers of trivially copyable pairs take no lock: they copy the slot and retry when the shard seqlock moved,
+	// other pairs are read under the shard lock
+	// a table outgrown is retired instead of freed, because a reader may still walk it, Reclaim() or the destructor free them,
+	// tables double so retired ones never cost more than the live ones, a table full of removed slots is rehashed in place
+	// Alloc is called by many threads at once, it must be thread safe
+	template<typename KeyType, typename ValueType, typename Alloc, typename KeyFuncs, typename TLockPolicy>
+	class TConcurrentMap
+	{
+		static_assert(!KeyFuncs::bAllowDuplicateKeys, "TConcurrentMap cannot be instantiated with a KeyFuncs which allows duplicate keys");
+	public:
+		using ElementType = TPair<KeyType, ValueType>;
+		using SizeType = typename Alloc::SizeType;
+		using USizeType = typename Alloc::USizeType;
+
+		// find never lock
+		static constexpr bool bLockFreeRead = std::is_trivially_copyable_v<ElementType>;
+	private:
+		// slot tags, full slots keep the low 32 bits of the mixed hash, shards are picked by the high 32 bits
+		static constexpr uint32 TagEmpty = 0;
+		static constexpr uint32 TagRemoved = 1;
+		static constexpr SizeType MinCapacity = 16;
+
+		struct Table
+		{
+			USizeType				Mask;		// capacity - 1
+			SizeType				Used;		// full and removed slots
+			Table*					Retired;	// older table a reader may still walk
+			std::atomic<uint32>*	Tags;
+			ElementType*			Slots;
+		};
+
+		struct alignas(CacheLineSize) Shard
+		{
+			SeqLock					Seq;
+			TLockPolicy				Lock;
+			std::atomic<Table*>		Current = nullptr;
+			std::atomic<SizeType>	Num = 0;
+		};
+
+		Shard*		m_Shards;
+		USizeType	m_ShardMask;
+		Alloc		m_Allocator;
+
+		//------------------------------Begin helper functions------------------------------
+		// GetTypeHash of integers is identity, mix it so shards and slots get all bits
+		static FORCEINLINE uint64 _Mix(const KeyType& Key) { return MixHash64(KeyFuncs::Hash(Key)); }
+		static FORCEINLINE uint32 _Tag(uint64 Mixed)
+		{
+			uint32 Tag = (uint32)Mixed;
+			return Tag > TagRemoved ? Tag : Tag + 2;
+		}
+		FORCEINLINE Shard& _ShardOf(uint64 Mixed) const { return m_Shards[(USizeType)(Mixed >> 32) & m_ShardMask]; }
+
+		// max load is 3/4, a rehash leave it at most 1/2
+		static FORCEINLINE SizeType _MaxLoad(const Table* T) { return (SizeType)(T->Mask + 1) - (SizeType)(T->Mask + 1) / 4; }
+		static FORCEINLINE SizeType _CapacityFor(SizeType Number)
+		{
+			SizeType Capacity = (SizeType)Math::RoundUpToPowerOfTwo((uint32)(Number * 2));
+			return Capacity < MinCapacity ? MinCapacity : Capacity;
+		}
+		static FORCEINLINE size_t _TagOffset() { return Align(sizeof(Table), alignof(std::atomic<uint32>)); }
+		static FORCEINLINE size_t _SlotOffset(SizeType Capacity) { return Align(_TagOffset() + Capacity * sizeof(std::atomic<uint32>), alignof(ElementType)); }
+		static FORCEINLINE size_t _BlockAlignment() { return alignof(ElementType) > alignof(Table) ? alignof(ElementType) : alignof(Table); }
+
+		Table* _AllocTable(SizeType Capacity)
+		{
+			void* Block = nullptr;
+			m_Allocator.ReserveRaw(Block, (SizeType)(_SlotOffset(Capacity) + Capacity * sizeof(ElementType)), (SizeType)_BlockAlignment());
+			Table* T = (Table*)Block;
+			T->Mask = (USizeType)Capacity - 1;
+			T->Used = 0;
+			T->Retired = nullptr;
+			T->Tags = (std::atomic<uint32>*)((uint8*)Block + _TagOffset());
+			T->Slots = (ElementType*)((uint8*)Block + _SlotOffset(Capacity));
+			for (SizeType i = 0; i < Capacity; ++i) new(T->Tags + i) std::atomic<uint32>(TagEmpty);
+			return T;
+		}
+		void _FreeTable(Table* T)
+		{
+			void* Block = T;
+			m_Allocator.FreeRaw(Block, (SizeType)_BlockAlignment());
+		}
+		static void _DestructElements(Table* T)
+		{
+			if constexpr (!std::is_trivially_destructible_v<ElementType>)
+			{
+				for (USizeType i = 0; i <= T->Mask; ++i)
+				{
+					if (T->Tags[i].load(std::memory_order_relaxed) > TagRemoved) T->Slots[i].~ElementType();
+				}
+			}
+		}
+
+		// walk slots by triangular steps, visit every slot once when capacity is power of two
+		// return slot of key or INDEX_NONE, OutFree get the first removed or empty slot on the way
+		static SizeType _ProbeLocked(const Table* T, uint32 Tag, const KeyType& Key, SizeType& OutFree)
+		{
+			OutFree = INDEX_NONE;
+			if (!T) return INDEX_NONE;
+			USizeType Index = Tag & T->Mask;
+			for (USizeType Step = 1; Step <= T->Mask + 1; ++Step)
+			{
+				uint32 SlotTag = T->Tags[Index].load(std::memory_order_relaxed);
+				if (SlotTag == TagEmpty)
+				{
+					if (OutFree == INDEX_NONE) OutFree = (SizeType)Index;
+					return INDEX_NONE;
+				}
+				if (SlotTag == TagRemoved)
+				{
+					if (OutFree == INDEX_NONE) OutFree = (SizeType)Index;
+				}
+				else if (SlotTag == Tag && KeyFuncs::Matches(KeyFuncs::Key(T->Slots[Index]), Key))
+				{
+					return (SizeType)Index;
+				}
+				Index = (Index + Step) & T->Mask;
+			}
+			return INDEX_NONE;
+		}
+
+		// copy the slot out and validate with the seqlock, only for trivially copyable pairs
+		bool _FindLockFree(const Shard& S, uint32 Tag, const KeyType& Key, ValueType* OutValue) const
+		{
+			alignas(ElementType) uint8 Buffer[sizeof(ElementType)];
+			const ElementType& Element = *(const ElementType*)Buffer;
+			for (;;)
+			{
+				const uint32 Seq = S.Seq.ReadBegin();
+				const Table* T = S.Current.load(std::memory_order_acquire);
+				bool bFound = false;
+				if (T)
+				{
+					USizeType Index = Tag & T->Mask;
+					for (USizeType Step = 1; Step <= T->Mask + 1; ++Step)
+					{
+						// acquire pair with the release of an add into an empty slot, the slot is complete once its tag is seen
+						uint32 SlotTag = T->Tags[Index].load(std::memory_order_acquire);
+						if (SlotTag == TagEmpty) break;
+						if (SlotTag == Tag)
+						{
+							Memcpy(Buffer, T->Slots + Index, sizeof(ElementType));
+							if (KeyFuncs::Matches(KeyFuncs::Key(Element), Key))
+							{
+								bFound = true;
+								break;
+							}
+						}
+						Index = (Index + Step) & T->Mask;
+					}
+				}
+				if (!S.Seq.ReadRetry(Seq))
+				{
+					if (bFound && OutValue) *OutValue = Element.Value;
+					return bFound;
+				}
+			}
+		}
+		bool _Find(uint64 Mixed, const KeyType& Key, ValueType* OutValue) const
+		{
+			Shard& S = _ShardOf(Mixed);
+			if constexpr (bLockFreeRead)
+			{
+				return _FindLockFree(S, _Tag(Mixed), Key, OutValue);
+			}
+			else
+			{
+				std::lock_guard<TLockPolicy> Guard(S.Lock);
+				SizeType Free;
+				const Table* T = S.Current.load(std::memory_order_relaxed);
+				SizeType Index = _ProbeLocked(T, _Tag(Mixed), Key, Free);
+				if (Index == INDEX_NONE) return false;
+				if (OutValue) *OutValue = T->Slots[Index].Value;
+				return true;
+			}
+		}
+
+		// removed slots filled the table but the pairs still fit, rehash them in the same table so nothing is retired
+		// readers retry on the seqlock until it is done
+		void _RehashInPlace(Shard& S, Table* T)
+		{
+			const SizeType LiveNum = S.Num.load(std::memory_order_relaxed);
+			const size_t SlotOffset = Align(LiveNum * sizeof(uint32), alignof(ElementType));
+			const size_t Alignment = alignof(ElementType) > alignof(uint32) ? alignof(ElementType) : alignof(uint32);
+			void* Block = nullptr;
+			if (LiveNum) m_Allocator.ReserveRaw(Block, (SizeType)(SlotOffset + LiveNum * sizeof(ElementType)), (SizeType)Alignment);
+			uint32* LiveTags = (uint32*)Block;
+			ElementType* LiveSlots = (ElementType*)((uint8*)Block + SlotOffset);
+
+			S.Seq.WriteBegin();
+			SizeType Count = 0;
+			for (USizeType i = 0; i <= T->Mask; ++i)
+			{
+				const uint32 SlotTag = T->Tags[i].load(std::memory_order_relaxed);
+				T->Tags[i].store(TagEmpty, std::memory_order_relaxed);
+				if (SlotTag <= TagRemoved) continue;
+				LiveTags[Count] = SlotTag;
+				if constexpr (bLockFreeRead)
+				{
+					Memcpy(LiveSlots + Count, T->Slots + i, sizeof(ElementType));
+				}
+				else
+				{
+					new(LiveSlots + Count) ElementType(std::move(T->Slots[i]));
+					T->Slots[i].~ElementType();
+				}
+				++Count;
+			}
+			check(Count == LiveNum);
+			for (SizeType i = 0; i < Count; ++i)
+			{
+				USizeType Index = LiveTags[i] & T->Mask;
+				for (USizeType Step = 1; T->Tags[Index].load(std::memory_order_relaxed) != TagEmpty; ++Step) Index = (Index + Step) & T->Mask;
+				if constexpr (bLockFreeRead)
+				{
+					Memcpy(T->Slots + Index, LiveSlots + i, sizeof(ElementType));
+				}
+				else
+				{
+					new(T->Slots + Index) ElementType(std::move(LiveSlots[i]));
+					LiveSlots[i].~ElementType();
+				}
+				T->Tags[Index].store(LiveTags[i], std::memory_order_relaxed);
+			}
+			T->Used = Count;
+			S.Seq.WriteEnd();
+
+			if (Block) m_Allocator.FreeRaw(Block, (SizeType)Alignment);
+		}
+
+		// rehash into a table fit for Num + 1, old one is retired when readers may walk it
+		// a new table is at least twice the old one, a table that would not grow is rehashed in place
+		Table* _Grow(Shard& S, Table* Old)
+		{
+			const SizeType Capacity = _CapacityFor(S.Num.load(std::memory_order_relaxed) + 1);
+			if (Old && Capacity <= (SizeType)Old->Mask + 1)
+			{
+				_RehashInPlace(S, Old);
+				return Old;
+			}
+			Table* New = _AllocTable(Capacity);
+			if (Old)
+			{
+				for (USizeType i = 0; i <= Old->Mask; ++i)
+				{
+					uint32 SlotTag = Old->Tags[i].load(std::memory_order_relaxed);
+					if (SlotTag <= TagRemoved) continue;
+					USizeType Index = SlotTag & New->Mask;
+					for (USizeType Step = 1; New->Tags[Index].load(std::memory_order_relaxed) != TagEmpty; ++Step) Index = (Index + Step) & New->Mask;
+					if constexpr (bLockFreeRead)
+					{
+						Memcpy(New->Slots + Index, Old->Slots + i, sizeof(ElementType));
+					}
+					else
+					{
+						new(New->Slots + Index) ElementType(std::move(Old->Slots[i]));
+						Old->Slots[i].~ElementType();
+					}
+					New->Tags[Index].store(SlotTag, std::memory_order_relaxed);
+					++New->Used;
+				}
+				if constexpr (bLockFreeRead)
+				{
+					New->Retired = Old;
+				}
+				else
+				{
+					_FreeTable(Old);
+				}
+			}
+
+			// readers on the old table retry and pick the new one
+			S.Seq.WriteBegin();
+			S.Current.store(New, std::memory_order_release);
+			S.Seq.WriteEnd();
+			return New;
+		}
+
+		// add under lock, key must not be in the table
+		template<typename InitKeyType, typename... InitValueType>
+		ValueType& _AddLocked(Shard& S, uint32 Tag, SizeType Free, InitKeyType&& Key, InitValueType&&... Value)
+		{
+			// removed slots are reused without growing, load count them too so an empty slot always end the probe
+			Table* T = S.Current.load(std::memory_order_relaxed);
+			if (!T || (T->Tags[Free].load(std::memory_order_relaxed) == TagEmpty && T->Used + 1 > _MaxLoad(T)))
+			{
+				T = _Grow(S, T);
+				USizeType Index = Tag & T->Mask;
+				for (USizeType Step = 1; T->Tags[Index].load(std::memory_order_relaxed) != TagEmpty; ++Step) Index = (Index + Step) & T->Mask;
+				Free = (SizeType)Index;
+			}
+			check(Free != INDEX_NONE);
+
+			ElementType* Slot = T->Slots + Free;
+			if (T->Tags[Free].load(std::memory_order_relaxed) == TagEmpty)
+			{
+				// nobody read an empty slot, publishing the tag is enough
+				new(Slot) ElementType(std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+				T->Tags[Free].store(Tag, std::memory_order_release);
+				++T->Used;
+			}
+			else
+			{
+				// a reader may still copy the removed pair
+				S.Seq.WriteBegin();
+				new(Slot) ElementType(std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+				T->Tags[Free].store(Tag, std::memory_order_release);
+				S.Seq.WriteEnd();
+			}
+			S.Num.fetch_add(1, std::memory_order_relaxed);
+			return Slot->Value;
+		}
+
+		template<typename InitKeyType, typename... InitValueType>
+		ValueType _FindOrAddImpl(InitKeyType&& Key, InitValueType&&... Value)
+		{
+			const uint64 Mixed = _Mix(Key);
+
+			// most calls of a shared cache hit, try without lock first
+			if constexpr (bLockFreeRead)
+			{
+				ValueType Result;
+				if (_Find(Mixed, Key, &Result)) return Result;
+			}
+
+			Shard& S = _ShardOf(Mixed);
+			std::lock_guard<TLockPolicy> Guard(S.Lock);
+			const uint32 Tag = _Tag(Mixed);
+			SizeType Free;
+			Table* T = S.Current.load(std::memory_order_relaxed);
+			SizeType Index = _ProbeLocked(T, Tag, Key, Free);
+			if (Index != INDEX_NONE) return T->Slots[Index].Value;
+			return _AddLocked(S, Tag, Free, std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+		}
+
+		template<typename InitKeyType, typename InitValueType>
+		void _AddImpl(InitKeyType&& Key, InitValueType&& Value)
+		{
+			const uint64 Mixed = _Mix(Key);
+			Shard& S = _ShardOf(Mixed);
+			std::lock_guard<TLockPolicy> Guard(S.Lock);
+			const uint32 Tag = _Tag(Mixed);
+			SizeType Free;
+			Table* T = S.Current.load(std::memory_order_relaxed);
+			SizeType Index = _ProbeLocked(T, Tag, Key, Free);
+			if (Index != INDEX_NONE)
+			{
+				S.Seq.WriteBegin();
+				T->Slots[Index].Value = std::forward<InitValueType>(Value);
+				S.Seq.WriteEnd();
+				return;
+			}
+			_AddLocked(S, Tag, Free, std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value));
+		}
+		//-------------------------------End helper functions-------------------------------
+	public:
+		// 0 shards means 4 per hardware thread, shard num is rounded up to power of two
+		explicit TConcurrentMap(SizeType InShardNum = 0, const Alloc& InAlloc = Alloc())
+			: m_Shards(nullptr)
+			, m_ShardMask(0)
+			, m_Allocator(InAlloc)
+		{
+			if (InShardNum <= 0) InShardNum = (SizeType)Math::Max(std::thread::hardware_concurrency(), 1u) * 4;
+			const SizeType ShardNum = (SizeType)Math::RoundUpToPowerOfTwo((uint32)InShardNum);
+			void* Block = nullptr;
+			m_Allocator.ReserveRaw(Block, (SizeType)(ShardNum * sizeof(Shard)), (SizeType)alignof(Shard));
+			m_Shards = (Shard*)Block;
+			for (SizeType i = 0; i < ShardNum; ++i) new(m_Shards + i) Shard();
+			m_ShardMask = (USizeType)ShardNum - 1;
+		}
+		~TConcurrentMap()
+		{
+			for (USizeType i = 0; i <= m_ShardMask; ++i)
+			{
+				Table* T = m_Shards[i].Current.load(std::memory_order_relaxed);
+				if (T) _DestructElements(T);
+				while (T)
+				{
+					Table* Retired = T->Retired;
+					_FreeTable(T);
+					T = Retired;
+				}
+				m_Shards[i].~Shard();
+			}
+			void* Block = m_Shards;
+			m_Allocator.FreeRaw(Block, (SizeType)alignof(Shard));
+		}
+
+		// shared by threads, never copied or moved
+		TConcurrentMap(const TConcurrentMap&) = delete;
+		TConcurrentMap& operator=(const TConcurrentMap&) = delete;
+
+		// information, Num is a sum of shard counters, exact only when no one writes
+		SizeType Num() const
+		{
+			SizeType Result = 0;
+			for (USizeType i = 0; i <= m_ShardMask; ++i) Result += m_Shards[i].Num.load(std::memory_order_relaxed);
+			return Result;
+		}
+		FORCEINLINE SizeType NumShards() const { return (SizeType)m_ShardMask + 1; }
+
+		// find, copy the value out since another thread may change it after we return
+		FORCEINLINE bool Find(const KeyType& Key, ValueType& OutValue) const { return _Find(_Mix(Key), Key, &OutValue); }
+		FORCEINLINE bool Contains(const KeyType& Key) const { return _Find(_Mix(Key), Key, nullptr); }
+
+		// return value found or added
+		FORCEINLINE ValueType FindOrAdd(const KeyType& Key) { return _FindOrAddImpl(Key); }
+		FORCEINLINE ValueType FindOrAdd(const KeyType& Key, const ValueType& Value) { return _FindOrAddImpl(Key, Value); }
+		FORCEINLINE ValueType FindOrAdd(const KeyType& Key, ValueType&& Value) { return _FindOrAddImpl(Key, std::move(Value)); }
+
+		// add or replace
+		FORCEINLINE void Add(const KeyType& Key, const ValueType& Value) { _AddImpl(Key, Value); }
+		FORCEINLINE void Add(const KeyType& Key, ValueType&& Value) { _AddImpl(Key, std::move(Value)); }
+
+		// update existed value, return false if key not found
+		FORCEINLINE bool Update(const KeyType& Key, const ValueType& Value)
+		{
+			return UpdateWith(Key, [&](ValueType& InValue) { InValue = Value; });
+		}
+		// Func(ValueType&) run under the shard lock and stall readers of the shard, keep it short
+		template<typename TFunc>
+		bool UpdateWith(const KeyType& Key, TFunc&& Func)
+		{
+			const uint64 Mixed = _Mix(Key);
+			Shard& S = _ShardOf(Mixed);
+			std::lock_guard<TLockPolicy> Guard(S.Lock);
+			SizeType Free;
+			Table* T = S.Current.load(std::memory_order_relaxed);
+			SizeType Index = _ProbeLocked(T, _Tag(Mixed), Key, Free);
+			if (Index == INDEX_NONE) return false;
+			S.Seq.WriteBegin();
+			Func(T->Slots[Index].Value);
+			S.Seq.WriteEnd();
+			return true;
+		}
+
+		// remove
+		FORCEINLINE bool Remove(const KeyType& Key) { return _RemoveImpl(Key, nullptr); }
+		FORCEINLINE bool RemoveAndCopyValue(const KeyType& Key, ValueType& OutRemovedValue) { return _RemoveImpl(Key, &OutRemovedValue); }
+
+		// visit every pair, one shard locked at a time, so it is not a snapshot of the whole map
+		template<typename TFunc>
+		void ForEach(TFunc&& Func) const
+		{
+			for (USizeType i = 0; i <= m_ShardMask; ++i)
+			{
+				Shard& S = m_Shards[i];
+				std::lock_guard<TLockPolicy> Guard(S.Lock);
+				const Table* T = S.Current.load(std::memory_order_relaxed);
+				if (!T) continue;
+				for (USizeType Index = 0; Index <= T->Mask; ++Index)
+				{
+					if (T->Tags[Index].load(std::memory_order_relaxed) > TagRemoved) Func(T->Slots[Index].Key, T->Slots[Index].Value);
+				}
+			}
+		}
+
+		// remove all pairs, tables are kept
+		void Empty()
+		{
+			for (USizeType i = 0; i <= m_ShardMask; ++i)
+			{
+				Shard& S = m_Shards[i];
+				std::lock_guard<TLockPolicy> Guard(S.Lock);
+				Table* T = S.Current.load(std::memory_order_relaxed);
+				if (!T) continue;
+				S.Seq.WriteBegin();
+				_DestructElements(T);
+				for (USizeType Index = 0; Index <= T->Mask; ++Index) T->Tags[Index].store(TagEmpty, std::memory_order_relaxed);
+				T->Used = 0;
+				S.Num.store(0, std::memory_order_relaxed);
+				S.Seq.WriteEnd();
+			}
+		}
+
+		// free retired tables, no other thread may use the map meanwhile
+		void Reclaim()
+		{
+			for (USizeType i = 0; i <= m_ShardMask; ++i)
+			{
+				Table* T = m_Shards[i].Current.load(std::memory_order_relaxed);
+				if (!T) continue;
+				Table* Retired = T->Retired;
+				T->Retired = nullptr;
+				while (Retired)
+				{
+					Table* Next = Retired->Retired;
+					_FreeTable(Retired);
+					Retired = Next;
+				}
+			}
+		}
+	private:
+		bool _RemoveImpl(const KeyType& Key, ValueType* OutValue)
+		{
+			const uint64 Mixed = _Mix(Key);
+			Shard& S = _ShardOf(Mixed);
+			std::lock_guard<TLockPolicy> Guard(S.Lock);
+			SizeType Free;
+			Table* T = S.Current.load(std::memory_order_relaxed);
+			SizeType Index = _ProbeLocked(T, _Tag(Mixed), Key, Free);
+			if (Index == INDEX_NONE) return false;
+
+			// the pair stay in place until the slot is reused, a reader copying it see a valid pair
+			ElementType& Slot = T->Slots[Index];
+			if (OutValue) *OutValue = std::move(Slot.Value);
+			T->Tags[Index].store(TagRemoved, std::memory_order_release);
+			if constexpr (!std::is_trivially_destructible_v<ElementType>) Slot.~ElementType();
+			S.Num.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	};
+}
@@ -1,4 +1,9 @@
 #pragma once
+#include "CoreType.h"
+
+// functor
+template<typename T>
+struct TLess;
 
 // allocator 
 namespace Fuko
@@ -14,6 +19,7 @@ namespace Fuko
 {
 	struct NoLock;
 	struct LockFree;
+	struct LockFreeSPSC;
 	struct MutexLock;
 	template<int YieldTime = -1>
 	struct TSpinLock;
@@ -31,13 +37,16 @@ namespace Fuko
 	template<typename T, typename TLockPolicy = NoLock, typename TAlloc = PmrAlloc>
 	class TPool;
 
-	template<typename T, bool bInAllowDuplicateKeys = false>
+	struct TypeHashPolicy;
+	struct MixHashPolicy;
+
+	template<typename T, bool bInAllowDuplicateKeys = false, typename HashPolicy = TypeHashPolicy>
 	struct DefaultKeyFuncs;
 
 	template<typename T, typename Alloc = PmrAlloc, typename KeyFuncs = DefaultKeyFuncs<T>>
 	class TSet;
 
-	template<typename TK, typename TV, bool bInAllowDuplicateKeys>
+	template<typename TK, typename TV, bool bInAllowDuplicateKeys, typename HashPolicy = TypeHashPolicy>
 	struct TDefaultMapKeyFuncs;
 
 	template<typename KeyType, typename ValueType
@@ -50,9 +59,44 @@ namespace Fuko
 		, typename KeyFuncs = TDefaultMapKeyFuncs<KeyType, ValueType, true>>
 		class TMultiMap;
 
+	template<typename T, typename Alloc = PmrAlloc, typename KeyFuncs = DefaultKeyFuncs<T>>
+	class TFlatSet;
+
+	template<typename KeyType, typename ValueType
+		, typename Alloc = PmrAlloc
+		, typename KeyFuncs = TDefaultMapKeyFuncs<KeyType, ValueType, false>>
+		class TFlatMap;
+
+	template<typename KeyType, typename ValueType
+		, typename Alloc = PmrAlloc
+		, typename KeyFuncs = TDefaultMapKeyFuncs<KeyType, ValueType, false>
+		, typename TLockPolicy = TSpinLock<>>
+		class TConcurrentMap;
+
 	template<typename T, typename TLockPolicy = NoLock, typename Alloc = PmrAlloc>
 	class TRingQueue;
 
 	template<typename T, typename Alloc = PmrAlloc>
 	class TSparseArray;
+
+	template<typename T, typename Alloc = PmrAlloc>
+	class TSlotMap;
+
+	template<typename KeyType, typename ValueType
+		, typename Alloc = PmrAlloc
+		, typename Compare = TLess<KeyType>>
+		class TSortedFlatMap;
+
+	template<typename KeyType, typename ValueType
+		, typename Alloc = PmrAlloc
+		, typename Compare = TLess<KeyType>
+		, uint32 NodeBytes = 512>
+		class TBTreeMap;
+	template<typename KeyType, typename ValueType, typename Alloc = PmrAlloc>
+	class TFrozenMap;
+
+	template<typename Alloc, typename...Ts>
+	class TSoAArrayAlloc;
+	template<typename...Ts>
+	using TSoAArray = TSoAArrayAlloc<PmrAlloc, Ts...>;
 }
\ No newline at end of file
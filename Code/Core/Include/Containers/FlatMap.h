@@ -0,0 +1,221 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include "Templates/Pair.h"
+#include "FlatSet.h"
+#include "Map.h"
+#include <Memory/MemoryOps.h>
+#include <Memory/MemoryPolicy.h>
+#include "ContainerFwd.h"
+
+// TFlatMap
+namespace Fuko
+{
+	// TMap over TFlatSet, pairs live in the slot array
+	template<typename KeyType, typename ValueType, typename Alloc, typename KeyFuncs>
+	class TFlatMap
+	{
+		static_assert(!KeyFuncs::bAllowDuplicateKeys, "TFlatMap cannot be instantiated with a KeyFuncs which allows duplicate keys");
+	public:
+		using ElementType = TPair<KeyType, ValueType>;
+		using ElementSetType = TFlatSet<ElementType, Alloc, KeyFuncs>;
+		using SizeType = typename Alloc::SizeType;
+	private:
+		ElementSetType	m_Pairs;
+
+		//-----------------------------begin help function-----------------------------
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& _FindOrAddImpl(uint32 KeyHash, InitKeyType&& Key, InitValueType&&...Value)
+		{
+			auto PairId = m_Pairs.FindOrEmplaceByHash(KeyHash, Key, nullptr, std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+			return m_Pairs[PairId].Value;
+		}
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& _EmplaceImpl(uint32 KeyHash, InitKeyType&& Key, InitValueType&&...Value)
+		{
+			bool bIsAlreadyInSet;
+			auto PairId = m_Pairs.FindOrEmplaceByHash(KeyHash, Key, &bIsAlreadyInSet, std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+			if (bIsAlreadyInSet) m_Pairs[PairId].Value = ValueType(std::forward<InitValueType>(Value)...);
+			return m_Pairs[PairId].Value;
+		}
+		//------------------------------end help function------------------------------
+	public:
+		// construct
+		FORCEINLINE TFlatMap(const Alloc& InAlloc = Alloc()) : m_Pairs(InAlloc) {}
+		TFlatMap(std::initializer_list<ElementType> InitList, const Alloc& InAlloc = Alloc())
+			: m_Pairs(InAlloc)
+		{
+			Reserve((SizeType)InitList.size());
+			for (const ElementType& Element : InitList)
+			{
+				Add(Element.Key, Element.Value);
+			}
+		}
+
+		// copy & move
+		FORCEINLINE TFlatMap(const TFlatMap&) = default;
+		FORCEINLINE TFlatMap(TFlatMap&&) = default;
+		FORCEINLINE TFlatMap& operator=(const TFlatMap&) = default;
+		FORCEINLINE TFlatMap& operator=(TFlatMap&&) = default;
+
+		// operators
+		FORCEINLINE void Empty(SizeType ExpectedNumElements = 0) { m_Pairs.Empty(ExpectedNumElements); }
+		FORCEINLINE void Reset() { m_Pairs.Reset(); }
+		FORCEINLINE void Shrink() { m_Pairs.Shrink(); }
+		FORCEINLINE void Reserve(SizeType Number) { m_Pairs.Reserve(Number); }
+		FORCEINLINE SizeType Num() const { return m_Pairs.Num(); }
+		FORCEINLINE SizeType Max() const { return m_Pairs.Max(); }
+		FORCEINLINE bool IsEmpty() const { return m_Pairs.IsEmpty(); }
+
+		// add, replace the value of an existing key
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, std::move(InValue)); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(std::move(InKey), InValue); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(std::move(InKey), std::move(InValue)); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey) { return Emplace(InKey); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey) { return Emplace(std::move(InKey)); }
+
+		// emplace
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& Emplace(InitKeyType&& InKey, InitValueType&&...InValue)
+		{
+			return _EmplaceImpl(KeyFuncs::Hash(InKey), std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue)...);
+		}
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& EmplaceByHash(uint32 KeyHash, InitKeyType&& InKey, InitValueType&&...InValue)
+		{
+			return _EmplaceImpl(KeyHash, std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue)...);
+		}
+
+		// remove
+		FORCEINLINE SizeType Remove(const KeyType& InKey) { return m_Pairs.Remove(InKey); }
+		FORCEINLINE SizeType RemoveByHash(uint32 KeyHash, const KeyType& Key) { return m_Pairs.RemoveByHash(KeyHash, Key); }
+		bool RemoveAndCopyValue(const KeyType& Key, ValueType& OutRemovedValue)
+		{
+			auto PairId = m_Pairs.FindId(Key);
+			if (!PairId.IsValid()) return false;
+			OutRemovedValue = std::move(m_Pairs[PairId].Value);
+			m_Pairs.Remove(PairId);
+			return true;
+		}
+		ValueType FindAndRemoveChecked(const KeyType& Key)
+		{
+			auto PairId = m_Pairs.FindId(Key);
+			check(PairId.IsValid());
+			ValueType Result = std::move(m_Pairs[PairId].Value);
+			m_Pairs.Remove(PairId);
+			return Result;
+		}
+
+		// find
+		FORCEINLINE ValueType* Find(const KeyType& Key)
+		{
+			ElementType* Pair = m_Pairs.Find(Key);
+			return Pair ? &Pair->Value : nullptr;
+		}
+		FORCEINLINE const ValueType* Find(const KeyType& Key) const { return const_cast<TFlatMap*>(this)->Find(Key); }
+		FORCEINLINE ValueType* FindByHash(uint32 KeyHash, const KeyType& Key)
+		{
+			ElementType* Pair = m_Pairs.FindByHash(KeyHash, Key);
+			return Pair ? &Pair->Value : nullptr;
+		}
+		FORCEINLINE const ValueType* FindByHash(uint32 KeyHash, const KeyType& Key) const { return const_cast<TFlatMap*>(this)->FindByHash(KeyHash, Key); }
+		FORCEINLINE ValueType& FindChecked(const KeyType& Key)
+		{
+			ValueType* Value = Find(Key);
+			check(Value != nullptr);
+			return *Value;
+		}
+		FORCEINLINE const ValueType& FindChecked(const KeyType& Key) const { return const_cast<TFlatMap*>(this)->FindChecked(Key); }
+
+		// find or add
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key) { return _FindOrAddImpl(KeyFuncs::Hash(Key), Key); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key) { return _FindOrAddImpl(KeyFuncs::Hash(Key), std::move(Key)); }
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key, const ValueType& Value) { return _FindOrAddImpl(KeyFuncs::Hash(Key), Key, Value); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key, ValueType&& Value) { return _FindOrAddImpl(KeyFuncs::Hash(Key), std::move(Key), std::move(Value)); }
+		FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType& Key) { return _FindOrAddImpl(KeyHash, Key); }
+		FORCEINLINE ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key) { return _FindOrAddImpl(KeyHash, std::move(Key)); }
+
+		// contains
+		FORCEINLINE bool Contains(const KeyType& Key) const { return m_Pairs.Contains(Key); }
+		FORCEINLINE bool ContainsByHash(uint32 KeyHash, const KeyType& Key) const { return m_Pairs.ContainsByHash(KeyHash, Key); }
+
+		// generate key & value array
+		void GenerateKeyArray(TArray<KeyType>& OutArray) const
+		{
+			OutArray.Empty(m_Pairs.Num());
+			for (const ElementType& Pair : m_Pairs) OutArray.Add(Pair.Key);
+		}
+		void GenerateValueArray(TArray<ValueType>& OutArray) const
+		{
+			OutArray.Empty(m_Pairs.Num());
+			for (const ElementType& Pair : m_Pairs) OutArray.Add(Pair.Value);
+		}
+
+		// compare, order independent
+		bool operator==(const TFlatMap& Other) const
+		{
+			if (Num() != Other.Num()) return false;
+			for (const ElementType& Pair : m_Pairs)
+			{
+				const ValueType* OtherValue = Other.Find(Pair.Key);
+				if (!OtherValue || !(*OtherValue == Pair.Value)) return false;
+			}
+			return true;
+		}
+		FORCEINLINE bool operator!=(const TFlatMap& Other) const { return !(*this == Other); }
+
+		// accessor
+		FORCEINLINE ValueType& operator[](const KeyType& Key) { return FindOrAdd(Key); }
+		FORCEINLINE const ValueType& operator[](const KeyType& Key) const { return FindChecked(Key); }
+
+		//----------------------------------------iterators----------------------------------------
+		class TIterator
+		{
+			using ItType = typename ElementSetType::TIterator;
+			ItType	m_SetIt;
+		public:
+			FORCEINLINE TIterator(TFlatMap& InMap, SizeType StartIndex = 0) : m_SetIt(InMap.m_Pairs, StartIndex) {}
+
+			FORCEINLINE TIterator& operator++() { ++m_SetIt; return *this; }
+			FORCEINLINE explicit operator bool() const { return !!m_SetIt; }
+			FORCEINLINE bool operator !() const { return !(bool)*this; }
+
+			FORCEINLINE friend bool operator==(const TIterator& Lhs, const TIterator& Rhs) { return Lhs.m_SetIt == Rhs.m_SetIt; }
+			FORCEINLINE friend bool operator!=(const TIterator& Lhs, const TIterator& Rhs) { return Lhs.m_SetIt != Rhs.m_SetIt; }
+
+			FORCEINLINE const KeyType& Key() const { return m_SetIt->Key; }
+			FORCEINLINE ValueType& Value() const { return m_SetIt->Value; }
+			FORCEINLINE SizeType GetIndex() const { return m_SetIt.GetId(); }
+			FORCEINLINE ElementType& operator* () const { return *m_SetIt; }
+			FORCEINLINE ElementType* operator->() const { return &*m_SetIt; }
+			FORCEINLINE void RemoveCurrent() { m_SetIt.RemoveCurrent(); }
+		};
+		class TConstIterator
+		{
+			using ItType = typename ElementSetType::TConstIterator;
+			ItType	m_SetIt;
+		public:
+			FORCEINLINE TConstIterator(const TFlatMap& InMap, SizeType StartIndex = 0) : m_SetIt(InMap.m_Pairs, StartIndex) {}
+
+			FORCEINLINE TConstIterator& operator++() { ++m_SetIt; return *this; }
+			FORCEINLINE explicit operator bool() const { return !!m_SetIt; }
+			FORCEINLINE bool operator !() const { return !(bool)*this; }
+
+			FORCEINLINE friend bool operator==(const TConstIterator& Lhs, const TConstIterator& Rhs) { return Lhs.m_SetIt == Rhs.m_SetIt; }
+			FORCEINLINE friend bool operator!=(const TConstIterator& Lhs, const TConstIterator& Rhs) { return Lhs.m_SetIt != Rhs.m_SetIt; }
+
+			FORCEINLINE const KeyType& Key() const { return m_SetIt->Key; }
+			FORCEINLINE const ValueType& Value() const { return m_SetIt->Value; }
+			FORCEINLINE SizeType GetIndex() const { return m_SetIt.GetId(); }
+			FORCEINLINE const ElementType& operator* () const { return *m_SetIt; }
+			FORCEINLINE const ElementType* operator->() const { return &*m_SetIt; }
+		};
+
+		// Support foreach
+		FORCEINLINE TIterator      begin()			{ return TIterator(*this); }
+		FORCEINLINE TConstIterator begin() const	{ return TConstIterator(*this); }
+		FORCEINLINE TIterator      end()			{ return TIterator(*this, m_Pairs.GetCapacity()); }
+		FORCEINLINE TConstIterator end() const		{ return TConstIterator(*this, m_Pairs.GetCapacity()); }
+	};
+}
@@ -0,0 +1,578 @@
+#pragma once
+#include "CoreConfig.h"
+#include "CoreType.h"
+#include "Templates/TypeTraits.h"
+#include "Templates/Align.h"
+#include "Misc/Assert.h"
+#include "Misc/CpuInfo.h"
+#include "Math/MathUtility.h"
+#include "Array.h"
+#include "Set.h"
+#include <Memory/MemoryOps.h>
+#include <Memory/MemoryPolicy.h>
+#include "ContainerFwd.h"
+#if CPU_X86
+#include <emmintrin.h>
+#endif
+
+// control group
+namespace Fuko
+{
+	// one control byte per slot, full slot keep 7 bits of the hash, so most mismatches never touch the slot
+	enum EFlatCtrl : int8
+	{
+		FlatCtrlEmpty = -128,
+		FlatCtrlDeleted = -2,
+	};
+
+	// 16 control bytes compared at once, each match function return one bit per slot
+	struct FlatCtrlGroup
+	{
+		static constexpr uint32 Width = 16;
+
+#if CPU_X86
+		__m128i	Ctrl;
+
+		FORCEINLINE explicit FlatCtrlGroup(const int8* Pos) : Ctrl(_mm_load_si128((const __m128i*)Pos)) {}
+		FORCEINLINE uint32 Match(int8 H2) const { return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(Ctrl, _mm_set1_epi8(H2))); }
+		FORCEINLINE uint32 MatchEmpty() const { return Match(FlatCtrlEmpty); }
+		FORCEINLINE uint32 MatchEmptyOrDeleted() const { return (uint32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), Ctrl)); }
+		FORCEINLINE uint32 MatchFull() const { return ~(uint32)_mm_movemask_epi8(Ctrl) & 0xFFFF; }
+#else
+		const int8*	Ctrl;
+
+		FORCEINLINE explicit FlatCtrlGroup(const int8* Pos) : Ctrl(Pos) {}
+		FORCEINLINE uint32 Match(int8 H2) const
+		{
+			uint32 Mask = 0;
+			for (uint32 i = 0; i < Width; ++i) Mask |= uint32(Ctrl[i] == H2) << i;
+			return Mask;
+		}
+		FORCEINLINE uint32 MatchEmpty() const { return Match(FlatCtrlEmpty); }
+		FORCEINLINE uint32 MatchEmptyOrDeleted() const
+		{
+			uint32 Mask = 0;
+			for (uint32 i = 0; i < Width; ++i) Mask |= uint32(Ctrl[i] < -1) << i;
+			return Mask;
+		}
+		FORCEINLINE uint32 MatchFull() const
+		{
+			uint32 Mask = 0;
+			for (uint32 i = 0; i < Width; ++i) Mask |= uint32(Ctrl[i] >= 0) << i;
+			return Mask;
+		}
+#endif
+	};
+}
+
+// TFlatSet
+namespace Fuko
+{
+	// open addressing set, elements live in the slot array, found through 16 wide control groups
+	// a lookup usually read one control group and one slot, against bucket + scattered element + chain for TSet
+	// element address and ids are only stable until the next add, ids are not stable over rehash
+	template<typename T, typename Alloc, typename KeyFuncs>
+	class TFlatSet
+	{
+		static_assert(!KeyFuncs::bAllowDuplicateKeys, "TFlatSet cannot be instantiated with a KeyFuncs which allows duplicate keys");
+	public:
+		using KeyType = typename KeyFuncs::KeyType;
+		using SizeType = typename Alloc::SizeType;
+		using USizeType = typename Alloc::USizeType;
+
+		class FlatElementId
+		{
+			SizeType Index;
+		public:
+			FORCEINLINE FlatElementId(SizeType InIndex = INDEX_NONE) : Index(InIndex) {}
+			FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+			FORCEINLINE operator SizeType() const { return Index; }
+			FORCEINLINE friend bool operator==(const FlatElementId& A, const FlatElementId& B) { return A.Index == B.Index; }
+			FORCEINLINE void Reset() { Index = INDEX_NONE; }
+		};
+	private:
+		static constexpr SizeType GroupWidth = FlatCtrlGroup::Width;
+		static constexpr size_t BlockAlignment = alignof(T) > GroupWidth ? alignof(T) : GroupWidth;
+
+		int8*		m_Ctrl;			// control bytes, slots follow them in the same block
+		T*			m_Slots;		// slots
+		SizeType	m_Num;			// full slots
+		SizeType	m_Capacity;		// slot num, power of two, 0 or at least GroupWidth
+		SizeType	m_GrowthLeft;	// empty slots we may still fill before rehash
+		Alloc		m_Allocator;	// allocator
+
+		//------------------------------Begin helper functions------------------------------
+		// spread the 32 bits hash, GetTypeHash of integers is identity, low bits alone would pile in a few groups
+		static FORCEINLINE uint64 _Mix(uint32 KeyHash) { return (uint64)KeyHash * 0x9E3779B97F4A7C15ull; }
+		static FORCEINLINE USizeType _H1(uint64 Mixed) { return (USizeType)(Mixed >> 32); }
+		static FORCEINLINE int8 _H2(uint64 Mixed) { return (int8)(Mixed >> 57); }
+
+		// max load is 7/8
+		static FORCEINLINE SizeType _MaxLoad(SizeType Capacity) { return Capacity - Capacity / 8; }
+		static FORCEINLINE SizeType _CapacityFor(SizeType Number)
+		{
+			if (Number == 0) return 0;
+			SizeType Capacity = (SizeType)Math::RoundUpToPowerOfTwo((uint32)Number);
+			if (_MaxLoad(Capacity) < Number) Capacity *= 2;
+			return Capacity < GroupWidth ? GroupWidth : Capacity;
+		}
+		static FORCEINLINE size_t _SlotOffset(SizeType Capacity) { return Align((size_t)Capacity, alignof(T)); }
+
+		// walk groups by triangular steps, visit every group once when group num is power of two
+		template<typename TFunc>
+		FORCEINLINE SizeType _Probe(uint64 Mixed, TFunc&& Func) const
+		{
+			USizeType GroupMask = (USizeType)m_Capacity / GroupWidth - 1;
+			USizeType Group = _H1(Mixed) & GroupMask;
+			for (USizeType Step = 1;; ++Step)
+			{
+				SizeType Found = Func((SizeType)(Group * GroupWidth));
+				if (Found != INDEX_NONE) return Found;
+				Group = (Group + Step) & GroupMask;
+			}
+		}
+
+		SizeType _FindIndex(uint64 Mixed, const KeyType& Key) const
+		{
+			if (!m_Num) return INDEX_NONE;
+			int8 H2 = _H2(Mixed);
+			SizeType NotFound = INDEX_NONE - 1;
+			SizeType Found = _Probe(Mixed, [&](SizeType Base)->SizeType
+			{
+				FlatCtrlGroup Group(m_Ctrl + Base);
+				for (uint32 Mask = Group.Match(H2); Mask; Mask &= Mask - 1)
+				{
+					SizeType Index = Base + (SizeType)Math::CountTrailingZeros(Mask);
+					if (KeyFuncs::Matches(KeyFuncs::Key(m_Slots[Index]), Key)) return Index;
+				}
+				return Group.MatchEmpty() ? NotFound : INDEX_NONE;
+			});
+			return Found == NotFound ? INDEX_NONE : Found;
+		}
+		FORCEINLINE SizeType _FindFirstNonFull(uint64 Mixed) const
+		{
+			return _Probe(Mixed, [&](SizeType Base)->SizeType
+			{
+				uint32 Mask = FlatCtrlGroup(m_Ctrl + Base).MatchEmptyOrDeleted();
+				return Mask ? Base + (SizeType)Math::CountTrailingZeros(Mask) : INDEX_NONE;
+			});
+		}
+
+		// allocate a block of all empty control bytes
+		void _Allocate(SizeType Capacity)
+		{
+			m_Capacity = Capacity;
+			m_Num = 0;
+			if (!Capacity)
+			{
+				m_Ctrl = nullptr;
+				m_Slots = nullptr;
+				m_GrowthLeft = 0;
+				return;
+			}
+			void* Block = nullptr;
+			m_Allocator.ReserveRaw(Block, (SizeType)(_SlotOffset(Capacity) + Capacity * sizeof(T)), (SizeType)BlockAlignment);
+			m_Ctrl = (int8*)Block;
+			m_Slots = (T*)((uint8*)Block + _SlotOffset(Capacity));
+			m_GrowthLeft = _MaxLoad(Capacity);
+			Memset(m_Ctrl, (uint8)FlatCtrlEmpty, Capacity);
+		}
+		void _Deallocate()
+		{
+			if (!m_Ctrl) return;
+			void* Block = m_Ctrl;
+			m_Allocator.FreeRaw(Block, (SizeType)BlockAlignment);
+			m_Ctrl = nullptr;
+			m_Slots = nullptr;
+		}
+		void _DestructAll()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				for (SizeType Index = _NextFull(0); Index < m_Capacity; Index = _NextFull(Index + 1))
+				{
+					DestructItems(m_Slots + Index);
+				}
+			}
+		}
+
+		// move all elements to a new block, drop tombstones
+		void _Resize(SizeType NewCapacity)
+		{
+			int8* OldCtrl = m_Ctrl;
+			T* OldSlots = m_Slots;
+			SizeType OldCapacity = m_Capacity;
+			SizeType OldNum = m_Num;
+
+			_Allocate(NewCapacity);
+			for (SizeType Index = 0; Index < OldCapacity; ++Index)
+			{
+				if (OldCtrl[Index] < 0) continue;
+				uint64 Mixed = _Mix(KeyFuncs::Hash(KeyFuncs::Key(OldSlots[Index])));
+				SizeType NewIndex = _FindFirstNonFull(Mixed);
+				m_Ctrl[NewIndex] = _H2(Mixed);
+				RelocateConstructItems(m_Slots + NewIndex, OldSlots + Index, 1);
+			}
+			m_Num = OldNum;
+			m_GrowthLeft -= OldNum;
+
+			if (OldCtrl)
+			{
+				void* Block = OldCtrl;
+				m_Allocator.FreeRaw(Block, (SizeType)BlockAlignment);
+			}
+		}
+
+		// claim a slot for a new key, may rehash
+		SizeType _PrepareInsert(uint64 Mixed)
+		{
+			SizeType Index = m_Capacity ? _FindFirstNonFull(Mixed) : INDEX_NONE;
+			if (Index == INDEX_NONE || (m_GrowthLeft == 0 && m_Ctrl[Index] == FlatCtrlEmpty))
+			{
+				// mostly tombstones, rebuild at the same size
+				SizeType NewCapacity = (m_Num + 1) * 32 <= m_Capacity * 25 ? m_Capacity : Math::Max(m_Capacity * 2, _CapacityFor(m_Num + 1));
+				_Resize(NewCapacity);
+				Index = _FindFirstNonFull(Mixed);
+			}
+			m_GrowthLeft -= (m_Ctrl[Index] == FlatCtrlEmpty);
+			m_Ctrl[Index] = _H2(Mixed);
+			++m_Num;
+			return Index;
+		}
+
+		// a group with an empty byte never stopped a probe, so the slot can be empty again, otherwise leave a tombstone
+		FORCEINLINE void _EraseAt(SizeType Index)
+		{
+			DestructItems(m_Slots + Index);
+			--m_Num;
+			if (FlatCtrlGroup(m_Ctrl + (Index & ~(GroupWidth - 1))).MatchEmpty())
+			{
+				m_Ctrl[Index] = FlatCtrlEmpty;
+				++m_GrowthLeft;
+			}
+			else
+			{
+				m_Ctrl[Index] = FlatCtrlDeleted;
+			}
+		}
+
+		// first full slot at or after Index, m_Capacity if none
+		FORCEINLINE SizeType _NextFull(SizeType Index) const
+		{
+			while (Index < m_Capacity)
+			{
+				SizeType Base = Index & ~(GroupWidth - 1);
+				uint32 Mask = FlatCtrlGroup(m_Ctrl + Base).MatchFull() & (~0u << (Index - Base));
+				if (Mask) return Base + (SizeType)Math::CountTrailingZeros(Mask);
+				Index = Base + GroupWidth;
+			}
+			return m_Capacity;
+		}
+
+		void _CopyFrom(const TFlatSet& Other)
+		{
+			_Allocate(Other.m_Capacity);
+			if (!m_Capacity) return;
+			Memcpy(m_Ctrl, Other.m_Ctrl, m_Capacity);
+			for (SizeType Index = Other._NextFull(0); Index < m_Capacity; Index = Other._NextFull(Index + 1))
+			{
+				new (m_Slots + Index) T(Other.m_Slots[Index]);
+			}
+			m_Num = Other.m_Num;
+			m_GrowthLeft = Other.m_GrowthLeft;
+		}
+		FORCEINLINE void _StealFrom(TFlatSet& Other)
+		{
+			m_Ctrl = Other.m_Ctrl;
+			m_Slots = Other.m_Slots;
+			m_Num = Other.m_Num;
+			m_Capacity = Other.m_Capacity;
+			m_GrowthLeft = Other.m_GrowthLeft;
+			Other.m_Ctrl = nullptr;
+			Other.m_Slots = nullptr;
+			Other.m_Num = 0;
+			Other.m_Capacity = 0;
+			Other.m_GrowthLeft = 0;
+		}
+		//----------------------------End helper functions----------------------------
+	public:
+		// construct
+		FORCEINLINE TFlatSet(const Alloc& InAlloc = Alloc())
+			: m_Ctrl(nullptr)
+			, m_Slots(nullptr)
+			, m_Num(0)
+			, m_Capacity(0)
+			, m_GrowthLeft(0)
+			, m_Allocator(InAlloc)
+		{}
+		FORCEINLINE TFlatSet(std::initializer_list<T> InitList, const Alloc& InAlloc = Alloc())
+			: TFlatSet(InAlloc)
+		{
+			*this += InitList;
+		}
+
+		// copy construct
+		FORCEINLINE TFlatSet(const TFlatSet& Other)
+			: m_Allocator(Other.m_Allocator)
+		{
+			_CopyFrom(Other);
+		}
+
+		// move construct
+		FORCEINLINE TFlatSet(TFlatSet&& Other)
+			: m_Allocator(std::move(Other.m_Allocator))
+		{
+			_StealFrom(Other);
+		}
+
+		// destruct
+		~TFlatSet()
+		{
+			_DestructAll();
+			_Deallocate();
+		}
+
+		// assign
+		TFlatSet& operator=(const TFlatSet& Other)
+		{
+			if (this == &Other) return *this;
+			_DestructAll();
+			_Deallocate();
+			_CopyFrom(Other);
+			return *this;
+		}
+		TFlatSet& operator=(TFlatSet&& Other)
+		{
+			if (this == &Other) return *this;
+			_DestructAll();
+			_Deallocate();
+			m_Allocator = std::move(Other.m_Allocator);
+			_StealFrom(Other);
+			return *this;
+		}
+
+		// get information
+		FORCEINLINE SizeType Num() const { return m_Num; }
+		FORCEINLINE SizeType Max() const { return _MaxLoad(m_Capacity); }
+		FORCEINLINE SizeType GetCapacity() const { return m_Capacity; }
+		FORCEINLINE bool IsEmpty() const { return m_Num == 0; }
+		FORCEINLINE Alloc& GetAllocator() { return m_Allocator; }
+		FORCEINLINE const Alloc& GetAllocator() const { return m_Allocator; }
+
+		// empty & reset & shrink & reserve
+		void Empty(SizeType ExpectedNumElements = 0)
+		{
+			_DestructAll();
+			SizeType NewCapacity = _CapacityFor(ExpectedNumElements);
+			if (NewCapacity != m_Capacity)
+			{
+				_Deallocate();
+				_Allocate(NewCapacity);
+			}
+			else if (m_Capacity)
+			{
+				Memset(m_Ctrl, (uint8)FlatCtrlEmpty, m_Capacity);
+				m_Num = 0;
+				m_GrowthLeft = _MaxLoad(m_Capacity);
+			}
+		}
+		void Reset()
+		{
+			Empty(m_Capacity ? _MaxLoad(m_Capacity) : 0);
+		}
+		void Shrink()
+		{
+			SizeType NewCapacity = _CapacityFor(m_Num);
+			if (NewCapacity < m_Capacity) _Resize(NewCapacity);
+		}
+		void Reserve(SizeType ExpectedNumElements)
+		{
+			if (ExpectedNumElements > m_Num + m_GrowthLeft)
+			{
+				_Resize(Math::Max(_CapacityFor(ExpectedNumElements), m_Capacity));
+			}
+		}
+
+		// check id
+		FORCEINLINE bool IsValid(FlatElementId Id) const { return Id.IsValid() && Id < m_Capacity && m_Ctrl[Id] >= 0; }
+
+		// accessor
+		FORCEINLINE T& operator[](FlatElementId Id) { check(IsValid(Id)); return m_Slots[Id]; }
+		FORCEINLINE const T& operator[](FlatElementId Id) const { check(IsValid(Id)); return m_Slots[Id]; }
+
+		// find the key, or construct the element from Args in a new slot, the element made by Args must have the key
+		template<typename...Ts>
+		FlatElementId FindOrEmplaceByHash(uint32 KeyHash, const KeyType& Key, bool* bIsAlreadyInSetPtr, Ts&&...Args)
+		{
+			check(KeyHash == KeyFuncs::Hash(Key));
+			uint64 Mixed = _Mix(KeyHash);
+			SizeType Index = _FindIndex(Mixed, Key);
+			if (bIsAlreadyInSetPtr) *bIsAlreadyInSetPtr = Index != INDEX_NONE;
+			if (Index != INDEX_NONE) return Index;
+
+			Index = _PrepareInsert(Mixed);
+			new (m_Slots + Index) T(std::forward<Ts>(Args)...);
+			return Index;
+		}
+
+		// add, an element already in set is replaced
+		FORCEINLINE FlatElementId Add(const T& InElement, bool* bIsAlreadyInSetPtr = nullptr) { return Emplace(InElement, bIsAlreadyInSetPtr); }
+		FORCEINLINE FlatElementId Add(T&& InElement, bool* bIsAlreadyInSetPtr = nullptr) { return Emplace(std::move(InElement), bIsAlreadyInSetPtr); }
+		FORCEINLINE FlatElementId AddByHash(uint32 KeyHash, const T& InElement, bool* bIsAlreadyInSetPtr = nullptr) { return EmplaceByHash(KeyHash, InElement, bIsAlreadyInSetPtr); }
+		FORCEINLINE FlatElementId AddByHash(uint32 KeyHash, T&& InElement, bool* bIsAlreadyInSetPtr = nullptr) { return EmplaceByHash(KeyHash, std::move(InElement), bIsAlreadyInSetPtr); }
+
+		// emplace
+		template <typename ArgsType>
+		FORCEINLINE FlatElementId Emplace(ArgsType&& Args, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			if constexpr (std::is_same_v<std::decay_t<ArgsType>, T>)
+			{
+				return EmplaceByHash(KeyFuncs::Hash(KeyFuncs::Key(Args)), std::forward<ArgsType>(Args), bIsAlreadyInSetPtr);
+			}
+			else
+			{
+				// need the element to know the key
+				T Element(std::forward<ArgsType>(Args));
+				return EmplaceByHash(KeyFuncs::Hash(KeyFuncs::Key(Element)), std::move(Element), bIsAlreadyInSetPtr);
+			}
+		}
+		template <typename ArgsType>
+		FlatElementId EmplaceByHash(uint32 KeyHash, ArgsType&& Args, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			if constexpr (std::is_same_v<std::decay_t<ArgsType>, T>)
+			{
+				bool bIsAlreadyInSet;
+				FlatElementId Id = FindOrEmplaceByHash(KeyHash, KeyFuncs::Key(Args), &bIsAlreadyInSet, std::forward<ArgsType>(Args));
+				if (bIsAlreadyInSet) m_Slots[Id] = std::forward<ArgsType>(Args);
+				if (bIsAlreadyInSetPtr) *bIsAlreadyInSetPtr = bIsAlreadyInSet;
+				return Id;
+			}
+			else
+			{
+				return EmplaceByHash(KeyHash, T(std::forward<ArgsType>(Args)), bIsAlreadyInSetPtr);
+			}
+		}
+
+		// append
+		TFlatSet& operator+=(const TArray<T>& InElements)
+		{
+			Reserve(m_Num + (SizeType)InElements.Num());
+			for (const T& Element : InElements) Add(Element);
+			return *this;
+		}
+		TFlatSet& operator+=(const TFlatSet& OtherSet)
+		{
+			Reserve(m_Num + OtherSet.Num());
+			for (const T& Element : OtherSet) Add(Element);
+			return *this;
+		}
+		TFlatSet& operator+=(std::initializer_list<T> InitList)
+		{
+			Reserve(m_Num + (SizeType)InitList.size());
+			for (const T& Element : InitList) Add(Element);
+			return *this;
+		}
+
+		// remove
+		FORCEINLINE void Remove(FlatElementId Id)
+		{
+			check(IsValid(Id));
+			_EraseAt(Id);
+		}
+		FORCEINLINE SizeType Remove(const KeyType& Key) { return RemoveByHash(KeyFuncs::Hash(Key), Key); }
+		SizeType RemoveByHash(uint32 KeyHash, const KeyType& Key)
+		{
+			check(KeyHash == KeyFuncs::Hash(Key));
+			SizeType Index = _FindIndex(_Mix(KeyHash), Key);
+			if (Index == INDEX_NONE) return 0;
+			_EraseAt(Index);
+			return 1;
+		}
+
+		// find
+		FORCEINLINE FlatElementId FindId(const KeyType& Key) const { return _FindIndex(_Mix(KeyFuncs::Hash(Key)), Key); }
+		FORCEINLINE FlatElementId FindIdByHash(uint32 KeyHash, const KeyType& Key) const
+		{
+			check(KeyHash == KeyFuncs::Hash(Key));
+			return _FindIndex(_Mix(KeyHash), Key);
+		}
+		FORCEINLINE T* Find(const KeyType& Key)
+		{
+			SizeType Index = _FindIndex(_Mix(KeyFuncs::Hash(Key)), Key);
+			return Index != INDEX_NONE ? m_Slots + Index : nullptr;
+		}
+		FORCEINLINE const T* Find(const KeyType& Key) const { return const_cast<TFlatSet*>(this)->Find(Key); }
+		FORCEINLINE T* FindByHash(uint32 KeyHash, const KeyType& Key)
+		{
+			FlatElementId Id = FindIdByHash(KeyHash, Key);
+			return Id.IsValid() ? m_Slots + Id : nullptr;
+		}
+		FORCEINLINE const T* FindByHash(uint32 KeyHash, const KeyType& Key) const { return const_cast<TFlatSet*>(this)->FindByHash(KeyHash, Key); }
+
+		// contains
+		FORCEINLINE bool Contains(const KeyType& Key) const { return FindId(Key).IsValid(); }
+		FORCEINLINE bool ContainsByHash(uint32 KeyHash, const KeyType& Key) const { return FindIdByHash(KeyHash, Key).IsValid(); }
+
+		// compare, order independent
+		bool operator==(const TFlatSet& Other) const
+		{
+			if (Other.Num() != Num()) return false;
+			for (const T& Element : Other)
+			{
+				if (!Contains(KeyFuncs::Key(Element))) return false;
+			}
+			return true;
+		}
+		bool operator!=(const TFlatSet& Other) const { return !(*this == Other); }
+
+		// To Array
+		TArray<T> Array() const
+		{
+			TArray<T> Result;
+			Result.Reserve(Num());
+			for (const T& Element : *this) Result.Add(Element);
+			return Result;
+		}
+
+		//-----------------------------------------------iterators-----------------------------------------------
+		template<bool bConst>
+		class TBaseIterator
+		{
+		protected:
+			using SetType = std::conditional_t<bConst, const TFlatSet, TFlatSet>;
+			using ItElementType = std::conditional_t<bConst, const T, T>;
+
+			SetType&	m_Set;
+			SizeType	m_Index;
+		public:
+			FORCEINLINE TBaseIterator(SetType& InSet, SizeType StartIndex = 0) : m_Set(InSet), m_Index(InSet._NextFull(StartIndex)) {}
+
+			FORCEINLINE TBaseIterator& operator++() { m_Index = m_Set._NextFull(m_Index + 1); return *this; }
+			FORCEINLINE explicit operator bool() const { return m_Index < m_Set.m_Capacity; }
+			FORCEINLINE bool operator !() const { return !(bool)*this; }
+
+			FORCEINLINE ItElementType* operator->() const { return m_Set.m_Slots + m_Index; }
+			FORCEINLINE ItElementType& operator*() const { return m_Set.m_Slots[m_Index]; }
+
+			FORCEINLINE friend bool operator==(const TBaseIterator& Lhs, const TBaseIterator& Rhs) { return Lhs.m_Index == Rhs.m_Index; }
+			FORCEINLINE friend bool operator!=(const TBaseIterator& Lhs, const TBaseIterator& Rhs) { return Lhs.m_Index != Rhs.m_Index; }
+
+			FORCEINLINE FlatElementId GetId() const { return m_Index; }
+		};
+		class TIterator : public TBaseIterator<false>
+		{
+		public:
+			using TBaseIterator<false>::TBaseIterator;
+
+			// erase never move other elements, so the walk can go on
+			FORCEINLINE void RemoveCurrent() { this->m_Set.Remove(this->GetId()); }
+		};
+		using TConstIterator = TBaseIterator<true>;
+
+		// Support foreach
+		FORCEINLINE TIterator      begin()		{ return TIterator(*this); }
+		FORCEINLINE TConstIterator begin() const{ return TConstIterator(*this); }
+		FORCEINLINE TIterator      end()		{ return TIterator(*this, m_Capacity); }
+		FORCEINLINE TConstIterator end() const	{ return TConstIterator(*this, m_Capacity); }
+	};
+}
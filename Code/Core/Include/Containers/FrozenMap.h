@@ -0,0 +1,489 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include <Memory/MemoryOps.h>
+#include <Math/MathUtility.h>
+#include <Templates/Pair.h>
+#include <Templates/Align.h>
+#include <Algo/Sort.h>
+#include <Algo/Container/PerfectHash.h>
+#include <Misc/Hash.h>
+#include "Array.h"
+#include "Misc/Assert.h"
+#include "ContainerFwd.h"
+
+// image header
+namespace Fuko
+{
+	// head of a frozen map image, every offset is from the image begin, so the image work at any address
+	// native endian and native MemHash64, an image made on another platform or by another hash version is refused
+	struct FrozenMapHeader
+	{
+		static constexpr uint32 MagicValue = 0x504D5A46;	// "FZMP"
+		static constexpr uint32 CurrentVersion = 1;
+
+		uint32	Magic;
+		uint32	Version;
+		uint64	ImageSize;
+		uint64	HashCheck;		// MemHash64 of a fixed probe, catch a hash change between build and load
+		uint64	Seed;
+		uint32	KeyKind;		// 0 for keys stored as is, char size for string keys
+		uint32	KeySize;
+		uint32	ValueSize;
+		uint32	SlotSize;
+		Algo::PerfectHashLayout	Layout;
+		uint64	PilotOffset;	// PerfectHashPilot[BucketNum]
+		uint64	RemapOffset;	// uint32[TableSize - Num]
+		uint64	SlotOffset;		// { key, value }[Num]
+		uint64	StringOffset;	// string keys, zero terminated
+		uint64	StringSize;
+	};
+}
+
+// key funcs
+namespace Fuko
+{
+	// how a key is hashed, compared and stored in the image, keys are stored as is and hashed by their bytes
+	template<typename KeyType>
+	struct TFrozenKeyFuncs
+	{
+		static_assert(std::is_trivially_copyable_v<KeyType> && std::has_unique_object_representations_v<KeyType>,
+			"frozen key without string funcs must be trivially copyable and without padding");
+
+		using StoredType = KeyType;
+		using ViewType = KeyType;
+		static constexpr uint32 KeyKind = 0;
+
+		// keys up to 8 bytes go through the bijective mixer, inlined and never collide
+		static FORCEINLINE uint64 Hash(const ViewType& Key, uint64 Seed)
+		{
+			if constexpr (sizeof(KeyType) <= sizeof(uint64))
+			{
+				uint64 Bits = 0;
+				Memcpy(&Bits, &Key, sizeof(KeyType));
+				return MixHash64(Bits ^ Seed);
+			}
+			else
+			{
+				return MemHash64(&Key, sizeof(KeyType), Seed);
+			}
+		}
+		static FORCEINLINE bool Equals(const ViewType& A, const ViewType& B) { return !Memcmp(&A, &B, sizeof(KeyType)); }
+		static FORCEINLINE const ViewType& ToView(const StoredType& Stored, const uint8* Strings) { return Stored; }
+		static FORCEINLINE uint64 StringSize(const ViewType& Key) { return 0; }
+		static FORCEINLINE StoredType Store(const ViewType& Key, uint8* Strings, uint64& StringPos) { return Key; }
+	};
+
+	// string key of the lookup, made from a zero terminated string or a pointer and a length
+	template<typename CharType>
+	struct TFrozenStringView
+	{
+		const CharType*	Data;
+		uint32			Len;
+
+		FORCEINLINE TFrozenStringView(const CharType* InData, uint32 InLen) : Data(InData), Len(InLen) {}
+		FORCEINLINE TFrozenStringView(const CharType* InData) : Data(InData), Len(0) { while (InData[Len]) ++Len; }
+	};
+
+	// string keys are copied into the string section of the image, slots keep offset and length
+	template<typename CharType>
+	struct TFrozenStringKeyFuncs
+	{
+		struct StoredType
+		{
+			uint32	Offset;
+			uint32	Len;
+		};
+		using ViewType = TFrozenStringView<CharType>;
+		static constexpr uint32 KeyKind = sizeof(CharType);
+
+		static FORCEINLINE uint64 Hash(const ViewType& Key, uint64 Seed) { return MemHash64(Key.Data, Key.Len * sizeof(CharType), Seed); }
+		static FORCEINLINE bool Equals(const ViewType& A, const ViewType& B) { return A.Len == B.Len && !Memcmp(A.Data, B.Data, A.Len * sizeof(CharType)); }
+		static FORCEINLINE ViewType ToView(const StoredType& Stored, const uint8* Strings) { return ViewType((const CharType*)(Strings + Stored.Offset), Stored.Len); }
+		static FORCEINLINE uint64 StringSize(const ViewType& Key) { return (Key.Len + 1) * sizeof(CharType); }
+		static FORCEINLINE StoredType Store(const ViewType& Key, uint8* Strings, uint64& StringPos)
+		{
+			StoredType Stored{ (uint32)StringPos, Key.Len };
+			Memcpy(Strings + StringPos, Key.Data, Key.Len * sizeof(CharType));
+			StringPos += StringSize(Key);
+			return Stored;
+		}
+	};
+	template<> struct TFrozenKeyFuncs<const ANSICHAR*> : TFrozenStringKeyFuncs<ANSICHAR> {};
+	template<> struct TFrozenKeyFuncs<const WIDECHAR*> : TFrozenStringKeyFuncs<WIDECHAR> {};
+}
+
+// TFrozenMap
+namespace Fuko
+{
+	// read only map built once over a minimal perfect hash, a lookup hash the key and check exactly one slot
+	// the whole map is one flat image without pointers, save it with GetImage and View it from a mapped file later, no load step
+	// values are read in place from the image, so they must be trivially copyable and without padding
+	template<typename KeyType, typename ValueType, typename Alloc>
+	class TFrozenMap
+	{
+		static_assert(std::is_trivially_copyable_v<ValueType>, "frozen value is read in place from the image, it must be trivially copyable");
+		static_assert(std::has_unique_object_representations_v<ValueType> || std::is_floating_point_v<ValueType>,
+			"frozen value must be without padding, padding bytes would make the image of the same pairs differ");
+	public:
+		using KeyFuncs = TFrozenKeyFuncs<KeyType>;
+		using StoredKeyType = typename KeyFuncs::StoredType;
+		using KeyViewType = typename KeyFuncs::ViewType;
+		using ElementType = TPair<KeyType, ValueType>;
+		using SizeType = typename Alloc::USizeType;
+
+		struct SlotType
+		{
+			StoredKeyType	Key;
+			ValueType		Value;
+		};
+
+		// every section start at this alignment, an image in memory should be aligned to it too
+		static constexpr uint32 ImageAlign = 64;
+	private:
+		Alloc							m_Allocator;
+		uint8*							m_Storage;		// owned image, null when viewing an image owned by someone else
+		const uint8*					m_Image;
+		uint64							m_ImageSize;
+
+		// copied out of the header, a lookup never touch it
+		Algo::PerfectHashLayout			m_Layout;
+		uint64							m_Seed;
+		const Algo::PerfectHashPilot*	m_Pilots;
+		const uint32*					m_Remap;
+		const SlotType*					m_Slots;
+		const uint8*					m_Strings;
+
+		//-----------------------------begin help function-----------------------------
+		// short and long input take different paths of MemHash64, probe both
+		static uint64 _HashCheck()
+		{
+			uint8 Probe[300];
+			for (uint32 i = 0; i < sizeof(Probe); ++i) Probe[i] = (uint8)(i * 7 + 1);
+			return MemHash64(Probe, 13, HashSecret[0]) ^ MemHash64(Probe, sizeof(Probe), HashSecret[1]);
+		}
+
+		FORCEINLINE void _Detach()
+		{
+			m_Image = nullptr;
+			m_ImageSize = 0;
+			m_Layout = Algo::PerfectHashLayout();
+			m_Seed = 0;
+			m_Pilots = nullptr;
+			m_Remap = nullptr;
+			m_Slots = nullptr;
+			m_Strings = nullptr;
+		}
+		FORCEINLINE void _FreeAll()
+		{
+			if (m_Storage)
+			{
+				void* Storage = m_Storage;
+				m_Allocator.FreeRaw(Storage, ImageAlign);
+				m_Storage = nullptr;
+			}
+			_Detach();
+		}
+		FORCEINLINE uint8* _AllocStorage(uint64 Size)
+		{
+			check(Size <= (uint64)(SizeType)-1);
+			void* Storage = nullptr;
+			m_Allocator.ReserveRaw(Storage, (SizeType)Size, ImageAlign);
+			return (uint8*)Storage;
+		}
+
+		// only the header is checked, the sections are trusted as made by Build, so View never touch them
+		static bool _Validate(const void* Image, uint64 Size)
+		{
+			if (!Image || Size < sizeof(FrozenMapHeader) || !IsAligned(Image, Math::Max(alignof(SlotType), alignof(FrozenMapHeader)))) return false;
+			const FrozenMapHeader& Header = *(const FrozenMapHeader*)Image;
+			if (Header.Magic != FrozenMapHeader::MagicValue || Header.Version != FrozenMapHeader::CurrentVersion || Header.ImageSize > Size) return false;
+			if (Header.HashCheck != _HashCheck() || Header.KeyKind != KeyFuncs::KeyKind || Header.KeySize != sizeof(StoredKeyType)
+				|| Header.ValueSize != sizeof(ValueType) || Header.SlotSize != sizeof(SlotType)) return false;
+
+			const Algo::PerfectHashLayout& Layout = Header.Layout;
+			if (Layout.Num && (Layout.TableSize <= Layout.Num || Layout.DenseBucketNum == 0 || Layout.DenseBucketNum >= Layout.BucketNum)) return false;
+			if (!Layout.Num && (Layout.TableSize || Layout.BucketNum)) return false;
+
+			// sections in order, aligned and inside the image
+			const uint64 Offsets[] = { Header.PilotOffset, Header.RemapOffset, Header.SlotOffset, Header.StringOffset };
+			for (uint64 Offset : Offsets) if (Offset > Header.ImageSize || !IsAligned(Offset, ImageAlign)) return false;
+			return Header.PilotOffset >= sizeof(FrozenMapHeader)
+				&& Header.PilotOffset + (uint64)Layout.BucketNum * sizeof(Algo::PerfectHashPilot) <= Header.RemapOffset
+				&& Header.RemapOffset + (uint64)(Layout.TableSize - Layout.Num) * sizeof(uint32) <= Header.SlotOffset
+				&& Header.SlotOffset + (uint64)Layout.Num * sizeof(SlotType) <= Header.StringOffset
+				&& Header.StringSize <= Header.ImageSize - Header.StringOffset;
+		}
+		FORCEINLINE void _Attach(const uint8* Image)
+		{
+			const FrozenMapHeader& Header = *(const FrozenMapHeader*)Image;
+			m_Image = Image;
+			m_ImageSize = Header.ImageSize;
+			m_Layout = Header.Layout;
+			m_Seed = Header.Seed;
+			m_Pilots = (const Algo::PerfectHashPilot*)(Image + Header.PilotOffset);
+			m_Remap = (const uint32*)(Image + Header.RemapOffset);
+			m_Slots = (const SlotType*)(Image + Header.SlotOffset);
+			m_Strings = Image + Header.StringOffset;
+		}
+		FORCEINLINE void _CopyFrom(const TFrozenMap& Other)
+		{
+			if (Other.m_Storage)
+			{
+				m_Storage = _AllocStorage(Other.m_ImageSize);
+				Memcpy(m_Storage, Other.m_Storage, (size_t)Other.m_ImageSize);
+				_Attach(m_Storage);
+			}
+			else if (Other.m_Image)
+			{
+				_Attach(Other.m_Image);
+			}
+		}
+		FORCEINLINE void _MoveFrom(TFrozenMap& Other)
+		{
+			m_Storage = Other.m_Storage;
+			m_Image = Other.m_Image;
+			m_ImageSize = Other.m_ImageSize;
+			m_Layout = Other.m_Layout;
+			m_Seed = Other.m_Seed;
+			m_Pilots = Other.m_Pilots;
+			m_Remap = Other.m_Remap;
+			m_Slots = Other.m_Slots;
+			m_Strings = Other.m_Strings;
+			Other.m_Storage = nullptr;
+			Other._Detach();
+		}
+
+		// one probe, the slot picked by the hash hold the key or the key is not in the map
+		FORCEINLINE SizeType _FindIndex(const KeyViewType& Key) const
+		{
+			if (!m_Layout.Num) return (SizeType)INDEX_NONE;
+			const uint64 Hash = KeyFuncs::Hash(Key, m_Seed);
+			uint32 Index = m_Layout.Position(Hash, Algo::PerfectHashLayout::PilotHash(m_Pilots[m_Layout.Bucket(Hash)]));
+			if (Index >= m_Layout.Num) Index = m_Remap[Index - m_Layout.Num];
+			return KeyFuncs::Equals(KeyFuncs::ToView(m_Slots[Index].Key, m_Strings), Key) ? (SizeType)Index : (SizeType)INDEX_NONE;
+		}
+
+		// Sources[i] is the pair of unique key i, Slots[i] its slot
+		void _WriteImage(const ElementType* Pairs, uint64 Seed, const Algo::PerfectHashLayout& Layout
+			, const TArray<Algo::PerfectHashPilot>& Pilots, const TArray<uint32>& Remap, const TArray<uint32>& Sources, const TArray<uint32>& Slots)
+		{
+			const uint32 Num = Layout.Num;
+
+			// strings are written in slot order, a scan over the slots walk them forward
+			TArray<uint32> SlotSources;
+			SlotSources.SetNumUninitialized(Num);
+			for (uint32 i = 0; i < Num; ++i) SlotSources[Slots[i]] = Sources[i];
+			uint64 StringSize = 0;
+			for (uint32 Source : SlotSources) StringSize += KeyFuncs::StringSize(Pairs[Source].Key);
+			// string keys are stored by a uint32 offset
+			check(StringSize <= (uint64)(uint32)-1);
+
+			FrozenMapHeader Header;
+			Memzero(&Header, sizeof(Header));
+			Header.Magic = FrozenMapHeader::MagicValue;
+			Header.Version = FrozenMapHeader::CurrentVersion;
+			Header.HashCheck = _HashCheck();
+			Header.Seed = Seed;
+			Header.KeyKind = KeyFuncs::KeyKind;
+			Header.KeySize = sizeof(StoredKeyType);
+			Header.ValueSize = sizeof(ValueType);
+			Header.SlotSize = sizeof(SlotType);
+			Header.Layout = Layout;
+			Header.PilotOffset = Align((uint64)sizeof(FrozenMapHeader), ImageAlign);
+			Header.RemapOffset = Align(Header.PilotOffset + (uint64)Layout.BucketNum * sizeof(Algo::PerfectHashPilot), ImageAlign);
+			Header.SlotOffset = Align(Header.RemapOffset + (uint64)(Layout.TableSize - Num) * sizeof(uint32), ImageAlign);
+			Header.StringOffset = Align(Header.SlotOffset + (uint64)Num * sizeof(SlotType), ImageAlign);
+			Header.StringSize = StringSize;
+			Header.ImageSize = Header.StringOffset + StringSize;
+
+			// zero first, padding bytes are part of the image and the same pairs must give the same bytes
+			_FreeAll();
+			m_Storage = _AllocStorage(Header.ImageSize);
+			Memzero(m_Storage, (size_t)Header.ImageSize);
+			Memcpy(m_Storage, &Header, sizeof(Header));
+			if (Num)
+			{
+				Memcpy(m_Storage + Header.PilotOffset, Pilots.GetData(), Pilots.Num() * sizeof(Algo::PerfectHashPilot));
+				if (Remap.Num()) Memcpy(m_Storage + Header.RemapOffset, Remap.GetData(), Remap.Num() * sizeof(uint32));
+			}
+			SlotType* OutSlots = (SlotType*)(m_Storage + Header.SlotOffset);
+			uint8* Strings = m_Storage + Header.StringOffset;
+			uint64 StringPos = 0;
+			for (uint32 i = 0; i < Num; ++i)
+			{
+				const ElementType& Pair = Pairs[SlotSources[i]];
+				OutSlots[i].Key = KeyFuncs::Store(Pair.Key, Strings, StringPos);
+				Memcpy(&OutSlots[i].Value, &Pair.Value, sizeof(ValueType));
+			}
+			_Attach(m_Storage);
+		}
+		//------------------------------end help function------------------------------
+	public:
+		// construct
+		FORCEINLINE TFrozenMap(const Alloc& InAlloc = Alloc())
+			: m_Allocator(InAlloc)
+			, m_Storage(nullptr)
+		{
+			_Detach();
+		}
+		TFrozenMap(std::initializer_list<ElementType> InitList, const Alloc& InAlloc = Alloc())
+			: TFrozenMap(InAlloc)
+		{
+			Build(InitList.begin(), (SizeType)InitList.size());
+		}
+
+		// copy & move, a copy of a view is the same view
+		TFrozenMap(const TFrozenMap& Other)
+			: TFrozenMap(Other.m_Allocator)
+		{
+			_CopyFrom(Other);
+		}
+		FORCEINLINE TFrozenMap(TFrozenMap&& Other)
+			: m_Allocator(std::move(Other.m_Allocator))
+		{
+			_MoveFrom(Other);
+		}
+		TFrozenMap& operator=(const TFrozenMap& Other)
+		{
+			if (this == &Other) return *this;
+			_FreeAll();
+			m_Allocator = Other.m_Allocator;
+			_CopyFrom(Other);
+			return *this;
+		}
+		FORCEINLINE TFrozenMap& operator=(TFrozenMap&& Other)
+		{
+			if (this == &Other) return *this;
+			_FreeAll();
+			m_Allocator = std::move(Other.m_Allocator);
+			_MoveFrom(Other);
+			return *this;
+		}
+
+		// destruct
+		FORCEINLINE ~TFrozenMap() { _FreeAll(); }
+
+		// build an owned image, the last pair of a key win, the same pairs always give the same image bytes
+		void Build(const ElementType* Pairs, SizeType Count)
+		{
+			using HashIndex = TPair<uint64, uint32>;
+			TArray<HashIndex> Order;
+			TArray<uint64> Hashes;
+			TArray<Algo::PerfectHashPilot> Pilots;
+			TArray<uint32> Sources, Remap, Slots;
+			Order.SetNumUninitialized(Count);
+			Hashes.Reserve(Count);
+			Sources.Reserve(Count);
+
+			for (uint64 Attempt = 0; ; ++Attempt)
+			{
+				// hash sorted with position, a run of equal hashes is one key written many times or a real collision
+				const uint64 Seed = MixHash64(HashSecret[3] + Attempt);
+				for (uint32 i = 0; i < Count; ++i) new(&Order[i]) HashIndex(KeyFuncs::Hash(Pairs[i].Key, Seed), i);
+				Algo::IntroSort(Order.GetData(), Count, [](const HashIndex& A, const HashIndex& B)
+				{
+					return A.Key < B.Key || (A.Key == B.Key && A.Value < B.Value);
+				});
+
+				bool bCollide = false;
+				Hashes.Reset();
+				Sources.Reset();
+				for (uint32 i = 0; i < Count && !bCollide; ++i)
+				{
+					if (i + 1 < Count && Order[i + 1].Key == Order[i].Key)
+					{
+						bCollide = !KeyFuncs::Equals(Pairs[Order[i].Value].Key, Pairs[Order[i + 1].Value].Key);
+						continue;
+					}
+					Hashes.Add(Order[i].Key);
+					Sources.Add(Order[i].Value);
+				}
+				if (bCollide) continue;
+
+				const Algo::PerfectHashLayout Layout = Algo::MakePerfectHashLayout(Hashes.Num());
+				Pilots.SetNumUninitialized(Layout.BucketNum);
+				Remap.SetNumUninitialized(Layout.TableSize - Layout.Num);
+				Slots.SetNumUninitialized(Layout.Num);
+				if (!Algo::BuildPerfectHash(Hashes.GetData(), Layout, Pilots.GetData(), Remap.GetData(), Slots.GetData())) continue;
+
+				_WriteImage(Pairs, Seed, Layout, Pilots, Remap, Sources, Slots);
+				return;
+			}
+		}
+		template<typename OtherAlloc>
+		FORCEINLINE void Build(const TArray<ElementType, OtherAlloc>& Pairs) { Build(Pairs.GetData(), Pairs.Num()); }
+
+		// use an image in place, such as a mapped file, it must outlive the map, false and empty when the image is refused
+		bool View(const void* Image, uint64 Size)
+		{
+			if (!_Validate(Image, Size))
+			{
+				_FreeAll();
+				return false;
+			}
+			if (m_Storage == Image) return true;
+			_FreeAll();
+			_Attach((const uint8*)Image);
+			return true;
+		}
+
+		// copy an image into owned memory, for an image read into a temporary buffer
+		bool Load(const void* Image, uint64 Size)
+		{
+			if (!_Validate(Image, Size))
+			{
+				_FreeAll();
+				return false;
+			}
+			const uint64 ImageSize = ((const FrozenMapHeader*)Image)->ImageSize;
+			uint8* Storage = _AllocStorage(ImageSize);
+			Memcpy(Storage, Image, (size_t)ImageSize);
+			_FreeAll();
+			m_Storage = Storage;
+			_Attach(m_Storage);
+			return true;
+		}
+
+		// image, write it out as is
+		FORCEINLINE const void* GetImage() const { return m_Image; }
+		FORCEINLINE uint64 GetImageSize() const { return m_ImageSize; }
+		FORCEINLINE bool IsView() const { return m_Image && !m_Storage; }
+
+		// operators
+		FORCEINLINE void Empty() { _FreeAll(); }
+		FORCEINLINE SizeType Num() const { return m_Layout.Num; }
+		FORCEINLINE bool IsEmpty() const { return m_Layout.Num == 0; }
+
+		// the slot of a key is a dense id in [0, Num), INDEX_NONE when key is not in the map
+		FORCEINLINE SizeType IndexOf(const KeyViewType& Key) const { return _FindIndex(Key); }
+		FORCEINLINE decltype(auto) KeyAt(SizeType Index) const { check(Index < Num()); return KeyFuncs::ToView(m_Slots[Index].Key, m_Strings); }
+		FORCEINLINE const ValueType& ValueAt(SizeType Index) const { check(Index < Num()); return m_Slots[Index].Value; }
+
+		// find
+		FORCEINLINE const ValueType* Find(const KeyViewType& Key) const
+		{
+			SizeType Index = _FindIndex(Key);
+			return Index != (SizeType)INDEX_NONE ? &m_Slots[Index].Value : nullptr;
+		}
+		FORCEINLINE const ValueType& FindChecked(const KeyViewType& Key) const
+		{
+			const ValueType* Value = Find(Key);
+			check(Value != nullptr);
+			return *Value;
+		}
+		FORCEINLINE ValueType FindRef(const KeyViewType& Key) const
+		{
+			const ValueType* Value = Find(Key);
+			return Value ? *Value : ValueType();
+		}
+		FORCEINLINE bool Contains(const KeyViewType& Key) const { return _FindIndex(Key) != (SizeType)INDEX_NONE; }
+
+		// visit pairs in slot order, Func(Key, Value)
+		template<typename FuncType>
+		FORCEINLINE void ForEach(FuncType&& Func) const
+		{
+			for (uint32 i = 0; i < m_Layout.Num; ++i) Func(KeyFuncs::ToView(m_Slots[i].Key, m_Strings), m_Slots[i].Value);
+		}
+	};
+}
@@ -1,8 +1,29 @@
 #pragma once
 #include <CoreConfig.h>
 #include <CoreType.h>
+#include <Misc/CpuInfo.h>
+#include "ContainerFwd.h"
 #include <mutex>
 #include <atomic>
+#include <thread>
+#if CPU_X86
+#include <emmintrin.h>
+#endif
+
+// concurrency helpers 
+namespace Fuko
+{
+	// data written by different threads live on different lines, or every write steal the line from the others 
+	inline constexpr size_t CacheLineSize = 64;
+
+	// spin wait hint, leave the core to the sibling hyper thread 
+	FORCEINLINE void CpuRelax()
+	{
+#if CPU_X86
+		_mm_pause();
+#endif
+	}
+}
 
 namespace Fuko
 {
@@ -12,7 +33,9 @@ namespace Fuko
 		FORCEINLINE void unlock() {}
 		FORCEINLINE void try_lock() {}
 	};
+	// lock free tags, containers specialize on them: LockFree for many producers and consumers, LockFreeSPSC for one of each 
 	struct LockFree : public NoLock {};
+	struct LockFreeSPSC : public NoLock {};
 
 	// 互斥锁 
 	struct MutexLock
@@ -25,7 +48,7 @@ namespace Fuko
 	};
 	
 	// 自旋锁 
-	template<int YieldTime = -1>
+	template<int YieldTime>
 	struct TSpinLock
 	{
 		FORCEINLINE void lock()
@@ -41,4 +64,31 @@ namespace Fuko
 	private:
 		std::atomic_flag LockFlag = ATOMIC_FLAG_INIT;
 	};
+
+	// 顺序锁, readers never write shared memory, they copy the data and retry when a writer ran meanwhile
+	// writers must be serialized by another lock, data read must be trivially copyable
+	struct SeqLock
+	{
+		FORCEINLINE uint32 ReadBegin() const
+		{
+			uint32 Seq;
+			while ((Seq = Sequence.load(std::memory_order_acquire)) & 1) CpuRelax();
+			return Seq;
+		}
+		FORCEINLINE bool ReadRetry(uint32 Seq) const
+		{
+			// data loads before the fence can not move after the check 
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return Sequence.load(std::memory_order_relaxed) != Seq;
+		}
+		FORCEINLINE void WriteBegin()
+		{
+			// odd sequence must be seen before any data store 
+			Sequence.store(Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+		FORCEINLINE void WriteEnd() { Sequence.store(Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+	private:
+		std::atomic<uint32> Sequence = 0;
+	};
 }
\ No newline at end of file
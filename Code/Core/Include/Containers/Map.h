@@ -10,7 +10,7 @@
 // KeyFunctions 
 namespace Fuko
 {
-	template<typename TK, typename TV, bool bInAllowDuplicateKeys>
+	template<typename TK, typename TV, bool bInAllowDuplicateKeys, typename HashPolicy>
 	struct TDefaultMapKeyFuncs
 	{
 		using KeyType = TK;
@@ -19,7 +19,7 @@ namespace Fuko
 
 		static FORCEINLINE const KeyType& Key(const ElementType& Element) { return Element.Key; }
 		static FORCEINLINE bool Matches(const KeyType& A, const KeyType& B) { return A == B; }
-		static FORCEINLINE uint32 Hash(KeyType Key) { return GetTypeHash(Key); }
+		static FORCEINLINE uint32 Hash(KeyType Key) { return HashPolicy::Hash(Key); }
 	};
 }
 
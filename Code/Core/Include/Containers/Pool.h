@@ -3,6 +3,7 @@
 #include <CoreType.h>
 #include "LockPolicy.h"
 #include "Array.h"
+#include <Algo/BinarySearch.h>
 #include "ContainerFwd.h"
 
 // TPool NoLock 
@@ -23,6 +24,12 @@ namespace Fuko
 		TArray<Node*,TAlloc>		m_Blocks;
 		Node*						m_FreeList;
 		SizeType					m_BlockSize;
+		SizeType					m_UsedNum;
+
+		// auto trim, start when free nodes reach m_NextAutoTrim
+		SizeType					m_AutoTrimHigh;
+		SizeType					m_AutoTrimLow;
+		SizeType					m_NextAutoTrim;
 		
 		//=================================Begin help function=================================
 		FORCEINLINE void _LinkToFreeList(Node* InNode)
@@ -36,6 +43,35 @@ namespace Fuko
 			m_FreeList = m_FreeList->Next;
 			return Ret;
 		}
+		FORCEINLINE void _ReserveFree(SizeType Num)
+		{
+			SizeType FreeNum = _FreeNum();
+			if (FreeNum < Num) _AllocBlock((Num - FreeNum + m_BlockSize - 1) / m_BlockSize);
+		}
+		FORCEINLINE void _PopN(T** Out, SizeType Num)
+		{
+			Node* It = m_FreeList;
+			for (SizeType i = 0; i < Num; ++i)
+			{
+				Out[i] = (T*)It;
+				It = It->Next;
+			}
+			m_FreeList = It;
+			m_UsedNum += Num;
+		}
+		FORCEINLINE void _LinkChain(T** In, SizeType Num)
+		{
+			for (SizeType i = 0; i + 1 < Num; ++i)
+			{
+				((Node*)In[i])->Next = (Node*)In[i + 1];
+			}
+		}
+		FORCEINLINE void _SpliceChain(Node* First, Node* Last, SizeType Num)
+		{
+			Last->Next = m_FreeList;
+			m_FreeList = First;
+			m_UsedNum -= Num;
+		}
 		FORCEINLINE void _AllocBlock(SizeType BlockNum = 1)
 		{
 			// alloc memory
@@ -50,6 +86,66 @@ namespace Fuko
 					++NewBlock;
 				}
 			}
+			m_NextAutoTrim = m_AutoTrimHigh * m_BlockSize;
+		}
+		FORCEINLINE SizeType _FreeNum() const { return m_Blocks.Num() * m_BlockSize - m_UsedNum; }
+		FORCEINLINE SizeType _BlockIndex(Node* InNode) const { return Algo::UpperBound(m_Blocks, InNode) - 1; }
+		SizeType _Trim(SizeType KeepFreeBlocks)
+		{
+			static constexpr SizeType ReleaseFlag = ~SizeType(0);
+			if (!m_FreeList) return 0;
+
+			// count free nodes per block, blocks are sorted by address for search
+			m_Blocks.Sort();
+			TArray<SizeType, TAlloc> FreeCount(SizeType(0), m_Blocks.Num(), m_Blocks.GetAllocator());
+			for (Node* It = m_FreeList; It; It = It->Next)
+			{
+				++FreeCount[_BlockIndex(It)];
+			}
+
+			// fully free blocks after the first KeepFreeBlocks are released
+			SizeType ReleaseNum = 0;
+			for (SizeType i = 0; i < m_Blocks.Num(); ++i)
+			{
+				if (FreeCount[i] != m_BlockSize) continue;
+				if (KeepFreeBlocks)
+				{
+					--KeepFreeBlocks;
+					continue;
+				}
+				FreeCount[i] = ReleaseFlag;
+				++ReleaseNum;
+			}
+			if (!ReleaseNum) return 0;
+
+			// unlink nodes of released blocks
+			Node** Link = &m_FreeList;
+			for (Node* It = m_FreeList; It; It = It->Next)
+			{
+				if (FreeCount[_BlockIndex(It)] == ReleaseFlag) continue;
+				*Link = It;
+				Link = &It->Next;
+			}
+			*Link = nullptr;
+
+			// free blocks, keep the rest sorted
+			SizeType WriteIndex = 0;
+			for (SizeType i = 0; i < m_Blocks.Num(); ++i)
+			{
+				if (FreeCount[i] == ReleaseFlag)
+					m_Blocks.GetAllocator().template Free<Node>(m_Blocks[i]);
+				else
+					m_Blocks[WriteIndex++] = m_Blocks[i];
+			}
+			m_Blocks.SetNum(WriteIndex, false);
+			return ReleaseNum;
+		}
+		FORCENOINLINE void _AutoTrim()
+		{
+			_Trim(m_AutoTrimLow);
+
+			// hysteresis, wait for another (high - low) blocks of free nodes even if nothing released
+			m_NextAutoTrim = Math::Max(m_AutoTrimHigh * m_BlockSize, _FreeNum() + (m_AutoTrimHigh - m_AutoTrimLow) * m_BlockSize);
 		}
 		//==================================End help function==================================
 	public:
@@ -57,6 +153,10 @@ namespace Fuko
 			: m_Blocks(InitBlockNum > 4 ? InitBlockNum : 4, InAlloc)
 			, m_FreeList(nullptr)
 			, m_BlockSize(BlockSize)
+			, m_UsedNum(0)
+			, m_AutoTrimHigh(0)
+			, m_AutoTrimLow(0)
+			, m_NextAutoTrim(0)
 		{
 			_AllocBlock(InitBlockNum);
 		}
@@ -70,19 +170,59 @@ namespace Fuko
 
 		bool IsInPool(void* Memory)
 		{
-			for (T* Ptr : m_Blocks)
+			for (Node* Ptr : m_Blocks)
 			{
 				if (Memory >= Ptr && Memory < (void*)(Ptr + m_BlockSize)) return true;
 			}
 			return false;
 		}
 
+		// occupancy 
+		SizeType NumUsed() const { return m_UsedNum; }
+		SizeType NumFree() const { return _FreeNum(); }
+		SizeType NumBlocks() const { return m_Blocks.Num(); }
+
+		// release fully free blocks except KeepFreeBlocks of them, return released block count 
+		SizeType Trim(SizeType KeepFreeBlocks = 0) { return _Trim(KeepFreeBlocks); }
+
+		// trim to LowFreeBlocks free blocks when free nodes reach HighFreeBlocks blocks, 0 to disable 
+		void SetAutoTrim(SizeType HighFreeBlocks, SizeType LowFreeBlocks = 1)
+		{
+			check(HighFreeBlocks == 0 || HighFreeBlocks > LowFreeBlocks);
+			m_AutoTrimHigh = HighFreeBlocks;
+			m_AutoTrimLow = LowFreeBlocks;
+			m_NextAutoTrim = HighFreeBlocks * m_BlockSize;
+		}
+
 		T* Alloc() 
 		{ 
 			if (!m_FreeList) _AllocBlock();
+			++m_UsedNum;
 			return (T*)_PopFreeList();
 		}
-		void Free(T* Ptr) { _LinkToFreeList((Node*)Ptr); }
+		void Free(T* Ptr)
+		{
+			_LinkToFreeList((Node*)Ptr);
+			--m_UsedNum;
+			if (m_AutoTrimHigh && _FreeNum() >= m_NextAutoTrim) _AutoTrim();
+		}
+
+		// make sure at least Num nodes can be allocated without grow 
+		void ReserveFree(SizeType Num) { _ReserveFree(Num); }
+
+		// batch alloc and free, the free list is split or spliced once per batch 
+		void AllocN(T** Out, SizeType Num)
+		{
+			_ReserveFree(Num);
+			_PopN(Out, Num);
+		}
+		void FreeN(T** In, SizeType Num)
+		{
+			if (!Num) return;
+			_LinkChain(In, Num);
+			_SpliceChain((Node*)In[0], (Node*)In[Num - 1], Num);
+			if (m_AutoTrimHigh && _FreeNum() >= m_NextAutoTrim) _AutoTrim();
+		}
 		
 		template<typename...Ts>
 		T* New(Ts&&...Args)
@@ -115,8 +255,14 @@ namespace Fuko
 		TArray<Node*, TAlloc>	m_Blocks;
 		Node*					m_FreeList;
 		SizeType				m_BlockSize;
+		SizeType				m_UsedNum;
 		TLockPolicy				m_LockPolicy;
 
+		// auto trim, start when free nodes reach m_NextAutoTrim
+		SizeType				m_AutoTrimHigh;
+		SizeType				m_AutoTrimLow;
+		SizeType				m_NextAutoTrim;
+
 
 		//=================================Begin help function=================================
 		FORCEINLINE void _LinkToFreeList(Node* InNode)
@@ -130,6 +276,35 @@ namespace Fuko
 			m_FreeList = m_FreeList->Next;
 			return Ret;
 		}
+		FORCEINLINE void _ReserveFree(SizeType Num)
+		{
+			SizeType FreeNum = _FreeNum();
+			if (FreeNum < Num) _AllocBlock((Num - FreeNum + m_BlockSize - 1) / m_BlockSize);
+		}
+		FORCEINLINE void _PopN(T** Out, SizeType Num)
+		{
+			Node* It = m_FreeList;
+			for (SizeType i = 0; i < Num; ++i)
+			{
+				Out[i] = (T*)It;
+				It = It->Next;
+			}
+			m_FreeList = It;
+			m_UsedNum += Num;
+		}
+		FORCEINLINE void _LinkChain(T** In, SizeType Num)
+		{
+			for (SizeType i = 0; i + 1 < Num; ++i)
+			{
+				((Node*)In[i])->Next = (Node*)In[i + 1];
+			}
+		}
+		FORCEINLINE void _SpliceChain(Node* First, Node* Last, SizeType Num)
+		{
+			Last->Next = m_FreeList;
+			m_FreeList = First;
+			m_UsedNum -= Num;
+		}
 		FORCEINLINE void _AllocBlock(SizeType BlockNum = 1)
 		{
 			// alloc memory
@@ -144,6 +319,66 @@ namespace Fuko
 					++NewBlock;
 				}
 			}
+			m_NextAutoTrim = m_AutoTrimHigh * m_BlockSize;
+		}
+		FORCEINLINE SizeType _FreeNum() const { return m_Blocks.Num() * m_BlockSize - m_UsedNum; }
+		FORCEINLINE SizeType _BlockIndex(Node* InNode) const { return Algo::UpperBound(m_Blocks, InNode) - 1; }
+		SizeType _Trim(SizeType KeepFreeBlocks)
+		{
+			static constexpr SizeType ReleaseFlag = ~SizeType(0);
+			if (!m_FreeList) return 0;
+
+			// count free nodes per block, blocks are sorted by address for search
+			m_Blocks.Sort();
+			TArray<SizeType, TAlloc> FreeCount(SizeType(0), m_Blocks.Num(), m_Blocks.GetAllocator());
+			for (Node* It = m_FreeList; It; It = It->Next)
+			{
+				++FreeCount[_BlockIndex(It)];
+			}
+
+			// fully free blocks after the first KeepFreeBlocks are released
+			SizeType ReleaseNum = 0;
+			for (SizeType i = 0; i < m_Blocks.Num(); ++i)
+			{
+				if (FreeCount[i] != m_BlockSize) continue;
+				if (KeepFreeBlocks)
+				{
+					--KeepFreeBlocks;
+					continue;
+				}
+				FreeCount[i] = ReleaseFlag;
+				++ReleaseNum;
+			}
+			if (!ReleaseNum) return 0;
+
+			// unlink nodes of released blocks
+			Node** Link = &m_FreeList;
+			for (Node* It = m_FreeList; It; It = It->Next)
+			{
+				if (FreeCount[_BlockIndex(It)] == ReleaseFlag) continue;
+				*Link = It;
+				Link = &It->Next;
+			}
+			*Link = nullptr;
+
+			// free blocks, keep the rest sorted
+			SizeType WriteIndex = 0;
+			for (SizeType i = 0; i < m_Blocks.Num(); ++i)
+			{
+				if (FreeCount[i] == ReleaseFlag)
+					m_Blocks.GetAllocator().template Free<Node>(m_Blocks[i]);
+				else
+					m_Blocks[WriteIndex++] = m_Blocks[i];
+			}
+			m_Blocks.SetNum(WriteIndex, false);
+			return ReleaseNum;
+		}
+		FORCENOINLINE void _AutoTrim()
+		{
+			_Trim(m_AutoTrimLow);
+
+			// hysteresis, wait for another (high - low) blocks of free nodes even if nothing released
+			m_NextAutoTrim = Math::Max(m_AutoTrimHigh * m_BlockSize, _FreeNum() + (m_AutoTrimHigh - m_AutoTrimLow) * m_BlockSize);
 		}
 		//==================================End help function==================================
 	public:
@@ -151,6 +386,10 @@ namespace Fuko
 			: m_Blocks(InitBlockNum > 4 ? InitBlockNum : 4, InAlloc)
 			, m_FreeList(nullptr)
 			, m_BlockSize(BlockSize)
+			, m_UsedNum(0)
+			, m_AutoTrimHigh(0)
+			, m_AutoTrimLow(0)
+			, m_NextAutoTrim(0)
 		{
 			_AllocBlock(InitBlockNum);
 		}
@@ -164,12 +403,35 @@ namespace Fuko
 
 		bool IsInPool(void* Memory)
 		{
-			for (T* Ptr : m_Blocks)
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			for (Node* Ptr : m_Blocks)
 			{
 				if (Memory >= Ptr && Memory < (Ptr + m_BlockSize)) return true;
 			}
 			return false;
 		}
+
+		// occupancy 
+		SizeType NumUsed() const { return m_UsedNum; }
+		SizeType NumBlocks() const { return m_Blocks.Num(); }
+
+		// release fully free blocks except KeepFreeBlocks of them, return released block count 
+		SizeType Trim(SizeType KeepFreeBlocks = 0)
+		{
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			return _Trim(KeepFreeBlocks);
+		}
+
+		// trim to LowFreeBlocks free blocks when free nodes reach HighFreeBlocks blocks, 0 to disable 
+		void SetAutoTrim(SizeType HighFreeBlocks, SizeType LowFreeBlocks = 1)
+		{
+			check(HighFreeBlocks == 0 || HighFreeBlocks > LowFreeBlocks);
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			m_AutoTrimHigh = HighFreeBlocks;
+			m_AutoTrimLow = LowFreeBlocks;
+			m_NextAutoTrim = HighFreeBlocks * m_BlockSize;
+		}
+
 		void ValidateData()
 		{
 			Node* CurHead = m_FreeList;
@@ -200,23 +462,50 @@ namespace Fuko
 				LastHead = CurHead;
 				CurHead = CurHead->Next;
 			}
-			check(Count == FullElementNum);
+			check(Count == FullElementNum - m_UsedNum);
 			for (int i = 0; i < FullElementNum; ++i)
 			{
-				check(BlockFlagArr[i] == 1);
+				check(BlockFlagArr[i] <= 1);
 			}
+			delete[] BlockFlagArr;
 		}
 
 		T* Alloc()
 		{
 			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
 			if (!m_FreeList) _AllocBlock();
+			++m_UsedNum;
 			return (T*)_PopFreeList();
 		}
 		void Free(T* Ptr)
 		{
 			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
 			_LinkToFreeList((Node*)Ptr);
+			--m_UsedNum;
+			if (m_AutoTrimHigh && _FreeNum() >= m_NextAutoTrim) _AutoTrim();
+		}
+
+		// make sure at least Num nodes can be allocated without grow 
+		void ReserveFree(SizeType Num)
+		{
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			_ReserveFree(Num);
+		}
+
+		// batch alloc and free, take the lock once per batch, nodes are linked outside the lock for free 
+		void AllocN(T** Out, SizeType Num)
+		{
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			_ReserveFree(Num);
+			_PopN(Out, Num);
+		}
+		void FreeN(T** In, SizeType Num)
+		{
+			if (!Num) return;
+			_LinkChain(In, Num);
+			std::lock_guard<TLockPolicy>	Lck(m_LockPolicy);
+			_SpliceChain((Node*)In[0], (Node*)In[Num - 1], Num);
+			if (m_AutoTrimHigh && _FreeNum() >= m_NextAutoTrim) _AutoTrim();
 		}
 
 		template<typename...Ts>
@@ -236,6 +525,8 @@ namespace Fuko
 // TPool Lockfree
 namespace Fuko
 {
+	// treiber stack, head packs a 48-bit node pointer and a 16-bit tag bumped by every change, so a stale CAS fails (ABA)
+	// a thread has to sleep through 65536 changes that bring back the same head to break it
 	template<typename T, typename TAlloc>
 	class TPool<T, LockFree, TAlloc> final
 	{
@@ -247,44 +538,117 @@ namespace Fuko
 			std::atomic<Node*>	Next;		// when we use free list, we use linked list  
 		};
 		static constexpr SizeType NodeSize = sizeof(Node);
+		static constexpr uint32 TagShift = 48;
+		static constexpr uint64 PtrMask = (uint64(1) << TagShift) - 1;
+
+		// blocks live until the pool dies, so IsInPool walk this chain without the lock 
+		struct BlockLink
+		{
+			Node*		Block;
+			SizeType	Size;
+			BlockLink*	Next;
+		};
 
 		TArray<Node*, TAlloc>	m_Blocks;
-		std::atomic<Node*>		m_Head;
-		std::atomic<Node*>		m_Tail;
+		std::atomic<BlockLink*>	m_BlockChain;
+		std::atomic<uint64>		m_Head;
 		std::mutex				m_AllocMtx;
 		SizeType				m_BlockSize;
 
 		//=================================Begin help function=================================
-		FORCEINLINE void _AllocBlock(SizeType BlockNum = 1)
+		static FORCEINLINE Node* _Ptr(uint64 Tagged) { return (Node*)(Tagged & PtrMask); }
+		static FORCEINLINE uint64 _Pack(Node* Ptr, uint64 OldTagged) { return (uint64)Ptr | (((OldTagged >> TagShift) + 1) << TagShift); }
+
+		// push a linked chain with one CAS 
+		FORCEINLINE void _PushChain(Node* First, Node* Last)
 		{
-			// alloc memory
-			for (int i = 0; i < BlockNum; ++i)
+			uint64 OldHead = m_Head.load(std::memory_order_relaxed);
+			do
+			{
+				Last->Next.store(_Ptr(OldHead), std::memory_order_relaxed);
+			} while (!m_Head.compare_exchange_weak(OldHead, _Pack(First, OldHead), std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// pop up to Num nodes with one CAS, node links may be overwritten by the owner while we walk, the tag check drops such a walk 
+		FORCEINLINE Node* _PopChain(SizeType Num, SizeType& OutNum)
+		{
+			uint64 OldHead = m_Head.load(std::memory_order_acquire);
+			while (Node* First = _Ptr(OldHead))
+			{
+				Node* Last = First;
+				SizeType Count = 1;
+				Node* Next = Last->Next.load(std::memory_order_relaxed);
+				while (Count < Num && Next)
+				{
+					// unchanged head means the link we read is real, check before follow it
+					uint64 CurHead = m_Head.load(std::memory_order_acquire);
+					if (CurHead != OldHead)
+					{
+						OldHead = CurHead;
+						goto Retry;
+					}
+					Last = Next;
+					Next = Last->Next.load(std::memory_order_relaxed);
+					++Count;
+				}
+				if (m_Head.compare_exchange_weak(OldHead, _Pack(Next, OldHead), std::memory_order_acquire, std::memory_order_acquire))
+				{
+					Last->Next.store(nullptr, std::memory_order_relaxed);
+					OutNum = Count;
+					return First;
+				}
+			Retry:;
+			}
+			OutNum = 0;
+			return nullptr;
+		}
+
+		// m_AllocMtx must be held, blocks are linked into one chain and pushed with one CAS 
+		void _AllocBlock(SizeType BlockNum = 1)
+		{
+			Node* First = nullptr;
+			Node* Last = nullptr;
+			for (SizeType Block = 0; Block < BlockNum; ++Block)
 			{
 				Node* NewBlock = nullptr;
 				m_BlockSize = m_Blocks.GetAllocator().Reserve(NewBlock, m_BlockSize);
+				always_check(((uint64)NewBlock & ~PtrMask) == 0);
 				m_Blocks.Add(NewBlock);
-				for (int j = 0; j < m_BlockSize; ++j)
+
+				// publish the block before its nodes can be handed out 
+				BlockLink* Link = nullptr;
+				m_Blocks.GetAllocator().Reserve(Link, 1);
+				Link->Block = NewBlock;
+				Link->Size = m_BlockSize;
+				Link->Next = m_BlockChain.load(std::memory_order_relaxed);
+				m_BlockChain.store(Link, std::memory_order_release);
+
+				for (SizeType i = 0; i + 1 < m_BlockSize; ++i)
 				{
-					// Link to free list 
-					Node* CurTail = m_Tail.load();
-					NewBlock->Next.store(nullptr);
-					while (!m_Tail.compare_exchange_strong(CurTail, NewBlock));
-					if (CurTail) CurTail->Next.store(NewBlock);
-					if (m_Head.load() == nullptr) m_Head.store(NewBlock);
-					++NewBlock;
+					NewBlock[i].Next.store(NewBlock + i + 1, std::memory_order_relaxed);
 				}
+				NewBlock[m_BlockSize - 1].Next.store(First, std::memory_order_relaxed);
+				if (!Last) Last = NewBlock + m_BlockSize - 1;
+				First = NewBlock;
 			}
+			if (First) _PushChain(First, Last);
+		}
+
+		// only one thread grows at once, others find the new nodes after wait
+		FORCENOINLINE void _Grow()
+		{
+			std::lock_guard<std::mutex> Lck(m_AllocMtx);
+			if (!_Ptr(m_Head.load(std::memory_order_acquire))) _AllocBlock();
 		}
 		//==================================End help function==================================
 	public:
-		SizeType Count = 0;
 		TPool(SizeType BlockSize, SizeType InitBlockNum = 1, const TAlloc& InAlloc = TAlloc())
 			: m_Blocks(InitBlockNum > 4 ? InitBlockNum : 4, InAlloc)
-			, m_Head(nullptr)
-			, m_Tail(nullptr)
+			, m_BlockChain(nullptr)
+			, m_Head(0)
 			, m_BlockSize(BlockSize)
 		{
-			auto Lck = std::lock_guard(m_AllocMtx);
+			std::lock_guard<std::mutex> Lck(m_AllocMtx);
 			_AllocBlock(InitBlockNum);
 		}
 		~TPool()
@@ -293,29 +657,33 @@ namespace Fuko
 			{
 				m_Blocks.GetAllocator().Free<Node>(Ptr);
 			}
+			for (BlockLink* Link = m_BlockChain.load(); Link;)
+			{
+				BlockLink* Next = Link->Next;
+				m_Blocks.GetAllocator().template Free<BlockLink>(Link);
+				Link = Next;
+			}
 		}
 
-		bool IsInPool(void* Memory)
+		bool IsInPool(void* Memory) const
 		{
-			for (Node* Ptr : m_Blocks)
+			for (BlockLink* Link = m_BlockChain.load(std::memory_order_acquire); Link; Link = Link->Next)
 			{
-				if (Memory >= Ptr && Memory < (Ptr + m_BlockSize)) return true;
+				if (Memory >= Link->Block && Memory < (Link->Block + Link->Size)) return true;
 			}
 			return false;
 		}
+
+		// must be called while no other thread use the pool 
 		void ValidateData()
 		{
-			Node* CurHead = m_Head.load();
-			Node* CurTail = m_Tail.load();
-			Node* LastHead;
-
 			SizeType FullElementNum = m_Blocks.Num() * m_BlockSize;
 			SizeType Count = 0;
 
 			char* BlockFlagArr = new char[FullElementNum];
 			Memzero(BlockFlagArr, FullElementNum);
 
-			while (CurHead)
+			for (Node* CurHead = _Ptr(m_Head.load()); CurHead; CurHead = CurHead->Next.load())
 			{
 				bool found = false;
 				for (int i = 0; i < m_Blocks.Num(); ++i)
@@ -329,74 +697,81 @@ namespace Fuko
 					}
 				}
 				check(found);
-
 				++Count;
-				LastHead = CurHead;
-				CurHead = CurHead->Next.load();
 			}
-			check(LastHead == CurTail);
 			check(Count == FullElementNum);
 			for (int i = 0; i < FullElementNum; ++i)
 			{
 				check(BlockFlagArr[i] == 1);
 			}
+			delete[] BlockFlagArr;
 		}
 
 		T* Alloc()
 		{
-			Node* CurHead = m_Head.load();
-			Node* CurTail = m_Tail.load();
-			
-			// need alloc new block  
-		TRY_ALLOC:
-			if (!CurHead || !CurTail || CurHead == CurTail)
+			uint64 OldHead = m_Head.load(std::memory_order_acquire);
+			while (true)
 			{
-				std::lock_guard<std::mutex> Lck(m_AllocMtx);
-				CurHead = m_Head.load();
-				CurTail = m_Tail.load();
-				// check again, we only alloc once
-				if (!CurHead || !CurTail || CurHead == CurTail)
+				Node* CurHead = _Ptr(OldHead);
+				if (!CurHead)
+				{
+					_Grow();
+					OldHead = m_Head.load(std::memory_order_acquire);
+					continue;
+				}
+				Node* NewHead = CurHead->Next.load(std::memory_order_relaxed);
+				if (m_Head.compare_exchange_weak(OldHead, _Pack(NewHead, OldHead), std::memory_order_acquire, std::memory_order_acquire))
 				{
-					_AllocBlock();
-					CurHead = m_Head.load();
-					CurTail = m_Tail.load();
+					return (T*)CurHead;
 				}
 			}
+		}
+		void Free(T* Ptr)
+		{
+			check(IsInPool(Ptr));
+			Node* NewHead = (Node*)Ptr;
+			_PushChain(NewHead, NewHead);
+		}
 
-			// now pop 
-			Node* NewHead;
-			SizeType LoopCount;
-			// wait link write
-			do
-			{
-				NewHead = CurHead->Next.load();
-				if (!NewHead) ++Count;
-			} while (NewHead == nullptr);
-			// get a head element 
-			while (!m_Head.compare_exchange_strong(CurHead, NewHead))
+		// free nodes are not counted here, so this always adds blocks that hold at least Num nodes 
+		void ReserveFree(SizeType Num)
+		{
+			if (!Num) return;
+			std::lock_guard<std::mutex> Lck(m_AllocMtx);
+			_AllocBlock((Num + m_BlockSize - 1) / m_BlockSize);
+		}
+
+		// batch alloc, one CAS per run of the free list 
+		void AllocN(T** Out, SizeType Num)
+		{
+			while (Num)
 			{
-				CurTail = m_Tail.load();
-				if (CurHead == CurTail) goto TRY_ALLOC;
-				do
+				SizeType GotNum;
+				Node* Chain = _PopChain(Num, GotNum);
+				if (!Chain)
+				{
+					_Grow();
+					continue;
+				}
+				for (; Chain; Chain = Chain->Next.load(std::memory_order_relaxed))
 				{
-					NewHead = CurHead->Next.load();
-					if (!NewHead) ++Count;
-				} while (NewHead == nullptr);
+					*Out++ = (T*)Chain;
+				}
+				Num -= GotNum;
 			}
-			// now pop and break link 
-			CurHead->Next.store(nullptr);
-			return (T*)CurHead;
 		}
-		void Free(T* Ptr)
+
+		// batch free, link nodes first and push them with one CAS 
+		void FreeN(T** In, SizeType Num)
 		{
-			check(IsInPool(Ptr));
-			Node* CurTail = m_Tail.load();
-			Node* NewTail = (Node*)Ptr;
-			
-			NewTail->Next.store(nullptr);
-			while (!m_Tail.compare_exchange_strong(CurTail, NewTail));
-			check(CurTail->Next.load() == nullptr);
-			CurTail->Next.store(NewTail);
+			if (!Num) return;
+			// one membership check per batch, a check per node would cost more than the push 
+			check(IsInPool(In[0]) && IsInPool(In[Num - 1]));
+			for (SizeType i = 0; i + 1 < Num; ++i)
+			{
+				((Node*)In[i])->Next.store((Node*)In[i + 1], std::memory_order_relaxed);
+			}
+			_PushChain((Node*)In[0], (Node*)In[Num - 1]);
 		}
 
 		template<typename...Ts>
@@ -411,4 +786,4 @@ namespace Fuko
 			Free(Ptr);
 		}
 	};
-}
\ No newline at end of file
+}
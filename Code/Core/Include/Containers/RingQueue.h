@@ -2,12 +2,49 @@
 #include <CoreType.h>
 #include <CoreConfig.h>
 #include <mutex>
+#include <Algo/Rotate.h>
+#include <Math/MathUtility.h>
 #include "Allocator.h"
 #include "LockPolicy.h"
 #include "ContainerFwd.h"
 
+// ring span
+namespace Fuko
+{
+	// contiguous run of ring storage 
+	template<typename T>
+	struct TRingSpan
+	{
+		T*		Data = nullptr;
+		uint32	Num = 0;
+
+		FORCEINLINE T* begin() const { return Data; }
+		FORCEINLINE T* end() const { return Data + Num; }
+		FORCEINLINE bool IsEmpty() const { return Num == 0; }
+	};
+
+	// elements seen from head, Second is only used when they wrap around the end of storage 
+	template<typename T>
+	struct TRingSpans
+	{
+		TRingSpan<T>	First;
+		TRingSpan<T>	Second;
 
-// no lock ring queue 
+		FORCEINLINE uint32 Num() const { return First.Num + Second.Num; }
+		FORCEINLINE bool IsEmpty() const { return First.Num == 0; }
+	};
+
+	// split [Index, Index + Count) of a power of two ring into two runs 
+	template<typename T, typename SizeType>
+	FORCEINLINE TRingSpans<T> SplitRing(T* Data, SizeType Mask, SizeType Index, SizeType Count)
+	{
+		const SizeType Start = Index & Mask;
+		const SizeType FirstNum = Math::Min<SizeType>(Count, Mask + 1 - Start);
+		return { { Data + Start, FirstNum }, { Data, Count - FirstNum } };
+	}
+}
+
+// no lock ring queue, capacity is power of two and index by mask 
 namespace Fuko
 {
 	template<typename T, typename Alloc>
@@ -15,8 +52,9 @@ namespace Fuko
 	{
 	protected:
 		using SizeType = typename Alloc::USizeType;
+		using AllocType = typename TElementAlloc<Alloc, T>::Type;
 
-		Alloc		m_Allocator;
+		AllocType	m_Allocator;
 		T*			m_Data;
 		SizeType	m_Max;
 		SizeType	m_Head;
@@ -25,7 +63,24 @@ namespace Fuko
 		//-----------------------------------Begin help function-----------------------------------
 		FORCENOINLINE void _ResizeTo(SizeType Number)
 		{
-			if (m_Max != Number) m_Max = m_Allocator.Reserve(m_Data, Number);
+			// slack of the block past the power of two is not used 
+			if (Number) Number = Math::RoundUpToPowerOfTwo(Number);
+			if (m_Max != Number)
+			{
+				SizeType NewMax = m_Allocator.Reserve(m_Data, Number);
+				m_Max = NewMax ? 1u << Math::FloorLog2(NewMax) : 0;
+			}
+		}
+		FORCEINLINE TRingSpans<T> _Split(SizeType Index, SizeType Count) const { return SplitRing(m_Data, m_Max - 1, Index, Count); }
+		FORCEINLINE void _DestructRange()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				TRingSpans<T> Spans = _Split(m_Head, Num());
+				DestructItems(Spans.First.Data, Spans.First.Num);
+				DestructItems(Spans.Second.Data, Spans.Second.Num);
+			}
+			m_Head = m_Tail;
 		}
 		//------------------------------------End help function------------------------------------
 	public:
@@ -72,22 +127,42 @@ namespace Fuko
 		// assign
 		TRingQueue& operator=(const TRingQueue& Other)
 		{
-			Reset(Other.Max());
-			ConstructItems(m_Data, Other.m_Data, Other.Max());
-			m_Max = Other.Max();
-			m_Head = Other.m_Head;
-			m_Tail = Other.m_Tail;
+			if (this == &Other) return *this;
+			Reset(Other.Num());
+			for (SizeType i = Other.m_Head; i != Other.m_Tail; ++i)
+			{
+				new (m_Data + (m_Tail & (m_Max - 1))) T(Other.m_Data[i & (Other.m_Max - 1)]);
+				++m_Tail;
+			}
 			return *this;
 		}
 
 		// move assign
 		TRingQueue& operator=(TRingQueue&& Other)
 		{
+			if (this == &Other) return *this;
+
 			// clear queue 
-			Empty();
+			Reset();
+			if (m_Data) m_Max = m_Allocator.Free(m_Data);
+			m_Allocator = Other.m_Allocator;
+
+			// elements in other's inline storage can't be stolen, relocate them
+			if constexpr (THasInlineStorage<AllocType>::Value)
+			{
+				if (Other.m_Allocator.IsInline(Other.m_Data))
+				{
+					Other.Normalize();
+					_ResizeTo(Other.Num());
+					RelocateConstructItems<T>(m_Data, Other.m_Data, Other.Num());
+					m_Tail = Other.Num();
+					Other.m_Max = Other.m_Allocator.Free(Other.m_Data);
+					Other.m_Head = Other.m_Tail = 0;
+					return *this;
+				}
+			}
 
 			// copy 
-			m_Allocator = Other.m_Allocator;
 			m_Data = Other.m_Data;
 			m_Max = Other.m_Max;
 			m_Head = Other.m_Head;
@@ -102,11 +177,7 @@ namespace Fuko
 		// destruct
 		~TRingQueue() 
 		{
-			while (m_Tail > m_Head)
-			{
-				DestructItems(&m_Data[m_Head % m_Max]);
-				++m_Head;
-			}
+			if (m_Data) _DestructRange();
 			m_Allocator.Free(m_Data);
 			m_Max = m_Head = m_Tail = 0;
 		}
@@ -118,8 +189,8 @@ namespace Fuko
 		FORCEINLINE SizeType Max() const { return m_Max; }
 		FORCEINLINE SizeType Slack() const { return m_Max - Num(); }
 		FORCEINLINE bool IsEmpty() const { return m_Tail == m_Head; }
-		FORCEINLINE const Alloc& GetAllocator() const { return m_Allocator; }
-		FORCEINLINE Alloc& GetAllocator() { return m_Allocator; }
+		FORCEINLINE const AllocType& GetAllocator() const { return m_Allocator; }
+		FORCEINLINE AllocType& GetAllocator() { return m_Allocator; }
 
 		// reserve 
 		FORCEINLINE void Reserve(SizeType Number)
@@ -132,21 +203,13 @@ namespace Fuko
 		}
 		FORCEINLINE void Empty(SizeType InSlack = 0)
 		{
-			while (m_Tail > m_Head)
-			{
-				DestructItems(&m_Data[m_Head % m_Max]);
-				++m_Head;
-			}
+			if (m_Data) _DestructRange();
 			m_Tail = m_Head = 0;
 			_ResizeTo(InSlack);
 		}
 		FORCEINLINE void Reset(SizeType NewSize = 0)
 		{
-			while (m_Tail > m_Head)
-			{
-				DestructItems(&m_Data[m_Head % m_Max]);
-				++m_Head;
-			}
+			if (m_Data) _DestructRange();
 			m_Tail = m_Head = 0;
 			Reserve(NewSize);
 		}
@@ -155,8 +218,8 @@ namespace Fuko
 		FORCEINLINE void Normalize()
 		{
 			if (!m_Max) return;
-			const SizeType HeadIndex = m_Head % m_Max;
-			const SizeType TailIndex = m_Tail % m_Max;
+			const SizeType HeadIndex = m_Head & (m_Max - 1);
+			const SizeType TailIndex = m_Tail & (m_Max - 1);
 
 			// normalized or empty 
 			if (HeadIndex == 0 || m_Head == m_Tail)
@@ -169,13 +232,13 @@ namespace Fuko
 			// normalize
 			if (HeadIndex >= TailIndex)
 			{
-				Algo::Rotate(m_Data, m_Max, HeadIndex);
+				Algo::Rotate(m_Data, m_Max, m_Max - HeadIndex);
 				m_Tail -= m_Head;
 				m_Head = 0;
 			}
 			else
 			{
-				Memmove(m_Data, m_Data + TailIndex, Num() * sizeof(T));
+				Memmove(m_Data, m_Data + HeadIndex, Num() * sizeof(T));
 				m_Tail -= m_Head;
 				m_Head = 0;
 			}
@@ -197,7 +260,7 @@ namespace Fuko
 			// add element 
 			auto LastTail = m_Tail;
 			++m_Tail;
-			return new(GetData() + LastTail % m_Max) T(std::forward<Ts>(Args)...);
+			return new(GetData() + (LastTail & (m_Max - 1))) T(std::forward<Ts>(Args)...);
 		}
 		FORCEINLINE bool Dequeue()
 		{
@@ -212,13 +275,60 @@ namespace Fuko
 			T* CurHead = Head();
 			if (!CurHead) return false;
 			OutElement = std::move(*CurHead);
+			DestructItems(CurHead);
 			++m_Head;
 			return true;
 		}
 
+		// batch enqueue, grow once and copy in at most two runs 
+		void EnqueueRange(const T* InData, SizeType Count)
+		{
+			if (!Count) return;
+			const SizeType CurNum = Num();
+			if (CurNum + Count > m_Max) Reserve(m_Allocator.GetGrow(CurNum + Count, m_Max));
+			TRingSpans<T> Spans = _Split(m_Tail, Count);
+			ConstructItems<T>(Spans.First.Data, InData, Spans.First.Num);
+			ConstructItems<T>(Spans.Second.Data, InData + Spans.First.Num, Spans.Second.Num);
+			m_Tail += Count;
+		}
+		FORCEINLINE void EnqueueRange(std::initializer_list<T> InitList) { EnqueueRange(InitList.begin(), (SizeType)InitList.size()); }
+
+		// batch dequeue, move up to MaxCount elements to Out, return the count 
+		SizeType DequeueRange(T* Out, SizeType MaxCount)
+		{
+			const SizeType Count = Math::Min(MaxCount, Num());
+			if (!Count) return 0;
+			TRingSpans<T> Spans = _Split(m_Head, Count);
+			MoveAssignItems(Out, Spans.First.Data, Spans.First.Num);
+			MoveAssignItems(Out + Spans.First.Num, Spans.Second.Data, Spans.Second.Num);
+			DestructItems(Spans.First.Data, Spans.First.Num);
+			DestructItems(Spans.Second.Data, Spans.Second.Num);
+			m_Head += Count;
+			return Count;
+		}
+		// drop up to Count elements from head, usually the ones just processed through PeekContiguous
+		SizeType DequeueRange(SizeType Count)
+		{
+			Count = Math::Min(Count, Num());
+			if (!Count) return 0;
+			TRingSpans<T> Spans = _Split(m_Head, Count);
+			DestructItems(Spans.First.Data, Spans.First.Num);
+			DestructItems(Spans.Second.Data, Spans.Second.Num);
+			m_Head += Count;
+			return Count;
+		}
+
+		// all elements in place, from head to tail 
+		FORCEINLINE TRingSpans<T> PeekContiguous() { return m_Data ? _Split(m_Head, Num()) : TRingSpans<T>(); }
+		FORCEINLINE TRingSpans<const T> PeekContiguous() const
+		{
+			TRingSpans<T> Spans = const_cast<TRingQueue*>(this)->PeekContiguous();
+			return { { Spans.First.Data, Spans.First.Num }, { Spans.Second.Data, Spans.Second.Num } };
+		}
+
 		// access 
-		FORCEINLINE T* Tail() { return m_Data ? m_Tail >= m_Head ? &m_Data[(m_Tail - 1) % m_Max] : nullptr : nullptr; }
-		FORCEINLINE T* Head() { return m_Data ? m_Tail >= m_Head ? &m_Data[m_Head % m_Max] : nullptr : nullptr; }
+		FORCEINLINE T* Tail() { return m_Data ? m_Tail > m_Head ? &m_Data[(m_Tail - 1) & (m_Max - 1)] : nullptr : nullptr; }
+		FORCEINLINE T* Head() { return m_Data ? m_Tail > m_Head ? &m_Data[m_Head & (m_Max - 1)] : nullptr : nullptr; }
 		FORCEINLINE const T* Tail() const { return const_cast<TRingQueue*>(this)->Tail(); }
 		FORCEINLINE const T* Head() const { return const_cast<TRingQueue*>(this)->Head(); }
 	};
@@ -247,13 +357,18 @@ namespace Fuko
 		//-----------------------------------Begin help function-----------------------------------
 		FORCENOINLINE void _ResizeTo(SizeType Number)
 		{
-			if (m_Max != Number) m_Max = m_Allocator.Reserve(m_Data, Number);
+			// index by mask, slack of the block is not used 
+			if (m_Max != Number)
+			{
+				m_Allocator.Reserve(m_Data, Number);
+				m_Max = Number;
+			}
 		}
 		FORCEINLINE void _Normalize()
 		{
 			if (!m_Max) return;
-			const SizeType HeadIndex = m_Head % m_Max;
-			const SizeType TailIndex = m_Tail % m_Max;
+			const SizeType HeadIndex = m_Head & (m_Max - 1);
+			const SizeType TailIndex = m_Tail & (m_Max - 1);
 
 			// normalized or empty 
 			if (HeadIndex == 0 || m_Head == m_Tail)
@@ -266,17 +381,52 @@ namespace Fuko
 			// normalize
 			if (HeadIndex >= TailIndex)
 			{
-				Algo::Rotate(m_Data, m_Max, HeadIndex);
+				Algo::Rotate(m_Data, m_Max, m_Max - HeadIndex);
 				m_Tail -= m_Head;
 				m_Head = 0;
 			}
 			else
 			{
-				Memmove(m_Data, m_Data + TailIndex, Num() * sizeof(T));
+				Memmove(m_Data, m_Data + HeadIndex, Num() * sizeof(T));
 				m_Tail -= m_Head;
 				m_Head = 0;
 			}
 		}
+		FORCEINLINE void _DestructRange()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				TRingSpans<T> Spans = SplitRing(m_Data, m_Max - 1, m_Head.load(), Num());
+				DestructItems(Spans.First.Data, Spans.First.Num);
+				DestructItems(Spans.Second.Data, Spans.Second.Num);
+			}
+			m_Head = m_Tail.load();
+		}
+		// copy in or move out as many elements as the ring allow, caller hold the lock 
+		FORCEINLINE SizeType _EnqueueRange(const T* InData, SizeType Count)
+		{
+			const SizeType Tail = m_Tail;
+			Count = Math::Min(Count, m_Max - (Tail - m_Head));
+			if (!Count) return 0;
+			TRingSpans<T> Spans = SplitRing(m_Data, m_Max - 1, Tail, Count);
+			ConstructItems<T>(Spans.First.Data, InData, Spans.First.Num);
+			ConstructItems<T>(Spans.Second.Data, InData + Spans.First.Num, Spans.Second.Num);
+			m_Tail = Tail + Count;
+			return Count;
+		}
+		FORCEINLINE SizeType _DequeueRange(T* Out, SizeType Count)
+		{
+			const SizeType Head = m_Head;
+			Count = Math::Min(Count, m_Tail - Head);
+			if (!Count) return 0;
+			TRingSpans<T> Spans = SplitRing(m_Data, m_Max - 1, Head, Count);
+			MoveAssignItems(Out, Spans.First.Data, Spans.First.Num);
+			MoveAssignItems(Out + Spans.First.Num, Spans.Second.Data, Spans.Second.Num);
+			DestructItems(Spans.First.Data, Spans.First.Num);
+			DestructItems(Spans.Second.Data, Spans.Second.Num);
+			m_Head = Head + Count;
+			return Count;
+		}
 		//------------------------------------End help function------------------------------------
 	public:
 		// construct 
@@ -296,7 +446,14 @@ namespace Fuko
 		{ Reserve(InitSize); }
 
 		// destruct
-		~TRingQueue() { if (m_Data) m_Allocator.Free(m_Data); }
+		~TRingQueue()
+		{
+			if (m_Data)
+			{
+				_DestructRange();
+				m_Allocator.Free(m_Data);
+			}
+		}
 
 		// delete for protect data
 		TRingQueue(const TRingQueue& Other, const Alloc& InAlloc = Alloc()) = delete;
@@ -310,7 +467,7 @@ namespace Fuko
 		FORCEINLINE SizeType Max() const { return m_Max; }
 		FORCEINLINE SizeType Slack() const { return m_Max - Num(); }
 		FORCEINLINE bool IsEmpty() const { return Num() == 0; }
-		FORCEINLINE const Alloc& GetAllocator() const { m_Allocator; }
+		FORCEINLINE const Alloc& GetAllocator() const { return m_Allocator; }
 		FORCEINLINE Alloc& GetAllocator() { return m_Allocator; }
 
 		// reserve 
@@ -329,11 +486,7 @@ namespace Fuko
 		{
 			m_Lock.lock();
 			InSlack = Math::RoundUpToPowerOfTwo(InSlack);
-			while (m_Tail > m_Head)
-			{
-				DestructItems(&m_Data[m_Head % m_Max]);
-				++m_Head;
-			}
+			if (m_Data) _DestructRange();
 			m_Tail = m_Head = 0;
 			_ResizeTo(InSlack);
 			m_Lock.unlock();
@@ -342,13 +495,9 @@ namespace Fuko
 		{
 			m_Lock.lock();
 			NewSize = Math::RoundUpToPowerOfTwo(NewSize);
-			while (m_Tail > m_Head)
-			{
-				DestructItems(&m_Data[m_Head % m_Max]);
-				++m_Head;
-			}
+			if (m_Data) _DestructRange();
 			m_Tail = m_Head = 0;
-			Reserve(NewSize);
+			if (NewSize > m_Max) _ResizeTo(NewSize);
 			m_Lock.unlock();
 		}
 
@@ -395,7 +544,7 @@ namespace Fuko
 		FORCEINLINE void Dequeue()
 		{
 		Wait:
-			SizeType GottenHead
+			SizeType GottenHead;
 			// wait for any thread enqueue
 			while (Num() == 0) std::this_thread::yield();
 			// lock for dequeue 
@@ -423,6 +572,7 @@ namespace Fuko
 				SizeType GottenHead = m_Head;
 				++m_Head;
 				OutElement = std::move(m_Data[GottenHead & (m_Max - 1)]);
+				m_Data[GottenHead & (m_Max - 1)].~T();
 			}
 		}
 		// unblock enqueue 
@@ -445,8 +595,412 @@ namespace Fuko
 			// now dequeue
 			SizeType GottenHead = m_Head;
 			++m_Head;
-			OutElement = std::move(m_Data[GottenHead & (m_Max - 1)])
+			OutElement = std::move(m_Data[GottenHead & (m_Max - 1)]);
+			m_Data[GottenHead & (m_Max - 1)].~T();
+			return true;
+		}
+
+		// batch enqueue, copy in as many as there is room for under one lock, return the count 
+		FORCEINLINE SizeType TryEnqueueRange(const T* InData, SizeType Count)
+		{
+			std::lock_guard<TLockPolicy> Lck(m_Lock);
+			return _EnqueueRange(InData, Count);
+		}
+		// block batch enqueue, one lock for each time room is found 
+		void EnqueueRange(const T* InData, SizeType Count)
+		{
+			while (Count)
+			{
+				// wait for any thread dequeue 
+				while (Num() >= m_Max) std::this_thread::yield();
+				const SizeType Done = TryEnqueueRange(InData, Count);
+				InData += Done;
+				Count -= Done;
+			}
+		}
+
+		// batch dequeue, move up to MaxCount elements to Out under one lock, return the count 
+		FORCEINLINE SizeType TryDequeueRange(T* Out, SizeType MaxCount)
+		{
+			std::lock_guard<TLockPolicy> Lck(m_Lock);
+			return _DequeueRange(Out, MaxCount);
+		}
+		// block batch dequeue, wait until Count elements are gotten 
+		void DequeueRange(T* Out, SizeType Count)
+		{
+			while (Count)
+			{
+				// wait for any thread enqueue
+				while (Num() == 0) std::this_thread::yield();
+				const SizeType Done = TryDequeueRange(Out, Count);
+				Out += Done;
+				Count -= Done;
+			}
+		}
+	};
+}
+
+// lock free ring queue, multi producer multi consumer
+namespace Fuko
+{
+	// bounded queue of Dmitry Vyukov, every cell keep a sequence number telling which lap of the ring may use it next
+	// a producer or consumer claim a position by one CAS, then wait free on its own cell, no thread ever block another
+	// capacity is fixed at construct, rounded up to power of two
+	template<typename T, typename Alloc>
+	class TRingQueue<T, LockFree, Alloc>
+	{
+		using SizeType = typename Alloc::USizeType;
+		using SignedSizeType = std::make_signed_t<SizeType>;
+
+		struct Cell
+		{
+			std::atomic<SizeType>	Sequence;
+			alignas(T) uint8		Storage[sizeof(T)];
+
+			FORCEINLINE T* Get() { return reinterpret_cast<T*>(Storage); }
+		};
+		using AllocType = typename TElementAlloc<Alloc, Cell>::Type;
+
+		// read only after construct, shared by all threads
+		AllocType	m_Allocator;
+		Cell*		m_Cells;
+		SizeType	m_Mask;
+
+		// producers and consumers each own a line
+		alignas(CacheLineSize) std::atomic<SizeType>	m_Tail;
+		alignas(CacheLineSize) std::atomic<SizeType>	m_Head;
+		uint8											m_Pad[CacheLineSize - sizeof(std::atomic<SizeType>)];
+	public:
+		// construct 
+		TRingQueue(SizeType InCapacity, const Alloc& InAlloc = Alloc())
+			: m_Allocator(InAlloc)
+			, m_Cells(nullptr)
+			, m_Mask(0)
+			, m_Tail(0)
+			, m_Head(0)
+		{
+			check(InCapacity > 0 && InCapacity <= ((SizeType)-1 >> 1));
+			const SizeType Capacity = (SizeType)Math::RoundUpToPowerOfTwo(InCapacity);
+			m_Allocator.Reserve(m_Cells, (typename Alloc::SizeType)Capacity);
+			for (SizeType i = 0; i < Capacity; ++i) new(&m_Cells[i].Sequence) std::atomic<SizeType>(i);
+			m_Mask = Capacity - 1;
+		}
+
+		// destruct, no other thread may use the queue 
+		~TRingQueue()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				while (TryDequeue()) {}
+			}
+			m_Allocator.Free(m_Cells);
+		}
+
+		// delete for protect data
+		TRingQueue(const TRingQueue&) = delete;
+		TRingQueue(TRingQueue&&) = delete;
+		TRingQueue& operator=(const TRingQueue&) = delete;
+		TRingQueue& operator=(TRingQueue&&) = delete;
+
+		// get information, Num is a snapshot, other threads may change it right after 
+		FORCEINLINE SizeType Num() const
+		{
+			const SizeType Head = m_Head.load(std::memory_order_relaxed);
+			const SizeType Tail = m_Tail.load(std::memory_order_relaxed);
+			return (SignedSizeType)(Tail - Head) > 0 ? Tail - Head : 0;
+		}
+		FORCEINLINE SizeType Max() const { return m_Mask + 1; }
+		FORCEINLINE bool IsEmpty() const { return Num() == 0; }
+
+		// unblock enqueue, false when full 
+		template<typename...Ts>
+		bool TryEnqueue(Ts&&...Args)
+		{
+			SizeType Pos = m_Tail.load(std::memory_order_relaxed);
+			Cell* Target;
+			for (;;)
+			{
+				Target = &m_Cells[Pos & m_Mask];
+				const SignedSizeType Diff = (SignedSizeType)(Target->Sequence.load(std::memory_order_acquire) - Pos);
+				if (Diff == 0)
+				{
+					// cell free on this lap, claim the position 
+					if (m_Tail.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (Diff < 0)
+				{
+					// cell still hold the element of last lap 
+					return false;
+				}
+				else
+				{
+					// another producer claimed it 
+					Pos = m_Tail.load(std::memory_order_relaxed);
+				}
+			}
+			new(Target->Get()) T(std::forward<Ts>(Args)...);
+			Target->Sequence.store(Pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// unblock dequeue, false when empty 
+		bool TryDequeue(T& OutElement)
+		{
+			return _TryDequeue([&](T& Element) { OutElement = std::move(Element); });
+		}
+		bool TryDequeue()
+		{
+			return _TryDequeue([](T&) {});
+		}
+
+		// block enqueue and dequeue, spin then yield until the queue let us in 
+		template<typename...Ts>
+		void Enqueue(Ts&&...Args)
+		{
+			for (uint32 Spin = 0; !TryEnqueue(std::forward<Ts>(Args)...); ++Spin)
+			{
+				if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+		void Dequeue(T& OutElement)
+		{
+			for (uint32 Spin = 0; !TryDequeue(OutElement); ++Spin)
+			{
+				if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+	private:
+		template<typename TFunc>
+		bool _TryDequeue(TFunc&& Func)
+		{
+			SizeType Pos = m_Head.load(std::memory_order_relaxed);
+			Cell* Target;
+			for (;;)
+			{
+				Target = &m_Cells[Pos & m_Mask];
+				const SignedSizeType Diff = (SignedSizeType)(Target->Sequence.load(std::memory_order_acquire) - (Pos + 1));
+				if (Diff == 0)
+				{
+					if (m_Head.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (Diff < 0)
+				{
+					// producer of this lap not done 
+					return false;
+				}
+				else
+				{
+					Pos = m_Head.load(std::memory_order_relaxed);
+				}
+			}
+			T* Element = Target->Get();
+			Func(*Element);
+			Element->~T();
+
+			// free the cell for next lap 
+			Target->Sequence.store(Pos + m_Mask + 1, std::memory_order_release);
+			return true;
+		}
+	};
+}
+
+// wait free ring queue, single producer single consumer
+namespace Fuko
+{
+	// only one thread enqueue and only one thread dequeue, each side own its index and keep a cached copy of the other one,
+	// so the shared line of the other side is only read when the cached copy say full or empty
+	// capacity is fixed at construct, rounded up to power of two
+	template<typename T, typename Alloc>
+	class TRingQueue<T, LockFreeSPSC, Alloc>
+	{
+		using SizeType = typename Alloc::USizeType;
+		using AllocType = typename TElementAlloc<Alloc, T>::Type;
+
+		// read only after construct 
+		AllocType	m_Allocator;
+		T*			m_Data;
+		SizeType	m_Mask;
+
+		// consumer line 
+		alignas(CacheLineSize) std::atomic<SizeType>	m_Head;
+		SizeType										m_CachedTail;
+
+		// producer line 
+		alignas(CacheLineSize) std::atomic<SizeType>	m_Tail;
+		SizeType										m_CachedHead;
+		uint8											m_Pad[CacheLineSize - sizeof(std::atomic<SizeType>) - sizeof(SizeType)];
+	public:
+		// construct 
+		TRingQueue(SizeType InCapacity, const Alloc& InAlloc = Alloc())
+			: m_Allocator(InAlloc)
+			, m_Data(nullptr)
+			, m_Mask(0)
+			, m_Head(0)
+			, m_CachedTail(0)
+			, m_Tail(0)
+			, m_CachedHead(0)
+		{
+			check(InCapacity > 0 && InCapacity <= ((SizeType)-1 >> 1));
+			const SizeType Capacity = (SizeType)Math::RoundUpToPowerOfTwo(InCapacity);
+			m_Allocator.Reserve(m_Data, (typename Alloc::SizeType)Capacity);
+			m_Mask = Capacity - 1;
+		}
+
+		// destruct, no other thread may use the queue 
+		~TRingQueue()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				while (TryDequeue()) {}
+			}
+			m_Allocator.Free(m_Data);
+		}
+
+		// delete for protect data
+		TRingQueue(const TRingQueue&) = delete;
+		TRingQueue(TRingQueue&&) = delete;
+		TRingQueue& operator=(const TRingQueue&) = delete;
+		TRingQueue& operator=(TRingQueue&&) = delete;
+
+		// get information, Num is a snapshot unless called from the producer or consumer 
+		FORCEINLINE SizeType Num() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+		FORCEINLINE SizeType Max() const { return m_Mask + 1; }
+		FORCEINLINE bool IsEmpty() const { return Num() == 0; }
+
+		// producer only, false when full 
+		template<typename...Ts>
+		FORCEINLINE bool TryEnqueue(Ts&&...Args)
+		{
+			const SizeType Tail = m_Tail.load(std::memory_order_relaxed);
+			if (Tail - m_CachedHead > m_Mask)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+				if (Tail - m_CachedHead > m_Mask) return false;
+			}
+			new(m_Data + (Tail & m_Mask)) T(std::forward<Ts>(Args)...);
+			m_Tail.store(Tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only, front element or nullptr when empty, valid until next dequeue 
+		FORCEINLINE T* Head()
+		{
+			const SizeType Head = m_Head.load(std::memory_order_relaxed);
+			if (Head == m_CachedTail)
+			{
+				m_CachedTail = m_Tail.load(std::memory_order_acquire);
+				if (Head == m_CachedTail) return nullptr;
+			}
+			return m_Data + (Head & m_Mask);
+		}
+
+		// consumer only, false when empty 
+		FORCEINLINE bool TryDequeue(T& OutElement)
+		{
+			T* Element = Head();
+			if (!Element) return false;
+			OutElement = std::move(*Element);
+			_Pop(Element);
 			return true;
 		}
+		FORCEINLINE bool TryDequeue()
+		{
+			T* Element = Head();
+			if (!Element) return false;
+			_Pop(Element);
+			return true;
+		}
+
+		// block enqueue and dequeue, spin then yield until the other side move 
+		template<typename...Ts>
+		void Enqueue(Ts&&...Args)
+		{
+			for (uint32 Spin = 0; !TryEnqueue(std::forward<Ts>(Args)...); ++Spin)
+			{
+				if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+		void Dequeue(T& OutElement)
+		{
+			for (uint32 Spin = 0; !TryDequeue(OutElement); ++Spin)
+			{
+				if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+
+		// producer only, copy in as many as there is room for, one release store publish the whole batch 
+		SizeType TryEnqueueRange(const T* InData, SizeType Count)
+		{
+			const SizeType Tail = m_Tail.load(std::memory_order_relaxed);
+			if (m_Mask + 1 - (Tail - m_CachedHead) < Count) m_CachedHead = m_Head.load(std::memory_order_acquire);
+			Count = Math::Min(Count, m_Mask + 1 - (Tail - m_CachedHead));
+			if (!Count) return 0;
+			TRingSpans<T> Spans = SplitRing(m_Data, m_Mask, Tail, Count);
+			ConstructItems<T>(Spans.First.Data, InData, Spans.First.Num);
+			ConstructItems<T>(Spans.Second.Data, InData + Spans.First.Num, Spans.Second.Num);
+			m_Tail.store(Tail + Count, std::memory_order_release);
+			return Count;
+		}
+		void EnqueueRange(const T* InData, SizeType Count)
+		{
+			for (uint32 Spin = 0; Count; ++Spin)
+			{
+				const SizeType Done = TryEnqueueRange(InData, Count);
+				InData += Done;
+				Count -= Done;
+				if (Done) Spin = 0; else if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+
+		// consumer only, move up to MaxCount elements to Out, return the count 
+		SizeType TryDequeueRange(T* Out, SizeType MaxCount)
+		{
+			const SizeType Head = m_Head.load(std::memory_order_relaxed);
+			if (m_CachedTail - Head < MaxCount) m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			const SizeType Count = Math::Min(MaxCount, m_CachedTail - Head);
+			if (!Count) return 0;
+			TRingSpans<T> Spans = SplitRing(m_Data, m_Mask, Head, Count);
+			MoveAssignItems(Out, Spans.First.Data, Spans.First.Num);
+			MoveAssignItems(Out + Spans.First.Num, Spans.Second.Data, Spans.Second.Num);
+			DestructItems(Spans.First.Data, Spans.First.Num);
+			DestructItems(Spans.Second.Data, Spans.Second.Num);
+			m_Head.store(Head + Count, std::memory_order_release);
+			return Count;
+		}
+		void DequeueRange(T* Out, SizeType Count)
+		{
+			for (uint32 Spin = 0; Count; ++Spin)
+			{
+				const SizeType Done = TryDequeueRange(Out, Count);
+				Out += Done;
+				Count -= Done;
+				if (Done) Spin = 0; else if (Spin < 64) CpuRelax(); else std::this_thread::yield();
+			}
+		}
+
+		// consumer only, every published element in place, hand them back by DequeueRange(Count) 
+		FORCEINLINE TRingSpans<T> PeekContiguous()
+		{
+			const SizeType Head = m_Head.load(std::memory_order_relaxed);
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			return SplitRing(m_Data, m_Mask, Head, m_CachedTail - Head);
+		}
+		SizeType DequeueRange(SizeType Count)
+		{
+			const SizeType Head = m_Head.load(std::memory_order_relaxed);
+			Count = Math::Min(Count, m_CachedTail - Head);
+			if (!Count) return 0;
+			TRingSpans<T> Spans = SplitRing(m_Data, m_Mask, Head, Count);
+			DestructItems(Spans.First.Data, Spans.First.Num);
+			DestructItems(Spans.Second.Data, Spans.Second.Num);
+			m_Head.store(Head + Count, std::memory_order_release);
+			return Count;
+		}
+	private:
+		FORCEINLINE void _Pop(T* Element)
+		{
+			Element->~T();
+			m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
 	};
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #include "CoreConfig.h"
 #include "CoreType.h"
 #include "Templates/TypeTraits.h"
+#include "Templates/TypeHash.h"
 #include "Misc/Assert.h"
 #include "SparseArray.h"
 #include <Memory/MemoryOps.h>
@@ -13,7 +14,7 @@
 // Key functions 
 namespace Fuko
 {
-	template<typename T, bool bInAllowDuplicateKeys>
+	template<typename T, bool bInAllowDuplicateKeys, typename HashPolicy>
 	struct DefaultKeyFuncs
 	{
 		using KeyType = T;
@@ -22,7 +23,7 @@ namespace Fuko
 		
 		static FORCEINLINE const KeyType& Key(const T& Element) { return Element; }
 		static FORCEINLINE bool Matches(const KeyType& A, const KeyType& B) { return A == B; }
-		static FORCEINLINE uint32 Hash(KeyType Key) { return GetTypeHash(Key); }
+		static FORCEINLINE uint32 Hash(KeyType Key) { return HashPolicy::Hash(Key); }
 	};
 }
 
@@ -103,8 +104,8 @@ namespace Fuko
 		{
 			check(Math::IsPowerOfTwo(m_HashSize));
 			
-			// realloc hash
-			m_HashSize = const_cast<TSet*>(this)->m_Elements.GetAllocator().Reserve(m_Hash, m_HashSize);
+			// realloc hash, slack of the block is not used, hash size must stay power of two 
+			const_cast<TSet*>(this)->m_Elements.GetAllocator().Reserve(m_Hash, m_HashSize);
 			
 			if (m_HashSize)
 			{
@@ -0,0 +1,242 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include <Memory/MemoryOps.h>
+#include <Templates/TypeHash.h>
+#include "Array.h"
+#include "Misc/Assert.h"
+#include "ContainerFwd.h"
+
+// Structs
+namespace Fuko
+{
+	// slot index and the generation of the slot when the handle was made
+	// generation is odd while the slot is in use, so a default handle never match
+	struct SlotHandle
+	{
+		uint32	Index = ~0u;
+		uint32	Generation = 0;
+
+		FORCEINLINE bool IsNull() const { return Generation == 0; }
+		FORCEINLINE void Reset() { Index = ~0u; Generation = 0; }
+
+		FORCEINLINE uint64 ToUInt64() const { return ((uint64)Generation << 32) | Index; }
+		static FORCEINLINE SlotHandle FromUInt64(uint64 Value) { return SlotHandle{ (uint32)Value, (uint32)(Value >> 32) }; }
+
+		FORCEINLINE bool operator==(const SlotHandle& Rhs) const { return Index == Rhs.Index && Generation == Rhs.Generation; }
+		FORCEINLINE bool operator!=(const SlotHandle& Rhs) const { return !(*this == Rhs); }
+	};
+	FORCEINLINE uint32 GetTypeHash(const SlotHandle& Handle) { return HashCombine(Handle.Index, Handle.Generation); }
+}
+
+// TSlotMap
+namespace Fuko
+{
+	// elements are kept dense for iteration and found by handle in O(1)
+	// remove swap the last element into the hole, so element pointers and dense order are not stable, handles are
+	// a handle of removed element is detected by generation, never aliased by the element reuse its slot
+	template<typename T, typename Alloc>
+	class TSlotMap final
+	{
+	public:
+		using SizeType = typename Alloc::SizeType;
+		using AllocType = typename TElementAlloc<Alloc, T>::Type;
+	private:
+		static constexpr uint32 InvalidIndex = ~0u;
+
+		// in use: index of the dense element; free: next free slot, same as TSparseArray's free list
+		struct Slot
+		{
+			uint32	DataIndexOrNextFree;
+			uint32	Generation;
+		};
+
+		TArray<T, Alloc>		m_Data;				// dense elements
+		TArray<uint32, Alloc>	m_DataToSlot;		// slot index of each dense element
+		TArray<Slot, Alloc>		m_Slots;			// slots, never shrink, or generations are lost
+		uint32					m_FirstFreeSlot;	// head of free slot list
+		SizeType				m_NumFreeSlots;		// free slot num
+
+		//-----------------------------------Begin help function-----------------------------------
+		FORCEINLINE const Slot* _FindSlot(SlotHandle Handle) const
+		{
+			if (Handle.Index >= (uint32)m_Slots.Num()) return nullptr;
+			const Slot& Found = m_Slots[Handle.Index];
+			return (Found.Generation == Handle.Generation && (Found.Generation & 1)) ? &Found : nullptr;
+		}
+		FORCEINLINE SlotHandle _AllocSlot(uint32 DataIndex)
+		{
+			uint32 SlotIndex;
+			if (m_NumFreeSlots)
+			{
+				SlotIndex = m_FirstFreeSlot;
+				m_FirstFreeSlot = m_Slots[SlotIndex].DataIndexOrNextFree;
+				--m_NumFreeSlots;
+			}
+			else
+			{
+				SlotIndex = m_Slots.AddUninitialized();
+				m_Slots[SlotIndex].Generation = 0;
+			}
+
+			Slot& NewSlot = m_Slots[SlotIndex];
+			++NewSlot.Generation;
+			NewSlot.DataIndexOrNextFree = DataIndex;
+			m_DataToSlot.Add(SlotIndex);
+			return SlotHandle{ SlotIndex, NewSlot.Generation };
+		}
+		FORCEINLINE void _FreeSlot(uint32 SlotIndex)
+		{
+			Slot& OldSlot = m_Slots[SlotIndex];
+
+			// generation wrapped, retire the slot, old handles must not match a new element
+			if (++OldSlot.Generation == 0) return;
+
+			OldSlot.DataIndexOrNextFree = m_FirstFreeSlot;
+			m_FirstFreeSlot = SlotIndex;
+			++m_NumFreeSlots;
+		}
+		FORCEINLINE void _FreeAllSlots()
+		{
+			for (uint32 SlotIndex : m_DataToSlot)
+			{
+				_FreeSlot(SlotIndex);
+			}
+		}
+		//------------------------------------End help function------------------------------------
+	public:
+		// construct
+		TSlotMap(const Alloc& InAlloc = Alloc())
+			: m_Data(InAlloc)
+			, m_DataToSlot(InAlloc)
+			, m_Slots(InAlloc)
+			, m_FirstFreeSlot(InvalidIndex)
+			, m_NumFreeSlots(0)
+		{}
+
+		// copy construct, handles of the source are valid in the copy
+		TSlotMap(const TSlotMap& Other) = default;
+
+		// move construct
+		TSlotMap(TSlotMap&& Other)
+			: m_Data(std::move(Other.m_Data))
+			, m_DataToSlot(std::move(Other.m_DataToSlot))
+			, m_Slots(std::move(Other.m_Slots))
+			, m_FirstFreeSlot(Other.m_FirstFreeSlot)
+			, m_NumFreeSlots(Other.m_NumFreeSlots)
+		{
+			Other.m_FirstFreeSlot = InvalidIndex;
+			Other.m_NumFreeSlots = 0;
+		}
+
+		// assign
+		TSlotMap& operator=(const TSlotMap& Other) = default;
+		TSlotMap& operator=(TSlotMap&& Other)
+		{
+			if (this == &Other) return *this;
+			m_Data = std::move(Other.m_Data);
+			m_DataToSlot = std::move(Other.m_DataToSlot);
+			m_Slots = std::move(Other.m_Slots);
+			m_FirstFreeSlot = Other.m_FirstFreeSlot;
+			m_NumFreeSlots = Other.m_NumFreeSlots;
+			Other.m_FirstFreeSlot = InvalidIndex;
+			Other.m_NumFreeSlots = 0;
+			return *this;
+		}
+
+		// get information
+		FORCEINLINE SizeType Num() const { return m_Data.Num(); }
+		FORCEINLINE SizeType Max() const { return m_Data.Max(); }
+		FORCEINLINE SizeType NumSlots() const { return m_Slots.Num(); }
+		FORCEINLINE bool IsEmpty() const { return m_Data.Num() == 0; }
+		FORCEINLINE const AllocType& GetAllocator() const { return m_Data.GetAllocator(); }
+		FORCEINLINE AllocType& GetAllocator() { return m_Data.GetAllocator(); }
+
+		// reserve
+		void Reserve(SizeType Number)
+		{
+			m_Data.Reserve(Number);
+			m_DataToSlot.Reserve(Number);
+			m_Slots.Reserve(Number);
+		}
+
+		// remove all elements and invalidate all handles, slots are kept for their generations
+		void Empty(SizeType InSlack = 0)
+		{
+			_FreeAllSlots();
+			m_Data.Empty(InSlack);
+			m_DataToSlot.Empty(InSlack);
+			m_Slots.Reserve(InSlack);
+		}
+		void Reset()
+		{
+			_FreeAllSlots();
+			m_Data.Reset();
+			m_DataToSlot.Reset();
+		}
+
+		// add
+		template<typename...Ts>
+		FORCEINLINE SlotHandle Emplace(Ts&&...Args)
+		{
+			return _AllocSlot((uint32)m_Data.Emplace(std::forward<Ts>(Args)...));
+		}
+		FORCEINLINE SlotHandle Add(const T& Element) { return Emplace(Element); }
+		FORCEINLINE SlotHandle Add(T&& Element) { return Emplace(std::move(Element)); }
+
+		// remove, return false if the handle is stale
+		bool Remove(SlotHandle Handle)
+		{
+			const Slot* Found = _FindSlot(Handle);
+			if (!Found) return false;
+
+			// the last element is swapped into the hole, point its slot there
+			uint32 DataIndex = Found->DataIndexOrNextFree;
+			uint32 LastIndex = (uint32)m_Data.Num() - 1;
+			if (DataIndex != LastIndex)
+			{
+				m_Slots[m_DataToSlot[LastIndex]].DataIndexOrNextFree = DataIndex;
+			}
+			m_Data.RemoveAtSwap(DataIndex, 1, false);
+			m_DataToSlot.RemoveAtSwap(DataIndex, 1, false);
+			_FreeSlot(Handle.Index);
+			return true;
+		}
+
+		// find
+		FORCEINLINE bool Contains(SlotHandle Handle) const { return _FindSlot(Handle) != nullptr; }
+		FORCEINLINE T* Find(SlotHandle Handle)
+		{
+			const Slot* Found = _FindSlot(Handle);
+			return Found ? m_Data.GetData() + Found->DataIndexOrNextFree : nullptr;
+		}
+		FORCEINLINE const T* Find(SlotHandle Handle) const { return const_cast<TSlotMap*>(this)->Find(Handle); }
+		FORCEINLINE T& operator[](SlotHandle Handle)
+		{
+			T* Found = Find(Handle);
+			check(Found != nullptr);
+			return *Found;
+		}
+		FORCEINLINE const T& operator[](SlotHandle Handle) const { return const_cast<TSlotMap&>(*this)[Handle]; }
+
+		// dense access, index is only valid until next remove
+		FORCEINLINE T* GetData() { return m_Data.GetData(); }
+		FORCEINLINE const T* GetData() const { return m_Data.GetData(); }
+		FORCEINLINE SlotHandle GetHandle(SizeType DenseIndex) const
+		{
+			uint32 SlotIndex = m_DataToSlot[DenseIndex];
+			return SlotHandle{ SlotIndex, m_Slots[SlotIndex].Generation };
+		}
+		FORCEINLINE SizeType GetDenseIndex(SlotHandle Handle) const
+		{
+			const Slot* Found = _FindSlot(Handle);
+			return Found ? (SizeType)Found->DataIndexOrNextFree : INDEX_NONE;
+		}
+
+		// support for ranged for
+		FORCEINLINE T*			begin() { return m_Data.begin(); }
+		FORCEINLINE const T*	begin() const { return m_Data.begin(); }
+		FORCEINLINE T*			end() { return m_Data.end(); }
+		FORCEINLINE const T*	end() const { return m_Data.end(); }
+	};
+}
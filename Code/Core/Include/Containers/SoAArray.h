@@ -0,0 +1,402 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include <Memory/MemoryOps.h>
+#include <Templates/Align.h>
+#include <Templates/Functor.h>
+#include <Templates/Tuple.h>
+#include <Templates/TypeList.h>
+#include <Algo/Sort.h>
+#include <Algo/StableSort.h>
+#include "Array.h"
+#include "Misc/Assert.h"
+#include "ContainerFwd.h"
+
+// column span
+namespace Fuko
+{
+	// all values of one column, contiguous and aligned
+	template<typename T>
+	struct TSoAColumn
+	{
+		T*		Data = nullptr;
+		uint32	Num = 0;
+
+		FORCEINLINE T* GetData() const { return Data; }
+		FORCEINLINE T& operator[](uint32 Index) const { check(Index < Num); return Data[Index]; }
+		FORCEINLINE T* begin() const { return Data; }
+		FORCEINLINE T* end() const { return Data + Num; }
+		FORCEINLINE bool IsEmpty() const { return Num == 0; }
+	};
+}
+
+// TSoAArray
+namespace Fuko
+{
+	// structure of arrays, element i is the i-th value of every column
+	// columns live in one block of the allocator, each starts on its own cache line, so a loop over one column
+	// only touch that column and can be vectorized
+	// elements are relocated when the block grow, bitwise when the type allow it
+	template<typename Alloc, typename...Ts>
+	class TSoAArrayAlloc final
+	{
+		static_assert(sizeof...(Ts) > 0, "TSoAArray need at least one column");
+	public:
+		using SizeType = typename Alloc::USizeType;
+		using ColumnTypes = TypeList<Ts...>;
+		using ElementType = TTuple<Ts...>;
+		template<uint32 N>
+		using ColumnType = TTypeAt_t<N, ColumnTypes>;
+
+		static constexpr uint32 NumColumns = (uint32)sizeof...(Ts);
+		static constexpr size_t ColumnAlign = 64;
+	private:
+		using ColumnSequence = std::make_integer_sequence<uint32, sizeof...(Ts)>;
+
+		static constexpr size_t ColumnSizes[] = { sizeof(Ts)... };
+		static constexpr size_t ColumnAligns[] = { (alignof(Ts) > ColumnAlign ? alignof(Ts) : ColumnAlign)... };
+
+		Alloc			m_Allocator;
+		void*			m_Block;
+		TTuple<Ts*...>	m_Columns;
+		SizeType		m_Num;
+		SizeType		m_Max;
+
+		//-----------------------------------Begin help function-----------------------------------
+		static constexpr size_t _BlockAlign()
+		{
+			size_t Result = ColumnAlign;
+			for (size_t ColumnAlignment : ColumnAligns) Result = ColumnAlignment > Result ? ColumnAlignment : Result;
+			return Result;
+		}
+		static FORCEINLINE size_t _ColumnOffset(uint32 Column, SizeType InMax)
+		{
+			size_t Offset = 0;
+			for (uint32 i = 0; i < Column; ++i) Offset = Align(Offset + ColumnSizes[i] * InMax, ColumnAligns[i + 1]);
+			return Offset;
+		}
+		template<uint32...Is>
+		static FORCEINLINE TTuple<Ts*...> _Layout(void* Block, SizeType InMax, std::integer_sequence<uint32, Is...>)
+		{
+			return TTuple<Ts*...>((Block ? (Ts*)((uint8*)Block + _ColumnOffset(Is, InMax)) : (Ts*)nullptr)...);
+		}
+		template<typename TFunc, uint32...Is>
+		static FORCEINLINE void _ForEachColumn(TFunc&& Func, std::integer_sequence<uint32, Is...>)
+		{
+			(Func(std::integral_constant<uint32, Is>()), ...);
+		}
+		template<typename TFunc>
+		static FORCEINLINE void _ForEachColumn(TFunc&& Func) { _ForEachColumn(std::forward<TFunc>(Func), ColumnSequence()); }
+
+		FORCENOINLINE void _ResizeTo(SizeType NewMax)
+		{
+			check(NewMax >= m_Num);
+			if (NewMax == m_Max) return;
+
+			// new block and relocate every column, columns move to new offsets so realloc can't be used
+			void* NewBlock = nullptr;
+			if (NewMax)
+			{
+				const size_t BlockSize = _ColumnOffset(NumColumns - 1, NewMax) + ColumnSizes[NumColumns - 1] * NewMax;
+				m_Allocator.ReserveRaw(NewBlock, (typename Alloc::SizeType)BlockSize, (typename Alloc::SizeType)_BlockAlign());
+			}
+			TTuple<Ts*...> NewColumns = _Layout(NewBlock, NewMax, ColumnSequence());
+			if (m_Num)
+			{
+				_ForEachColumn([&](auto I)
+				{
+					RelocateConstructItems(NewColumns.template Get<I>(), m_Columns.template Get<I>(), m_Num);
+				});
+			}
+			if (m_Block) m_Allocator.FreeRaw(m_Block, (typename Alloc::SizeType)_BlockAlign());
+
+			m_Block = NewBlock;
+			m_Columns = NewColumns;
+			m_Max = NewMax;
+		}
+		FORCEINLINE void _ResizeGrow(SizeType NewNum)
+		{
+			if (NewNum > m_Max) _ResizeTo((SizeType)m_Allocator.GetGrow(NewNum, m_Max));
+		}
+		FORCEINLINE void _ResizeShrink()
+		{
+			SizeType NewMax = (SizeType)m_Allocator.GetShrink(m_Num, m_Max);
+			if (NewMax < m_Max) _ResizeTo(NewMax);
+		}
+		FORCEINLINE void _DestructAll()
+		{
+			_ForEachColumn([&](auto I) { DestructItems(m_Columns.template Get<I>(), m_Num); });
+			m_Num = 0;
+		}
+		void _CopyFrom(const TSoAArrayAlloc& Other)
+		{
+			if (!Other.m_Num) return;
+			if (Other.m_Num > m_Max) _ResizeTo(Other.m_Num);
+			_ForEachColumn([&](auto I)
+			{
+				ConstructItems<ColumnType<I>>(m_Columns.template Get<I>(), Other.m_Columns.template Get<I>(), Other.m_Num);
+			});
+			m_Num = Other.m_Num;
+		}
+		FORCEINLINE void _MoveFrom(TSoAArrayAlloc& Other)
+		{
+			m_Block = Other.m_Block;
+			m_Columns = Other.m_Columns;
+			m_Num = Other.m_Num;
+			m_Max = Other.m_Max;
+			Other.m_Block = nullptr;
+			Other.m_Columns = _Layout(nullptr, 0, ColumnSequence());
+			Other.m_Num = Other.m_Max = 0;
+		}
+
+		// move the rows to the order given by Order[NewIndex] = OldIndex, one gather per column
+		void _Permute(const SizeType* Order)
+		{
+			size_t MaxColumnSize = 0;
+			for (size_t Size : ColumnSizes) MaxColumnSize = Size > MaxColumnSize ? Size : MaxColumnSize;
+
+			void* Scratch = nullptr;
+			m_Allocator.ReserveRaw(Scratch, (typename Alloc::SizeType)(MaxColumnSize * m_Num), (typename Alloc::SizeType)_BlockAlign());
+			_ForEachColumn([&](auto I)
+			{
+				using T = ColumnType<I>;
+				T* Column = m_Columns.template Get<I>();
+				T* Temp = (T*)Scratch;
+				for (SizeType i = 0; i < m_Num; ++i) new (Temp + i) T(std::move(Column[Order[i]]));
+				DestructItems(Column, m_Num);
+				RelocateConstructItems(Column, Temp, m_Num);
+			});
+			m_Allocator.FreeRaw(Scratch, (typename Alloc::SizeType)_BlockAlign());
+		}
+		//------------------------------------End help function------------------------------------
+	public:
+		// construct
+		TSoAArrayAlloc(const Alloc& InAlloc = Alloc())
+			: m_Allocator(InAlloc)
+			, m_Block(nullptr)
+			, m_Columns(_Layout(nullptr, 0, ColumnSequence()))
+			, m_Num(0)
+			, m_Max(0)
+		{}
+		TSoAArrayAlloc(SizeType InitMax, const Alloc& InAlloc = Alloc())
+			: TSoAArrayAlloc(InAlloc)
+		{
+			_ResizeTo(InitMax);
+		}
+
+		// copy construct
+		TSoAArrayAlloc(const TSoAArrayAlloc& Other)
+			: TSoAArrayAlloc(Other.m_Allocator)
+		{
+			_CopyFrom(Other);
+		}
+
+		// move construct
+		TSoAArrayAlloc(TSoAArrayAlloc&& Other)
+			: m_Allocator(std::move(Other.m_Allocator))
+		{
+			_MoveFrom(Other);
+		}
+
+		// assign
+		TSoAArrayAlloc& operator=(const TSoAArrayAlloc& Other)
+		{
+			if (this == &Other) return *this;
+			_DestructAll();
+			_CopyFrom(Other);
+			return *this;
+		}
+		TSoAArrayAlloc& operator=(TSoAArrayAlloc&& Other)
+		{
+			if (this == &Other) return *this;
+			Empty();
+			m_Allocator = std::move(Other.m_Allocator);
+			_MoveFrom(Other);
+			return *this;
+		}
+
+		// destruct
+		~TSoAArrayAlloc() { Empty(); }
+
+		// get information
+		FORCEINLINE SizeType Num() const { return m_Num; }
+		FORCEINLINE SizeType Max() const { return m_Max; }
+		FORCEINLINE SizeType Slack() const { return m_Max - m_Num; }
+		FORCEINLINE bool IsEmpty() const { return m_Num == 0; }
+		FORCEINLINE bool IsValidIndex(SizeType Index) const { return Index < m_Num; }
+		FORCEINLINE const Alloc& GetAllocator() const { return m_Allocator; }
+		FORCEINLINE Alloc& GetAllocator() { return m_Allocator; }
+
+		// column by index or by type, type must be unique among columns
+		template<uint32 N>
+		FORCEINLINE ColumnType<N>* GetData() { return m_Columns.template Get<N>(); }
+		template<uint32 N>
+		FORCEINLINE const ColumnType<N>* GetData() const { return m_Columns.template Get<N>(); }
+		template<uint32 N>
+		FORCEINLINE TSoAColumn<ColumnType<N>> Column() { return { GetData<N>(), (uint32)m_Num }; }
+		template<uint32 N>
+		FORCEINLINE TSoAColumn<const ColumnType<N>> Column() const { return { GetData<N>(), (uint32)m_Num }; }
+		template<typename T>
+		FORCEINLINE TSoAColumn<T> Column() { return Column<(uint32)TTypeIndex_v<T, ColumnTypes>>(); }
+		template<typename T>
+		FORCEINLINE TSoAColumn<const T> Column() const { return Column<(uint32)TTypeIndex_v<T, ColumnTypes>>(); }
+
+		// element access
+		template<uint32 N>
+		FORCEINLINE ColumnType<N>& Get(SizeType Index)
+		{
+			check(IsValidIndex(Index));
+			return GetData<N>()[Index];
+		}
+		template<uint32 N>
+		FORCEINLINE const ColumnType<N>& Get(SizeType Index) const
+		{
+			check(IsValidIndex(Index));
+			return GetData<N>()[Index];
+		}
+		FORCEINLINE ElementType GetElement(SizeType Index) const
+		{
+			check(IsValidIndex(Index));
+			return _GetElement(Index, ColumnSequence());
+		}
+
+		// reserve & shrink
+		FORCEINLINE void Reserve(SizeType Number)
+		{
+			if (Number > m_Max) _ResizeTo(Number);
+		}
+		FORCEINLINE void Shrink()
+		{
+			if (m_Max != m_Num) _ResizeTo(m_Num);
+		}
+		FORCEINLINE void Reset(SizeType NewSize = 0)
+		{
+			_DestructAll();
+			Reserve(NewSize);
+		}
+		FORCEINLINE void Empty(SizeType InSlack = 0)
+		{
+			_DestructAll();
+			_ResizeTo(InSlack);
+		}
+		void SetNum(SizeType NewNum, bool bAllowShrinking = true)
+		{
+			if (NewNum > m_Num)
+			{
+				AddDefaulted(NewNum - m_Num);
+			}
+			else if (NewNum < m_Num)
+			{
+				_ForEachColumn([&](auto I) { DestructItems(m_Columns.template Get<I>() + NewNum, m_Num - NewNum); });
+				m_Num = NewNum;
+				if (bAllowShrinking) _ResizeShrink();
+			}
+		}
+
+		// add, one value for each column, return index of the element
+		template<typename...Args>
+		SizeType Add(Args&&...Values)
+		{
+			static_assert(sizeof...(Args) == sizeof...(Ts), "TSoAArray::Add need one value for each column");
+			_ResizeGrow(m_Num + 1);
+			_Construct(m_Num, ColumnSequence(), std::forward<Args>(Values)...);
+			return m_Num++;
+		}
+		FORCEINLINE SizeType AddElement(const ElementType& Element) { return _AddElement(Element, ColumnSequence()); }
+		SizeType AddDefaulted(SizeType Count = 1)
+		{
+			const SizeType Index = AddUninitialized(Count);
+			_ForEachColumn([&](auto I) { DefaultConstructItems<ColumnType<I>>(m_Columns.template Get<I>() + Index, Count); });
+			return Index;
+		}
+		// columns must be filled by caller before any other call
+		SizeType AddUninitialized(SizeType Count = 1)
+		{
+			const SizeType Index = m_Num;
+			_ResizeGrow(m_Num + Count);
+			m_Num += Count;
+			return Index;
+		}
+
+		// remove, move last elements to the hole, order is not kept
+		void RemoveAtSwap(SizeType Index, SizeType Count = 1, bool bAllowShrinking = true)
+		{
+			if (!Count) return;
+			check(Index + Count <= m_Num);
+
+			const SizeType NumElementsAfterHole = m_Num - (Index + Count);
+			const SizeType NumElementsToMoveIntoHole = Math::Min(Count, NumElementsAfterHole);
+			_ForEachColumn([&](auto I)
+			{
+				using T = ColumnType<I>;
+				T* Column = m_Columns.template Get<I>();
+				DestructItems(Column + Index, Count);
+				if (NumElementsToMoveIntoHole) RelocateConstructItems(Column + Index, Column + (m_Num - NumElementsToMoveIntoHole), NumElementsToMoveIntoHole);
+			});
+			m_Num -= Count;
+
+			if (bAllowShrinking) _ResizeShrink();
+		}
+		FORCEINLINE void SwapElements(SizeType A, SizeType B)
+		{
+			check(IsValidIndex(A) && IsValidIndex(B));
+			if (A == B) return;
+			_ForEachColumn([&](auto I)
+			{
+				ColumnType<I>* Column = m_Columns.template Get<I>();
+				Swap(Column[A], Column[B]);
+			});
+		}
+
+		// sort rows by one column, the key column is compared through an index array, then every column is gathered once
+		template<uint32 KeyColumn, typename TPred = TLess<ColumnType<KeyColumn>>>
+		void Sort(TPred&& Pred = TPred())
+		{
+			const ColumnType<KeyColumn>* Keys = GetData<KeyColumn>();
+			SortBy([&](SizeType A, SizeType B) { return Pred(Keys[A], Keys[B]); });
+		}
+		template<uint32 KeyColumn, typename TPred = TLess<ColumnType<KeyColumn>>>
+		void StableSort(TPred&& Pred = TPred())
+		{
+			const ColumnType<KeyColumn>* Keys = GetData<KeyColumn>();
+			StableSortBy([&](SizeType A, SizeType B) { return Pred(Keys[A], Keys[B]); });
+		}
+		// sort rows by a predicate on two element index, for keys made of several columns
+		template<typename TPred>
+		void SortBy(TPred&& Pred)
+		{
+			if (m_Num < 2) return;
+			TArray<SizeType, Alloc> Order(m_Allocator);
+			Order.SetNumUninitialized(m_Num);
+			for (SizeType i = 0; i < m_Num; ++i) Order[i] = i;
+			Algo::IntroSort(Order.GetData(), m_Num, std::forward<TPred>(Pred));
+			_Permute(Order.GetData());
+		}
+		template<typename TPred>
+		void StableSortBy(TPred&& Pred)
+		{
+			if (m_Num < 2) return;
+			TArray<SizeType, Alloc> Order(m_Allocator);
+			Order.SetNumUninitialized(m_Num);
+			for (SizeType i = 0; i < m_Num; ++i) Order[i] = i;
+			Algo::StableSort(Order.GetData(), m_Num, std::forward<TPred>(Pred));
+			_Permute(Order.GetData());
+		}
+	private:
+		template<uint32...Is, typename...Args>
+		FORCEINLINE void _Construct(SizeType Index, std::integer_sequence<uint32, Is...>, Args&&...Values)
+		{
+			(new (m_Columns.template Get<Is>() + Index) ColumnType<Is>(std::forward<Args>(Values)), ...);
+		}
+		template<uint32...Is>
+		FORCEINLINE SizeType _AddElement(const ElementType& Element, std::integer_sequence<uint32, Is...>)
+		{
+			return Add(Element.template Get<Is>()...);
+		}
+		template<uint32...Is>
+		FORCEINLINE ElementType _GetElement(SizeType Index, std::integer_sequence<uint32, Is...>) const
+		{
+			return ElementType(m_Columns.template Get<Is>()[Index]...);
+		}
+	};
+}
@@ -0,0 +1,358 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include <Memory/MemoryOps.h>
+#include <Math/MathUtility.h>
+#include <Templates/Pair.h>
+#include <Templates/Functor.h>
+#include <Algo/BinarySearch.h>
+#include <Algo/Sort.h>
+#include "Array.h"
+#include "Misc/Assert.h"
+#include "ContainerFwd.h"
+
+// sorted range
+namespace Fuko
+{
+	// contiguous run of sorted pairs, result of range query
+	template<typename T>
+	struct TSortedRange
+	{
+		T*		First = nullptr;
+		T*		Last = nullptr;
+
+		FORCEINLINE uint32 Num() const { return (uint32)(Last - First); }
+		FORCEINLINE bool IsEmpty() const { return First == Last; }
+		FORCEINLINE T* begin() const { return First; }
+		FORCEINLINE T* end() const { return Last; }
+	};
+}
+
+// sort pairs by key
+namespace Fuko
+{
+	// slot i take the pair at IndexAt(i), walk each cycle once, visited slots are marked by IndexAt(i) = i
+	template<typename T, typename TIndexAt>
+	void PermuteItems(T* Data, uint32 Num, TIndexAt&& IndexAt)
+	{
+		alignas(T) uint8 Temp[sizeof(T)];
+		for (uint32 i = 0; i < Num; ++i)
+		{
+			if (IndexAt(i) == i) continue;
+			RelocateConstructItems((T*)Temp, Data + i, 1);
+			uint32 Hole = i;
+			for (;;)
+			{
+				uint32 Next = IndexAt(Hole);
+				IndexAt(Hole) = Hole;
+				if (Next == i)
+				{
+					RelocateConstructItems(Data + Hole, (T*)Temp, 1);
+					break;
+				}
+				RelocateConstructItems(Data + Hole, Data + Next, 1);
+				Hole = Next;
+			}
+		}
+	}
+
+	// sort by key and keep the last pair of each key, so later pairs of a batch win
+	// an already sorted batch is not sorted again, else (key, position) is sorted and the pairs permuted in place
+	template<typename KeyType, typename ValueType, typename Alloc, typename Compare>
+	void SortUniquePairs(TArray<TPair<KeyType, ValueType>, Alloc>& Pairs, const Compare& Less)
+	{
+		using ElementType = TPair<KeyType, ValueType>;
+		const uint32 Num = Pairs.Num();
+		if (Num < 2) return;
+		ElementType* Data = Pairs.GetData();
+
+		uint32 Unsorted = 1;
+		while (Unsorted < Num && !Less(Data[Unsorted].Key, Data[Unsorted - 1].Key)) ++Unsorted;
+		if (Unsorted < Num)
+		{
+			if constexpr (std::is_trivially_copyable_v<KeyType>)
+			{
+				// keys copied beside their position, the sort never leave the array
+				TArray<TPair<KeyType, uint32>> Order;
+				Order.SetNumUninitialized(Num);
+				for (uint32 i = 0; i < Num; ++i) new(&Order[i]) TPair<KeyType, uint32>(Data[i].Key, i);
+				Algo::IntroSort(Order.GetData(), Num, [&Less](const TPair<KeyType, uint32>& A, const TPair<KeyType, uint32>& B)
+				{
+					return Less(A.Key, B.Key) || (!Less(B.Key, A.Key) && A.Value < B.Value);
+				});
+				PermuteItems(Data, Num, [&Order](uint32 i) -> uint32& { return Order[i].Value; });
+			}
+			else
+			{
+				TArray<uint32> Order;
+				Order.SetNumUninitialized(Num);
+				for (uint32 i = 0; i < Num; ++i) Order[i] = i;
+				Algo::IntroSort(Order.GetData(), Num, [Data, &Less](uint32 A, uint32 B)
+				{
+					return Less(Data[A].Key, Data[B].Key) || (!Less(Data[B].Key, Data[A].Key) && A < B);
+				});
+				PermuteItems(Data, Num, [&Order](uint32 i) -> uint32& { return Order[i]; });
+			}
+		}
+
+		uint32 Result = 0;
+		for (uint32 i = 1; i < Num; ++i)
+		{
+			if (Less(Data[Result].Key, Data[i].Key)) ++Result;
+			if (Result != i) Data[Result] = std::move(Data[i]);
+		}
+		Pairs.SetNum(Result + 1, false);
+	}
+}
+
+// TSortedFlatMap
+namespace Fuko
+{
+	// ordered map over a sorted TArray of pairs, lookups are binary search over contiguous memory
+	// single insert move the tail, batch of keys should go through Build or Merge
+	template<typename KeyType, typename ValueType, typename Alloc, typename Compare>
+	class TSortedFlatMap
+	{
+	public:
+		using ElementType = TPair<KeyType, ValueType>;
+		using ElementArrayType = TArray<ElementType, Alloc>;
+		using SizeType = typename Alloc::USizeType;
+		using RangeType = TSortedRange<ElementType>;
+		using ConstRangeType = TSortedRange<const ElementType>;
+	private:
+		ElementArrayType	m_Pairs;
+		Compare				m_Less;
+
+		//-----------------------------begin help function-----------------------------
+		FORCEINLINE SizeType _LowerBound(const KeyType& Key) const
+		{
+			return Algo::Impl::LowerBoundInternal(m_Pairs.GetData(), m_Pairs.Num(), Key, MapKey(), m_Less);
+		}
+		FORCEINLINE SizeType _UpperBound(const KeyType& Key) const
+		{
+			return Algo::Impl::UpperBoundInternal(m_Pairs.GetData(), m_Pairs.Num(), Key, MapKey(), m_Less);
+		}
+		FORCEINLINE SizeType _FindIndex(const KeyType& Key) const
+		{
+			SizeType Index = _LowerBound(Key);
+			return (Index < m_Pairs.Num() && !m_Less(Key, m_Pairs[Index].Key)) ? Index : (SizeType)INDEX_NONE;
+		}
+
+		// merge a sorted unique batch in place from the back, pairs of the batch replace pairs with the same key
+		void _MergeSorted(ElementArrayType& Batch)
+		{
+			if (Batch.IsEmpty()) return;
+
+			// count keys already in map, so the merged tail can be written from the back
+			SizeType Duplicate = 0;
+			for (SizeType i = 0, j = 0; i < m_Pairs.Num() && j < Batch.Num();)
+			{
+				if (m_Less(m_Pairs[i].Key, Batch[j].Key)) ++i;
+				else if (m_Less(Batch[j].Key, m_Pairs[i].Key)) ++j;
+				else { ++Duplicate; ++i; ++j; }
+			}
+
+			const SizeType OldNum = m_Pairs.Num();
+			m_Pairs.AddUninitialized(Batch.Num() - Duplicate);
+			ElementType* Data = m_Pairs.GetData();
+			int64 i = (int64)OldNum - 1, j = (int64)Batch.Num() - 1, k = (int64)m_Pairs.Num() - 1;
+			while (j >= 0)
+			{
+				if (i >= 0 && m_Less(Batch[j].Key, Data[i].Key))
+				{
+					if (i != k) RelocateConstructItems(Data + k, Data + i, 1);
+					--i;
+				}
+				else
+				{
+					if (i >= 0 && !m_Less(Data[i].Key, Batch[j].Key)) DestructItems(Data + i--, 1);
+					new(Data + k) ElementType(std::move(Batch[j--]));
+				}
+				--k;
+			}
+		}
+
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& _FindOrAddImpl(bool bReplace, InitKeyType&& Key, InitValueType&&...Value)
+		{
+			SizeType Index = _LowerBound(Key);
+			if (Index < m_Pairs.Num() && !m_Less(Key, m_Pairs[Index].Key))
+			{
+				if (bReplace) m_Pairs[Index].Value = ValueType(std::forward<InitValueType>(Value)...);
+				return m_Pairs[Index].Value;
+			}
+			m_Pairs.EmplaceAt(Index, std::forward<InitKeyType>(Key), std::forward<InitValueType>(Value)...);
+			return m_Pairs[Index].Value;
+		}
+		//------------------------------end help function------------------------------
+	public:
+		// construct
+		FORCEINLINE TSortedFlatMap(const Alloc& InAlloc = Alloc(), const Compare& InLess = Compare()) : m_Pairs(InAlloc), m_Less(InLess) {}
+		TSortedFlatMap(std::initializer_list<ElementType> InitList, const Alloc& InAlloc = Alloc(), const Compare& InLess = Compare())
+			: m_Pairs(InitList, InAlloc)
+			, m_Less(InLess)
+		{
+			SortUniquePairs(m_Pairs, m_Less);
+		}
+		TSortedFlatMap(ElementArrayType&& Pairs, const Compare& InLess = Compare())
+			: m_Pairs(std::move(Pairs))
+			, m_Less(InLess)
+		{
+			SortUniquePairs(m_Pairs, m_Less);
+		}
+
+		// copy & move
+		FORCEINLINE TSortedFlatMap(const TSortedFlatMap&) = default;
+		FORCEINLINE TSortedFlatMap(TSortedFlatMap&&) = default;
+		FORCEINLINE TSortedFlatMap& operator=(const TSortedFlatMap&) = default;
+		FORCEINLINE TSortedFlatMap& operator=(TSortedFlatMap&&) = default;
+
+		// operators
+		FORCEINLINE void Empty(SizeType ExpectedNumElements = 0) { m_Pairs.Empty(ExpectedNumElements); }
+		FORCEINLINE void Reset() { m_Pairs.Reset(); }
+		FORCEINLINE void Shrink() { m_Pairs.Shrink(); }
+		FORCEINLINE void Reserve(SizeType Number) { m_Pairs.Reserve(Number); }
+		FORCEINLINE SizeType Num() const { return m_Pairs.Num(); }
+		FORCEINLINE SizeType Max() const { return m_Pairs.Max(); }
+		FORCEINLINE bool IsEmpty() const { return m_Pairs.IsEmpty(); }
+		FORCEINLINE const ElementArrayType& GetPairs() const { return m_Pairs; }
+
+		// bulk build, replace all pairs, unsorted input is sorted once, the last pair of a key win
+		void Build(ElementArrayType&& Pairs)
+		{
+			m_Pairs = std::move(Pairs);
+			SortUniquePairs(m_Pairs, m_Less);
+		}
+		void Build(const ElementType* Pairs, SizeType Count)
+		{
+			m_Pairs.Reset();
+			if (Count) m_Pairs.Insert(Pairs, Count, 0);
+			SortUniquePairs(m_Pairs, m_Less);
+		}
+
+		// merge insert a batch in one pass, pairs of the batch replace existing values
+		void Merge(ElementArrayType&& Pairs)
+		{
+			SortUniquePairs(Pairs, m_Less);
+			_MergeSorted(Pairs);
+		}
+		void Merge(const ElementType* Pairs, SizeType Count)
+		{
+			if (!Count) return;
+			ElementArrayType Batch(Pairs, Count);
+			SortUniquePairs(Batch, m_Less);
+			_MergeSorted(Batch);
+		}
+
+		// add, replace the value of an existing key
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, std::move(InValue)); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(std::move(InKey), InValue); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(std::move(InKey), std::move(InValue)); }
+		FORCEINLINE ValueType& Add(const KeyType&  InKey) { return Emplace(InKey); }
+		FORCEINLINE ValueType& Add(KeyType&& InKey) { return Emplace(std::move(InKey)); }
+
+		// emplace
+		template <typename InitKeyType, typename...InitValueType>
+		FORCEINLINE ValueType& Emplace(InitKeyType&& InKey, InitValueType&&...InValue)
+		{
+			return _FindOrAddImpl(true, std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue)...);
+		}
+
+		// find or add
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key) { return _FindOrAddImpl(false, Key); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key) { return _FindOrAddImpl(false, std::move(Key)); }
+		FORCEINLINE ValueType& FindOrAdd(const KeyType& Key, const ValueType& Value) { return _FindOrAddImpl(false, Key, Value); }
+		FORCEINLINE ValueType& FindOrAdd(KeyType&& Key, ValueType&& Value) { return _FindOrAddImpl(false, std::move(Key), std::move(Value)); }
+
+		// remove
+		SizeType Remove(const KeyType& Key)
+		{
+			SizeType Index = _FindIndex(Key);
+			if (Index == (SizeType)INDEX_NONE) return 0;
+			m_Pairs.RemoveAt(Index, 1, false);
+			return 1;
+		}
+		bool RemoveAndCopyValue(const KeyType& Key, ValueType& OutRemovedValue)
+		{
+			SizeType Index = _FindIndex(Key);
+			if (Index == (SizeType)INDEX_NONE) return false;
+			OutRemovedValue = std::move(m_Pairs[Index].Value);
+			m_Pairs.RemoveAt(Index, 1, false);
+			return true;
+		}
+		ValueType FindAndRemoveChecked(const KeyType& Key)
+		{
+			SizeType Index = _FindIndex(Key);
+			check(Index != (SizeType)INDEX_NONE);
+			ValueType Result = std::move(m_Pairs[Index].Value);
+			m_Pairs.RemoveAt(Index, 1, false);
+			return Result;
+		}
+		// remove keys in [Lower, Upper), return the removed count
+		SizeType RemoveRange(const KeyType& Lower, const KeyType& Upper)
+		{
+			SizeType First = _LowerBound(Lower);
+			SizeType Last = Math::Max(First, _LowerBound(Upper));
+			m_Pairs.RemoveAt(First, Last - First, false);
+			return Last - First;
+		}
+
+		// find
+		FORCEINLINE ValueType* Find(const KeyType& Key)
+		{
+			SizeType Index = _FindIndex(Key);
+			return Index == (SizeType)INDEX_NONE ? nullptr : &m_Pairs[Index].Value;
+		}
+		FORCEINLINE const ValueType* Find(const KeyType& Key) const { return const_cast<TSortedFlatMap*>(this)->Find(Key); }
+		FORCEINLINE ValueType& FindChecked(const KeyType& Key)
+		{
+			ValueType* Value = Find(Key);
+			check(Value != nullptr);
+			return *Value;
+		}
+		FORCEINLINE const ValueType& FindChecked(const KeyType& Key) const { return const_cast<TSortedFlatMap*>(this)->FindChecked(Key); }
+		FORCEINLINE ValueType FindRef(const KeyType& Key) const
+		{
+			const ValueType* Value = Find(Key);
+			return Value ? *Value : ValueType();
+		}
+		FORCEINLINE bool Contains(const KeyType& Key) const { return _FindIndex(Key) != (SizeType)INDEX_NONE; }
+
+		// ordered query, index of the first key not less than / greater than Key
+		FORCEINLINE SizeType LowerBound(const KeyType& Key) const { return _LowerBound(Key); }
+		FORCEINLINE SizeType UpperBound(const KeyType& Key) const { return _UpperBound(Key); }
+
+		// pairs with key in [Lower, Upper)
+		FORCEINLINE RangeType Range(const KeyType& Lower, const KeyType& Upper)
+		{
+			SizeType First = _LowerBound(Lower);
+			SizeType Last = Math::Max(First, _LowerBound(Upper));
+			return RangeType{ m_Pairs.GetData() + First, m_Pairs.GetData() + Last };
+		}
+		FORCEINLINE ConstRangeType Range(const KeyType& Lower, const KeyType& Upper) const
+		{
+			RangeType Result = const_cast<TSortedFlatMap*>(this)->Range(Lower, Upper);
+			return ConstRangeType{ Result.First, Result.Last };
+		}
+		// pairs from the lower bound of Key to the end
+		FORCEINLINE RangeType From(const KeyType& Key) { return RangeType{ m_Pairs.GetData() + _LowerBound(Key), m_Pairs.GetData() + m_Pairs.Num() }; }
+		FORCEINLINE ConstRangeType From(const KeyType& Key) const { return ConstRangeType{ m_Pairs.GetData() + _LowerBound(Key), m_Pairs.GetData() + m_Pairs.Num() }; }
+
+		// access by order, the key is read only so the order can't break
+		FORCEINLINE const KeyType& KeyAt(SizeType Index) const { return m_Pairs[Index].Key; }
+		FORCEINLINE ValueType& ValueAt(SizeType Index) { return m_Pairs[Index].Value; }
+		FORCEINLINE const ValueType& ValueAt(SizeType Index) const { return m_Pairs[Index].Value; }
+		// key must not be changed
+		FORCEINLINE ElementType& First() { return m_Pairs[0]; }
+		FORCEINLINE const ElementType& First() const { return m_Pairs[0]; }
+		FORCEINLINE ElementType& Last() { return m_Pairs.Last(); }
+		FORCEINLINE const ElementType& Last() const { return m_Pairs.Last(); }
+
+		// iterator in key order
+		FORCEINLINE ElementType* begin() { return m_Pairs.begin(); }
+		FORCEINLINE const ElementType* begin() const { return m_Pairs.begin(); }
+		FORCEINLINE ElementType* end() { return m_Pairs.end(); }
+		FORCEINLINE const ElementType* end() const { return m_Pairs.end(); }
+	};
+}
@@ -205,6 +205,8 @@ namespace Fuko
 		bool IsCompact() const { return m_NumFreeIndices == 0; }
 		bool IsAllocated(SizeType Index) const { return _GetBit(Index); }
 		SizeType GetMaxIndex() const { return m_Data.Num(); }
+		// one bit per index up to GetMaxIndex(), set when allocated
+		const uint32* GetAllocationFlags() const { return _GetBitArray(); }
 		SizeType Num() const { return m_Data.Num() - m_NumFreeIndices; }
 		SizeType Max() const { return m_Data.Max(); }
 		Alloc& GetAllocator() { return m_Data.GetAllocator(); }
@@ -667,7 +669,7 @@ namespace Fuko
 		public:
 			explicit TConstIterator(const TSparseArray& InArray, SizeType StartIndex = 0)
 				: m_Array(InArray)
-				, m_BitArrayIt(m_Array._GetBitArray(), m_Array.GetMaxIndex())
+				, m_BitArrayIt(m_Array._GetBitArray(), m_Array.GetMaxIndex(), StartIndex)
 #if FUKO_DEBUG
 				, m_InitialNum(InArray.Num())
 #endif
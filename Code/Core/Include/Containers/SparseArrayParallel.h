@@ -0,0 +1,69 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#include "SparseArray.h"
+#include <JobSystem/JobSystem.h>
+#include <thread>
+
+// parallel visit of TSparseArray, apart so the container doesn't pull in the job system
+namespace Fuko
+{
+	// visit allocated elements from job workers, Func(T&) must be safe to call concurrently for different elements
+	// ranges are cut on bit words and hold the same number of allocated elements, found by popcount
+	template<typename T, typename Alloc, typename TFunc>
+	std::pair<Job::Job, Job::Job> ParallelForEachAllocated(Job::JobBucketBuilder& Bucket, TSparseArray<T, Alloc>& Array, TFunc&& Func, uint32 ChunkNum = 0)
+	{
+		using SizeType = typename TSparseArray<T, Alloc>::SizeType;
+		const uint32* Words = Array.GetAllocationFlags();
+		const SizeType MaxIndex = Array.GetMaxIndex();
+		const SizeType NumWords = Algo::CalculateNumWords(MaxIndex);
+		const SizeType Total = Array.Num();
+		ChunkNum = ChunkNum ? ChunkNum : std::thread::hardware_concurrency();
+		ChunkNum = Math::Max(1u, Math::Min(ChunkNum, (uint32)Total));
+
+		Job::Job Begin = Bucket.PlaceHolder();
+		Job::Job End = Bucket.PlaceHolder();
+		Begin.Precede(End);
+
+		SizeType Word = 0;
+		SizeType Counted = 0;
+		for (uint32 Chunk = 0; Chunk < ChunkNum; ++Chunk)
+		{
+			// take words until the chunk reach its share
+			SizeType FirstWord = Word;
+			if (Chunk + 1 == ChunkNum)
+			{
+				Word = NumWords;
+			}
+			else
+			{
+				const SizeType Share = (SizeType)((int64)Total * (Chunk + 1) / ChunkNum);
+				while (Word < NumWords && Counted < Share) Counted += Math::CountBits(Words[Word++]);
+			}
+
+			const SizeType BeginIndex = FirstWord << NumBitsPerDWORDLogTwo;
+			const SizeType EndIndex = Math::Min(Word << NumBitsPerDWORDLogTwo, MaxIndex);
+			if (BeginIndex >= EndIndex) continue;
+			Bucket.Emplace([&Array, Func, BeginIndex, EndIndex]
+			{
+				for (TConstSetBitIterator<SizeType> It(Array.GetAllocationFlags(), EndIndex, BeginIndex); It; ++It)
+				{
+					Func(Array[It.GetIndex()]);
+				}
+			}).Precede(End).Depend(Begin);
+		}
+		return std::make_pair(Begin, End);
+	}
+
+	// ChunkNum 0 means one range per worker of the executer
+	template<typename T, typename Alloc, typename TFunc>
+	void ParallelForEachAllocated(Job::JobExecuter& Executer, TSparseArray<T, Alloc>& Array, TFunc&& Func, uint32 ChunkNum = 0)
+	{
+		Job::JobBucket Bucket;
+		ParallelForEachAllocated(Bucket, Array, std::forward<TFunc>(Func), ChunkNum ? ChunkNum : Executer.NumWorkers());
+
+		std::future<void> Done;
+		Executer.Execute(Bucket).Future(Done);
+		Done.wait();
+	}
+}
@@ -11,15 +11,25 @@
 #include "Containers/ContainerFwd.h"
 #include "Containers/Array.h"
 #include "Containers/BitArray.h"
+#include "Containers/ConcurrentMap.h"
+#include "Containers/FlatMap.h"
+#include "Containers/FlatSet.h"
 #include "Containers/Map.h"
 #include "Containers/Pool.h"
 #include "Containers/RingQueue.h"
 #include "Containers/Set.h"
 #include "Containers/SparseArray.h"
+#include "Containers/SparseArrayParallel.h"
+#include "Containers/SlotMap.h"
+#include "Containers/SoAArray.h"
+#include "Containers/SortedFlatMap.h"
+#include "Containers/BTreeMap.h"
+#include "Containers/FrozenMap.h"
 
 // filesystem 
 #include "FileSystem/FileDevice.h"
 #include "FileSystem/FileSystem.h"
+#include "FileSystem/MappedFile.h"
 #include "FileSystem/Path.h"
 #include "FileSystem/SystemFileDevice.h"
 
@@ -33,12 +43,16 @@
 // memory 
 #include "Memory/MemoryOps.h"
 #include "Memory/MemoryPolicy.h" 
+#include "Memory/ArenaAllocator.h"
+#include "Memory/ProfilingAllocator.h"
 
 // misc
 #include "Misc/Assert.h"
 #include "Misc/ByteSwap.h"
+#include "Misc/CpuInfo.h"
 #include "Misc/Crc.h"
 #include "Misc/Delegate.h"
+#include "Misc/Hash.h"
 #include "Misc/LazyObject.h"
 #include "Misc/Log.h"
 #include "Misc/SmartPtr.h"
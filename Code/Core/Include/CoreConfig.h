@@ -7,6 +7,15 @@
 // Name 
 
 
+// platform 
+#if defined(_WIN32)
+#define PLATFORM_WINDOWS 1
+#define PLATFORM_POSIX 0
+#else
+#define PLATFORM_WINDOWS 0
+#define PLATFORM_POSIX 1
+#endif
+
 #ifdef EXPORT_CORE
 #define CORE_API __declspec(dllexport)
 #else
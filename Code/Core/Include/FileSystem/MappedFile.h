@@ -0,0 +1,31 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+
+namespace Fuko
+{
+	// read only view of a whole file, pages are loaded by the os on first touch and shared between processes
+	// the view is page aligned, so data laid out with offsets (TFrozenMap image) can be used in place
+	class CORE_API MappedFile
+	{
+		const void*		m_Data;
+		uint64			m_Size;
+	public:
+		MappedFile();
+		~MappedFile();
+
+		// non copyable
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& Other);
+		MappedFile& operator=(MappedFile&& Other);
+
+		// map the file at utf-8 path, false when it can not be opened or mapped, an empty file can not be mapped either
+		bool Open(const char* InPath);
+		void Close();
+
+		FORCEINLINE bool IsOpen() const { return m_Data != nullptr; }
+		FORCEINLINE const void* GetData() const { return m_Data; }
+		FORCEINLINE uint64 GetSize() const { return m_Size; }
+	};
+}
@@ -32,6 +32,7 @@ namespace Fuko::Job
 		inline ~SingleQueueExecuter();
 
 		inline PlanBuilder Execute(JobBucket& Bucket);
+		inline uint32_t NumWorkers() const { return (uint32_t)m_AllThread.size(); }
 
 		inline void WaitForAll();
 
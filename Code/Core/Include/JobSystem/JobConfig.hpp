@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <assert.h>
 #include <future>
+#include <algorithm>
 #include <vector>
 #include <string>
 
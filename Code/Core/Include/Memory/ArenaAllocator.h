@@ -0,0 +1,232 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Misc/Assert.h>
+#include <Templates/Align.h>
+#include <Math/MathUtility.h>
+#include <Memory/MemoryOps.h>
+#include <Memory/MemoryPolicy.h>
+
+// Arena allocator
+namespace Fuko
+{
+	// bump pointer allocator over chained chunks, free is no-op, memory comes back by Rewind/Reset
+	// chunks after the current one are kept for reuse, call Trim() to return them
+	// not thread safe, use one arena per thread/frame/request
+	class ArenaAllocator : public IAllocator
+	{
+		struct alignas(16) Chunk
+		{
+			Chunk*	Next;
+			size_t	Size;
+
+			FORCEINLINE uint8* Begin() { return (uint8*)(this + 1); }
+			FORCEINLINE uint8* End() { return Begin() + Size; }
+		};
+
+		IAllocator*	m_Backing;
+		size_t		m_ChunkSize;
+		Chunk*		m_First;
+		Chunk*		m_Current;
+		uint8*		m_Cursor;
+		uint8*		m_End;
+		uint8*		m_LastAlloc;
+
+		//====================================Begin help function====================================
+		FORCEINLINE void _UseChunk(Chunk* InChunk)
+		{
+			m_Current = InChunk;
+			m_Cursor = InChunk->Begin();
+			m_End = InChunk->End();
+		}
+		FORCEINLINE Chunk* _FindChunk(void* Ptr)
+		{
+			for (Chunk* It = m_First; It; It = It->Next)
+			{
+				if (Ptr >= It->Begin() && Ptr < It->End()) return It;
+			}
+			return nullptr;
+		}
+		FORCENOINLINE void* _AllocSlow(size_t InSize, size_t Alignment)
+		{
+			size_t NeedSize = InSize + Alignment;
+
+			// reuse a retained chunk, or link a new one after the current
+			Chunk* Next = m_Current ? m_Current->Next : m_First;
+			if (!Next || Next->Size < NeedSize)
+			{
+				size_t ChunkSize = Math::Max(m_ChunkSize, Align(NeedSize, 16));
+				Chunk* NewChunk = (Chunk*)m_Backing->Alloc(sizeof(Chunk) + ChunkSize, 16);
+				always_check(NewChunk != nullptr);
+				NewChunk->Size = ChunkSize;
+				NewChunk->Next = Next;
+				if (m_Current)
+					m_Current->Next = NewChunk;
+				else
+					m_First = NewChunk;
+				Next = NewChunk;
+			}
+			_UseChunk(Next);
+
+			uint8* Ret = Align(m_Cursor, Alignment);
+			m_Cursor = Ret + InSize;
+			m_LastAlloc = Ret;
+			return Ret;
+		}
+		//=====================================End help function=====================================
+	public:
+		struct Mark
+		{
+			Chunk*	MarkChunk;
+			uint8*	MarkCursor;
+		};
+
+		ArenaAllocator(size_t ChunkSize = 64 * 1024, IAllocator* Backing = DefaultAllocator())
+			: m_Backing(Backing)
+			, m_ChunkSize(ChunkSize)
+			, m_First(nullptr)
+			, m_Current(nullptr)
+			, m_Cursor(nullptr)
+			, m_End(nullptr)
+			, m_LastAlloc(nullptr)
+		{
+			check(m_Backing != nullptr);
+		}
+		ArenaAllocator(const ArenaAllocator&) = delete;
+		ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+		~ArenaAllocator()
+		{
+			for (Chunk* It = m_First; It;)
+			{
+				Chunk* Next = It->Next;
+				m_Backing->Free(It);
+				It = Next;
+			}
+		}
+
+		// IAllocator
+		void* Alloc(size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override
+		{
+			if (InSize == 0) return nullptr;
+			uint8* Ret = Align(m_Cursor, Alignment);
+			if (m_Cursor && Ret + InSize <= m_End)
+			{
+				m_Cursor = Ret + InSize;
+				m_LastAlloc = Ret;
+				return Ret;
+			}
+			return _AllocSlow(InSize, Alignment);
+		}
+		void* Realloc(void* InPtr, size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override
+		{
+			if (InPtr == nullptr) return Alloc(InSize, Alignment);
+			if (InSize == 0) return nullptr;
+
+			// the last allocation grows and shrinks in place
+			if (InPtr == m_LastAlloc && (uint8*)InPtr + InSize <= m_End)
+			{
+				m_Cursor = (uint8*)InPtr + InSize;
+				return InPtr;
+			}
+
+			// old size is unknown, copy up to the cursor in the current chunk or to the end of an older chunk, the old data is always inside
+			// the new block start at or after the cursor, move anyway since the old range may reach past it in an older chunk
+			Chunk* OldChunk = _FindChunk(InPtr);
+			check(OldChunk != nullptr);
+			uint8* OldEnd = OldChunk == m_Current ? m_Cursor : OldChunk->End();
+			check((uint8*)InPtr < OldEnd);
+			size_t CopySize = Math::Min(InSize, (size_t)(OldEnd - (uint8*)InPtr));
+			void* NewPtr = Alloc(InSize, Alignment);
+			Memmove(NewPtr, InPtr, CopySize);
+			return NewPtr;
+		}
+		void Free(void* InPtr) override {}
+		size_t Size(void* Ptr, size_t Alignment = DEFAULT_ALIGNMENT) override
+		{
+			// only the last allocation knows its size
+			return Ptr && Ptr == m_LastAlloc ? (size_t)(m_Cursor - (uint8*)Ptr) : 0;
+		}
+		void Trim() override
+		{
+			Chunk* It = m_Current ? m_Current->Next : m_First;
+			if (m_Current)
+				m_Current->Next = nullptr;
+			else
+				m_First = nullptr;
+
+			while (It)
+			{
+				Chunk* Next = It->Next;
+				m_Backing->Free(It);
+				It = Next;
+			}
+		}
+
+		// mark and rewind, rewinding invalidates every allocation made after the mark
+		FORCEINLINE Mark GetMark() const { return Mark{ m_Current, m_Cursor }; }
+		FORCEINLINE void Rewind(const Mark& InMark)
+		{
+			if (InMark.MarkChunk)
+			{
+				m_Current = InMark.MarkChunk;
+				m_Cursor = InMark.MarkCursor;
+				m_End = m_Current->End();
+			}
+			else
+			{
+				Reset();
+			}
+			m_LastAlloc = nullptr;
+		}
+
+		// drop all allocations and keep the chunks
+		FORCEINLINE void Reset()
+		{
+			if (m_First)
+			{
+				_UseChunk(m_First);
+			}
+			else
+			{
+				m_Current = nullptr;
+				m_Cursor = m_End = nullptr;
+			}
+			m_LastAlloc = nullptr;
+		}
+
+		// statistics
+		size_t UsedBytes() const
+		{
+			size_t Ret = 0;
+			for (Chunk* It = m_First; It && It != m_Current; It = It->Next)
+			{
+				Ret += It->Size;
+			}
+			return m_Current ? Ret + (m_Cursor - m_Current->Begin()) : 0;
+		}
+		size_t ReservedBytes() const
+		{
+			size_t Ret = 0;
+			for (Chunk* It = m_First; It; It = It->Next)
+			{
+				Ret += It->Size;
+			}
+			return Ret;
+		}
+	};
+
+	// rewind arena to the construct point when leave the scope
+	class ArenaScope
+	{
+		ArenaAllocator&			m_Arena;
+		ArenaAllocator::Mark	m_Mark;
+	public:
+		FORCEINLINE ArenaScope(ArenaAllocator& InArena)
+			: m_Arena(InArena)
+			, m_Mark(InArena.GetMark())
+		{}
+		ArenaScope(const ArenaScope&) = delete;
+		ArenaScope& operator=(const ArenaScope&) = delete;
+		FORCEINLINE ~ArenaScope() { m_Arena.Rewind(m_Mark); }
+	};
+}
@@ -5,8 +5,7 @@
 #include <Misc/Assert.h>
 #include <Math/MathUtility.h>
 
-#include <corecrt_malloc.h>
-#include <vcruntime_string.h>
+#include <cstring>
 
 // Move,Copy... 
 namespace Fuko
@@ -19,12 +18,29 @@ namespace Fuko
 		B = Tmp;
 	}
 	CORE_API void MemswapGreaterThan8(void* Ptr1, void* Ptr2, size_t Size);
-	
-	FORCEINLINE void* Memmove(void* Dest, const void* Src, size_t Count) { return memmove(Dest, Src, Count); } 
+
+	// copy or zero bigger than the last level cache bypass it with non-temporal store, so the cache is not flushed by data never read again
+	// below MemStreamMinSize the crt is always used, the check stay inline
+	inline constexpr size_t MemStreamMinSize = 1024 * 1024;
+	CORE_API void* MemcpyLarge(void* Dest, const void* Src, size_t Count);
+	CORE_API void* MemzeroLarge(void* Dest, size_t Count);
+
+	// always use non-temporal store, for buffers the caller know won't be read soon
+	CORE_API void* MemcpyStream(void* Dest, const void* Src, size_t Count);
+	CORE_API void* MemzeroStream(void* Dest, size_t Count);
+
+	// size from which Memcpy/Memzero stream, default is the last level cache size, 0 means detect again
+	CORE_API size_t GetMemStreamThreshold();
+	CORE_API void SetMemStreamThreshold(size_t Threshold);
+
+	// instruction set picked by runtime dispatch: "avx2", "sse2" or "scalar"
+	CORE_API const char* GetMemOpsIsa();
+
+	FORCEINLINE void* Memmove(void* Dest, const void* Src, size_t Count) { return memmove(Dest, Src, Count); }
 	FORCEINLINE int32_t Memcmp(const void* Buf1, const void* Buf2, size_t Count) { return memcmp(Buf1, Buf2, Count); }
 	FORCEINLINE void* Memset(void* Dest, uint8 Char, size_t Count) { return memset(Dest, Char, Count); }
-	FORCEINLINE void* Memzero(void* Dest, size_t Count) { return memset(Dest, 0, Count); }
-	FORCEINLINE void* Memcpy(void* Dest, const void* Src, size_t Count) { return memcpy(Dest, Src, Count); }
+	FORCEINLINE void* Memzero(void* Dest, size_t Count) { return Count < MemStreamMinSize ? memset(Dest, 0, Count) : MemzeroLarge(Dest, Count); }
+	FORCEINLINE void* Memcpy(void* Dest, const void* Src, size_t Count) { return Count < MemStreamMinSize ? memcpy(Dest, Src, Count) : MemcpyLarge(Dest, Src, Count); }
 	FORCEINLINE void Memswap(void* Ptr1, void* Ptr2, size_t Size)
 	{
 		switch (Size)
@@ -229,7 +245,7 @@ namespace Fuko
 	template <typename ElementType>
 	void MoveAssignItems(ElementType* Dest, const ElementType* Source, size_t Count)
 	{
-		if constexpr (std::is_trivially_move_assignable<ElementType>)
+		if constexpr (std::is_trivially_move_assignable_v<ElementType>)
 		{
 			Memmove(Dest, Source, sizeof(ElementType) * Count);
 		}
@@ -36,6 +36,22 @@ namespace Fuko
 	};
 }
 
+// Heap malloc 
+namespace Fuko
+{
+	// aligned malloc of the platform heap, a block must be reallocated and sized with the alignment it was allocated with 
+	// posix: realloc grow in place when it can, glibc move blocks above its mmap threshold by mremap without copy 
+	CORE_API void*	HeapMAlloc(size_t InSize, size_t InAlign);
+	CORE_API void*	HeapRealloc(void* Ptr, size_t InSize, size_t InAlign);
+	CORE_API void	HeapFree(void* Ptr);
+
+	// usable size, may be larger than requested 
+	CORE_API size_t	HeapMSize(void* Ptr, size_t InAlign);
+
+	// give free heap memory back to os 
+	CORE_API void	HeapTrim();
+}
+
 // Heap allocator
 namespace Fuko
 {
@@ -50,7 +66,7 @@ namespace Fuko
 		void* Alloc(size_t InSize, size_t Alignment) override
 		{
 			if (InSize != 0) ++m_Count;
-			return _aligned_malloc(InSize, Alignment);
+			return HeapMAlloc(InSize, Alignment);
 		}
 		void* Realloc(void* InPtr, size_t InSize, size_t Alignment) override
 		{
@@ -58,19 +74,22 @@ namespace Fuko
 				++m_Count;
 			else if (InPtr != nullptr && InSize == 0)
 				--m_Count;
-			return _aligned_realloc(InPtr, InSize, Alignment);
+			return HeapRealloc(InPtr, InSize, Alignment);
 		}
 		void Free(void* InPtr) override
 		{
 			if (InPtr != nullptr)
 				--m_Count;
-			return _aligned_free(InPtr);
+			return HeapFree(InPtr);
 		}
 		size_t Size(void* Ptr, size_t Alignment) override
 		{
-			return _aligned_msize(Ptr, Alignment, 0);
+			return HeapMSize(Ptr, Alignment);
+		}
+		void Trim() override
+		{
+			HeapTrim();
 		}
-		void Trim() override {}
 	};
 }
 
@@ -79,6 +98,10 @@ namespace Fuko
 {
 	CORE_API IAllocator* DefaultAllocator();
 
+	// replace the default allocator, nullptr restore the heap allocator
+	// memory allocated before must still be freed by the new one, so it's used to install a wrapper like ProfilingAllocator
+	CORE_API void SetDefaultAllocator(IAllocator* InAllocator);
+
 	// Default malloc 
 	FORCEINLINE void*	MAlloc(size_t InSize, size_t InAlign) { return DefaultAllocator()->Alloc(InSize, InAlign); }
 	FORCEINLINE void*	Realloc(void* Ptr, size_t InSize, size_t InAlign) { return DefaultAllocator()->Realloc(Ptr, InSize, InAlign); }
@@ -90,4 +113,44 @@ namespace Fuko
 	CORE_API void*	PoolRealloc(void* Ptr, size_t InSize, size_t InAlign);
 	CORE_API void	PoolFree(void* Ptr);
 	CORE_API size_t PoolMSize(void* Ptr); 
+
+	// the pool as IAllocator, never routed by SetPoolAllocator
+	CORE_API IAllocator* PoolAllocator();
+
+	// route pool entry points to InAllocator, nullptr restore, same rule as SetDefaultAllocator
+	CORE_API void SetPoolAllocator(IAllocator* InAllocator);
+}
+
+// Pool statistics 
+namespace Fuko
+{
+	struct PoolClassStats
+	{
+		size_t	BlockSize;		// block size of the class 
+		size_t	SlabBytes;		// bytes reserved from os for slabs 
+		size_t	SpareBytes;		// released slabs kept decommitted for reuse 
+		size_t	UsedBlocks;		// blocks handed out, include blocks cached by threads 
+		size_t	FreeBlocks;		// blocks left in slabs 
+		uint64	AllocCount;		// allocations served, thread caches report at refill 
+		uint64	RequestBytes;	// bytes requested by those allocations 
+	};
+
+	struct PoolStats
+	{
+		static constexpr uint32 MaxClassNum = 64;
+
+		PoolClassStats	Classes[MaxClassNum];
+		uint32			ClassNum;
+		size_t			LargeBytes;		// live bytes above the slab tier 
+		size_t			LargeCount;		// live allocations above the slab tier 
+	};
+
+	CORE_API void	PoolGetStats(PoolStats& OutStats);
+
+	// print per class fragmentation to stdout 
+	CORE_API void	PoolDumpStats();
+
+	// give fully free slabs back to os and trim the heap under large blocks, return slab bytes released 
+	// classes also trim themselves when free blocks pile up, this one flushes the caller's thread cache first 
+	CORE_API size_t	PoolTrim();
 }
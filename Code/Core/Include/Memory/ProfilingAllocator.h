@@ -0,0 +1,161 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Misc/Assert.h>
+#include <Memory/MemoryPolicy.h>
+
+// allocation tag
+namespace Fuko
+{
+	// tag of the current thread, ProfilingAllocator group allocations by it, must be a string literal or live forever
+	CORE_API const char*	GetAllocTag();
+	CORE_API const char*	SetAllocTag(const char* InTag);
+
+	// set tag for allocations in the scope
+	class AllocTagScope
+	{
+		const char*	m_LastTag;
+	public:
+		FORCEINLINE AllocTagScope(const char* InTag) : m_LastTag(SetAllocTag(InTag)) {}
+		AllocTagScope(const AllocTagScope&) = delete;
+		AllocTagScope& operator=(const AllocTagScope&) = delete;
+		FORCEINLINE ~AllocTagScope() { SetAllocTag(m_LastTag); }
+	};
+}
+
+// profiling allocator
+namespace Fuko
+{
+	struct AllocProfilerState;
+
+	// how ProfilingAllocator group allocations
+	enum class EAllocProfileKey : uint8
+	{
+		Tag,		// by AllocTagScope of the allocating thread
+		Callsite,	// by return address of Alloc/Realloc
+	};
+
+	struct AllocSiteStats
+	{
+		static constexpr uint32 SizeBucketNum = 32;		// bucket i counts request sizes in [2^i, 2^(i+1))
+		static constexpr uint32 LifetimeBucketNum = 10;	// bucket i counts lifetimes under 10^(i+2) ns, the last one is the rest
+
+		const char*	Tag;
+		const void*	Callsite;			// nullptr in tag mode
+		uint64		AllocCount;
+		uint64		FreeCount;
+		uint64		ReallocCount;
+		uint64		AllocBytes;			// bytes requested in total, realloc count the grown part
+		int64		LiveCount;			// signed, a free may be merged before its alloc from another thread
+		int64		LiveBytes;
+		int64		PeakBytes;			// peak of LiveBytes
+		uint64		TotalLifetime;		// ns, sum over freed allocations
+		uint64		SizeHistogram[SizeBucketNum];
+		uint64		LifetimeHistogram[LifetimeBucketNum];
+	};
+
+	// wrap another allocator and record who allocates what
+	// events are batched in thread local buffers and merged on flush or report, so peaks are counted per batch
+	// pointers unknown to the profiler are passed through, so it can wrap an allocator already in use:
+	//     ProfilingAllocator Profiler(DefaultAllocator());	SetDefaultAllocator(&Profiler);
+	//     ProfilingAllocator Profiler(PoolAllocator());		SetPoolAllocator(&Profiler);
+	class CORE_API ProfilingAllocator : public IAllocator
+	{
+		IAllocator*			m_Inner;
+		AllocProfilerState*	m_State;
+		EAllocProfileKey	m_KeyMode;
+
+		//====================================Begin help function====================================
+		void _OnAlloc(void* Ptr, size_t InSize, const void* Callsite);
+		void _OnFree(void* Ptr);
+		//=====================================End help function=====================================
+	public:
+		static constexpr uint32 MaxSiteNum = 1024;
+
+		ProfilingAllocator(IAllocator* Inner = DefaultAllocator(), EAllocProfileKey KeyMode = EAllocProfileKey::Tag);
+		ProfilingAllocator(const ProfilingAllocator&) = delete;
+		ProfilingAllocator& operator=(const ProfilingAllocator&) = delete;
+		~ProfilingAllocator();
+
+		// IAllocator
+		void*	Alloc(size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void*	Realloc(void* InPtr, size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void	Free(void* InPtr) override;
+		size_t	Size(void* Ptr, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void	Trim() override;
+
+		FORCEINLINE IAllocator* GetInner() const { return m_Inner; }
+
+		// merge all thread buffers, then copy stats, return number of sites
+		uint32	GetSiteStats(AllocSiteStats* OutStats, uint32 MaxNum);
+		int64	GetLiveBytes();
+		int64	GetPeakBytes();
+
+		// print sites sorted by peak to stdout
+		void	DumpReport();
+
+		// one row per site, histogram buckets as columns
+		bool	ExportCSV(const char* Path);
+	};
+}
+
+// heap sampling
+namespace Fuko
+{
+	// mean bytes between two samples
+	inline constexpr size_t DefaultHeapSampleInterval = 512 * 1024;
+
+	// live sampled memory of one stack, estimates scale each sample by the chance it had to be sampled
+	struct HeapSampleStack
+	{
+		static constexpr uint32 MaxDepth = 32;
+
+		const void*	Frames[MaxDepth];	// innermost first, empty for the overflow stack
+		uint32		Depth;
+		uint64		SampleCount;		// live samples
+		uint64		SampleBytes;		// requested bytes of live samples
+		uint64		EstimatedCount;		// live allocations
+		uint64		EstimatedBytes;		// live bytes
+		uint64		OldestAge;			// ns since the oldest live sample was allocated
+	};
+
+	// wrap another allocator and keep a stack trace of about one allocation per sample interval bytes until it's freed
+	// the sample point is drawn from a poisson process over allocated bytes, so every byte has the same chance
+	// unsampled allocation only pay a thread local subtraction, unsampled free a filter lookup
+	// all sampling allocators share one set of samples, started and stopped by StartHeapSampling/StopHeapSampling
+	class CORE_API SamplingAllocator : public IAllocator
+	{
+		IAllocator*	m_Inner;
+
+		//====================================Begin help function====================================
+		void _OnSample(void* Ptr, size_t InSize);
+		void _OnSampledFree(void* Ptr);
+		//=====================================End help function=====================================
+	public:
+		SamplingAllocator(IAllocator* Inner = DefaultAllocator());
+		SamplingAllocator(const SamplingAllocator&) = delete;
+		SamplingAllocator& operator=(const SamplingAllocator&) = delete;
+
+		// IAllocator
+		void*	Alloc(size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void*	Realloc(void* InPtr, size_t InSize, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void	Free(void* InPtr) override;
+		size_t	Size(void* Ptr, size_t Alignment = DEFAULT_ALIGNMENT) override;
+		void	Trim() override;
+
+		FORCEINLINE IAllocator* GetInner() const { return m_Inner; }
+		FORCEINLINE void SetInner(IAllocator* Inner) { m_Inner = Inner; }
+	};
+
+	// route MAlloc/Realloc and pool entry points through sampling allocators, call again to change the interval
+	// the pool route is replaced, stop set it back to nullptr and the default allocator back to the one wrapped
+	CORE_API void	StartHeapSampling(size_t SampleInterval = DefaultHeapSampleInterval);
+	CORE_API void	StopHeapSampling();
+	CORE_API bool	IsHeapSampling();
+
+	// live samples grouped by stack, sorted by estimated bytes, return number of stacks
+	CORE_API uint32	GetHeapSampleSnapshot(HeapSampleStack* OutStacks, uint32 MaxNum);
+
+	// print the snapshot to stdout, frames as addresses
+	CORE_API void	DumpHeapSampleSnapshot(uint32 MaxStackNum = 20);
+}
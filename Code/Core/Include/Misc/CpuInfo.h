@@ -0,0 +1,35 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+
+// isa
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+// compile a function for an isa the whole target is not built with, call it only after GetCpuInfo() says so
+#if defined(_MSC_VER)
+#define CPU_TARGET(Isa)
+#else
+#define CPU_TARGET(Isa) __attribute__((target(Isa)))
+#endif
+
+// cpu information, detected once
+namespace Fuko
+{
+	struct CpuInfo
+	{
+		bool	SSE2;
+		bool	SSE42;
+		bool	POPCNT;
+		bool	PCLMUL;
+		bool	AVX2;		// include os support of ymm state
+		bool	BMI1;
+		bool	BMI2;
+		size_t	LastLevelCacheSize;
+	};
+
+	CORE_API const CpuInfo& GetCpuInfo();
+}
@@ -158,8 +158,15 @@ namespace Fuko::Crc
 // CRC Func
 namespace Fuko::Crc
 {
+	// crc32 of the 0x04c11db7 polynomial (zlib, png), pclmulqdq folding when the cpu has it, the same result as the tables
 	uint32 CORE_API MemCrc32(const void* Data, int32 Length, uint32 CRC = 0);
 
+	// crc32c of the castagnoli polynomial (iscsi, ext4), sse4.2 crc32 instruction when the cpu has it
+	uint32 CORE_API MemCrc32C(const void* Data, int32 Length, uint32 CRC = 0);
+
+	// instruction set picked by runtime dispatch: "pclmul", "sse4.2" or "table"
+	CORE_API const char* GetCrcIsa();
+
 	template <typename T>
 	uint32 TypeCrc32(const T& Data, uint32 CRC = 0) { return MemCrc32(&Data, sizeof(T), CRC); }
 
@@ -0,0 +1,89 @@
+#pragma once
+#include "CoreType.h"
+#include "CoreConfig.h"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// hash constants
+namespace Fuko
+{
+	// wyhash secret, odd and with balanced bits
+	inline constexpr uint64 HashSecret[4] =
+	{
+		0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+	};
+}
+
+// mix functions
+namespace Fuko
+{
+	// full 64x64->128 multiply
+	FORCEINLINE void Mul128(uint64 A, uint64 B, uint64& OutLo, uint64& OutHi)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		OutLo = _umul128(A, B, &OutHi);
+#elif defined(__SIZEOF_INT128__)
+		__uint128_t R = (__uint128_t)A * B;
+		OutLo = (uint64)R;
+		OutHi = (uint64)(R >> 64);
+#else
+		uint64 Ha = A >> 32, Hb = B >> 32, La = (uint32)A, Lb = (uint32)B;
+		uint64 RHH = Ha * Hb, RHL = Ha * Lb, RLH = La * Hb, RLL = La * Lb;
+		uint64 T = RLL + (RHL << 32);
+		uint64 Carry = T < RLL;
+		OutLo = T + (RLH << 32);
+		Carry += OutLo < T;
+		OutHi = RHH + (RHL >> 32) + (RLH >> 32) + Carry;
+#endif
+	}
+
+	// multiply and fold the two halves, the core step of wyhash
+	FORCEINLINE uint64 MulFold64(uint64 A, uint64 B)
+	{
+		uint64 Lo, Hi;
+		Mul128(A, B, Lo, Hi);
+		return Lo ^ Hi;
+	}
+
+	// bijective 64 bit mixer (murmur3 finalizer), every input bit reach every output bit
+	FORCEINLINE constexpr uint64 MixHash64(uint64 Key)
+	{
+		Key ^= Key >> 33;
+		Key *= 0xff51afd7ed558ccdull;
+		Key ^= Key >> 33;
+		Key *= 0xc4ceb9fe1a85ec53ull;
+		Key ^= Key >> 33;
+		return Key;
+	}
+	// low bits are as good as high bits, fit for Hash & (Size - 1)
+	FORCEINLINE constexpr uint32 MixHash32(uint64 Key) { return (uint32)MixHash64(Key); }
+}
+
+// memory hash
+namespace Fuko
+{
+	// wyhash below 256 bytes, an xxh3 style striped accumulator over sse2/avx2 above
+	// result is the same for every instruction set, but it is not stable across versions, never persist it
+	CORE_API uint64 MemHash64(const void* Data, size_t Length, uint64 Seed = 0);
+
+	template <typename T>
+	FORCEINLINE uint64 TypeHash64(const T& Data, uint64 Seed = 0) { return MemHash64(&Data, sizeof(T), Seed); }
+
+	// string hash over MemHash64, a faster replacement of Crc::StrCrc32 for hash tables
+	template <typename CharType>
+	FORCEINLINE uint32 StrHash(const CharType* Data, size_t Length, uint64 Seed = 0)
+	{
+		return (uint32)MemHash64(Data, Length * sizeof(CharType), Seed);
+	}
+	template <typename CharType>
+	FORCEINLINE uint32 StrHash(const CharType* Data)
+	{
+		const CharType* End = Data;
+		while (*End) ++End;
+		return StrHash(Data, (size_t)(End - Data));
+	}
+
+	// instruction set picked by runtime dispatch for long input: "avx2", "sse2" or "scalar"
+	CORE_API const char* GetHashIsa();
+}
@@ -115,10 +115,16 @@ namespace Fuko
 	template<typename T, typename TAlloc = BlockAlloc>
 	class TString
 	{
-		using StringSP = TStringSP<T, TAlloc>;
+		using AllocType = typename TElementAlloc<TAlloc, T>::Type;
+		using StringSP = TStringSP<T, AllocType>;
+		struct EmptySP {};
 
-		TAlloc		m_Alloc;
+		// with inline storage, characters may live inside this string, so it is never shared and keeps its SP inside too
+		static constexpr bool bInlineStorage = THasInlineStorage<AllocType>::Value;
+
+		AllocType	m_Alloc;
 		StringSP*	m_StrSP;
+		std::conditional_t<bInlineStorage, StringSP, EmptySP>	m_LocalSP;
 
 		using SizeType = typename TAlloc::SizeType;
 		using CString = TCString<T>;
@@ -128,8 +134,9 @@ namespace Fuko
 			if (m_StrSP && m_StrSP->Release())
 			{
 				m_StrSP->Free(m_Alloc);
-				m_Alloc.Free(m_StrSP);
+				if constexpr (!bInlineStorage) m_Alloc.Free(m_StrSP);
 			}
+			m_StrSP = nullptr;
 		}
 		void _Detach()
 		{
@@ -156,7 +163,10 @@ namespace Fuko
 		{
 			if (!m_StrSP)
 			{
-				m_Alloc.Reserve(m_StrSP, 1);
+				if constexpr (bInlineStorage)
+					m_StrSP = &m_LocalSP;
+				else
+					m_Alloc.Reserve(m_StrSP, 1);
 				new(m_StrSP)StringSP();
 				m_StrSP->Retain();
 			}
@@ -220,34 +230,51 @@ namespace Fuko
 		// copy construct
 		FORCEINLINE TString(const TString& InStr, const TAlloc& Alloc = TAlloc())
 			: m_Alloc(Alloc)
-			, m_StrSP(InStr.m_StrSP)
+			, m_StrSP(nullptr)
 		{
-			if (m_StrSP) m_StrSP->Retain();
+			*this = InStr;
 		}
 
 		// move construct 
 		FORCEINLINE TString(TString&& InStr)
 			: m_Alloc(InStr.m_Alloc)
-			, m_StrSP(InStr.m_StrSP)
+			, m_StrSP(nullptr)
 		{
-			InStr.m_StrSP = nullptr;
+			*this = std::move(InStr);
 		}
 
 		// copy assign 
 		FORCEINLINE TString& operator=(const TString& InStr)
 		{
+			if (this == &InStr) return *this;
 			_Free();
-			m_StrSP = InStr.m_StrSP;
-			if (m_StrSP) m_StrSP->Retain();
+			if constexpr (bInlineStorage)
+			{
+				if (InStr.Len()) Append(InStr.GetData(), InStr.Len());
+			}
+			else
+			{
+				m_StrSP = InStr.m_StrSP;
+				if (m_StrSP) m_StrSP->Retain();
+			}
 			return *this;
 		}
 
 		// move assign 
 		FORCEINLINE TString& operator=(TString&& InStr)
 		{
+			if (this == &InStr) return *this;
 			_Free();
-			m_StrSP = InStr.m_StrSP;
-			InStr.m_StrSP = nullptr;
+			if constexpr (bInlineStorage)
+			{
+				if (InStr.Len()) Append(InStr.GetData(), InStr.Len());
+				InStr._Free();
+			}
+			else
+			{
+				m_StrSP = InStr.m_StrSP;
+				InStr.m_StrSP = nullptr;
+			}
 			return *this;
 		}
 
@@ -619,4 +646,10 @@ namespace Fuko
 		auto Data = Str.GetData();
 		return Data ? Crc::StrCrc32(Data) : 0;
 	}
+	template<typename T,typename TAlloc>
+	uint32 GetMixedTypeHash(const TString<T, TAlloc>& Str)
+	{
+		auto Data = Str.GetData();
+		return Data ? StrHash(Data, (size_t)Str.Len()) : 0;
+	}
 }
@@ -4,6 +4,7 @@
 #include "TypeTraits.h"
 #include "UtilityTemp.h"
 #include "Misc/Crc.h"
+#include "Misc/Hash.h"
 
 namespace Fuko
 {
@@ -65,3 +66,65 @@ namespace Fuko
 		}
 	}
 }
+
+// mixed hash
+namespace Fuko
+{
+	// GetTypeHash run through a strong mixer, integers and pointers keep all 64 bits, strings use StrHash instead of crc
+	// overload it for a type that can hash better than mixing its GetTypeHash
+	template <typename T>
+	FORCEINLINE uint32 GetMixedTypeHash(const T& Key)
+	{
+		if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+		{
+			return MixHash32((uint64)Key);
+		}
+		else if constexpr (std::is_same_v<T, float>)
+		{
+			return MixHash32(*(const uint32*)&Key);
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			return MixHash32(*(const uint64*)&Key);
+		}
+		else
+		{
+			return MixHash32(GetTypeHash(Key));
+		}
+	}
+	// typed pointers hash their address, character pointers are strings like the overloads below
+	template <typename T>
+	FORCEINLINE uint32 GetMixedTypeHash(T* Ptr)
+	{
+		if constexpr (std::is_same_v<std::remove_cv_t<T>, ANSICHAR> || std::is_same_v<std::remove_cv_t<T>, WIDECHAR>)
+		{
+			return StrHash(Ptr);
+		}
+		else
+		{
+			return MixHash32((uint64)(size_t)Ptr);
+		}
+	}
+	FORCEINLINE uint32 GetMixedTypeHash(const void* A) { return MixHash32((uint64)(size_t)A); }
+	FORCEINLINE uint32 GetMixedTypeHash(void* A) { return MixHash32((uint64)(size_t)A); }
+	FORCEINLINE uint32 GetMixedTypeHash(const ANSICHAR* S) { return StrHash(S); }
+	FORCEINLINE uint32 GetMixedTypeHash(const WIDECHAR* S) { return StrHash(S); }
+}
+
+// hash policy of DefaultKeyFuncs/TDefaultMapKeyFuncs
+namespace Fuko
+{
+	// GetTypeHash as is, integers hash to themselves, cheapest when keys are already random
+	struct TypeHashPolicy
+	{
+		template <typename T>
+		static FORCEINLINE uint32 Hash(const T& Key) { return GetTypeHash(Key); }
+	};
+
+	// GetMixedTypeHash, for strided ids, aligned pointers and strings
+	struct MixHashPolicy
+	{
+		template <typename T>
+		static FORCEINLINE uint32 Hash(const T& Key) { return GetMixedTypeHash(Key); }
+	};
+}
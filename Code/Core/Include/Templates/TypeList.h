@@ -28,6 +28,15 @@ namespace Fuko
 	template<typename T, typename TList>
 	inline constexpr bool TContainType_v = TContainType<T, TList>::Value;
 
+	template<typename T, typename TList>
+	struct TTypeIndex;
+	template<typename T, typename...Ts>
+	struct TTypeIndex<T, TypeList<T, Ts...>> { static constexpr int Value = 0; };
+	template<typename T, typename U, typename...Ts>
+	struct TTypeIndex<T, TypeList<U, Ts...>> { static constexpr int Value = 1 + TTypeIndex<T, TypeList<Ts...>>::Value; };
+	template<typename T, typename TList>
+	inline constexpr int TTypeIndex_v = TTypeIndex<T, TList>::Value;
+
 	template<int N,typename TList>
 	struct TRightTypes;
 	template<int N, typename T, typename...Ts>
@@ -0,0 +1,314 @@
+#include <Algo/Container/BitArray.h>
+#include <Misc/CpuInfo.h>
+#include <atomic>
+#include <cstring>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+// kernels
+namespace Fuko::Algo
+{
+	using BitwiseFunc = void(*)(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op);
+	using CountWordsFunc = size_t(*)(const uint32* Data, size_t NumWords);
+	using FindWordFunc = size_t(*)(const uint32* Data, size_t NumWords, uint32 SkipWord);
+
+	//====================================Begin help function====================================
+	static FORCEINLINE uint64 _Read64(const uint32* P) { uint64 V; memcpy(&V, P, 8); return V; }
+	static FORCEINLINE void _Write64(uint32* P, uint64 V) { memcpy(P, &V, 8); }
+
+	template<EBitwiseOp Op, typename T>
+	static FORCEINLINE T _Apply(T A, T B)
+	{
+		if constexpr (Op == EBitwiseOp::And) return A & B;
+		else if constexpr (Op == EBitwiseOp::Or) return A | B;
+		else if constexpr (Op == EBitwiseOp::Xor) return A ^ B;
+		else return A & ~B;
+	}
+
+	// 64 bit words, the odd word left is done alone
+	template<EBitwiseOp Op>
+	static FORCEINLINE void _BitwiseScalarOp(uint32* Dst, const uint32* Src, size_t NumWords)
+	{
+		size_t i = 0;
+		for (; i + 2 <= NumWords; i += 2) _Write64(Dst + i, _Apply<Op>(_Read64(Dst + i), _Read64(Src + i)));
+		if (i < NumWords) Dst[i] = _Apply<Op>(Dst[i], Src[i]);
+	}
+	static void _BitwiseScalar(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op)
+	{
+		switch (Op)
+		{
+		case EBitwiseOp::And: _BitwiseScalarOp<EBitwiseOp::And>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Or: _BitwiseScalarOp<EBitwiseOp::Or>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Xor: _BitwiseScalarOp<EBitwiseOp::Xor>(Dst, Src, NumWords); break;
+		case EBitwiseOp::AndNot: _BitwiseScalarOp<EBitwiseOp::AndNot>(Dst, Src, NumWords); break;
+		}
+	}
+	static size_t _CountWordsScalar(const uint32* Data, size_t NumWords)
+	{
+		size_t Count = 0;
+		size_t i = 0;
+		for (; i + 2 <= NumWords; i += 2) Count += Math::CountBits(_Read64(Data + i));
+		if (i < NumWords) Count += Math::CountBits((uint64)Data[i]);
+		return Count;
+	}
+	static size_t _FindWordScalar(const uint32* Data, size_t NumWords, uint32 SkipWord)
+	{
+		const uint64 Skip64 = ((uint64)SkipWord << 32) | SkipWord;
+		size_t i = 0;
+		for (; i + 2 <= NumWords; i += 2)
+		{
+			if (_Read64(Data + i) != Skip64) return Data[i] != SkipWord ? i : i + 1;
+		}
+		if (i < NumWords && Data[i] != SkipWord) return i;
+		return NumWords;
+	}
+
+#if CPU_X86
+	template<EBitwiseOp Op>
+	static FORCEINLINE __m128i _ApplySSE2(__m128i A, __m128i B)
+	{
+		if constexpr (Op == EBitwiseOp::And) return _mm_and_si128(A, B);
+		else if constexpr (Op == EBitwiseOp::Or) return _mm_or_si128(A, B);
+		else if constexpr (Op == EBitwiseOp::Xor) return _mm_xor_si128(A, B);
+		else return _mm_andnot_si128(B, A);
+	}
+	template<EBitwiseOp Op>
+	static FORCEINLINE void _BitwiseSSE2Op(uint32* Dst, const uint32* Src, size_t NumWords)
+	{
+		size_t i = 0;
+		for (; i + 8 <= NumWords; i += 8)
+		{
+			__m128i A0 = _mm_loadu_si128((const __m128i*)(Dst + i));
+			__m128i A1 = _mm_loadu_si128((const __m128i*)(Dst + i + 4));
+			__m128i B0 = _mm_loadu_si128((const __m128i*)(Src + i));
+			__m128i B1 = _mm_loadu_si128((const __m128i*)(Src + i + 4));
+			_mm_storeu_si128((__m128i*)(Dst + i), _ApplySSE2<Op>(A0, B0));
+			_mm_storeu_si128((__m128i*)(Dst + i + 4), _ApplySSE2<Op>(A1, B1));
+		}
+		_BitwiseScalarOp<Op>(Dst + i, Src + i, NumWords - i);
+	}
+	static void _BitwiseSSE2(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op)
+	{
+		switch (Op)
+		{
+		case EBitwiseOp::And: _BitwiseSSE2Op<EBitwiseOp::And>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Or: _BitwiseSSE2Op<EBitwiseOp::Or>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Xor: _BitwiseSSE2Op<EBitwiseOp::Xor>(Dst, Src, NumWords); break;
+		case EBitwiseOp::AndNot: _BitwiseSSE2Op<EBitwiseOp::AndNot>(Dst, Src, NumWords); break;
+		}
+	}
+	static size_t _FindWordSSE2(const uint32* Data, size_t NumWords, uint32 SkipWord)
+	{
+		const __m128i Skip = _mm_set1_epi32((int32)SkipWord);
+		size_t i = 0;
+		for (; i + 8 <= NumWords; i += 8)
+		{
+			__m128i E0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(Data + i)), Skip);
+			__m128i E1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(Data + i + 4)), Skip);
+			uint32 Mask = (uint32)_mm_movemask_ps(_mm_castsi128_ps(E0)) | ((uint32)_mm_movemask_ps(_mm_castsi128_ps(E1)) << 4);
+			if (Mask != 0xff) return i + Math::CountTrailingZeros(~Mask);
+		}
+		return i + _FindWordScalar(Data + i, NumWords - i, SkipWord);
+	}
+	CPU_TARGET("popcnt") static size_t _CountWordsPOPCNT(const uint32* Data, size_t NumWords)
+	{
+		// four chains, so popcnt latency is hidden
+		uint64 C0 = 0, C1 = 0, C2 = 0, C3 = 0;
+		size_t i = 0;
+		for (; i + 8 <= NumWords; i += 8)
+		{
+			C0 += _mm_popcnt_u64(_Read64(Data + i));
+			C1 += _mm_popcnt_u64(_Read64(Data + i + 2));
+			C2 += _mm_popcnt_u64(_Read64(Data + i + 4));
+			C3 += _mm_popcnt_u64(_Read64(Data + i + 6));
+		}
+		for (; i < NumWords; ++i) C0 += _mm_popcnt_u32(Data[i]);
+		return (size_t)(C0 + C1 + C2 + C3);
+	}
+
+	template<EBitwiseOp Op>
+	CPU_TARGET("avx2") static FORCEINLINE __m256i _ApplyAVX2(__m256i A, __m256i B)
+	{
+		if constexpr (Op == EBitwiseOp::And) return _mm256_and_si256(A, B);
+		else if constexpr (Op == EBitwiseOp::Or) return _mm256_or_si256(A, B);
+		else if constexpr (Op == EBitwiseOp::Xor) return _mm256_xor_si256(A, B);
+		else return _mm256_andnot_si256(B, A);
+	}
+	template<EBitwiseOp Op>
+	CPU_TARGET("avx2") static void _BitwiseAVX2Op(uint32* Dst, const uint32* Src, size_t NumWords)
+	{
+		size_t i = 0;
+		for (; i + 32 <= NumWords; i += 32)
+		{
+			__m256i A0 = _mm256_loadu_si256((const __m256i*)(Dst + i));
+			__m256i A1 = _mm256_loadu_si256((const __m256i*)(Dst + i + 8));
+			__m256i A2 = _mm256_loadu_si256((const __m256i*)(Dst + i + 16));
+			__m256i A3 = _mm256_loadu_si256((const __m256i*)(Dst + i + 24));
+			__m256i B0 = _mm256_loadu_si256((const __m256i*)(Src + i));
+			__m256i B1 = _mm256_loadu_si256((const __m256i*)(Src + i + 8));
+			__m256i B2 = _mm256_loadu_si256((const __m256i*)(Src + i + 16));
+			__m256i B3 = _mm256_loadu_si256((const __m256i*)(Src + i + 24));
+			_mm256_storeu_si256((__m256i*)(Dst + i), _ApplyAVX2<Op>(A0, B0));
+			_mm256_storeu_si256((__m256i*)(Dst + i + 8), _ApplyAVX2<Op>(A1, B1));
+			_mm256_storeu_si256((__m256i*)(Dst + i + 16), _ApplyAVX2<Op>(A2, B2));
+			_mm256_storeu_si256((__m256i*)(Dst + i + 24), _ApplyAVX2<Op>(A3, B3));
+		}
+		for (; i + 8 <= NumWords; i += 8)
+		{
+			__m256i A = _mm256_loadu_si256((const __m256i*)(Dst + i));
+			__m256i B = _mm256_loadu_si256((const __m256i*)(Src + i));
+			_mm256_storeu_si256((__m256i*)(Dst + i), _ApplyAVX2<Op>(A, B));
+		}
+		_BitwiseScalarOp<Op>(Dst + i, Src + i, NumWords - i);
+	}
+	static void _BitwiseAVX2(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op)
+	{
+		switch (Op)
+		{
+		case EBitwiseOp::And: _BitwiseAVX2Op<EBitwiseOp::And>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Or: _BitwiseAVX2Op<EBitwiseOp::Or>(Dst, Src, NumWords); break;
+		case EBitwiseOp::Xor: _BitwiseAVX2Op<EBitwiseOp::Xor>(Dst, Src, NumWords); break;
+		case EBitwiseOp::AndNot: _BitwiseAVX2Op<EBitwiseOp::AndNot>(Dst, Src, NumWords); break;
+		}
+	}
+
+	// nibble lookup with pshufb, bytes sum up in 8 bit lanes and are widened by psadbw every 16 vectors (16 * 8 < 256)
+	CPU_TARGET("avx2") static FORCEINLINE __m256i _PopcntBytesAVX2(__m256i V, __m256i Lut, __m256i Low)
+	{
+		__m256i Lo = _mm256_and_si256(V, Low);
+		__m256i Hi = _mm256_and_si256(_mm256_srli_epi16(V, 4), Low);
+		return _mm256_add_epi8(_mm256_shuffle_epi8(Lut, Lo), _mm256_shuffle_epi8(Lut, Hi));
+	}
+	CPU_TARGET("avx2,popcnt") static size_t _CountWordsAVX2(const uint32* Data, size_t NumWords)
+	{
+		const __m256i Lut = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i Low = _mm256_set1_epi8(0x0f);
+		__m256i Total = _mm256_setzero_si256();
+		size_t i = 0;
+		for (; i + 128 <= NumWords; i += 128)
+		{
+			__m256i Acc0 = _mm256_setzero_si256();
+			__m256i Acc1 = _mm256_setzero_si256();
+			__m256i Acc2 = _mm256_setzero_si256();
+			__m256i Acc3 = _mm256_setzero_si256();
+			for (size_t j = 0; j < 128; j += 32)
+			{
+				Acc0 = _mm256_add_epi8(Acc0, _PopcntBytesAVX2(_mm256_loadu_si256((const __m256i*)(Data + i + j)), Lut, Low));
+				Acc1 = _mm256_add_epi8(Acc1, _PopcntBytesAVX2(_mm256_loadu_si256((const __m256i*)(Data + i + j + 8)), Lut, Low));
+				Acc2 = _mm256_add_epi8(Acc2, _PopcntBytesAVX2(_mm256_loadu_si256((const __m256i*)(Data + i + j + 16)), Lut, Low));
+				Acc3 = _mm256_add_epi8(Acc3, _PopcntBytesAVX2(_mm256_loadu_si256((const __m256i*)(Data + i + j + 24)), Lut, Low));
+			}
+			__m256i Acc = _mm256_add_epi8(_mm256_add_epi8(Acc0, Acc1), _mm256_add_epi8(Acc2, Acc3));
+			Total = _mm256_add_epi64(Total, _mm256_sad_epu8(Acc, _mm256_setzero_si256()));
+		}
+		alignas(32) uint64 Lanes[4];
+		_mm256_store_si256((__m256i*)Lanes, Total);
+		uint64 Count = Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+		for (; i + 2 <= NumWords; i += 2) Count += _mm_popcnt_u64(_Read64(Data + i));
+		if (i < NumWords) Count += _mm_popcnt_u32(Data[i]);
+		return (size_t)Count;
+	}
+	CPU_TARGET("avx2") static size_t _FindWordAVX2(const uint32* Data, size_t NumWords, uint32 SkipWord)
+	{
+		const __m256i Skip = _mm256_set1_epi32((int32)SkipWord);
+		size_t i = 0;
+		for (; i + 16 <= NumWords; i += 16)
+		{
+			__m256i E0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(Data + i)), Skip);
+			__m256i E1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(Data + i + 8)), Skip);
+			if (!_mm256_testc_si256(_mm256_and_si256(E0, E1), _mm256_set1_epi32(-1)))
+			{
+				uint32 Mask = (uint32)_mm256_movemask_ps(_mm256_castsi256_ps(E0)) | ((uint32)_mm256_movemask_ps(_mm256_castsi256_ps(E1)) << 8);
+				return i + Math::CountTrailingZeros(~Mask);
+			}
+		}
+		return i + _FindWordScalar(Data + i, NumWords - i, SkipWord);
+	}
+#endif
+	//=====================================End help function=====================================
+}
+
+// dispatch
+namespace Fuko::Algo
+{
+	static void _BitwiseResolve(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op);
+	static size_t _CountWordsResolve(const uint32* Data, size_t NumWords);
+	static size_t _FindWordResolve(const uint32* Data, size_t NumWords, uint32 SkipWord);
+
+	// start at resolvers, so a call during static init still works, the first call pick kernels by cpu
+	static std::atomic<BitwiseFunc>		g_Bitwise = &_BitwiseResolve;
+	static std::atomic<CountWordsFunc>	g_CountWords = &_CountWordsResolve;
+	static std::atomic<FindWordFunc>	g_FindWord = &_FindWordResolve;
+	static std::atomic<const char*>		g_BitOpsIsa = nullptr;
+
+	//====================================Begin help function====================================
+	static void _ResolveBitOps()
+	{
+		BitwiseFunc Bitwise = &_BitwiseScalar;
+		CountWordsFunc Count = &_CountWordsScalar;
+		FindWordFunc Find = &_FindWordScalar;
+		const char* Isa = "scalar";
+#if CPU_X86
+		const CpuInfo& Info = GetCpuInfo();
+		if (Info.AVX2 && Info.POPCNT)
+		{
+			Bitwise = &_BitwiseAVX2;
+			Count = &_CountWordsAVX2;
+			Find = &_FindWordAVX2;
+			Isa = "avx2";
+		}
+		else if (Info.SSE2)
+		{
+			Bitwise = &_BitwiseSSE2;
+			if (Info.POPCNT) Count = &_CountWordsPOPCNT;
+			Find = &_FindWordSSE2;
+			Isa = "sse2";
+		}
+#endif
+		// every thread resolve the same value, relaxed is enough
+		g_Bitwise.store(Bitwise, std::memory_order_relaxed);
+		g_CountWords.store(Count, std::memory_order_relaxed);
+		g_FindWord.store(Find, std::memory_order_relaxed);
+		g_BitOpsIsa.store(Isa, std::memory_order_relaxed);
+	}
+	static void _BitwiseResolve(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op)
+	{
+		_ResolveBitOps();
+		g_Bitwise.load(std::memory_order_relaxed)(Dst, Src, NumWords, Op);
+	}
+	static size_t _CountWordsResolve(const uint32* Data, size_t NumWords)
+	{
+		_ResolveBitOps();
+		return g_CountWords.load(std::memory_order_relaxed)(Data, NumWords);
+	}
+	static size_t _FindWordResolve(const uint32* Data, size_t NumWords, uint32 SkipWord)
+	{
+		_ResolveBitOps();
+		return g_FindWord.load(std::memory_order_relaxed)(Data, NumWords, SkipWord);
+	}
+	//=====================================End help function=====================================
+
+	CORE_API void BitwiseWords(uint32* Dst, const uint32* Src, size_t NumWords, EBitwiseOp Op)
+	{
+		g_Bitwise.load(std::memory_order_relaxed)(Dst, Src, NumWords, Op);
+	}
+
+	CORE_API size_t CountSetBitsInWords(const uint32* Data, size_t NumWords)
+	{
+		return g_CountWords.load(std::memory_order_relaxed)(Data, NumWords);
+	}
+
+	CORE_API size_t FindWordNotEqual(const uint32* Data, size_t NumWords, uint32 SkipWord)
+	{
+		return g_FindWord.load(std::memory_order_relaxed)(Data, NumWords, SkipWord);
+	}
+
+	CORE_API const char* GetBitOpsIsa()
+	{
+		if (!g_BitOpsIsa.load(std::memory_order_relaxed)) _ResolveBitOps();
+		return g_BitOpsIsa.load(std::memory_order_relaxed);
+	}
+}
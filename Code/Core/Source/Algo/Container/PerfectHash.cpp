@@ -0,0 +1,113 @@
+#include <Algo/Container/PerfectHash.h>
+#include <Containers/Array.h>
+#include <Math/MathUtility.h>
+
+namespace Fuko::Algo
+{
+	// average keys per bucket, bigger means less pilots but a much longer search, the lookup barely change
+	inline constexpr uint32 PerfectHashBucketLoad = 4;
+	// a bucket that find no pilot restart the build with another seed
+	inline constexpr uint32 PerfectHashMaxPilot = (PerfectHashPilot)-1;
+
+	//====================================Begin help function====================================
+	static FORCEINLINE bool _TestBit(const uint64* Bits, uint32 Index) { return (Bits[Index >> 6] >> (Index & 63)) & 1; }
+	static FORCEINLINE void _SetBit(uint64* Bits, uint32 Index) { Bits[Index >> 6] |= 1ull << (Index & 63); }
+	static FORCEINLINE void _ClearBit(uint64* Bits, uint32 Index) { Bits[Index >> 6] &= ~(1ull << (Index & 63)); }
+	//=====================================End help function=====================================
+
+	PerfectHashLayout MakePerfectHashLayout(uint32 Num)
+	{
+		PerfectHashLayout Layout;
+		if (Num == 0) return Layout;
+		Layout.Num = Num;
+		// ~3% free slots, the remap array stay small and the last single key buckets still land in a few tries
+		Layout.TableSize = Num + Num / 32 + 1;
+		Layout.BucketNum = Math::Max((Num + PerfectHashBucketLoad - 1) / PerfectHashBucketLoad, 2u);
+		Layout.DenseBucketNum = Math::Clamp((uint32)((uint64)Layout.BucketNum * 3 / 10), 1u, Layout.BucketNum - 1);
+		return Layout;
+	}
+
+	bool BuildPerfectHash(const uint64* Hashes, const PerfectHashLayout& Layout, PerfectHashPilot* OutPilots, uint32* OutRemap, uint32* OutSlots)
+	{
+		const uint32 Num = Layout.Num;
+		const uint32 BucketNum = Layout.BucketNum;
+		if (Num == 0) return true;
+
+		// keys grouped by bucket, counting sort
+		TArray<uint32> BucketStart((uint32)0, BucketNum + 1);
+		for (uint32 i = 0; i < Num; ++i) ++BucketStart[Layout.Bucket(Hashes[i]) + 1];
+		uint32 MaxBucketSize = 0;
+		for (uint32 i = 0; i < BucketNum; ++i)
+		{
+			MaxBucketSize = Math::Max(MaxBucketSize, BucketStart[i + 1]);
+			BucketStart[i + 1] += BucketStart[i];
+		}
+		TArray<uint64> BucketHashes;
+		BucketHashes.SetNumUninitialized(Num);
+		{
+			TArray<uint32> Cursor(BucketStart);
+			for (uint32 i = 0; i < Num; ++i) BucketHashes[Cursor[Layout.Bucket(Hashes[i])]++] = Hashes[i];
+		}
+
+		// buckets by size, biggest first, counting sort again
+		TArray<uint32> SizeStart((uint32)0, MaxBucketSize + 2);
+		for (uint32 i = 0; i < BucketNum; ++i) ++SizeStart[MaxBucketSize - (BucketStart[i + 1] - BucketStart[i]) + 1];
+		for (uint32 i = 0; i <= MaxBucketSize; ++i) SizeStart[i + 1] += SizeStart[i];
+		TArray<uint32> BucketOrder;
+		BucketOrder.SetNumUninitialized(BucketNum);
+		for (uint32 i = 0; i < BucketNum; ++i) BucketOrder[SizeStart[MaxBucketSize - (BucketStart[i + 1] - BucketStart[i])]++] = i;
+
+		// each bucket try pilots until all its keys hit free slots, slots taken by a failed try are given back
+		TArray<uint64> Taken((uint64)0, (Layout.TableSize + 63) / 64);
+		TArray<uint32> Positions;
+		Positions.SetNumUninitialized(Math::Max(MaxBucketSize, 1u));
+		for (uint32 Bucket : BucketOrder)
+		{
+			const uint64* Keys = BucketHashes.GetData() + BucketStart[Bucket];
+			const uint32 KeyNum = BucketStart[Bucket + 1] - BucketStart[Bucket];
+			OutPilots[Bucket] = 0;
+			if (KeyNum == 0) continue;
+
+			for (uint32 Pilot = 0; ; ++Pilot)
+			{
+				if (Pilot == PerfectHashMaxPilot) return false;
+				const uint64 PilotHash = PerfectHashLayout::PilotHash(Pilot);
+				uint32 Placed = 0;
+				for (; Placed < KeyNum; ++Placed)
+				{
+					const uint32 Position = Layout.Position(Keys[Placed], PilotHash);
+					if (_TestBit(Taken.GetData(), Position)) break;
+					_SetBit(Taken.GetData(), Position);
+					Positions[Placed] = Position;
+				}
+				if (Placed == KeyNum)
+				{
+					OutPilots[Bucket] = (PerfectHashPilot)Pilot;
+					break;
+				}
+				for (uint32 i = 0; i < Placed; ++i) _ClearBit(Taken.GetData(), Positions[i]);
+			}
+		}
+
+		// taken slots past Num move to the free slots below Num, both sides have the same count
+		uint32 FreeSlot = 0;
+		for (uint32 Position = Num; Position < Layout.TableSize; ++Position)
+		{
+			if (!_TestBit(Taken.GetData(), Position))
+			{
+				OutRemap[Position - Num] = 0;
+				continue;
+			}
+			while (_TestBit(Taken.GetData(), FreeSlot)) ++FreeSlot;
+			OutRemap[Position - Num] = FreeSlot++;
+		}
+
+		for (uint32 i = 0; i < Num; ++i)
+		{
+			const uint64 Hash = Hashes[i];
+			const uint32 Position = Layout.Position(Hash, PerfectHashLayout::PilotHash(OutPilots[Layout.Bucket(Hash)]));
+			OutSlots[i] = Position < Num ? Position : OutRemap[Position - Num];
+		}
+		return true;
+	}
+}
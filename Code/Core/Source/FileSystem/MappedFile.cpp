@@ -0,0 +1,96 @@
+#include <FileSystem/MappedFile.h>
+
+#if PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Fuko
+{
+	MappedFile::MappedFile()
+		: m_Data(nullptr)
+		, m_Size(0)
+	{}
+
+	MappedFile::~MappedFile() { Close(); }
+
+	MappedFile::MappedFile(MappedFile&& Other)
+		: m_Data(Other.m_Data)
+		, m_Size(Other.m_Size)
+	{
+		Other.m_Data = nullptr;
+		Other.m_Size = 0;
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& Other)
+	{
+		if (this != &Other)
+		{
+			Close();
+			m_Data = Other.m_Data;
+			m_Size = Other.m_Size;
+			Other.m_Data = nullptr;
+			Other.m_Size = 0;
+		}
+		return *this;
+	}
+
+	bool MappedFile::Open(const char* InPath)
+	{
+		Close();
+#if PLATFORM_WINDOWS
+		wchar_t WidePath[MAX_PATH * 4];
+		if (!::MultiByteToWideChar(CP_UTF8, 0, InPath, -1, WidePath, MAX_PATH * 4)) return false;
+		HANDLE File = ::CreateFileW(WidePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE) return false;
+
+		// the view keep the mapping and the file alive, both handles can go now
+		LARGE_INTEGER Size;
+		HANDLE Mapping = nullptr;
+		if (::GetFileSizeEx(File, &Size) && Size.QuadPart > 0)
+		{
+			Mapping = ::CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		::CloseHandle(File);
+		if (!Mapping) return false;
+		m_Data = ::MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		::CloseHandle(Mapping);
+		if (!m_Data) return false;
+		m_Size = (uint64)Size.QuadPart;
+#else
+		int File = ::open(InPath, O_RDONLY | O_CLOEXEC);
+		if (File < 0) return false;
+
+		// the mapping keep the file alive, close the descriptor now
+		struct stat Stat;
+		void* Map = MAP_FAILED;
+		if (::fstat(File, &Stat) == 0 && Stat.st_size > 0)
+		{
+			Map = ::mmap(nullptr, (size_t)Stat.st_size, PROT_READ, MAP_SHARED, File, 0);
+		}
+		::close(File);
+		if (Map == MAP_FAILED) return false;
+		m_Data = Map;
+		m_Size = (uint64)Stat.st_size;
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!m_Data) return;
+#if PLATFORM_WINDOWS
+		::UnmapViewOfFile(m_Data);
+#else
+		::munmap(const_cast<void*>(m_Data), (size_t)m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+}
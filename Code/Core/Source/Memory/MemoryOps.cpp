@@ -0,0 +1,363 @@
+#include <Memory/MemoryOps.h>
+#include <Templates/Align.h>
+#include <Misc/CpuInfo.h>
+#include <atomic>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+// kernels
+namespace Fuko
+{
+	using MemswapFunc = void(*)(void*, void*, size_t);
+	using MemcpyFunc = void(*)(void*, const void*, size_t);
+	using MemzeroFunc = void(*)(void*, size_t);
+
+	// streaming kernels copy this much per loop, smaller call go to crt
+	inline constexpr size_t MemStreamBlock = 256;
+
+	//====================================Begin help function====================================
+	static void _MemswapScalar(void* Ptr1, void* Ptr2, size_t Size)
+	{
+		union PtrUnion
+		{
+			void*		PtrVoid;
+			uint8_t*	Ptr8;
+			uint16_t*	Ptr16;
+			uint32_t*	Ptr32;
+			uint64_t*	Ptr64;
+			size_t		PtrUint;
+		};
+
+		PtrUnion Union1 = { Ptr1 };
+		PtrUnion Union2 = { Ptr2 };
+
+		// 先把底部交换方便进行对齐的高速交换, 小于8字节的尾部直接逐个交换
+		if (Size > 8)
+		{
+			if (Union1.PtrUint & 1)
+			{
+				Valswap(*Union1.Ptr8++, *Union2.Ptr8++);
+				Size -= 1;
+			}
+			if (Union1.PtrUint & 2)
+			{
+				Valswap(*Union1.Ptr16++, *Union2.Ptr16++);
+				Size -= 2;
+			}
+			if (Union1.PtrUint & 4)
+			{
+				Valswap(*Union1.Ptr32++, *Union2.Ptr32++);
+				Size -= 4;
+			}
+		}
+
+		// 对齐的内存交换
+		uint32_t CommonAlignment = Math::Min(Math::CountTrailingZeros((uint32)Union1.PtrUint - (uint32)Union2.PtrUint), 3u);
+		switch (CommonAlignment)
+		{
+		default:
+			for (; Size >= 8; Size -= 8)
+			{
+				Valswap(*Union1.Ptr64++, *Union2.Ptr64++);
+			}
+
+		case 2:
+			for (; Size >= 4; Size -= 4)
+			{
+				Valswap(*Union1.Ptr32++, *Union2.Ptr32++);
+			}
+
+		case 1:
+			for (; Size >= 2; Size -= 2)
+			{
+				Valswap(*Union1.Ptr16++, *Union2.Ptr16++);
+			}
+
+		case 0:
+			for (; Size >= 1; Size -= 1)
+			{
+				Valswap(*Union1.Ptr8++, *Union2.Ptr8++);
+			}
+		}
+	}
+	static void _MemcpyCRT(void* Dest, const void* Src, size_t Count) { memcpy(Dest, Src, Count); }
+	static void _MemzeroCRT(void* Dest, size_t Count) { memset(Dest, 0, Count); }
+
+#if CPU_X86
+	static void _MemswapSSE2(void* Ptr1, void* Ptr2, size_t Size)
+	{
+		uint8* P1 = (uint8*)Ptr1;
+		uint8* P2 = (uint8*)Ptr2;
+		for (; Size >= 64; Size -= 64, P1 += 64, P2 += 64)
+		{
+			__m128i A0 = _mm_loadu_si128((const __m128i*)P1 + 0);
+			__m128i A1 = _mm_loadu_si128((const __m128i*)P1 + 1);
+			__m128i A2 = _mm_loadu_si128((const __m128i*)P1 + 2);
+			__m128i A3 = _mm_loadu_si128((const __m128i*)P1 + 3);
+			__m128i B0 = _mm_loadu_si128((const __m128i*)P2 + 0);
+			__m128i B1 = _mm_loadu_si128((const __m128i*)P2 + 1);
+			__m128i B2 = _mm_loadu_si128((const __m128i*)P2 + 2);
+			__m128i B3 = _mm_loadu_si128((const __m128i*)P2 + 3);
+			_mm_storeu_si128((__m128i*)P1 + 0, B0);
+			_mm_storeu_si128((__m128i*)P1 + 1, B1);
+			_mm_storeu_si128((__m128i*)P1 + 2, B2);
+			_mm_storeu_si128((__m128i*)P1 + 3, B3);
+			_mm_storeu_si128((__m128i*)P2 + 0, A0);
+			_mm_storeu_si128((__m128i*)P2 + 1, A1);
+			_mm_storeu_si128((__m128i*)P2 + 2, A2);
+			_mm_storeu_si128((__m128i*)P2 + 3, A3);
+		}
+		for (; Size >= 16; Size -= 16, P1 += 16, P2 += 16)
+		{
+			__m128i A = _mm_loadu_si128((const __m128i*)P1);
+			__m128i B = _mm_loadu_si128((const __m128i*)P2);
+			_mm_storeu_si128((__m128i*)P1, B);
+			_mm_storeu_si128((__m128i*)P2, A);
+		}
+		if (Size) _MemswapScalar(P1, P2, Size);
+	}
+	CPU_TARGET("avx2") static void _MemswapAVX2(void* Ptr1, void* Ptr2, size_t Size)
+	{
+		uint8* P1 = (uint8*)Ptr1;
+		uint8* P2 = (uint8*)Ptr2;
+		for (; Size >= 128; Size -= 128, P1 += 128, P2 += 128)
+		{
+			__m256i A0 = _mm256_loadu_si256((const __m256i*)P1 + 0);
+			__m256i A1 = _mm256_loadu_si256((const __m256i*)P1 + 1);
+			__m256i A2 = _mm256_loadu_si256((const __m256i*)P1 + 2);
+			__m256i A3 = _mm256_loadu_si256((const __m256i*)P1 + 3);
+			__m256i B0 = _mm256_loadu_si256((const __m256i*)P2 + 0);
+			__m256i B1 = _mm256_loadu_si256((const __m256i*)P2 + 1);
+			__m256i B2 = _mm256_loadu_si256((const __m256i*)P2 + 2);
+			__m256i B3 = _mm256_loadu_si256((const __m256i*)P2 + 3);
+			_mm256_storeu_si256((__m256i*)P1 + 0, B0);
+			_mm256_storeu_si256((__m256i*)P1 + 1, B1);
+			_mm256_storeu_si256((__m256i*)P1 + 2, B2);
+			_mm256_storeu_si256((__m256i*)P1 + 3, B3);
+			_mm256_storeu_si256((__m256i*)P2 + 0, A0);
+			_mm256_storeu_si256((__m256i*)P2 + 1, A1);
+			_mm256_storeu_si256((__m256i*)P2 + 2, A2);
+			_mm256_storeu_si256((__m256i*)P2 + 3, A3);
+		}
+		for (; Size >= 32; Size -= 32, P1 += 32, P2 += 32)
+		{
+			__m256i A = _mm256_loadu_si256((const __m256i*)P1);
+			__m256i B = _mm256_loadu_si256((const __m256i*)P2);
+			_mm256_storeu_si256((__m256i*)P1, B);
+			_mm256_storeu_si256((__m256i*)P2, A);
+		}
+		if (Size >= 16)
+		{
+			__m128i A = _mm_loadu_si128((const __m128i*)P1);
+			__m128i B = _mm_loadu_si128((const __m128i*)P2);
+			_mm_storeu_si128((__m128i*)P1, B);
+			_mm_storeu_si128((__m128i*)P2, A);
+			Size -= 16;
+			P1 += 16;
+			P2 += 16;
+		}
+		if (Size) _MemswapScalar(P1, P2, Size);
+	}
+
+	// non-temporal store need aligned destination, head and tail go through crt
+	static void _MemcpyStreamSSE2(void* Dest, const void* Src, size_t Count)
+	{
+		uint8* D = (uint8*)Dest;
+		const uint8* S = (const uint8*)Src;
+		size_t Head = Align(D, 16) - D;
+		memcpy(D, S, Head);
+		D += Head;
+		S += Head;
+		Count -= Head;
+		for (; Count >= 64; Count -= 64, D += 64, S += 64)
+		{
+			__m128i V0 = _mm_loadu_si128((const __m128i*)S + 0);
+			__m128i V1 = _mm_loadu_si128((const __m128i*)S + 1);
+			__m128i V2 = _mm_loadu_si128((const __m128i*)S + 2);
+			__m128i V3 = _mm_loadu_si128((const __m128i*)S + 3);
+			_mm_stream_si128((__m128i*)D + 0, V0);
+			_mm_stream_si128((__m128i*)D + 1, V1);
+			_mm_stream_si128((__m128i*)D + 2, V2);
+			_mm_stream_si128((__m128i*)D + 3, V3);
+		}
+		_mm_sfence();
+		memcpy(D, S, Count);
+	}
+	CPU_TARGET("avx2") static void _MemcpyStreamAVX2(void* Dest, const void* Src, size_t Count)
+	{
+		uint8* D = (uint8*)Dest;
+		const uint8* S = (const uint8*)Src;
+		size_t Head = Align(D, 32) - D;
+		memcpy(D, S, Head);
+		D += Head;
+		S += Head;
+		Count -= Head;
+		for (; Count >= 128; Count -= 128, D += 128, S += 128)
+		{
+			__m256i V0 = _mm256_loadu_si256((const __m256i*)S + 0);
+			__m256i V1 = _mm256_loadu_si256((const __m256i*)S + 1);
+			__m256i V2 = _mm256_loadu_si256((const __m256i*)S + 2);
+			__m256i V3 = _mm256_loadu_si256((const __m256i*)S + 3);
+			_mm256_stream_si256((__m256i*)D + 0, V0);
+			_mm256_stream_si256((__m256i*)D + 1, V1);
+			_mm256_stream_si256((__m256i*)D + 2, V2);
+			_mm256_stream_si256((__m256i*)D + 3, V3);
+		}
+		_mm_sfence();
+		memcpy(D, S, Count);
+	}
+	static void _MemzeroStreamSSE2(void* Dest, size_t Count)
+	{
+		uint8* D = (uint8*)Dest;
+		size_t Head = Align(D, 16) - D;
+		memset(D, 0, Head);
+		D += Head;
+		Count -= Head;
+		const __m128i Zero = _mm_setzero_si128();
+		for (; Count >= 64; Count -= 64, D += 64)
+		{
+			_mm_stream_si128((__m128i*)D + 0, Zero);
+			_mm_stream_si128((__m128i*)D + 1, Zero);
+			_mm_stream_si128((__m128i*)D + 2, Zero);
+			_mm_stream_si128((__m128i*)D + 3, Zero);
+		}
+		_mm_sfence();
+		memset(D, 0, Count);
+	}
+	CPU_TARGET("avx2") static void _MemzeroStreamAVX2(void* Dest, size_t Count)
+	{
+		uint8* D = (uint8*)Dest;
+		size_t Head = Align(D, 32) - D;
+		memset(D, 0, Head);
+		D += Head;
+		Count -= Head;
+		const __m256i Zero = _mm256_setzero_si256();
+		for (; Count >= 128; Count -= 128, D += 128)
+		{
+			_mm256_stream_si256((__m256i*)D + 0, Zero);
+			_mm256_stream_si256((__m256i*)D + 1, Zero);
+			_mm256_stream_si256((__m256i*)D + 2, Zero);
+			_mm256_stream_si256((__m256i*)D + 3, Zero);
+		}
+		_mm_sfence();
+		memset(D, 0, Count);
+	}
+#endif
+	//=====================================End help function=====================================
+}
+
+// dispatch
+namespace Fuko
+{
+	static void _MemswapResolve(void* Ptr1, void* Ptr2, size_t Size);
+	static void _MemcpyStreamResolve(void* Dest, const void* Src, size_t Count);
+	static void _MemzeroStreamResolve(void* Dest, size_t Count);
+
+	// start at resolvers, so a call during static init still works, the first call pick kernels by cpu
+	static std::atomic<MemswapFunc>	g_Memswap = &_MemswapResolve;
+	static std::atomic<MemcpyFunc>	g_MemcpyStream = &_MemcpyStreamResolve;
+	static std::atomic<MemzeroFunc>	g_MemzeroStream = &_MemzeroStreamResolve;
+	static std::atomic<const char*>	g_MemOpsIsa = nullptr;
+	static std::atomic<size_t>		g_MemStreamThreshold = 0;
+
+	//====================================Begin help function====================================
+	static void _ResolveMemOps()
+	{
+		MemswapFunc Swap = &_MemswapScalar;
+		MemcpyFunc Copy = &_MemcpyCRT;
+		MemzeroFunc Zero = &_MemzeroCRT;
+		const char* Isa = "scalar";
+#if CPU_X86
+		const CpuInfo& Info = GetCpuInfo();
+		if (Info.AVX2)
+		{
+			Swap = &_MemswapAVX2;
+			Copy = &_MemcpyStreamAVX2;
+			Zero = &_MemzeroStreamAVX2;
+			Isa = "avx2";
+		}
+		else if (Info.SSE2)
+		{
+			Swap = &_MemswapSSE2;
+			Copy = &_MemcpyStreamSSE2;
+			Zero = &_MemzeroStreamSSE2;
+			Isa = "sse2";
+		}
+#endif
+		// every thread resolve the same value, relaxed is enough
+		g_Memswap.store(Swap, std::memory_order_relaxed);
+		g_MemcpyStream.store(Copy, std::memory_order_relaxed);
+		g_MemzeroStream.store(Zero, std::memory_order_relaxed);
+		g_MemOpsIsa.store(Isa, std::memory_order_relaxed);
+	}
+	static void _MemswapResolve(void* Ptr1, void* Ptr2, size_t Size)
+	{
+		_ResolveMemOps();
+		g_Memswap.load(std::memory_order_relaxed)(Ptr1, Ptr2, Size);
+	}
+	static void _MemcpyStreamResolve(void* Dest, const void* Src, size_t Count)
+	{
+		_ResolveMemOps();
+		g_MemcpyStream.load(std::memory_order_relaxed)(Dest, Src, Count);
+	}
+	static void _MemzeroStreamResolve(void* Dest, size_t Count)
+	{
+		_ResolveMemOps();
+		g_MemzeroStream.load(std::memory_order_relaxed)(Dest, Count);
+	}
+	//=====================================End help function=====================================
+
+	CORE_API void MemswapGreaterThan8(void* Ptr1, void* Ptr2, size_t Size)
+	{
+		checkf(Ptr1 && Ptr2, TEXT("Pointers must be non-null: %p, %p"), Ptr1, Ptr2);
+		check(Size > 8);
+		g_Memswap.load(std::memory_order_relaxed)(Ptr1, Ptr2, Size);
+	}
+
+	CORE_API void* MemcpyStream(void* Dest, const void* Src, size_t Count)
+	{
+		if (Count < MemStreamBlock) return memcpy(Dest, Src, Count);
+		g_MemcpyStream.load(std::memory_order_relaxed)(Dest, Src, Count);
+		return Dest;
+	}
+
+	CORE_API void* MemzeroStream(void* Dest, size_t Count)
+	{
+		if (Count < MemStreamBlock) return memset(Dest, 0, Count);
+		g_MemzeroStream.load(std::memory_order_relaxed)(Dest, Count);
+		return Dest;
+	}
+
+	CORE_API void* MemcpyLarge(void* Dest, const void* Src, size_t Count)
+	{
+		return Count >= GetMemStreamThreshold() ? MemcpyStream(Dest, Src, Count) : memcpy(Dest, Src, Count);
+	}
+
+	CORE_API void* MemzeroLarge(void* Dest, size_t Count)
+	{
+		return Count >= GetMemStreamThreshold() ? MemzeroStream(Dest, Count) : memset(Dest, 0, Count);
+	}
+
+	CORE_API size_t GetMemStreamThreshold()
+	{
+		size_t Threshold = g_MemStreamThreshold.load(std::memory_order_relaxed);
+		if (Threshold == 0)
+		{
+			Threshold = Math::Max(GetCpuInfo().LastLevelCacheSize, MemStreamMinSize);
+			g_MemStreamThreshold.store(Threshold, std::memory_order_relaxed);
+		}
+		return Threshold;
+	}
+
+	CORE_API void SetMemStreamThreshold(size_t Threshold)
+	{
+		g_MemStreamThreshold.store(Threshold ? Math::Max(Threshold, MemStreamMinSize) : 0, std::memory_order_relaxed);
+	}
+
+	CORE_API const char* GetMemOpsIsa()
+	{
+		if (!g_MemOpsIsa.load(std::memory_order_relaxed)) _ResolveMemOps();
+		return g_MemOpsIsa.load(std::memory_order_relaxed);
+	}
+}
@@ -3,127 +3,698 @@
 #include <Misc/Assert.h>
 #include <Memory/MemoryOps.h>
 #include <Memory/MemoryPolicy.h>
-#include <Containers/Pool.h>
+#include <Containers/Array.h>
+#include <Containers/LockPolicy.h>
+#include <Algo/BinarySearch.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include "PageMap.h"
+#include "PlatformMemory.h"
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
 
 namespace Fuko
 {
+	static std::atomic<IAllocator*> g_DefaultAllocator = nullptr;
+	static std::atomic<IAllocator*> g_PoolAllocator = nullptr;
+
 	CORE_API IAllocator* DefaultAllocator()
 	{
 		static HeapAllocator s_HeapAllocator;
-		return &s_HeapAllocator;
+		IAllocator* Allocator = g_DefaultAllocator.load(std::memory_order_acquire);
+		return Allocator ? Allocator : &s_HeapAllocator;
+	}
+
+	CORE_API void SetDefaultAllocator(IAllocator* InAllocator)
+	{
+		g_DefaultAllocator.store(InAllocator, std::memory_order_release);
 	}
+}
+
+// heap 
+namespace Fuko
+{
+#if !PLATFORM_WINDOWS
+	// malloc already align to this, only stricter alignment need posix_memalign 
+	inline constexpr size_t HeapMinAlignment = alignof(std::max_align_t);
 
-	template<int InSize>
-	struct TBlock
+	//====================================Begin help function====================================
+	FORCEINLINE size_t _HeapUsableSize(void* Ptr)
+	{
+#if defined(__APPLE__)
+		return ::malloc_size(Ptr);
+#else
+		return ::malloc_usable_size(Ptr);
+#endif
+	}
+	FORCENOINLINE void* _HeapReallocAligned(void* Ptr, size_t InSize, size_t InAlign)
 	{
-		int32		Size;
-		int32		Unused1;
-		int64		Unused2;
-		TAlignedBytes<InSize, 16>	Memory;
-		TBlock()
-			: Size(InSize)
-			, Unused1(0)
-			, Unused2(0)
+		// fits the block and not waste half of it, keep it 
+		size_t Usable = _HeapUsableSize(Ptr);
+		if (InSize <= Usable && InSize * 2 >= Usable) return Ptr;
+
+		// realloc may move to a worse aligned block after it freed the old one, so move by hand 
+		// a failed alloc leave the old block untouched 
+		void* NewPtr = HeapMAlloc(InSize, InAlign);
+		if (NewPtr == nullptr) return nullptr;
+		Memcpy(NewPtr, Ptr, Math::Min(InSize, Usable));
+		::free(Ptr);
+		return NewPtr;
+	}
+	//=====================================End help function=====================================
+#endif
+
+	CORE_API void* HeapMAlloc(size_t InSize, size_t InAlign)
+	{
+#if PLATFORM_WINDOWS
+		return _aligned_malloc(InSize, InAlign);
+#else
+		if (InSize == 0) return nullptr;
+		if (InAlign <= HeapMinAlignment) return ::malloc(InSize);
+		void* Ret = nullptr;
+		return ::posix_memalign(&Ret, InAlign, InSize) == 0 ? Ret : nullptr;
+#endif
+	}
+
+	CORE_API void* HeapRealloc(void* Ptr, size_t InSize, size_t InAlign)
+	{
+#if PLATFORM_WINDOWS
+		return _aligned_realloc(Ptr, InSize, InAlign);
+#else
+		if (Ptr == nullptr) return HeapMAlloc(InSize, InAlign);
+		if (InSize == 0)
+		{
+			::free(Ptr);
+			return nullptr;
+		}
+
+		// glibc grow the block in place when next chunk is free, and mremap blocks above the mmap threshold 
+		if (InAlign <= HeapMinAlignment) return ::realloc(Ptr, InSize);
+		return _HeapReallocAligned(Ptr, InSize, InAlign);
+#endif
+	}
+
+	CORE_API void HeapFree(void* Ptr)
+	{
+#if PLATFORM_WINDOWS
+		_aligned_free(Ptr);
+#else
+		::free(Ptr);
+#endif
+	}
+
+	CORE_API size_t HeapMSize(void* Ptr, size_t InAlign)
+	{
+		if (Ptr == nullptr) return 0;
+#if PLATFORM_WINDOWS
+		return _aligned_msize(Ptr, InAlign, 0);
+#else
+		return _HeapUsableSize(Ptr);
+#endif
+	}
+
+	CORE_API void HeapTrim()
+	{
+#if PLATFORM_WINDOWS
+		_heapmin();
+#elif defined(__GLIBC__)
+		::malloc_trim(0);
+#endif
+	}
+}
+
+// pool 
+namespace Fuko
+{
+
+	// small block size class, 16 byte step up to 128, then four classes per doubling up to 32 KB
+	inline constexpr uint32 SmallBlockClassNum = 40;
+	inline constexpr size_t MaxSmallBlockSize = 32 * 1024;
+	inline constexpr int32 MaxMagazineSize = 64;
+
+	// a class trims itself when it holds this many slabs of free blocks, and keeps one released slab decommitted
+	inline constexpr size_t AutoTrimSlabNum = 4;
+	inline constexpr int32 AutoTrimSpareNum = 1;
+
+	constexpr uint32 _ClassBlockSize(uint32 Index)
+	{
+		if (Index < 8) return (Index + 1) * 16;
+		uint32 Base = 128u << ((Index - 8) / 4);
+		return Base + ((Index - 8) % 4 + 1) * (Base / 4);
+	}
+	static_assert(_ClassBlockSize(8) == 160 && _ClassBlockSize(11) == 256 && _ClassBlockSize(12) == 320);
+	static_assert(_ClassBlockSize(SmallBlockClassNum - 1) == MaxSmallBlockSize);
+
+	// at least 4 blocks per slab, grow slab until the tail waste is under 1/16
+	constexpr size_t _ClassSlabSize(uint32 BlockSize)
+	{
+		size_t MinPages = (BlockSize * 4 + OSPageAlignment - 1) / OSPageAlignment;
+		size_t BestPages = MinPages;
+		size_t BestWaste = (MinPages * OSPageAlignment) % BlockSize;
+		for (size_t Pages = MinPages; Pages < MinPages + 8; ++Pages)
+		{
+			size_t SlabSize = Pages * OSPageAlignment;
+			size_t Waste = SlabSize % BlockSize;
+			if (Waste * 16 <= SlabSize) return SlabSize;
+			if (Waste * BestPages < BestWaste * Pages)
+			{
+				BestPages = Pages;
+				BestWaste = Waste;
+			}
+		}
+		return BestPages * OSPageAlignment;
+	}
+
+	// size class of every slab page, value is class index + 1, 0 means not a slab page
+	PageMap g_PageMap;
+
+	// live allocations above the slab tier
+	std::atomic<size_t> g_LargeBytes = 0;
+	std::atomic<size_t> g_LargeCount = 0;
+
+	// size class, blocks are carved from slabs without header, free blocks link through their first word
+	class SizeClass
+	{
+		MutexLock					m_Lock;
+		void*						m_FreeList;
+		uint8*						m_SlabCursor;
+		uint8*						m_SlabEnd;
+		TArray<void*, BaseAlloc>	m_Slabs;
+		TArray<void*, BaseAlloc>	m_SpareSlabs;		// released slabs kept decommitted for reuse
+		uint32						m_BlockSize;
+		uint32						m_SlabSize;
+		int32						m_MagazineSize;
+		uint8						m_Index;
+
+		// statistics
+		size_t						m_CarvedBlocks;
+		size_t						m_FreeBlocks;
+		uint64						m_AllocCount;
+		uint64						m_RequestBytes;
+
+		// free blocks to reach before next auto trim
+		size_t						m_NextTrimFree;
+
+		//====================================Begin help function====================================
+		FORCEINLINE size_t _SlabBlocks() const { return m_SlabSize / m_BlockSize; }
+		FORCEINLINE size_t _AutoTrimFloor() const { return _SlabBlocks() * AutoTrimSlabNum; }
+		void _AllocSlab()
+		{
+			uint8* Slab;
+			if (m_SpareSlabs.Num())
+			{
+				Slab = (uint8*)m_SpareSlabs.Pop(false);
+				always_check(OSPageCommit(Slab, m_SlabSize));
+			}
+			else
+			{
+				Slab = (uint8*)OSPageAlloc(m_SlabSize);
+			}
+			always_check(Slab != nullptr);
+			g_PageMap.Set(Slab, m_SlabSize, m_Index + 1);
+			m_Slabs.Add(Slab);
+			m_SlabCursor = Slab;
+			m_SlabEnd = Slab + (m_SlabSize / m_BlockSize) * m_BlockSize;
+		}
+		FORCEINLINE void* _PopBlock()
+		{
+			if (m_FreeList)
+			{
+				void* Ret = m_FreeList;
+				m_FreeList = *(void**)Ret;
+				--m_FreeBlocks;
+				return Ret;
+			}
+			if (m_SlabCursor == m_SlabEnd) _AllocSlab();
+			void* Ret = m_SlabCursor;
+			m_SlabCursor += m_BlockSize;
+			++m_CarvedBlocks;
+			return Ret;
+		}
+		FORCEINLINE void _PushBlock(void* Block)
+		{
+			*(void**)Block = m_FreeList;
+			m_FreeList = Block;
+			++m_FreeBlocks;
+		}
+		FORCEINLINE int32 _SlabIndex(void* Block) const { return Algo::UpperBound(m_Slabs, Block) - 1; }
+
+		// release fully free slabs, keep up to KeepSpare of them decommitted, return bytes given back to os
+		size_t _Trim(int32 KeepSpare)
+		{
+			static constexpr size_t ReleaseFlag = ~size_t(0);
+			size_t SlabBlocks = _SlabBlocks();
+			size_t Released = 0;
+			if (m_Slabs.Num())
+			{
+				// free blocks per slab, blocks after the cursor of the carving slab are free too
+				m_Slabs.Sort();
+				TArray<size_t, BaseAlloc> FreeCount(size_t(0), m_Slabs.Num());
+				int32 CarveIndex = m_SlabCursor ? _SlabIndex(m_SlabEnd - 1) : INDEX_NONE;
+				size_t UncarvedNum = m_SlabCursor ? (m_SlabEnd - m_SlabCursor) / m_BlockSize : 0;
+				if (CarveIndex != INDEX_NONE) FreeCount[CarveIndex] = UncarvedNum;
+				for (void* It = m_FreeList; It; It = *(void**)It)
+				{
+					++FreeCount[_SlabIndex(It)];
+				}
+
+				size_t ReleaseNum = 0;
+				for (int32 i = 0; i < m_Slabs.Num(); ++i)
+				{
+					if (FreeCount[i] != SlabBlocks) continue;
+					FreeCount[i] = ReleaseFlag;
+					++ReleaseNum;
+				}
+
+				if (ReleaseNum)
+				{
+					// unlink blocks of released slabs
+					void** Link = &m_FreeList;
+					for (void* It = m_FreeList; It; It = *(void**)It)
+					{
+						if (FreeCount[_SlabIndex(It)] == ReleaseFlag) continue;
+						*Link = It;
+						Link = (void**)It;
+					}
+					*Link = nullptr;
+
+					// carving slab don't have all blocks in free list
+					if (CarveIndex != INDEX_NONE && FreeCount[CarveIndex] == ReleaseFlag)
+					{
+						m_CarvedBlocks -= SlabBlocks - UncarvedNum;
+						m_FreeBlocks -= SlabBlocks - UncarvedNum;
+						m_SlabCursor = m_SlabEnd = nullptr;
+						--ReleaseNum;
+					}
+					m_CarvedBlocks -= ReleaseNum * SlabBlocks;
+					m_FreeBlocks -= ReleaseNum * SlabBlocks;
+
+					// released slabs go to spare list, rest of the slabs stay sorted
+					int32 WriteIndex = 0;
+					for (int32 i = 0; i < m_Slabs.Num(); ++i)
+					{
+						if (FreeCount[i] != ReleaseFlag)
+						{
+							m_Slabs[WriteIndex++] = m_Slabs[i];
+							continue;
+						}
+						g_PageMap.Set(m_Slabs[i], m_SlabSize, 0);
+						OSPageDecommit(m_Slabs[i], m_SlabSize);
+						m_SpareSlabs.Add(m_Slabs[i]);
+						Released += m_SlabSize;
+					}
+					m_Slabs.SetNum(WriteIndex, false);
+				}
+			}
+
+			// spare slabs over the limit are unmapped
+			while (m_SpareSlabs.Num() > KeepSpare)
+			{
+				OSPageFree(m_SpareSlabs.Pop(false), m_SlabSize);
+			}
+			return Released;
+		}
+		FORCEINLINE void _CheckAutoTrim()
+		{
+			if (m_FreeBlocks < m_NextTrimFree) return;
+			_Trim(AutoTrimSpareNum);
+
+			// hysteresis, wait for another AutoTrimSlabNum slabs of free blocks even if nothing released
+			m_NextTrimFree = Math::Max(_AutoTrimFloor(), m_FreeBlocks + _AutoTrimFloor());
+		}
+		//=====================================End help function=====================================
+	public:
+		SizeClass(uint8 InIndex)
+			: m_FreeList(nullptr)
+			, m_SlabCursor(nullptr)
+			, m_SlabEnd(nullptr)
+			, m_BlockSize(_ClassBlockSize(InIndex))
+			, m_SlabSize((uint32)_ClassSlabSize(_ClassBlockSize(InIndex)))
+			, m_MagazineSize(Math::Clamp<int32>(int32(32 * 1024 / _ClassBlockSize(InIndex)), 4, MaxMagazineSize))
+			, m_Index(InIndex)
+			, m_CarvedBlocks(0)
+			, m_FreeBlocks(0)
+			, m_AllocCount(0)
+			, m_RequestBytes(0)
+			, m_NextTrimFree(_AutoTrimFloor())
 		{}
+		~SizeClass()
+		{
+			for (void* Slab : m_Slabs)
+			{
+				OSPageFree(Slab, m_SlabSize);
+			}
+			for (void* Slab : m_SpareSlabs)
+			{
+				OSPageFree(Slab, m_SlabSize);
+			}
+		}
+
+		FORCEINLINE uint32 BlockSize() const { return m_BlockSize; }
+		FORCEINLINE int32 MagazineSize() const { return m_MagazineSize; }
+
+		void* Alloc(size_t RequestSize)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			++m_AllocCount;
+			m_RequestBytes += RequestSize;
+			return _PopBlock();
+		}
+		void Free(void* Block)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			_PushBlock(Block);
+			_CheckAutoTrim();
+		}
+		void Refill(void** OutBlocks, int32 Num, uint64 AllocCount, uint64 RequestBytes)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			m_AllocCount += AllocCount;
+			m_RequestBytes += RequestBytes;
+			for (int32 i = 0; i < Num; ++i)
+			{
+				OutBlocks[i] = _PopBlock();
+			}
+		}
+		void Flush(void** InBlocks, int32 Num)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			for (int32 i = 0; i < Num; ++i)
+			{
+				_PushBlock(InBlocks[i]);
+			}
+			_CheckAutoTrim();
+		}
+		size_t Trim()
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			size_t Released = _Trim(0);
+			m_NextTrimFree = Math::Max(_AutoTrimFloor(), m_FreeBlocks + _AutoTrimFloor());
+			return Released;
+		}
+		void AddCounter(uint64 AllocCount, uint64 RequestBytes)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			m_AllocCount += AllocCount;
+			m_RequestBytes += RequestBytes;
+		}
+		void GetStats(PoolClassStats& OutStats)
+		{
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			size_t SlabBlocks = m_SlabSize / m_BlockSize;
+			OutStats.BlockSize = m_BlockSize;
+			OutStats.SlabBytes = m_Slabs.Num() * (size_t)m_SlabSize;
+			OutStats.SpareBytes = m_SpareSlabs.Num() * (size_t)m_SlabSize;
+			OutStats.UsedBlocks = m_CarvedBlocks - m_FreeBlocks;
+			OutStats.FreeBlocks = m_Slabs.Num() * SlabBlocks - OutStats.UsedBlocks;
+			OutStats.AllocCount = m_AllocCount;
+			OutStats.RequestBytes = m_RequestBytes;
+		}
 	};
 
-	static_assert(sizeof(TBlock<32>) == 48);
+	// global pool
+	SizeClass g_SizeClasses[SmallBlockClassNum] = {
+		0,  1,  2,  3,  4,  5,  6,  7,
+		8,  9,  10, 11, 12, 13, 14, 15,
+		16, 17, 18, 19, 20, 21, 22, 23,
+		24, 25, 26, 27, 28, 29, 30, 31,
+		32, 33, 34, 35, 36, 37, 38, 39,
+	};
 
-	// global pool 
-	TPool<TBlock<16>, MutexLock, BaseAlloc>		g_Block16(128, 4);
-	TPool<TBlock<32>, MutexLock, BaseAlloc>		g_Block32(64, 4);
-	TPool<TBlock<64>, MutexLock, BaseAlloc>		g_Block64(32, 4);
-	TPool<TBlock<128>, MutexLock, BaseAlloc>	g_Block128(16, 4);
-	TPool<TBlock<256>, MutexLock, BaseAlloc>	g_Block256(16, 2);
-	TPool<TBlock<512>, MutexLock, BaseAlloc>	g_Block512(16, 2);
+	// per-thread magazine, refill and flush half of the capacity at once
+	struct Magazine
+	{
+		int32	Num;
+		uint64	AllocCount;
+		uint64	RequestBytes;
+		void*	Blocks[MaxMagazineSize];
+	};
 
+	// thread cache, flush back to global pool when thread exit
+	static thread_local bool t_bThreadCacheDead = false;
+	struct ThreadCache
+	{
+		Magazine	Magazines[SmallBlockClassNum] = {};
 
-	CORE_API void*	PoolMAlloc(size_t InSize, size_t InAlign)
+		// later frees of this thread go to global pool directly
+		~ThreadCache()
+		{
+			t_bThreadCacheDead = true;
+			FlushAll();
+		}
+
+		void FlushAll()
+		{
+			for (uint32 i = 0; i < SmallBlockClassNum; ++i)
+			{
+				Magazine& Mag = Magazines[i];
+				if (Mag.Num) g_SizeClasses[i].Flush(Mag.Blocks, Mag.Num);
+				if (Mag.AllocCount) g_SizeClasses[i].AddCounter(Mag.AllocCount, Mag.RequestBytes);
+				Mag.Num = 0;
+				Mag.AllocCount = 0;
+				Mag.RequestBytes = 0;
+			}
+		}
+
+		FORCEINLINE void* Alloc(uint32 ClassIndex, size_t RequestSize)
+		{
+			Magazine& Mag = Magazines[ClassIndex];
+			if (Mag.Num == 0)
+			{
+				SizeClass& Class = g_SizeClasses[ClassIndex];
+				int32 BatchNum = Class.MagazineSize() / 2;
+				Class.Refill(Mag.Blocks, BatchNum, Mag.AllocCount, Mag.RequestBytes);
+				Mag.Num = BatchNum;
+				Mag.AllocCount = 0;
+				Mag.RequestBytes = 0;
+			}
+			++Mag.AllocCount;
+			Mag.RequestBytes += RequestSize;
+			return Mag.Blocks[--Mag.Num];
+		}
+		FORCEINLINE void Free(uint32 ClassIndex, void* Block)
+		{
+			Magazine& Mag = Magazines[ClassIndex];
+			SizeClass& Class = g_SizeClasses[ClassIndex];
+			if (Mag.Num == Class.MagazineSize())
+			{
+				int32 BatchNum = Class.MagazineSize() / 2;
+				Class.Flush(Mag.Blocks + BatchNum, Mag.Num - BatchNum);
+				Mag.Num = BatchNum;
+			}
+			Mag.Blocks[Mag.Num++] = Block;
+		}
+	};
+	static thread_local ThreadCache t_ThreadCache;
+
+	//====================================Begin help function====================================
+	FORCEINLINE uint32 _SizeToClass(size_t InSize)
+	{
+		check(InSize > 0 && InSize <= MaxSmallBlockSize);
+		if (InSize <= 128) return uint32((InSize - 1) >> 4);
+		uint32 Log2 = Math::FloorLog2(uint32(InSize - 1));
+		return 8 + (Log2 - 7) * 4 + uint32((InSize - 1 - (size_t(1) << Log2)) >> (Log2 - 2));
+	}
+	FORCEINLINE void* _SmallAlloc(uint32 ClassIndex, size_t RequestSize)
+	{
+		return t_bThreadCacheDead ? g_SizeClasses[ClassIndex].Alloc(RequestSize) : t_ThreadCache.Alloc(ClassIndex, RequestSize);
+	}
+	FORCEINLINE void _SmallFree(uint32 ClassIndex, void* Ptr)
+	{
+		if (t_bThreadCacheDead)
+			g_SizeClasses[ClassIndex].Free(Ptr);
+		else
+			t_ThreadCache.Free(ClassIndex, Ptr);
+	}
+
+	// large block, a 16 byte header before user memory records the request size
+	FORCEINLINE size_t* _LargeHeader(void* Ptr) { return (size_t*)((uint8*)Ptr - 16); }
+	FORCEINLINE void* _LargeAlloc(size_t InSize)
+	{
+		size_t* RawMemory = (size_t*)MAlloc(InSize + 16, 16);
+		*RawMemory = InSize;
+		g_LargeBytes.fetch_add(InSize, std::memory_order_relaxed);
+		g_LargeCount.fetch_add(1, std::memory_order_relaxed);
+		return (uint8*)RawMemory + 16;
+	}
+	FORCEINLINE void* _LargeRealloc(void* Ptr, size_t InSize)
+	{
+		size_t LastSize = *_LargeHeader(Ptr);
+		size_t* RawMemory = (size_t*)Realloc(_LargeHeader(Ptr), InSize + 16, 16);
+		*RawMemory = InSize;
+		g_LargeBytes.fetch_add(InSize - LastSize, std::memory_order_relaxed);
+		return (uint8*)RawMemory + 16;
+	}
+	FORCEINLINE void _LargeFree(void* Ptr)
+	{
+		g_LargeBytes.fetch_sub(*_LargeHeader(Ptr), std::memory_order_relaxed);
+		g_LargeCount.fetch_sub(1, std::memory_order_relaxed);
+		Free(_LargeHeader(Ptr));
+	}
+
+	FORCEINLINE void*	_PoolMAlloc(size_t InSize, size_t InAlign)
 	{
 		check(InAlign <= 16);
-		size_t BlockSize = Math::RoundUpToPowerOfTwo(InSize);
-		switch (BlockSize)
-		{
-		case 0: 
-			return nullptr;
-		case 1:
-		case 2:
-		case 4:
-		case 8:
-		case 16:
-			return &g_Block16.New()->Memory;
-		case 32:
-			return &g_Block32.New()->Memory;
-		case 64:
-			return &g_Block64.New()->Memory;
-		case 128:
-			return &g_Block128.New()->Memory;
-		case 256:
-			return &g_Block256.New()->Memory;
-		case 512:
-			return &g_Block512.New()->Memory;
-		default:
-		{
-			int32* RawMemory = (int32*)MAlloc(InSize + 16, 16);
-			*RawMemory = (int32)InSize;
-			return RawMemory + 4;
-		}
-		}
-	}
-	
-	CORE_API void*	PoolRealloc(void* Ptr, size_t InSize, size_t InAlign)
+		if (InSize == 0) return nullptr;
+		if (InSize <= MaxSmallBlockSize) return _SmallAlloc(_SizeToClass(InSize), InSize);
+		return _LargeAlloc(InSize);
+	}
+
+	FORCEINLINE void	_PoolFree(void* Ptr)
+	{
+		if (Ptr == nullptr) return;
+		uint8 PageValue = g_PageMap.Get(Ptr);
+		if (PageValue)
+			_SmallFree(PageValue - 1, Ptr);
+		else
+			_LargeFree(Ptr);
+	}
+
+	FORCEINLINE void*	_PoolRealloc(void* Ptr, size_t InSize, size_t InAlign)
 	{
-		size_t LastSize = PoolMSize(Ptr);
-		size_t BlockSize = Math::RoundUpToPowerOfTwo(InSize);
+		if (Ptr == nullptr) return _PoolMAlloc(InSize, InAlign);
 		if (InSize == 0)
 		{
-			PoolFree(Ptr);
+			_PoolFree(Ptr);
 			return nullptr;
 		}
-		if (LastSize == BlockSize) return Ptr;
-		if (LastSize > 512 && InSize > 512) return Realloc(Ptr, InSize, InAlign);
-		void* NewPtr = PoolMAlloc(InSize, InAlign);
+
+		uint8 PageValue = g_PageMap.Get(Ptr);
+		size_t LastSize;
+		if (PageValue)
+		{
+			uint32 ClassIndex = PageValue - 1;
+			if (InSize <= MaxSmallBlockSize && _SizeToClass(InSize) == ClassIndex) return Ptr;
+			LastSize = g_SizeClasses[ClassIndex].BlockSize();
+		}
+		else
+		{
+			if (InSize > MaxSmallBlockSize) return _LargeRealloc(Ptr, InSize);
+			LastSize = *_LargeHeader(Ptr);
+		}
+
+		void* NewPtr = _PoolMAlloc(InSize, InAlign);
 		Memcpy(NewPtr, Ptr, Math::Min(LastSize, InSize));
-		PoolFree(Ptr);
+		_PoolFree(Ptr);
 		return NewPtr;
 	}
-	
+
+	FORCEINLINE size_t	_PoolMSize(void* Ptr)
+	{
+		if (Ptr == nullptr) return 0;
+		uint8 PageValue = g_PageMap.Get(Ptr);
+		return PageValue ? g_SizeClasses[PageValue - 1].BlockSize() : *_LargeHeader(Ptr);
+	}
+	//=====================================End help function=====================================
+
+	CORE_API void*	PoolMAlloc(size_t InSize, size_t InAlign)
+	{
+		IAllocator* Allocator = g_PoolAllocator.load(std::memory_order_acquire);
+		return Allocator ? Allocator->Alloc(InSize, InAlign) : _PoolMAlloc(InSize, InAlign);
+	}
+
+	CORE_API void*	PoolRealloc(void* Ptr, size_t InSize, size_t InAlign)
+	{
+		IAllocator* Allocator = g_PoolAllocator.load(std::memory_order_acquire);
+		return Allocator ? Allocator->Realloc(Ptr, InSize, InAlign) : _PoolRealloc(Ptr, InSize, InAlign);
+	}
+
 	CORE_API void	PoolFree(void* Ptr)
 	{
-		int32* RawPtr = (((int32*)Ptr) - 4);
-		int32 BlockSize = *RawPtr;
-		switch (BlockSize)
-		{
-		case 16:
-			g_Block16.Free((TBlock<16>*)RawPtr);
-			break;
-		case 32:
-			g_Block32.Free((TBlock<32>*)RawPtr);
-			break;
-		case 64:
-			g_Block64.Free((TBlock<64>*)RawPtr);
-			break;
-		case 128:
-			g_Block128.Free((TBlock<128>*)RawPtr);
-			break;
-		case 256:
-			g_Block256.Free((TBlock<256>*)RawPtr);
-			break;
-		case 512:
-			g_Block512.Free((TBlock<512>*)RawPtr);
-			break;
-		default:
-		{
-			check(BlockSize > 512);
-			Free(RawPtr);
-		}
-		}
-	}
-	
+		IAllocator* Allocator = g_PoolAllocator.load(std::memory_order_acquire);
+		if (Allocator)
+			Allocator->Free(Ptr);
+		else
+			_PoolFree(Ptr);
+	}
+
 	CORE_API size_t PoolMSize(void* Ptr)
 	{
-		if (Ptr == 0) return 0;
-		int32* RawPtr = (((int32*)Ptr) - 4);
-		return *RawPtr;
+		IAllocator* Allocator = g_PoolAllocator.load(std::memory_order_acquire);
+		return Allocator ? Allocator->Size(Ptr) : _PoolMSize(Ptr);
+	}
+
+	// pool as IAllocator, skip the route
+	class PoolRawAllocator : public IAllocator
+	{
+	public:
+		void* Alloc(size_t InSize, size_t Alignment) override { return _PoolMAlloc(InSize, Alignment); }
+		void* Realloc(void* InPtr, size_t InSize, size_t Alignment) override { return _PoolRealloc(InPtr, InSize, Alignment); }
+		void Free(void* InPtr) override { _PoolFree(InPtr); }
+		size_t Size(void* Ptr, size_t Alignment) override { return _PoolMSize(Ptr); }
+		void Trim() override { PoolTrim(); }
+	};
+
+	CORE_API IAllocator* PoolAllocator()
+	{
+		static PoolRawAllocator s_PoolAllocator;
+		return &s_PoolAllocator;
+	}
+
+	CORE_API void SetPoolAllocator(IAllocator* InAllocator)
+	{
+		g_PoolAllocator.store(InAllocator, std::memory_order_release);
+	}
+
+	CORE_API size_t PoolTrim()
+	{
+		// blocks cached by this thread can't make their slab free, give them back first
+		if (!t_bThreadCacheDead) t_ThreadCache.FlushAll();
+
+		size_t Released = 0;
+		for (SizeClass& Class : g_SizeClasses)
+		{
+			Released += Class.Trim();
+		}
+
+		// large blocks live in the heap
+		DefaultAllocator()->Trim();
+		return Released;
+	}
+
+	CORE_API void PoolGetStats(PoolStats& OutStats)
+	{
+		static_assert(SmallBlockClassNum <= PoolStats::MaxClassNum);
+		OutStats.ClassNum = SmallBlockClassNum;
+		for (uint32 i = 0; i < SmallBlockClassNum; ++i)
+		{
+			g_SizeClasses[i].GetStats(OutStats.Classes[i]);
+		}
+		OutStats.LargeBytes = g_LargeBytes.load(std::memory_order_relaxed);
+		OutStats.LargeCount = g_LargeCount.load(std::memory_order_relaxed);
+	}
+
+	CORE_API void PoolDumpStats()
+	{
+		PoolStats Stats;
+		PoolGetStats(Stats);
+
+		size_t TotalSlab = 0;
+		size_t TotalUsed = 0;
+		size_t TotalSpare = 0;
+		std::printf("%8s %10s %10s %10s %12s %9s %9s\n", "Block", "Slab(KB)", "Used", "Free", "Allocs", "Internal", "External");
+		for (uint32 i = 0; i < Stats.ClassNum; ++i)
+		{
+			const PoolClassStats& Class = Stats.Classes[i];
+			TotalSpare += Class.SpareBytes;
+			if (Class.SlabBytes == 0) continue;
+
+			// internal: block bytes lost to rounding up requests, external: slab bytes not handed out
+			uint64 BlockBytes = Class.AllocCount * Class.BlockSize;
+			double Internal = BlockBytes ? 1.0 - (double)Class.RequestBytes / BlockBytes : 0.0;
+			double External = 1.0 - (double)(Class.UsedBlocks * Class.BlockSize) / Class.SlabBytes;
+			std::printf("%8zu %10zu %10zu %10zu %12llu %8.2f%% %8.2f%%\n",
+				Class.BlockSize, Class.SlabBytes / 1024, Class.UsedBlocks, Class.FreeBlocks,
+				(unsigned long long)Class.AllocCount, Internal * 100.0, External * 100.0);
+
+			TotalSlab += Class.SlabBytes;
+			TotalUsed += Class.UsedBlocks * Class.BlockSize;
+		}
+		std::printf("slab: %zu KB reserved, %zu KB used, %zu KB decommitted; large: %zu KB in %zu allocations\n",
+			TotalSlab / 1024, TotalUsed / 1024, TotalSpare / 1024, Stats.LargeBytes / 1024, Stats.LargeCount);
 	}
 }
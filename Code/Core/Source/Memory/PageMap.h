@@ -0,0 +1,82 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Misc/Assert.h>
+#include <Containers/LockPolicy.h>
+#include "PlatformMemory.h"
+
+// radix page map
+namespace Fuko
+{
+	// map every OSPageAlignment page of the 48-bit address space to a uint8 value
+	// root is static, leaves are committed on demand and live until the map die
+	class PageMap
+	{
+		static constexpr uint32 AddressBits = 48;
+		static constexpr uint32 PageBits = 16;
+		static constexpr uint32 LeafBits = 17;
+		static constexpr uint32 RootBits = AddressBits - PageBits - LeafBits;
+		static constexpr size_t LeafSize = size_t(1) << LeafBits;
+		static_assert((size_t(1) << PageBits) == OSPageAlignment);
+
+		struct Leaf
+		{
+			uint8	Values[LeafSize];
+		};
+
+		std::atomic<Leaf*>	m_Root[size_t(1) << RootBits];
+		MutexLock			m_Lock;
+
+		//====================================Begin help function====================================
+		static FORCEINLINE size_t _RootIndex(size_t Address) { return Address >> (PageBits + LeafBits); }
+		static FORCEINLINE size_t _LeafIndex(size_t Address) { return (Address >> PageBits) & (LeafSize - 1); }
+		Leaf* _EnsureLeaf(size_t Index)
+		{
+			Leaf* Ret = m_Root[Index].load(std::memory_order_acquire);
+			if (Ret) return Ret;
+
+			std::lock_guard<MutexLock> Lck(m_Lock);
+			Ret = m_Root[Index].load(std::memory_order_relaxed);
+			if (!Ret)
+			{
+				// fresh os pages are zero filled
+				Ret = (Leaf*)OSPageAlloc(sizeof(Leaf));
+				always_check(Ret != nullptr);
+				m_Root[Index].store(Ret, std::memory_order_release);
+			}
+			return Ret;
+		}
+		//=====================================End help function=====================================
+	public:
+		PageMap() = default;
+		PageMap(const PageMap&) = delete;
+		PageMap& operator=(const PageMap&) = delete;
+		~PageMap()
+		{
+			for (std::atomic<Leaf*>& Root : m_Root)
+			{
+				OSPageFree(Root.load(std::memory_order_relaxed), sizeof(Leaf));
+			}
+		}
+
+		// set value for all pages in [Ptr, Ptr + Size), Ptr and Size must be page aligned
+		void Set(void* Ptr, size_t Size, uint8 Value)
+		{
+			check(IsAligned(Ptr, OSPageAlignment) && IsAligned(Size, OSPageAlignment));
+			for (size_t Address = (size_t)Ptr, End = (size_t)Ptr + Size; Address < End; Address += OSPageAlignment)
+			{
+				check((Address >> AddressBits) == 0);
+				_EnsureLeaf(_RootIndex(Address))->Values[_LeafIndex(Address)] = Value;
+			}
+		}
+
+		// get value of the page contains Ptr, 0 if the page never set
+		FORCEINLINE uint8 Get(const void* Ptr) const
+		{
+			size_t Address = (size_t)Ptr;
+			if ((Address >> AddressBits) != 0) return 0;
+			Leaf* FoundLeaf = m_Root[_RootIndex(Address)].load(std::memory_order_acquire);
+			return FoundLeaf ? FoundLeaf->Values[_LeafIndex(Address)] : 0;
+		}
+	};
+}
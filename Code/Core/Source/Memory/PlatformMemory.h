@@ -0,0 +1,73 @@
+#pragma once
+#include <CoreConfig.h>
+#include <CoreType.h>
+#include <Templates/Align.h>
+#include <Misc/Assert.h>
+
+#if PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// os page memory, used by the pool allocator for slabs
+namespace Fuko
+{
+	// all page allocation are aligned to this, equals to the windows allocation granularity
+	inline constexpr size_t OSPageAlignment = 64 * 1024;
+
+	// alloc pages aligned to OSPageAlignment, Size must be a multiple of OSPageAlignment
+	inline void* OSPageAlloc(size_t Size)
+	{
+		check(IsAligned(Size, OSPageAlignment));
+#if PLATFORM_WINDOWS
+		return ::VirtualAlloc(nullptr, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		// over map and cut the unaligned head and tail
+		size_t MapSize = Size + OSPageAlignment;
+		void* Map = ::mmap(nullptr, MapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (Map == MAP_FAILED) return nullptr;
+
+		uint8* MapBegin = (uint8*)Map;
+		uint8* Begin = Align(MapBegin, OSPageAlignment);
+		uint8* End = Begin + Size;
+		if (Begin != MapBegin) ::munmap(MapBegin, Begin - MapBegin);
+		if (End != MapBegin + MapSize) ::munmap(End, MapBegin + MapSize - End);
+		return Begin;
+#endif
+	}
+
+	// give physical pages back to os but keep the range, contents are lost, call OSPageCommit before touch it again
+	inline void OSPageDecommit(void* Ptr, size_t Size)
+	{
+		check(IsAligned(Ptr, OSPageAlignment) && IsAligned(Size, OSPageAlignment));
+#if PLATFORM_WINDOWS
+		::VirtualFree(Ptr, Size, MEM_DECOMMIT);
+#else
+		::madvise(Ptr, Size, MADV_DONTNEED);
+#endif
+	}
+
+	// make a decommitted range usable again, pages read as zero
+	inline bool OSPageCommit(void* Ptr, size_t Size)
+	{
+#if PLATFORM_WINDOWS
+		return ::VirtualAlloc(Ptr, Size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+		// anonymous pages fault back in on touch
+		return true;
+#endif
+	}
+
+	inline void OSPageFree(void* Ptr, size_t Size)
+	{
+		if (!Ptr) return;
+#if PLATFORM_WINDOWS
+		::VirtualFree(Ptr, 0, MEM_RELEASE);
+#else
+		::munmap(Ptr, Size);
+#endif
+	}
+}
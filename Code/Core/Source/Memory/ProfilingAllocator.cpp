@@ -0,0 +1,1005 @@
+#include <Memory/ProfilingAllocator.h>
+#include <Math/MathUtility.h>
+#include <Containers/LockPolicy.h>
+#include <Algo/Sort.h>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include "PlatformMemory.h"
+
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#define FUKO_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define FUKO_RETURN_ADDRESS() __builtin_return_address(0)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define FUKO_HAS_BACKTRACE 1
+#endif
+#endif
+
+// allocation tag
+namespace Fuko
+{
+	static const char* const UntaggedName = "<untagged>";
+	static const char* const OverflowName = "<overflow>";
+	static thread_local const char* t_AllocTag = UntaggedName;
+
+	CORE_API const char* GetAllocTag()
+	{
+		return t_AllocTag;
+	}
+
+	CORE_API const char* SetAllocTag(const char* InTag)
+	{
+		const char* LastTag = t_AllocTag;
+		t_AllocTag = InTag ? InTag : UntaggedName;
+		return LastTag;
+	}
+}
+
+// profiling state
+namespace Fuko
+{
+	// guards thread buffers and record shards, both are held for a few instructions
+	using ProfileLock = TSpinLock<-1>;
+
+	// profiler memory never comes from an IAllocator, it may be the one we are wrapping
+	template<typename T>
+	FORCEINLINE T* _OSNew(size_t Count)
+	{
+		T* Ret = (T*)OSPageAlloc(Align(Count * sizeof(T), OSPageAlignment));
+		always_check(Ret != nullptr);
+		for (size_t i = 0; i < Count; ++i) new(Ret + i) T();
+		return Ret;
+	}
+	template<typename T>
+	FORCEINLINE void _OSDelete(T* Ptr, size_t Count)
+	{
+		if (!Ptr) return;
+		for (size_t i = 0; i < Count; ++i) Ptr[i].~T();
+		OSPageFree(Ptr, Align(Count * sizeof(T), OSPageAlignment));
+	}
+
+	FORCEINLINE uint64 _NowNs()
+	{
+		return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	FORCEINLINE uint64 _HashPointer(const void* Ptr)
+	{
+		return ((uint64)(size_t)Ptr >> 4) * 0x9E3779B97F4A7C15ull;
+	}
+
+	// a live allocation known by the profiler
+	struct LiveRecord
+	{
+		void*	Ptr;
+		size_t	Size;
+		uint64	Birth;
+		uint32	Site;
+	};
+
+	// open addressing pointer map, linear probe, backward shift on remove
+	struct RecordShard
+	{
+		static constexpr uint32 MinCapacity = uint32(OSPageAlignment / sizeof(LiveRecord));
+
+		ProfileLock		Lock;
+		LiveRecord*		Slots = nullptr;
+		uint32			Capacity = 0;
+		uint32			Num = 0;
+
+		~RecordShard() { _OSDelete(Slots, Capacity); }
+
+		FORCEINLINE uint32 _Home(void* Ptr) const { return uint32(_HashPointer(Ptr) >> 32) & (Capacity - 1); }
+		void _Grow()
+		{
+			LiveRecord* OldSlots = Slots;
+			uint32 OldCapacity = Capacity;
+			Capacity = Capacity ? Capacity * 2 : MinCapacity;
+			Slots = _OSNew<LiveRecord>(Capacity);
+			for (uint32 i = 0; i < OldCapacity; ++i)
+			{
+				if (OldSlots[i].Ptr) _Insert(OldSlots[i]);
+			}
+			_OSDelete(OldSlots, OldCapacity);
+		}
+		FORCEINLINE void _Insert(const LiveRecord& Record)
+		{
+			uint32 Index = _Home(Record.Ptr);
+			while (Slots[Index].Ptr) Index = (Index + 1) & (Capacity - 1);
+			Slots[Index] = Record;
+		}
+
+		void Add(const LiveRecord& Record)
+		{
+			if ((Num + 1) * 4 > Capacity * 3) _Grow();
+			_Insert(Record);
+			++Num;
+		}
+		bool Remove(void* Ptr, LiveRecord& OutRecord)
+		{
+			if (!Capacity) return false;
+			uint32 Mask = Capacity - 1;
+			uint32 Index = _Home(Ptr);
+			while (Slots[Index].Ptr != Ptr)
+			{
+				if (!Slots[Index].Ptr) return false;
+				Index = (Index + 1) & Mask;
+			}
+			OutRecord = Slots[Index];
+			--Num;
+
+			// shift back following records that can't be reached from their home anymore
+			uint32 Hole = Index;
+			for (uint32 Next = (Hole + 1) & Mask; Slots[Next].Ptr; Next = (Next + 1) & Mask)
+			{
+				uint32 Home = _Home(Slots[Next].Ptr);
+				if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+				{
+					Slots[Hole] = Slots[Next];
+					Hole = Next;
+				}
+			}
+			Slots[Hole].Ptr = nullptr;
+			return true;
+		}
+	};
+
+	struct SiteKey
+	{
+		const void*	Key;
+		uint32		Site;
+	};
+
+	// a batched allocation event
+	enum class EProfileEvent : uint32
+	{
+		Alloc,
+		Realloc,
+		Free,
+	};
+	struct ProfileEvent
+	{
+		EProfileEvent	Kind;
+		uint32			Site;
+		size_t			Size;
+		size_t			OldSize;	// realloc only
+		uint64			Lifetime;	// free only
+	};
+
+	FORCEINLINE uint32 _SizeBucket(size_t InSize)
+	{
+		return InSize ? Math::Min<uint32>((uint32)Math::FloorLog2((uint64)InSize), AllocSiteStats::SizeBucketNum - 1) : 0;
+	}
+	FORCEINLINE uint32 _LifetimeBucket(uint64 Lifetime)
+	{
+		uint32 Bucket = 0;
+		for (uint64 Bound = 100; Bucket < AllocSiteStats::LifetimeBucketNum - 1 && Lifetime >= Bound; Bound *= 10) ++Bucket;
+		return Bucket;
+	}
+}
+
+// profiler state
+namespace Fuko
+{
+	struct AllocProfilerState
+	{
+		static constexpr uint32 MaxSiteNum = ProfilingAllocator::MaxSiteNum;
+		static constexpr uint32 ShardNum = 16;
+		static constexpr uint32 KeyTableSize = MaxSiteNum * 2;
+
+		// merged stats
+		MutexLock		StatsLock;
+		AllocSiteStats	Sites[MaxSiteNum];
+		uint32			SiteNum;
+		int64			LiveBytes;
+		int64			PeakBytes;
+
+		// key -> site, site 0 takes keys after the table is full
+		MutexLock		SiteLock;
+		SiteKey			KeyTable[KeyTableSize];
+
+		// live allocations
+		RecordShard		Shards[ShardNum];
+
+		AllocProfilerState()
+			: Sites{}
+			, SiteNum(1)
+			, LiveBytes(0)
+			, PeakBytes(0)
+			, KeyTable{}
+		{
+			Sites[0].Tag = OverflowName;
+		}
+
+		FORCEINLINE RecordShard& ShardOf(void* Ptr) { return Shards[_HashPointer(Ptr) >> 60]; }
+
+		uint32 FindSite(const void* Key, const char* Tag, const void* Callsite)
+		{
+			std::lock_guard<MutexLock> Lck(SiteLock);
+			uint32 Index = uint32(_HashPointer(Key) >> 32) & (KeyTableSize - 1);
+			while (KeyTable[Index].Key)
+			{
+				if (KeyTable[Index].Key == Key) return KeyTable[Index].Site;
+				Index = (Index + 1) & (KeyTableSize - 1);
+			}
+
+			std::lock_guard<MutexLock> StatsLck(StatsLock);
+			if (SiteNum == MaxSiteNum) return 0;
+			AllocSiteStats& Site = Sites[SiteNum];
+			Site.Tag = Tag;
+			Site.Callsite = Callsite;
+			KeyTable[Index] = SiteKey{ Key, SiteNum };
+			return SiteNum++;
+		}
+
+		// StatsLock must be held
+		void Apply(const ProfileEvent* Events, int32 Num)
+		{
+			for (int32 i = 0; i < Num; ++i)
+			{
+				const ProfileEvent& Event = Events[i];
+				AllocSiteStats& Site = Sites[Event.Site];
+				switch (Event.Kind)
+				{
+				case EProfileEvent::Alloc:
+					++Site.AllocCount;
+					++Site.LiveCount;
+					++Site.SizeHistogram[_SizeBucket(Event.Size)];
+					Site.AllocBytes += Event.Size;
+					Site.LiveBytes += (int64)Event.Size;
+					LiveBytes += (int64)Event.Size;
+					break;
+				case EProfileEvent::Realloc:
+					++Site.ReallocCount;
+					++Site.SizeHistogram[_SizeBucket(Event.Size)];
+					if (Event.Size > Event.OldSize) Site.AllocBytes += Event.Size - Event.OldSize;
+					Site.LiveBytes += (int64)Event.Size - (int64)Event.OldSize;
+					LiveBytes += (int64)Event.Size - (int64)Event.OldSize;
+					break;
+				case EProfileEvent::Free:
+					++Site.FreeCount;
+					--Site.LiveCount;
+					++Site.LifetimeHistogram[_LifetimeBucket(Event.Lifetime)];
+					Site.TotalLifetime += Event.Lifetime;
+					Site.LiveBytes -= (int64)Event.Size;
+					LiveBytes -= (int64)Event.Size;
+					break;
+				}
+				Site.PeakBytes = Math::Max(Site.PeakBytes, Site.LiveBytes);
+				PeakBytes = Math::Max(PeakBytes, LiveBytes);
+			}
+		}
+	};
+}
+
+// thread buffer
+namespace Fuko
+{
+	// events of one thread for one profiler, flushed when full, when the profiler changes, or on report
+	struct ProfileThreadBuffer
+	{
+		static constexpr int32 MaxEventNum = 256;
+		static constexpr uint32 SiteCacheSize = 16;
+
+		ProfileLock							Lock;
+		AllocProfilerState*	Owner = nullptr;
+		ProfileThreadBuffer*				Prev = nullptr;
+		ProfileThreadBuffer*				Next = nullptr;
+		int32								Num = 0;
+		SiteKey								SiteCache[SiteCacheSize] = {};
+		ProfileEvent						Events[MaxEventNum];
+
+		// Lock must be held
+		void Flush()
+		{
+			if (Num && Owner)
+			{
+				std::lock_guard<MutexLock> Lck(Owner->StatsLock);
+				Owner->Apply(Events, Num);
+			}
+			Num = 0;
+		}
+		void Bind(AllocProfilerState* InOwner)
+		{
+			if (Owner == InOwner) return;
+			Flush();
+			Owner = InOwner;
+			for (SiteKey& Cache : SiteCache) Cache.Key = nullptr;
+		}
+		FORCEINLINE uint32 FindSite(const void* Key, const char* Tag, const void* Callsite)
+		{
+			SiteKey& Cache = SiteCache[uint32(_HashPointer(Key) >> 32) & (SiteCacheSize - 1)];
+			if (Cache.Key != Key)
+			{
+				Cache.Site = Owner->FindSite(Key, Tag, Callsite);
+				Cache.Key = Key;
+			}
+			return Cache.Site;
+		}
+		FORCEINLINE void Push(const ProfileEvent& Event)
+		{
+			Events[Num++] = Event;
+			if (Num == MaxEventNum) Flush();
+		}
+	};
+
+	// all living thread buffers, report and profiler destruction walk it
+	struct ProfileBufferRegistry
+	{
+		MutexLock				Lock;
+		ProfileThreadBuffer*	Head = nullptr;
+
+		void Add(ProfileThreadBuffer* Buffer)
+		{
+			std::lock_guard<MutexLock> Lck(Lock);
+			Buffer->Next = Head;
+			if (Head) Head->Prev = Buffer;
+			Head = Buffer;
+		}
+		void Remove(ProfileThreadBuffer* Buffer)
+		{
+			std::lock_guard<MutexLock> Lck(Lock);
+			{
+				std::lock_guard<ProfileLock> BufferLck(Buffer->Lock);
+				Buffer->Flush();
+				Buffer->Owner = nullptr;
+			}
+			if (Buffer->Prev) Buffer->Prev->Next = Buffer->Next;
+			else Head = Buffer->Next;
+			if (Buffer->Next) Buffer->Next->Prev = Buffer->Prev;
+		}
+
+		// flush buffers of the owner, release them too if bUnbind
+		void FlushOwner(AllocProfilerState* Owner, bool bUnbind)
+		{
+			std::lock_guard<MutexLock> Lck(Lock);
+			for (ProfileThreadBuffer* It = Head; It; It = It->Next)
+			{
+				std::lock_guard<ProfileLock> BufferLck(It->Lock);
+				if (It->Owner != Owner) continue;
+				It->Flush();
+				if (bUnbind) It->Owner = nullptr;
+			}
+		}
+	};
+	static ProfileBufferRegistry& _GetBufferRegistry()
+	{
+		static ProfileBufferRegistry s_Registry;
+		return s_Registry;
+	}
+
+	// after the buffer die, events of this thread are applied directly
+	static thread_local bool t_bProfileBufferDead = false;
+	struct ThreadBufferHolder
+	{
+		ProfileThreadBuffer*	Buffer;
+
+		ThreadBufferHolder()
+			: Buffer(_OSNew<ProfileThreadBuffer>(1))
+		{
+			_GetBufferRegistry().Add(Buffer);
+		}
+		~ThreadBufferHolder()
+		{
+			t_bProfileBufferDead = true;
+			_GetBufferRegistry().Remove(Buffer);
+			_OSDelete(Buffer, 1);
+		}
+	};
+	static thread_local ThreadBufferHolder t_ProfileBuffer;
+
+	//====================================Begin help function====================================
+	static void _RecordEvent(AllocProfilerState* State, const ProfileEvent& Event)
+	{
+		if (t_bProfileBufferDead)
+		{
+			std::lock_guard<MutexLock> Lck(State->StatsLock);
+			State->Apply(&Event, 1);
+			return;
+		}
+		ProfileThreadBuffer* Buffer = t_ProfileBuffer.Buffer;
+		std::lock_guard<ProfileLock> Lck(Buffer->Lock);
+		Buffer->Bind(State);
+		Buffer->Push(Event);
+	}
+	static uint32 _FindSite(AllocProfilerState* State, const void* Key, const char* Tag, const void* Callsite)
+	{
+		if (t_bProfileBufferDead) return State->FindSite(Key, Tag, Callsite);
+		ProfileThreadBuffer* Buffer = t_ProfileBuffer.Buffer;
+		std::lock_guard<ProfileLock> Lck(Buffer->Lock);
+		Buffer->Bind(State);
+		return Buffer->FindSite(Key, Tag, Callsite);
+	}
+	//=====================================End help function=====================================
+}
+
+// profiling allocator
+namespace Fuko
+{
+	ProfilingAllocator::ProfilingAllocator(IAllocator* Inner, EAllocProfileKey KeyMode)
+		: m_Inner(Inner)
+		, m_State(_OSNew<AllocProfilerState>(1))
+		, m_KeyMode(KeyMode)
+	{
+		check(m_Inner != nullptr && m_Inner != this);
+
+		// registry must outlive the profiler
+		_GetBufferRegistry();
+	}
+
+	ProfilingAllocator::~ProfilingAllocator()
+	{
+		_GetBufferRegistry().FlushOwner(m_State, true);
+		_OSDelete(m_State, 1);
+	}
+
+	void ProfilingAllocator::_OnAlloc(void* Ptr, size_t InSize, const void* Callsite)
+	{
+		const char* Tag = GetAllocTag();
+		uint32 Site = m_KeyMode == EAllocProfileKey::Tag ?
+			_FindSite(m_State, Tag, Tag, nullptr) :
+			_FindSite(m_State, Callsite, Tag, Callsite);
+
+		RecordShard& Shard = m_State->ShardOf(Ptr);
+		{
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			Shard.Add(LiveRecord{ Ptr, InSize, _NowNs(), Site });
+		}
+		_RecordEvent(m_State, ProfileEvent{ EProfileEvent::Alloc, Site, InSize, 0, 0 });
+	}
+
+	void ProfilingAllocator::_OnFree(void* Ptr)
+	{
+		LiveRecord Record;
+		{
+			RecordShard& Shard = m_State->ShardOf(Ptr);
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			if (!Shard.Remove(Ptr, Record)) return;
+		}
+		_RecordEvent(m_State, ProfileEvent{ EProfileEvent::Free, Record.Site, Record.Size, 0, _NowNs() - Record.Birth });
+	}
+
+	void* ProfilingAllocator::Alloc(size_t InSize, size_t Alignment)
+	{
+		void* Ptr = m_Inner->Alloc(InSize, Alignment);
+		if (Ptr) _OnAlloc(Ptr, InSize, FUKO_RETURN_ADDRESS());
+		return Ptr;
+	}
+
+	void* ProfilingAllocator::Realloc(void* InPtr, size_t InSize, size_t Alignment)
+	{
+		const void* Callsite = FUKO_RETURN_ADDRESS();
+		if (!InPtr)
+		{
+			void* NewPtr = m_Inner->Realloc(InPtr, InSize, Alignment);
+			if (NewPtr) _OnAlloc(NewPtr, InSize, Callsite);
+			return NewPtr;
+		}
+
+		// take the old record before the inner realloc free the block, another thread may get its address from Alloc
+		LiveRecord Record;
+		bool bFound;
+		{
+			RecordShard& Shard = m_State->ShardOf(InPtr);
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			bFound = Shard.Remove(InPtr, Record);
+		}
+		void* NewPtr = m_Inner->Realloc(InPtr, InSize, Alignment);
+
+		// unknown block become a new allocation
+		if (!bFound)
+		{
+			if (NewPtr) _OnAlloc(NewPtr, InSize, Callsite);
+			return NewPtr;
+		}
+
+		// failed realloc keep the old block, shrink to zero free it
+		if (!NewPtr && InSize)
+		{
+			RecordShard& Shard = m_State->ShardOf(InPtr);
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			Shard.Add(Record);
+			return nullptr;
+		}
+		if (!NewPtr)
+		{
+			_RecordEvent(m_State, ProfileEvent{ EProfileEvent::Free, Record.Site, Record.Size, 0, _NowNs() - Record.Birth });
+			return nullptr;
+		}
+
+		// keep site and birth, a grown buffer is still the same allocation
+		{
+			RecordShard& Shard = m_State->ShardOf(NewPtr);
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			Shard.Add(LiveRecord{ NewPtr, InSize, Record.Birth, Record.Site });
+		}
+		_RecordEvent(m_State, ProfileEvent{ EProfileEvent::Realloc, Record.Site, InSize, Record.Size, 0 });
+		return NewPtr;
+	}
+
+	void ProfilingAllocator::Free(void* InPtr)
+	{
+		if (InPtr) _OnFree(InPtr);
+		m_Inner->Free(InPtr);
+	}
+
+	size_t ProfilingAllocator::Size(void* Ptr, size_t Alignment)
+	{
+		return m_Inner->Size(Ptr, Alignment);
+	}
+
+	void ProfilingAllocator::Trim()
+	{
+		m_Inner->Trim();
+	}
+
+	uint32 ProfilingAllocator::GetSiteStats(AllocSiteStats* OutStats, uint32 MaxNum)
+	{
+		_GetBufferRegistry().FlushOwner(m_State, false);
+		std::lock_guard<MutexLock> Lck(m_State->StatsLock);
+		uint32 CopyNum = Math::Min(MaxNum, m_State->SiteNum);
+		for (uint32 i = 0; i < CopyNum; ++i)
+		{
+			OutStats[i] = m_State->Sites[i];
+		}
+		return m_State->SiteNum;
+	}
+
+	int64 ProfilingAllocator::GetLiveBytes()
+	{
+		_GetBufferRegistry().FlushOwner(m_State, false);
+		std::lock_guard<MutexLock> Lck(m_State->StatsLock);
+		return m_State->LiveBytes;
+	}
+
+	int64 ProfilingAllocator::GetPeakBytes()
+	{
+		_GetBufferRegistry().FlushOwner(m_State, false);
+		std::lock_guard<MutexLock> Lck(m_State->StatsLock);
+		return m_State->PeakBytes;
+	}
+
+	void ProfilingAllocator::DumpReport()
+	{
+		AllocSiteStats* Sites = _OSNew<AllocSiteStats>(MaxSiteNum);
+		uint32 SiteNum = GetSiteStats(Sites, MaxSiteNum);
+		Algo::IntroSort(Sites, SiteNum, [](const AllocSiteStats& A, const AllocSiteStats& B) { return A.PeakBytes > B.PeakBytes; });
+
+		std::printf("%-32s %18s %10s %10s %10s %12s %10s %12s %12s %10s %12s\n",
+			"Site", "Callsite", "Allocs", "Frees", "Reallocs", "Bytes(KB)", "Live", "Live(KB)", "Peak(KB)", "AvgSize", "AvgLife(us)");
+		for (uint32 i = 0; i < SiteNum; ++i)
+		{
+			const AllocSiteStats& Site = Sites[i];
+			if (Site.AllocCount == 0) continue;
+			std::printf("%-32.32s %18p %10llu %10llu %10llu %12llu %10lld %12lld %12lld %10llu %12.2f\n",
+				Site.Tag, Site.Callsite,
+				(unsigned long long)Site.AllocCount, (unsigned long long)Site.FreeCount, (unsigned long long)Site.ReallocCount,
+				(unsigned long long)(Site.AllocBytes / 1024), (long long)Site.LiveCount, (long long)(Site.LiveBytes / 1024), (long long)(Site.PeakBytes / 1024),
+				(unsigned long long)(Site.AllocBytes / Site.AllocCount),
+				Site.FreeCount ? (double)Site.TotalLifetime / Site.FreeCount / 1000.0 : 0.0);
+
+			// non-empty buckets only
+			std::printf("    size:");
+			for (uint32 Bucket = 0; Bucket < AllocSiteStats::SizeBucketNum; ++Bucket)
+			{
+				if (Site.SizeHistogram[Bucket]) std::printf(" <%llu:%llu", 2ull << Bucket, (unsigned long long)Site.SizeHistogram[Bucket]);
+			}
+			std::printf("\n    life:");
+			uint64 Bound = 100;
+			for (uint32 Bucket = 0; Bucket < AllocSiteStats::LifetimeBucketNum; ++Bucket, Bound *= 10)
+			{
+				if (!Site.LifetimeHistogram[Bucket]) continue;
+				if (Bucket == AllocSiteStats::LifetimeBucketNum - 1)
+					std::printf(" >=%lluns:%llu", Bound / 10, (unsigned long long)Site.LifetimeHistogram[Bucket]);
+				else
+					std::printf(" <%lluns:%llu", Bound, (unsigned long long)Site.LifetimeHistogram[Bucket]);
+			}
+			std::printf("\n");
+		}
+		std::printf("live: %lld KB, peak: %lld KB\n", (long long)(GetLiveBytes() / 1024), (long long)(GetPeakBytes() / 1024));
+		_OSDelete(Sites, MaxSiteNum);
+	}
+
+	bool ProfilingAllocator::ExportCSV(const char* Path)
+	{
+		std::FILE* File = std::fopen(Path, "w");
+		if (!File) return false;
+
+		AllocSiteStats* Sites = _OSNew<AllocSiteStats>(MaxSiteNum);
+		uint32 SiteNum = GetSiteStats(Sites, MaxSiteNum);
+
+		std::fprintf(File, "Tag,Callsite,AllocCount,FreeCount,ReallocCount,AllocBytes,LiveCount,LiveBytes,PeakBytes,TotalLifetimeNs");
+		for (uint32 Bucket = 0; Bucket < AllocSiteStats::SizeBucketNum; ++Bucket)
+		{
+			std::fprintf(File, ",Size<%llu", 2ull << Bucket);
+		}
+		uint64 Bound = 100;
+		for (uint32 Bucket = 0; Bucket < AllocSiteStats::LifetimeBucketNum; ++Bucket, Bound *= 10)
+		{
+			if (Bucket == AllocSiteStats::LifetimeBucketNum - 1)
+				std::fprintf(File, ",Life>=%lluns", Bound / 10);
+			else
+				std::fprintf(File, ",Life<%lluns", Bound);
+		}
+		std::fprintf(File, "\n");
+
+		for (uint32 i = 0; i < SiteNum; ++i)
+		{
+			const AllocSiteStats& Site = Sites[i];
+			if (Site.AllocCount == 0) continue;
+			std::fprintf(File, "\"%s\",%p,%llu,%llu,%llu,%llu,%lld,%lld,%lld,%llu",
+				Site.Tag, Site.Callsite,
+				(unsigned long long)Site.AllocCount, (unsigned long long)Site.FreeCount, (unsigned long long)Site.ReallocCount,
+				(unsigned long long)Site.AllocBytes, (long long)Site.LiveCount, (long long)Site.LiveBytes, (long long)Site.PeakBytes, (unsigned long long)Site.TotalLifetime);
+			for (uint64 Count : Site.SizeHistogram) std::fprintf(File, ",%llu", (unsigned long long)Count);
+			for (uint64 Count : Site.LifetimeHistogram) std::fprintf(File, ",%llu", (unsigned long long)Count);
+			std::fprintf(File, "\n");
+		}
+
+		_OSDelete(Sites, MaxSiteNum);
+		return std::fclose(File) == 0;
+	}
+}
+
+// heap sampler state
+namespace Fuko
+{
+	struct SampledStack
+	{
+		uint64		Hash;
+		uint32		Depth;
+		const void*	Frames[HeapSampleStack::MaxDepth];
+	};
+
+	struct HeapSamplerState
+	{
+		static constexpr uint32 MaxStackNum = 4096;
+		static constexpr uint32 StackTableSize = MaxStackNum * 2;
+		static constexpr uint32 ShardNum = 16;
+		static constexpr uint32 FilterSize = 64 * 1024;
+
+		// mean bytes between samples, 0 when stopped
+		std::atomic<int64>		Interval;
+		MutexLock				ControlLock;
+
+		// stack 0 takes samples after the table is full
+		MutexLock				StackLock;
+		SampledStack			Stacks[MaxStackNum];
+		uint32					StackNum;
+		uint32					StackTable[StackTableSize];	// stack index + 1, 0 is empty
+
+		// live samples, site of a record is its stack
+		RecordShard				Shards[ShardNum];
+
+		// number of live samples per pointer hash, free skip the shard lock when it's 0
+		std::atomic<uint16>		Filter[FilterSize];
+
+		HeapSamplerState()
+			: Interval(0)
+			, Stacks{}
+			, StackNum(1)
+			, StackTable{}
+		{
+			for (std::atomic<uint16>& Count : Filter) Count.store(0, std::memory_order_relaxed);
+		}
+
+		FORCEINLINE RecordShard& ShardOf(void* Ptr) { return Shards[_HashPointer(Ptr) >> 60]; }
+		FORCEINLINE std::atomic<uint16>& FilterOf(void* Ptr) { return Filter[uint32(_HashPointer(Ptr) >> 40) & (FilterSize - 1)]; }
+
+		uint32 FindStack(const void* const* Frames, uint32 Depth)
+		{
+			uint64 Hash = Depth;
+			for (uint32 i = 0; i < Depth; ++i) Hash = (Hash ^ (uint64)(size_t)Frames[i]) * 0x9E3779B97F4A7C15ull;
+
+			std::lock_guard<MutexLock> Lck(StackLock);
+			uint32 Index = uint32(Hash >> 32) & (StackTableSize - 1);
+			while (StackTable[Index])
+			{
+				const SampledStack& Stack = Stacks[StackTable[Index] - 1];
+				if (Stack.Hash == Hash && Stack.Depth == Depth && !std::memcmp(Stack.Frames, Frames, Depth * sizeof(void*)))
+				{
+					return StackTable[Index] - 1;
+				}
+				Index = (Index + 1) & (StackTableSize - 1);
+			}
+
+			if (StackNum == MaxStackNum) return 0;
+			SampledStack& Stack = Stacks[StackNum];
+			Stack.Hash = Hash;
+			Stack.Depth = Depth;
+			std::memcpy(Stack.Frames, Frames, Depth * sizeof(void*));
+			StackTable[Index] = StackNum + 1;
+			return StackNum++;
+		}
+
+		// drop all live samples, stacks are kept
+		void Clear()
+		{
+			for (RecordShard& Shard : Shards)
+			{
+				std::lock_guard<ProfileLock> Lck(Shard.Lock);
+				for (uint32 i = 0; i < Shard.Capacity; ++i) Shard.Slots[i].Ptr = nullptr;
+				Shard.Num = 0;
+			}
+			for (std::atomic<uint16>& Count : Filter) Count.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// created by the first sampling allocator and never freed, sampled blocks may be freed during static destruction
+	static HeapSamplerState* g_HeapSampler = nullptr;
+	static HeapSamplerState* _GetHeapSampler()
+	{
+		static HeapSamplerState* s_Sampler = g_HeapSampler = _OSNew<HeapSamplerState>(1);
+		return s_Sampler;
+	}
+
+	// bytes to allocate before the next sample, zero initialized so the first allocation of a thread seeds it
+	struct HeapSampleCounter
+	{
+		int64	BytesLeft;
+		uint64	Rng;
+	};
+	static thread_local HeapSampleCounter t_HeapSampleCounter;
+
+	//====================================Begin help function====================================
+	// exponential distribution of mean Interval, gaps between points of a poisson process
+	FORCEINLINE int64 _NextSampleBytes(uint64& Rng, int64 Interval)
+	{
+		Rng ^= Rng << 13;
+		Rng ^= Rng >> 7;
+		Rng ^= Rng << 17;
+		double Uniform = (double)((Rng >> 11) + 1) * (1.0 / 9007199254740992.0);
+		return (int64)(-std::log(Uniform) * (double)Interval) + 1;
+	}
+
+	// chance an allocation of Size bytes is sampled
+	FORCEINLINE double _SampleProbability(size_t Size, int64 Interval)
+	{
+		return 1.0 - std::exp(-(double)Size / (double)Interval);
+	}
+
+	FORCENOINLINE static uint32 _CaptureStack(const void** Frames, uint32 MaxDepth, uint32 Skip)
+	{
+		// skip this function too
+		++Skip;
+#if PLATFORM_WINDOWS
+		return ::RtlCaptureStackBackTrace(Skip, MaxDepth, (PVOID*)Frames, nullptr);
+#elif defined(FUKO_HAS_BACKTRACE)
+		void* Buffer[HeapSampleStack::MaxDepth + 8];
+		int Depth = ::backtrace(Buffer, (int)Math::Min<uint32>(MaxDepth + Skip, HeapSampleStack::MaxDepth + 8));
+		uint32 Num = Depth > (int)Skip ? uint32(Depth - Skip) : 0;
+		for (uint32 i = 0; i < Num; ++i) Frames[i] = Buffer[i + Skip];
+		return Num;
+#else
+		Frames[0] = FUKO_RETURN_ADDRESS();
+		return 1;
+#endif
+	}
+
+	FORCEINLINE bool _IsSampled(void* Ptr)
+	{
+		return g_HeapSampler->FilterOf(Ptr).load(std::memory_order_relaxed) != 0;
+	}
+	//=====================================End help function=====================================
+}
+
+// sampling allocator
+namespace Fuko
+{
+	SamplingAllocator::SamplingAllocator(IAllocator* Inner)
+		: m_Inner(Inner)
+	{
+		check(m_Inner != nullptr && m_Inner != this);
+		_GetHeapSampler();
+	}
+
+	void SamplingAllocator::_OnSample(void* Ptr, size_t InSize)
+	{
+		HeapSamplerState* State = g_HeapSampler;
+		HeapSampleCounter& Counter = t_HeapSampleCounter;
+		int64 Interval = State->Interval.load(std::memory_order_relaxed);
+		if (!Interval)
+		{
+			Counter.BytesLeft = DefaultHeapSampleInterval;
+			return;
+		}
+
+		bool bSeeded = Counter.Rng != 0;
+		if (!bSeeded) Counter.Rng = (_HashPointer(&Counter) ^ _NowNs()) | 1;
+		Counter.BytesLeft = _NextSampleBytes(Counter.Rng, Interval);
+		if (!bSeeded) return;
+
+		// skip this function and the allocator entry
+		const void* Frames[HeapSampleStack::MaxDepth];
+		uint32 Depth = _CaptureStack(Frames, HeapSampleStack::MaxDepth, 2);
+		uint32 Stack = State->FindStack(Frames, Depth);
+
+		// filter first, a free can only see the pointer after we return
+		State->FilterOf(Ptr).fetch_add(1, std::memory_order_relaxed);
+		RecordShard& Shard = State->ShardOf(Ptr);
+		std::lock_guard<ProfileLock> Lck(Shard.Lock);
+		Shard.Add(LiveRecord{ Ptr, InSize, _NowNs(), Stack });
+	}
+
+	void SamplingAllocator::_OnSampledFree(void* Ptr)
+	{
+		HeapSamplerState* State = g_HeapSampler;
+		LiveRecord Record;
+		{
+			RecordShard& Shard = State->ShardOf(Ptr);
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			if (!Shard.Remove(Ptr, Record)) return;
+		}
+		State->FilterOf(Ptr).fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void* SamplingAllocator::Alloc(size_t InSize, size_t Alignment)
+	{
+		void* Ptr = m_Inner->Alloc(InSize, Alignment);
+		if (Ptr && (t_HeapSampleCounter.BytesLeft -= (int64)InSize) < 0) _OnSample(Ptr, InSize);
+		return Ptr;
+	}
+
+	void* SamplingAllocator::Realloc(void* InPtr, size_t InSize, size_t Alignment)
+	{
+		// forget the old block before its address can be reused, the result is counted as a new allocation
+		if (InPtr && _IsSampled(InPtr)) _OnSampledFree(InPtr);
+		void* NewPtr = m_Inner->Realloc(InPtr, InSize, Alignment);
+		if (NewPtr && (t_HeapSampleCounter.BytesLeft -= (int64)InSize) < 0) _OnSample(NewPtr, InSize);
+		return NewPtr;
+	}
+
+	void SamplingAllocator::Free(void* InPtr)
+	{
+		if (InPtr && _IsSampled(InPtr)) _OnSampledFree(InPtr);
+		m_Inner->Free(InPtr);
+	}
+
+	size_t SamplingAllocator::Size(void* Ptr, size_t Alignment)
+	{
+		return m_Inner->Size(Ptr, Alignment);
+	}
+
+	void SamplingAllocator::Trim()
+	{
+		m_Inner->Trim();
+	}
+}
+
+// heap sampling
+namespace Fuko
+{
+	// entry points keep pointing at these after stop, they must live forever
+	static SamplingAllocator& _DefaultSampler()
+	{
+		static SamplingAllocator s_Sampler(DefaultAllocator());
+		return s_Sampler;
+	}
+	static SamplingAllocator& _PoolSampler()
+	{
+		static SamplingAllocator s_Sampler(PoolAllocator());
+		return s_Sampler;
+	}
+
+	CORE_API void StartHeapSampling(size_t SampleInterval)
+	{
+		check(SampleInterval > 0);
+		HeapSamplerState* State = _GetHeapSampler();
+		std::lock_guard<MutexLock> Lck(State->ControlLock);
+		bool bRunning = State->Interval.exchange((int64)SampleInterval) != 0;
+		if (bRunning) return;
+
+		_DefaultSampler().SetInner(DefaultAllocator());
+		SetDefaultAllocator(&_DefaultSampler());
+		SetPoolAllocator(&_PoolSampler());
+	}
+
+	CORE_API void StopHeapSampling()
+	{
+		HeapSamplerState* State = _GetHeapSampler();
+		std::lock_guard<MutexLock> Lck(State->ControlLock);
+		if (State->Interval.exchange(0) == 0) return;
+
+		SetDefaultAllocator(_DefaultSampler().GetInner());
+		SetPoolAllocator(nullptr);
+		State->Clear();
+	}
+
+	CORE_API bool IsHeapSampling()
+	{
+		return g_HeapSampler && g_HeapSampler->Interval.load(std::memory_order_relaxed) != 0;
+	}
+
+	CORE_API uint32 GetHeapSampleSnapshot(HeapSampleStack* OutStacks, uint32 MaxNum)
+	{
+		static constexpr uint32 MaxStackNum = HeapSamplerState::MaxStackNum;
+		HeapSamplerState* State = _GetHeapSampler();
+		int64 Interval = State->Interval.load(std::memory_order_relaxed);
+		if (!Interval) return 0;
+
+		// accumulate in double, the estimates are sums of fractions
+		struct StackSum
+		{
+			uint64	SampleCount;
+			uint64	SampleBytes;
+			double	EstimatedCount;
+			double	EstimatedBytes;
+			uint64	OldestBirth;
+		};
+		StackSum* Sums = _OSNew<StackSum>(MaxStackNum);
+		uint64 Now = _NowNs();
+		for (RecordShard& Shard : State->Shards)
+		{
+			std::lock_guard<ProfileLock> Lck(Shard.Lock);
+			for (uint32 i = 0; i < Shard.Capacity; ++i)
+			{
+				const LiveRecord& Record = Shard.Slots[i];
+				if (!Record.Ptr) continue;
+				StackSum& Sum = Sums[Record.Site];
+				double Probability = _SampleProbability(Record.Size, Interval);
+				Sum.OldestBirth = Sum.SampleCount ? Math::Min(Sum.OldestBirth, Record.Birth) : Record.Birth;
+				++Sum.SampleCount;
+				Sum.SampleBytes += Record.Size;
+				Sum.EstimatedCount += 1.0 / Probability;
+				Sum.EstimatedBytes += (double)Record.Size / Probability;
+			}
+		}
+
+		// stacks are never changed once added
+		uint32 StackNum;
+		{
+			std::lock_guard<MutexLock> Lck(State->StackLock);
+			StackNum = State->StackNum;
+		}
+		HeapSampleStack* Stacks = _OSNew<HeapSampleStack>(MaxStackNum);
+		uint32 Num = 0;
+		for (uint32 i = 0; i < StackNum; ++i)
+		{
+			const StackSum& Sum = Sums[i];
+			if (!Sum.SampleCount) continue;
+			const SampledStack& Source = State->Stacks[i];
+			HeapSampleStack& Stack = Stacks[Num++];
+			std::memcpy(Stack.Frames, Source.Frames, Source.Depth * sizeof(void*));
+			Stack.Depth = Source.Depth;
+			Stack.SampleCount = Sum.SampleCount;
+			Stack.SampleBytes = Sum.SampleBytes;
+			Stack.EstimatedCount = (uint64)(Sum.EstimatedCount + 0.5);
+			Stack.EstimatedBytes = (uint64)(Sum.EstimatedBytes + 0.5);
+			Stack.OldestAge = Now > Sum.OldestBirth ? Now - Sum.OldestBirth : 0;
+		}
+		Algo::IntroSort(Stacks, Num, [](const HeapSampleStack& A, const HeapSampleStack& B) { return A.EstimatedBytes > B.EstimatedBytes; });
+
+		uint32 CopyNum = Math::Min(MaxNum, Num);
+		for (uint32 i = 0; i < CopyNum; ++i) OutStacks[i] = Stacks[i];
+		_OSDelete(Stacks, MaxStackNum);
+		_OSDelete(Sums, MaxStackNum);
+		return Num;
+	}
+
+	CORE_API void DumpHeapSampleSnapshot(uint32 MaxStackNum)
+	{
+		if (!MaxStackNum) return;
+		HeapSampleStack* Stacks = _OSNew<HeapSampleStack>(MaxStackNum);
+		uint32 Num = GetHeapSampleSnapshot(Stacks, MaxStackNum);
+		uint32 ShowNum = Math::Min(Num, MaxStackNum);
+
+		uint64 TotalBytes = 0;
+		for (uint32 i = 0; i < ShowNum; ++i) TotalBytes += Stacks[i].EstimatedBytes;
+		std::printf("heap samples: %u stacks, top %u hold ~%llu KB\n", Num, ShowNum, (unsigned long long)(TotalBytes / 1024));
+		for (uint32 i = 0; i < ShowNum; ++i)
+		{
+			const HeapSampleStack& Stack = Stacks[i];
+			std::printf("~%llu KB in ~%llu allocations (%llu samples, oldest %.1f s)\n",
+				(unsigned long long)(Stack.EstimatedBytes / 1024), (unsigned long long)Stack.EstimatedCount,
+				(unsigned long long)Stack.SampleCount, (double)Stack.OldestAge / 1e9);
+			if (!Stack.Depth) std::printf("    %s\n", OverflowName);
+			for (uint32 Frame = 0; Frame < Stack.Depth; ++Frame) std::printf("    #%u %p\n", Frame, Stack.Frames[Frame]);
+		}
+		_OSDelete(Stacks, MaxStackNum);
+	}
+}
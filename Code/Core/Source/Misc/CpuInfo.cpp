@@ -0,0 +1,89 @@
+#include <Misc/CpuInfo.h>
+#if PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <intrin.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Fuko
+{
+	// used when os can't tell
+	inline constexpr size_t DefaultLastLevelCacheSize = 8 * 1024 * 1024;
+
+	//====================================Begin help function====================================
+	static void _DetectIsa(CpuInfo& Info)
+	{
+#if CPU_X86 && defined(_MSC_VER)
+		int Regs[4];
+		__cpuid(Regs, 0);
+		int MaxLeaf = Regs[0];
+
+		__cpuid(Regs, 1);
+		Info.SSE2 = (Regs[3] >> 26) & 1;
+		Info.SSE42 = (Regs[2] >> 20) & 1;
+		Info.POPCNT = (Regs[2] >> 23) & 1;
+		Info.PCLMUL = (Regs[2] >> 1) & 1;
+		bool bOSYmm = ((Regs[2] >> 27) & 1) && ((Regs[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+
+		if (MaxLeaf >= 7)
+		{
+			__cpuidex(Regs, 7, 0);
+			Info.AVX2 = bOSYmm && ((Regs[1] >> 5) & 1);
+			Info.BMI1 = (Regs[1] >> 3) & 1;
+			Info.BMI2 = (Regs[1] >> 8) & 1;
+		}
+#elif CPU_X86
+		__builtin_cpu_init();
+		Info.SSE2 = __builtin_cpu_supports("sse2");
+		Info.SSE42 = __builtin_cpu_supports("sse4.2");
+		Info.POPCNT = __builtin_cpu_supports("popcnt");
+		Info.PCLMUL = __builtin_cpu_supports("pclmul");
+		Info.AVX2 = __builtin_cpu_supports("avx2");
+		Info.BMI1 = __builtin_cpu_supports("bmi");
+		Info.BMI2 = __builtin_cpu_supports("bmi2");
+#endif
+	}
+	static size_t _DetectLastLevelCache()
+	{
+		size_t Ret = 0;
+#if PLATFORM_WINDOWS
+		DWORD Bytes = 0;
+		::GetLogicalProcessorInformation(nullptr, &Bytes);
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION Buffer[256];
+		if (Bytes <= sizeof(Buffer) && ::GetLogicalProcessorInformation(Buffer, &Bytes))
+		{
+			BYTE Level = 0;
+			for (DWORD i = 0; i < Bytes / sizeof(Buffer[0]); ++i)
+			{
+				if (Buffer[i].Relationship != RelationCache || Buffer[i].Cache.Level < Level) continue;
+				Level = Buffer[i].Cache.Level;
+				Ret = Buffer[i].Cache.Size;
+			}
+		}
+#else
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+		long Size = ::sysconf(_SC_LEVEL3_CACHE_SIZE);
+		if (Size <= 0) Size = ::sysconf(_SC_LEVEL2_CACHE_SIZE);
+		if (Size > 0) Ret = (size_t)Size;
+#endif
+#endif
+		return Ret ? Ret : DefaultLastLevelCacheSize;
+	}
+	static CpuInfo _DetectCpu()
+	{
+		CpuInfo Info = {};
+		_DetectIsa(Info);
+		Info.LastLevelCacheSize = _DetectLastLevelCache();
+		return Info;
+	}
+	//=====================================End help function=====================================
+
+	CORE_API const CpuInfo& GetCpuInfo()
+	{
+		static const CpuInfo s_Info = _DetectCpu();
+		return s_Info;
+	}
+}
@@ -1,6 +1,11 @@
 #include "Misc/Crc.h"
 #include "Templates/UtilityTemp.h"
 #include "Misc/ByteSwap.h"
+#include "Misc/CpuInfo.h"
+#include <atomic>
+#if CPU_X86
+#include <immintrin.h>
+#endif
 
 enum { Crc32Poly = 0x04c11db7 };
 
@@ -14,49 +19,235 @@ FORCEINLINE uint32 ReverseBits(uint32 Bits)
 	return Bits;
 }
 
-uint32 Fuko::Crc::MemCrc32(const void* InData, int32 Length, uint32 CRC)
+// kernels, all of them take and return the inverted crc
+namespace Fuko::Crc
 {
-	CRC = ~CRC;
+	using CrcFunc = uint32(*)(const uint8*, int32, uint32);
 
-	const uint8* __restrict Data = (uint8*)InData;
+	// folding need 4 lanes of 16 bytes to start
+	inline constexpr int32 CrcFoldMinSize = 64;
 
-	// First we need to align to 32-bits
-	int32 InitBytes = static_cast<int32>(Align(Data, 4) - Data);
+	// reflected 0x1edc6f41
+	inline constexpr uint32 Crc32CPolyReflected = 0x82f63b78u;
 
-	if (Length > InitBytes)
+	// castagnoli table, slicing by 8 like CRCTablesSB8
+	struct Crc32CTables
 	{
-		Length -= InitBytes;
+		uint32 Tables[8][256];
+	};
+	static constexpr Crc32CTables _MakeCrc32CTables()
+	{
+		Crc32CTables Ret = {};
+		for (uint32 i = 0; i < 256; ++i)
+		{
+			uint32 CRC = i;
+			for (int Bit = 0; Bit < 8; ++Bit) CRC = (CRC >> 1) ^ (Crc32CPolyReflected & (0u - (CRC & 1)));
+			Ret.Tables[0][i] = CRC;
+		}
+		for (uint32 i = 0; i < 256; ++i)
+		{
+			for (int Table = 1; Table < 8; ++Table)
+			{
+				uint32 Prev = Ret.Tables[Table - 1][i];
+				Ret.Tables[Table][i] = (Prev >> 8) ^ Ret.Tables[0][Prev & 0xFF];
+			}
+		}
+		return Ret;
+	}
+	static constexpr Crc32CTables g_Crc32CTables = _MakeCrc32CTables();
+
+	//====================================Begin help function====================================
+	static FORCEINLINE uint32 _CrcSlicing8(const uint32 (&Tables)[8][256], const uint8* Data, int32 Length, uint32 CRC)
+	{
+		// First we need to align to 32-bits
+		int32 InitBytes = static_cast<int32>(Align(Data, 4) - Data);
+
+		if (Length > InitBytes)
+		{
+			Length -= InitBytes;
+
+			for (; InitBytes; --InitBytes)
+			{
+				CRC = (CRC >> 8) ^ Tables[0][(CRC & 0xFF) ^ *Data++];
+			}
+
+			auto Data4 = (const uint32*)Data;
+			for (uint32 Repeat = Length / 8; Repeat; --Repeat)
+			{
+				uint32 V1 = *Data4++ ^ CRC;
+				uint32 V2 = *Data4++;
+				CRC =
+					Tables[7][V1 & 0xFF] ^
+					Tables[6][(V1 >> 8) & 0xFF] ^
+					Tables[5][(V1 >> 16) & 0xFF] ^
+					Tables[4][V1 >> 24] ^
+					Tables[3][V2 & 0xFF] ^
+					Tables[2][(V2 >> 8) & 0xFF] ^
+					Tables[1][(V2 >> 16) & 0xFF] ^
+					Tables[0][V2 >> 24];
+			}
+			Data = (const uint8*)Data4;
+
+			Length %= 8;
+		}
 
-		for (; InitBytes; --InitBytes)
+		for (; Length; --Length)
 		{
-			CRC = (CRC >> 8) ^ CRCTablesSB8[0][(CRC & 0xFF) ^ *Data++];
+			CRC = (CRC >> 8) ^ Tables[0][(CRC & 0xFF) ^ *Data++];
 		}
+		return CRC;
+	}
+	static uint32 _Crc32Table(const uint8* Data, int32 Length, uint32 CRC) { return _CrcSlicing8(CRCTablesSB8, Data, Length, CRC); }
+	static uint32 _Crc32CTable(const uint8* Data, int32 Length, uint32 CRC) { return _CrcSlicing8(g_Crc32CTables.Tables, Data, Length, CRC); }
+
+#if CPU_X86
+	// carry-less multiply folding for the reflected 0x04c11db7 polynomial (intel, "fast crc computation using pclmulqdq")
+	// fold 4x128 bits by 512 bits, then 128 by 128, then reduce 128 to 64 and barrett reduce 64 to 32
+	alignas(16) static const uint64 g_CrcK1K2[2] = { 0x0154442bd4ull, 0x01c6e41596ull };
+	alignas(16) static const uint64 g_CrcK3K4[2] = { 0x01751997d0ull, 0x00ccaa009eull };
+	alignas(16) static const uint64 g_CrcK5K0[2] = { 0x0163cd6124ull, 0x0000000000ull };
+	alignas(16) static const uint64 g_CrcPoly[2] = { 0x01db710641ull, 0x01f7011641ull };
+
+	CPU_TARGET("sse4.1,pclmul") static FORCEINLINE __m128i _CrcFold(__m128i Acc, __m128i K, __m128i Next)
+	{
+		__m128i Lo = _mm_clmulepi64_si128(Acc, K, 0x00);
+		__m128i Hi = _mm_clmulepi64_si128(Acc, K, 0x11);
+		return _mm_xor_si128(_mm_xor_si128(Hi, Lo), Next);
+	}
+	CPU_TARGET("sse4.1,pclmul") static uint32 _Crc32PCLMUL(const uint8* Data, int32 Length, uint32 CRC)
+	{
+		if (Length < CrcFoldMinSize) return _Crc32Table(Data, Length, CRC);
+		int32 Tail = Length & 15;
+		Length -= Tail;
 
-		auto Data4 = (const uint32*)Data;
-		for (uint32 Repeat = Length / 8; Repeat; --Repeat)
+		__m128i X1 = _mm_loadu_si128((const __m128i*)Data + 0);
+		__m128i X2 = _mm_loadu_si128((const __m128i*)Data + 1);
+		__m128i X3 = _mm_loadu_si128((const __m128i*)Data + 2);
+		__m128i X4 = _mm_loadu_si128((const __m128i*)Data + 3);
+		X1 = _mm_xor_si128(X1, _mm_cvtsi32_si128((int)CRC));
+		Data += 64;
+		Length -= 64;
+
+		__m128i K = _mm_load_si128((const __m128i*)g_CrcK1K2);
+		for (; Length >= 64; Length -= 64, Data += 64)
+		{
+			X1 = _CrcFold(X1, K, _mm_loadu_si128((const __m128i*)Data + 0));
+			X2 = _CrcFold(X2, K, _mm_loadu_si128((const __m128i*)Data + 1));
+			X3 = _CrcFold(X3, K, _mm_loadu_si128((const __m128i*)Data + 2));
+			X4 = _CrcFold(X4, K, _mm_loadu_si128((const __m128i*)Data + 3));
+		}
+
+		K = _mm_load_si128((const __m128i*)g_CrcK3K4);
+		X1 = _CrcFold(X1, K, X2);
+		X1 = _CrcFold(X1, K, X3);
+		X1 = _CrcFold(X1, K, X4);
+		for (; Length >= 16; Length -= 16, Data += 16)
 		{
-			uint32 V1 = *Data4++ ^ CRC;
-			uint32 V2 = *Data4++;
-			CRC =
-				CRCTablesSB8[7][V1 & 0xFF] ^
-				CRCTablesSB8[6][(V1 >> 8) & 0xFF] ^
-				CRCTablesSB8[5][(V1 >> 16) & 0xFF] ^
-				CRCTablesSB8[4][V1 >> 24] ^
-				CRCTablesSB8[3][V2 & 0xFF] ^
-				CRCTablesSB8[2][(V2 >> 8) & 0xFF] ^
-				CRCTablesSB8[1][(V2 >> 16) & 0xFF] ^
-				CRCTablesSB8[0][V2 >> 24];
+			X1 = _CrcFold(X1, K, _mm_loadu_si128((const __m128i*)Data));
 		}
-		Data = (const uint8*)Data4;
 
-		Length %= 8;
+		// 128 -> 64
+		const __m128i Mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+		__m128i X2b = _mm_clmulepi64_si128(X1, K, 0x10);
+		X1 = _mm_xor_si128(_mm_srli_si128(X1, 8), X2b);
+		K = _mm_loadl_epi64((const __m128i*)g_CrcK5K0);
+		X2b = _mm_srli_si128(X1, 4);
+		X1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(X1, Mask32), K, 0x00), X2b);
+
+		// 64 -> 32
+		K = _mm_load_si128((const __m128i*)g_CrcPoly);
+		X2b = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(X1, Mask32), K, 0x10), Mask32);
+		X1 = _mm_xor_si128(X1, _mm_clmulepi64_si128(X2b, K, 0x00));
+		CRC = (uint32)_mm_extract_epi32(X1, 1);
+
+		return Tail ? _Crc32Table(Data, Tail, CRC) : CRC;
 	}
 
-	for (; Length; --Length)
+	// the crc32 instruction only knows castagnoli, 8 bytes per instruction once aligned
+	CPU_TARGET("sse4.2") static uint32 _Crc32CSSE42(const uint8* Data, int32 Length, uint32 CRC)
 	{
-		CRC = (CRC >> 8) ^ CRCTablesSB8[0][(CRC & 0xFF) ^ *Data++];
+		for (; Length && ((size_t)Data & 7); --Length) CRC = _mm_crc32_u8(CRC, *Data++);
+#if defined(_M_X64) || defined(__x86_64__)
+		uint64 CRC64 = CRC;
+		for (; Length >= 32; Length -= 32, Data += 32)
+		{
+			CRC64 = _mm_crc32_u64(CRC64, *(const uint64*)(Data + 0));
+			CRC64 = _mm_crc32_u64(CRC64, *(const uint64*)(Data + 8));
+			CRC64 = _mm_crc32_u64(CRC64, *(const uint64*)(Data + 16));
+			CRC64 = _mm_crc32_u64(CRC64, *(const uint64*)(Data + 24));
+		}
+		for (; Length >= 8; Length -= 8, Data += 8) CRC64 = _mm_crc32_u64(CRC64, *(const uint64*)Data);
+		CRC = (uint32)CRC64;
+#else
+		for (; Length >= 4; Length -= 4, Data += 4) CRC = _mm_crc32_u32(CRC, *(const uint32*)Data);
+#endif
+		for (; Length; --Length) CRC = _mm_crc32_u8(CRC, *Data++);
+		return CRC;
 	}
+#endif
+	//=====================================End help function=====================================
+}
 
-	return ~CRC;
+// dispatch
+namespace Fuko::Crc
+{
+	static uint32 _Crc32Resolve(const uint8* Data, int32 Length, uint32 CRC);
+	static uint32 _Crc32CResolve(const uint8* Data, int32 Length, uint32 CRC);
+
+	// start at resolvers, so a call during static init still works
+	static std::atomic<CrcFunc>		g_Crc32 = &_Crc32Resolve;
+	static std::atomic<CrcFunc>		g_Crc32C = &_Crc32CResolve;
+	static std::atomic<const char*>	g_CrcIsa = nullptr;
+
+	//====================================Begin help function====================================
+	static void _ResolveCrc()
+	{
+		CrcFunc Crc32 = &_Crc32Table;
+		CrcFunc Crc32C = &_Crc32CTable;
+		const char* Isa = "table";
+#if CPU_X86
+		const CpuInfo& Info = GetCpuInfo();
+		if (Info.PCLMUL && Info.SSE42)
+		{
+			Crc32 = &_Crc32PCLMUL;
+			Isa = "pclmul";
+		}
+		if (Info.SSE42)
+		{
+			Crc32C = &_Crc32CSSE42;
+			if (!Info.PCLMUL) Isa = "sse4.2";
+		}
+#endif
+		// every thread resolve the same value, relaxed is enough
+		g_Crc32.store(Crc32, std::memory_order_relaxed);
+		g_Crc32C.store(Crc32C, std::memory_order_relaxed);
+		g_CrcIsa.store(Isa, std::memory_order_relaxed);
+	}
+	static uint32 _Crc32Resolve(const uint8* Data, int32 Length, uint32 CRC)
+	{
+		_ResolveCrc();
+		return g_Crc32.load(std::memory_order_relaxed)(Data, Length, CRC);
+	}
+	static uint32 _Crc32CResolve(const uint8* Data, int32 Length, uint32 CRC)
+	{
+		_ResolveCrc();
+		return g_Crc32C.load(std::memory_order_relaxed)(Data, Length, CRC);
+	}
+	//=====================================End help function=====================================
+
+	CORE_API uint32 MemCrc32(const void* Data, int32 Length, uint32 CRC)
+	{
+		return ~g_Crc32.load(std::memory_order_relaxed)((const uint8*)Data, Length, ~CRC);
+	}
+
+	CORE_API uint32 MemCrc32C(const void* Data, int32 Length, uint32 CRC)
+	{
+		return ~g_Crc32C.load(std::memory_order_relaxed)((const uint8*)Data, Length, ~CRC);
+	}
+
+	CORE_API const char* GetCrcIsa()
+	{
+		if (!g_CrcIsa.load(std::memory_order_relaxed)) _ResolveCrc();
+		return g_CrcIsa.load(std::memory_order_relaxed);
+	}
 }
-#
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include <Misc/Hash.h>
+#include <Misc/CpuInfo.h>
+#include <atomic>
+#include <cstring>
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+// kernels
+namespace Fuko
+{
+	// stripes are accumulated into 8 lanes, a block of stripes is followed by a scramble
+	inline constexpr size_t HashStripeSize = 64;
+	inline constexpr size_t HashStripesPerBlock = 16;
+	inline constexpr size_t HashBlockSize = HashStripeSize * HashStripesPerBlock;
+	inline constexpr size_t HashLongMinSize = 256;
+
+	// stripe n use lanes [n, n + 8) of the secret, the scramble use the last 8 lanes
+	inline constexpr size_t HashSecretLanes = HashStripesPerBlock + 8;
+	inline constexpr size_t HashScrambleLane = HashSecretLanes - 8;
+	inline constexpr size_t HashLastStripeLane = 9;
+	inline constexpr uint64 HashScramblePrime = 0x9E3779B1u;
+
+	struct HashLongSecret
+	{
+		alignas(32) uint64 Lanes[HashSecretLanes];
+	};
+	static constexpr HashLongSecret _MakeHashSecret()
+	{
+		// splitmix64
+		HashLongSecret Secret = {};
+		uint64 State = HashSecret[0];
+		for (size_t i = 0; i < HashSecretLanes; ++i)
+		{
+			uint64 Z = (State += 0x9E3779B97F4A7C15ull);
+			Z = (Z ^ (Z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			Z = (Z ^ (Z >> 27)) * 0x94d049bb133111ebull;
+			Secret.Lanes[i] = Z ^ (Z >> 31);
+		}
+		return Secret;
+	}
+	static constexpr HashLongSecret g_HashLongSecret = _MakeHashSecret();
+
+	using HashAccumulateFunc = void(*)(uint64* Acc, const uint8* Data, size_t StripeNum, const uint64* Secret);
+	using HashScrambleFunc = void(*)(uint64* Acc, const uint64* Secret);
+
+	//====================================Begin help function====================================
+	static FORCEINLINE uint64 _Read64(const uint8* P) { uint64 V; memcpy(&V, P, 8); return V; }
+	static FORCEINLINE uint64 _Read32(const uint8* P) { uint32 V; memcpy(&V, P, 4); return V; }
+	static FORCEINLINE uint64 _Read3(const uint8* P, size_t Length) { return ((uint64)P[0] << 16) | ((uint64)P[Length >> 1] << 8) | P[Length - 1]; }
+
+	// wyhash final v4
+	static uint64 _HashShort(const uint8* P, size_t Length, uint64 Seed)
+	{
+		Seed ^= MulFold64(Seed ^ HashSecret[0], HashSecret[1]);
+		uint64 A, B;
+		if (Length <= 16)
+		{
+			if (Length >= 4)
+			{
+				size_t Offset = (Length >> 3) << 2;
+				A = (_Read32(P) << 32) | _Read32(P + Offset);
+				B = (_Read32(P + Length - 4) << 32) | _Read32(P + Length - 4 - Offset);
+			}
+			else if (Length > 0)
+			{
+				A = _Read3(P, Length);
+				B = 0;
+			}
+			else
+			{
+				A = B = 0;
+			}
+		}
+		else
+		{
+			size_t Left = Length;
+			if (Left > 48)
+			{
+				uint64 Seed1 = Seed, Seed2 = Seed;
+				do
+				{
+					Seed = MulFold64(_Read64(P) ^ HashSecret[1], _Read64(P + 8) ^ Seed);
+					Seed1 = MulFold64(_Read64(P + 16) ^ HashSecret[2], _Read64(P + 24) ^ Seed1);
+					Seed2 = MulFold64(_Read64(P + 32) ^ HashSecret[3], _Read64(P + 40) ^ Seed2);
+					P += 48;
+					Left -= 48;
+				} while (Left > 48);
+				Seed ^= Seed1 ^ Seed2;
+			}
+			while (Left > 16)
+			{
+				Seed = MulFold64(_Read64(P) ^ HashSecret[1], _Read64(P + 8) ^ Seed);
+				P += 16;
+				Left -= 16;
+			}
+			A = _Read64(P + Left - 16);
+			B = _Read64(P + Left - 8);
+		}
+		Mul128(A ^ HashSecret[1], B ^ Seed, A, B);
+		return MulFold64(A ^ HashSecret[0] ^ Length, B ^ HashSecret[1]);
+	}
+
+	// lane i take the 32x32 product of its own keyed input and the raw input of lane i ^ 1
+	static void _HashAccumulateScalar(uint64* Acc, const uint8* Data, size_t StripeNum, const uint64* Secret)
+	{
+		for (size_t Stripe = 0; Stripe < StripeNum; ++Stripe, Data += HashStripeSize)
+		{
+			for (size_t i = 0; i < 8; ++i)
+			{
+				uint64 Value = _Read64(Data + i * 8);
+				uint64 Keyed = Value ^ Secret[Stripe + i];
+				Acc[i ^ 1] += Value;
+				Acc[i] += (Keyed & 0xFFFFFFFFu) * (Keyed >> 32);
+			}
+		}
+	}
+	static void _HashScrambleScalar(uint64* Acc, const uint64* Secret)
+	{
+		for (size_t i = 0; i < 8; ++i)
+		{
+			uint64 Value = Acc[i];
+			Value ^= Value >> 47;
+			Value ^= Secret[i];
+			Acc[i] = Value * HashScramblePrime;
+		}
+	}
+
+#if CPU_X86
+	static void _HashAccumulateSSE2(uint64* Acc, const uint8* Data, size_t StripeNum, const uint64* Secret)
+	{
+		__m128i A[4];
+		for (int i = 0; i < 4; ++i) A[i] = _mm_loadu_si128((const __m128i*)Acc + i);
+		for (size_t Stripe = 0; Stripe < StripeNum; ++Stripe, Data += HashStripeSize)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				__m128i Value = _mm_loadu_si128((const __m128i*)Data + i);
+				__m128i Keyed = _mm_xor_si128(Value, _mm_loadu_si128((const __m128i*)(Secret + Stripe) + i));
+				__m128i Product = _mm_mul_epu32(Keyed, _mm_shuffle_epi32(Keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+				A[i] = _mm_add_epi64(A[i], _mm_shuffle_epi32(Value, _MM_SHUFFLE(1, 0, 3, 2)));
+				A[i] = _mm_add_epi64(A[i], Product);
+			}
+		}
+		for (int i = 0; i < 4; ++i) _mm_storeu_si128((__m128i*)Acc + i, A[i]);
+	}
+	static void _HashScrambleSSE2(uint64* Acc, const uint64* Secret)
+	{
+		const __m128i Prime = _mm_set1_epi32((int)HashScramblePrime);
+		for (int i = 0; i < 4; ++i)
+		{
+			__m128i Value = _mm_loadu_si128((const __m128i*)Acc + i);
+			Value = _mm_xor_si128(Value, _mm_srli_epi64(Value, 47));
+			Value = _mm_xor_si128(Value, _mm_loadu_si128((const __m128i*)Secret + i));
+			__m128i Lo = _mm_mul_epu32(Value, Prime);
+			__m128i Hi = _mm_mul_epu32(_mm_srli_epi64(Value, 32), Prime);
+			_mm_storeu_si128((__m128i*)Acc + i, _mm_add_epi64(Lo, _mm_slli_epi64(Hi, 32)));
+		}
+	}
+	CPU_TARGET("avx2") static void _HashAccumulateAVX2(uint64* Acc, const uint8* Data, size_t StripeNum, const uint64* Secret)
+	{
+		__m256i A0 = _mm256_loadu_si256((const __m256i*)Acc + 0);
+		__m256i A1 = _mm256_loadu_si256((const __m256i*)Acc + 1);
+		for (size_t Stripe = 0; Stripe < StripeNum; ++Stripe, Data += HashStripeSize)
+		{
+			__m256i V0 = _mm256_loadu_si256((const __m256i*)Data + 0);
+			__m256i V1 = _mm256_loadu_si256((const __m256i*)Data + 1);
+			__m256i K0 = _mm256_xor_si256(V0, _mm256_loadu_si256((const __m256i*)(Secret + Stripe) + 0));
+			__m256i K1 = _mm256_xor_si256(V1, _mm256_loadu_si256((const __m256i*)(Secret + Stripe) + 1));
+			A0 = _mm256_add_epi64(A0, _mm256_shuffle_epi32(V0, _MM_SHUFFLE(1, 0, 3, 2)));
+			A1 = _mm256_add_epi64(A1, _mm256_shuffle_epi32(V1, _MM_SHUFFLE(1, 0, 3, 2)));
+			A0 = _mm256_add_epi64(A0, _mm256_mul_epu32(K0, _mm256_shuffle_epi32(K0, _MM_SHUFFLE(0, 3, 0, 1))));
+			A1 = _mm256_add_epi64(A1, _mm256_mul_epu32(K1, _mm256_shuffle_epi32(K1, _MM_SHUFFLE(0, 3, 0, 1))));
+		}
+		_mm256_storeu_si256((__m256i*)Acc + 0, A0);
+		_mm256_storeu_si256((__m256i*)Acc + 1, A1);
+	}
+	CPU_TARGET("avx2") static void _HashScrambleAVX2(uint64* Acc, const uint64* Secret)
+	{
+		const __m256i Prime = _mm256_set1_epi32((int)HashScramblePrime);
+		for (int i = 0; i < 2; ++i)
+		{
+			__m256i Value = _mm256_loadu_si256((const __m256i*)Acc + i);
+			Value = _mm256_xor_si256(Value, _mm256_srli_epi64(Value, 47));
+			Value = _mm256_xor_si256(Value, _mm256_loadu_si256((const __m256i*)Secret + i));
+			__m256i Lo = _mm256_mul_epu32(Value, Prime);
+			__m256i Hi = _mm256_mul_epu32(_mm256_srli_epi64(Value, 32), Prime);
+			_mm256_storeu_si256((__m256i*)Acc + i, _mm256_add_epi64(Lo, _mm256_slli_epi64(Hi, 32)));
+		}
+	}
+#endif
+
+	// whole blocks, then whole stripes, then the last 64 bytes (may overlap the stripes before)
+	template<HashAccumulateFunc Accumulate, HashScrambleFunc Scramble>
+	static uint64 _HashLong(const uint8* P, size_t Length, uint64 Seed)
+	{
+		const uint64* Secret = g_HashLongSecret.Lanes;
+		uint64 Acc[8];
+		for (size_t i = 0; i < 8; ++i) Acc[i] = HashSecret[i & 3] + Seed;
+
+		size_t BlockNum = (Length - 1) / HashBlockSize;
+		for (size_t Block = 0; Block < BlockNum; ++Block)
+		{
+			Accumulate(Acc, P + Block * HashBlockSize, HashStripesPerBlock, Secret);
+			Scramble(Acc, Secret + HashScrambleLane);
+		}
+		size_t Tail = BlockNum * HashBlockSize;
+		Accumulate(Acc, P + Tail, (Length - 1 - Tail) / HashStripeSize, Secret);
+		Accumulate(Acc, P + Length - HashStripeSize, 1, Secret + HashLastStripeLane);
+
+		uint64 Result = Length * 0x9E3779B185EBCA87ull ^ Seed;
+		for (size_t i = 0; i < 8; i += 2)
+		{
+			Result += MulFold64(Acc[i] ^ Secret[i], Acc[i + 1] ^ Secret[i + 1]);
+		}
+		return MixHash64(Result);
+	}
+}
+
+// dispatch
+namespace Fuko
+{
+	using HashLongFunc = uint64(*)(const uint8*, size_t, uint64);
+
+	static uint64 _HashLongResolve(const uint8* P, size_t Length, uint64 Seed);
+
+	// start at the resolver, so a call during static init still works
+	static std::atomic<HashLongFunc>	g_HashLong = &_HashLongResolve;
+	static std::atomic<const char*>		g_HashIsa = nullptr;
+
+	//====================================Begin help function====================================
+	static void _ResolveHash()
+	{
+		HashLongFunc Func = &_HashLong<&_HashAccumulateScalar, &_HashScrambleScalar>;
+		const char* Isa = "scalar";
+#if CPU_X86
+		const CpuInfo& Info = GetCpuInfo();
+		if (Info.AVX2)
+		{
+			Func = &_HashLong<&_HashAccumulateAVX2, &_HashScrambleAVX2>;
+			Isa = "avx2";
+		}
+		else if (Info.SSE2)
+		{
+			Func = &_HashLong<&_HashAccumulateSSE2, &_HashScrambleSSE2>;
+			Isa = "sse2";
+		}
+#endif
+		// every thread resolve the same value, relaxed is enough
+		g_HashLong.store(Func, std::memory_order_relaxed);
+		g_HashIsa.store(Isa, std::memory_order_relaxed);
+	}
+	static uint64 _HashLongResolve(const uint8* P, size_t Length, uint64 Seed)
+	{
+		_ResolveHash();
+		return g_HashLong.load(std::memory_order_relaxed)(P, Length, Seed);
+	}
+	//=====================================End help function=====================================
+
+	CORE_API uint64 MemHash64(const void* Data, size_t Length, uint64 Seed)
+	{
+		if (Length < HashLongMinSize) return _HashShort((const uint8*)Data, Length, Seed);
+		return g_HashLong.load(std::memory_order_relaxed)((const uint8*)Data, Length, Seed);
+	}
+
+	CORE_API const char* GetHashIsa()
+	{
+		if (!g_HashIsa.load(std::memory_order_relaxed)) _ResolveHash();
+		return g_HashIsa.load(std::memory_order_relaxed);
+	}
+}
@@ -324,4 +324,29 @@ void TestArray()
 		A.HeapPush(100, TGreater<>());
 		always_check(A.HeapTop() == 100);
 	}
+	// inline allocator
+	{
+		TArray<int, Fuko::TInlineAlloc<8>> A;
+		for (int i = 0; i < 8; ++i) A.Add(i);
+		always_check(A.GetAllocator().IsInline(A.GetData()));
+
+		// move relocate inline elements
+		TArray<int, Fuko::TInlineAlloc<8>> B(std::move(A));
+		always_check(B.Num() == 8 && A.Num() == 0);
+		always_check(B.GetAllocator().IsInline(B.GetData()));
+		for (int i = 0; i < 8; ++i) always_check(B[i] == i);
+
+		// spill to secondary allocator and back
+		for (int i = 8; i < 100; ++i) B.Add(i);
+		always_check(!B.GetAllocator().IsInline(B.GetData()));
+		for (int i = 0; i < 100; ++i) always_check(B[i] == i);
+		B.SetNum(4);
+		B.Shrink();
+		always_check(B.GetAllocator().IsInline(B.GetData()));
+		for (int i = 0; i < 4; ++i) always_check(B[i] == i);
+
+		TArray<int, Fuko::TInlineAlloc<8>> C;
+		C = B;
+		always_check(C.Num() == 4 && C.GetAllocator().IsInline(C.GetData()));
+	}
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+#include <Containers/BTreeMap.h>
+#include <Containers/SortedFlatMap.h>
+#include <Containers/Array.h>
+#include <iostream>
+#include <chrono>
+#include <map>
+
+using Fuko::TBTreeMap;
+
+// same ops on the tree and the reference, then compare every pair in order
+template<typename MapType>
+static void _BTreeRandomOps(MapType& Map, std::map<int32, int32>& Ref, int OpNum, int32 KeyRange, uint32 Seed)
+{
+	for (int i = 0; i < OpNum; ++i)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		int32 Key = (int32)((Seed >> 8) % (uint32)KeyRange);
+		switch ((Seed >> 28) % 5)
+		{
+		case 0: Map.Add(Key, i); Ref[Key] = i; break;
+		case 1: always_check(Map.FindOrAdd(Key, i) == Ref.emplace(Key, i).first->second); break;
+		case 2:
+		case 3: always_check(Map.Remove(Key) == (uint32)Ref.erase(Key)); break;
+		case 4:
+		{
+			auto It = Ref.find(Key);
+			const int32* Value = Map.Find(Key);
+			always_check((Value != nullptr) == (It != Ref.end()));
+			if (Value) always_check(*Value == It->second);
+			break;
+		}
+		}
+	}
+	Map.CheckInvariants();
+	always_check(Map.Num() == (uint32)Ref.size());
+	auto It = Ref.begin();
+	for (auto Pair : Map)
+	{
+		always_check(Pair.Key == It->first && Pair.Value == It->second);
+		++It;
+	}
+	always_check(It == Ref.end());
+}
+
+void TestBTreeMap()
+{
+	using PairType = Fuko::TPair<int32, int32>;
+
+	// behaviour, against std::map, small nodes make a deep tree so split, borrow and merge run at every level
+	{
+		TBTreeMap<int32, int32, Fuko::PmrAlloc, TLess<int32>, 128> Small;
+		TBTreeMap<int32, int32> Map;
+		std::map<int32, int32> SmallRef, Ref;
+		always_check(Map.IsEmpty() && Map.Height() == 0 && Map.Find(1) == nullptr && !Map.LowerBound(0));
+
+		for (uint32 Round = 0; Round < 8; ++Round)
+		{
+			_BTreeRandomOps(Small, SmallRef, 20000, 4000, Round);
+			_BTreeRandomOps(Map, Ref, 20000, 4000, Round);
+		}
+		always_check(Small.Height() > Map.Height());
+
+		// remove every key, the tree fold back to empty
+		for (auto& Pair : SmallRef) always_check(Small.Remove(Pair.first) == 1);
+		Small.CheckInvariants();
+		always_check(Small.IsEmpty() && Small.Height() == 0 && Small.begin() == Small.end());
+
+		// lower bound iteration, bounds and range scan
+		for (int32 Key = -5; Key < 4005; Key += 7)
+		{
+			auto Lower = Map.LowerBound(Key);
+			auto RefLower = Ref.lower_bound(Key);
+			always_check((bool)Lower == (RefLower != Ref.end()));
+			for (int Step = 0; Lower && Step < 10; ++Step, ++Lower, ++RefLower) always_check(Lower.Key() == RefLower->first && Lower.Value() == RefLower->second);
+
+			auto Upper = Map.UpperBound(Key);
+			auto RefUpper = Ref.upper_bound(Key);
+			always_check(Upper ? Upper.Key() == RefUpper->first : RefUpper == Ref.end());
+
+			int Count = 0;
+			for (auto Pair : Map.Range(Key, Key + 100))
+			{
+				always_check(Pair.Key >= Key && Pair.Key < Key + 100);
+				++Count;
+			}
+			always_check(Count == (int)std::distance(Ref.lower_bound(Key), Ref.lower_bound(Key + 100)));
+			int64 Sum = 0, RefSum = 0;
+			Map.ForEachRange(Key, Key + 100, [&](const int32& InKey, int32& Value) { Sum += InKey + Value; });
+			for (auto It = Ref.lower_bound(Key); It != Ref.lower_bound(Key + 100); ++It) RefSum += It->first + It->second;
+			always_check(Sum == RefSum);
+		}
+		always_check(Map.Range(100, 50).IsEmpty());
+		always_check(Map.First().Key() == Ref.begin()->first && Map.Last().Key() == Ref.rbegin()->first);
+
+		// copy and move
+		TBTreeMap<int32, int32> Copy = Map;
+		Copy.CheckInvariants();
+		always_check(Copy.Num() == Map.Num());
+		for (auto Pair : Map) always_check(Copy.FindChecked(Pair.Key) == Pair.Value);
+		TBTreeMap<int32, int32> Moved = std::move(Copy);
+		always_check(Copy.IsEmpty() && Moved.Num() == Map.Num());
+		Copy = Moved;
+		Moved.Empty();
+		always_check(Moved.IsEmpty() && Copy.Num() == Map.Num());
+
+		int32 Value = 0;
+		always_check(Map.RemoveAndCopyValue(Ref.begin()->first, Value) && Value == Ref.begin()->second);
+		always_check(!Map.RemoveAndCopyValue(-1, Value));
+	}
+
+	// bulk load and merge insert, the last pair of a key win, values own memory
+	{
+		using TagMap = TBTreeMap<int32, Fuko::TArray<int32>, Fuko::PmrAlloc, TLess<int32>, 256>;
+		Fuko::TArray<Fuko::TPair<int32, Fuko::TArray<int32>>> Pairs;
+		for (int i = 0; i < 20000; ++i) Pairs.Add({ (i * 7919) % 10000, Fuko::TArray<int32>(i, (uint32)(i % 4 + 1)) });
+		TagMap Map;
+		Map.Build(std::move(Pairs));
+		Map.CheckInvariants();
+		always_check(Map.Num() == 10000);
+		for (auto Pair : Map) always_check(Pair.Value.Num() == Pair.Value[0] % 4 + 1 && Pair.Value[0] >= 10000 && (Pair.Value[0] * 7919) % 10000 == Pair.Key);
+
+		// large batch rebuild, small batch insert, both replace existing values
+		for (int32 BatchStep : { 2, 97 })
+		{
+			Fuko::TArray<Fuko::TPair<int32, Fuko::TArray<int32>>> Batch;
+			for (int32 Key = -1000; Key < 12000; Key += BatchStep) Batch.Add({ Key, Fuko::TArray<int32>(-Key, 1) });
+			Map.Merge(std::move(Batch));
+			Map.CheckInvariants();
+			for (int32 Key = -1000; Key < 12000; Key += BatchStep) always_check(Map.FindChecked(Key)[0] == -Key);
+		}
+		always_check(Map.Contains(1) && Map.Contains(-1000) && Map.Contains(11998) && !Map.Contains(10001));
+		while (Map.Num() > 10) Map.Remove(Map.First().Key());
+		Map.CheckInvariants();
+		while (!Map.IsEmpty()) Map.Remove(Map.Last().Key());
+		always_check(Map.Height() == 0 && !Map.First());
+
+		TBTreeMap<int32, int32> Init{ { 5, 50 }, { 1, 10 }, { 3, 30 }, { 1, 11 } };
+		always_check(Init.Num() == 3 && Init.FindChecked(1) == 11 && Init.First().Key() == 1 && Init.Last().Value() == 50);
+	}
+
+	// lookup and range scan over 1M keys, against std::map and the sorted flat map
+	{
+		static constexpr int KeyNum = 1 << 20;
+		Fuko::TArray<PairType> Pairs;
+		Pairs.Reserve(KeyNum);
+		for (int i = 0; i < KeyNum; ++i) Pairs.Add(PairType((int32)((uint32)i * 2654435761u & 0x3FFFFFFF), i));
+
+		TBTreeMap<int32, int32> Map;
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (const PairType& Pair : Pairs) Map.Add(Pair.Key, Pair.Value);
+		auto mid = std::chrono::high_resolution_clock::now();
+		std::map<int32, int32> Ref;
+		for (const PairType& Pair : Pairs) Ref.emplace(Pair.Key, Pair.Value);
+		auto end = std::chrono::high_resolution_clock::now();
+		Map.CheckInvariants();
+		std::cout << "insert 1M, btree map : " << std::chrono::duration<double, std::milli>(mid - begin).count()
+			<< " ms, std::map : " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+
+		begin = std::chrono::high_resolution_clock::now();
+		Map.Build(Pairs.GetData(), Pairs.Num());
+		end = std::chrono::high_resolution_clock::now();
+		Map.CheckInvariants();
+		std::cout << "bulk load 1M, btree map : " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms, height " << Map.Height() << std::endl;
+
+		Fuko::TSortedFlatMap<int32, int32> Flat;
+		Flat.Build(Pairs.GetData(), Pairs.Num());
+		int64 Sum[3] = {};
+		double Time[3];
+		// visit out of insertion order, std::map nodes are allocated in that order and would get a cache friendly walk otherwise
+		auto Bench = [&](int Index, auto&& Find, auto&& Scan)
+		{
+			auto BenchBegin = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < KeyNum; i += 3) Sum[Index] += Find(Pairs[((uint32)i * 7919u) & (KeyNum - 1)].Key);
+			for (int i = 0; i < KeyNum; i += 1024) Sum[Index] += Scan(Pairs[i].Key, Pairs[i].Key + (1 << 20));
+			auto BenchEnd = std::chrono::high_resolution_clock::now();
+			Time[Index] = std::chrono::duration<double, std::milli>(BenchEnd - BenchBegin).count();
+		};
+		Bench(0, [&](int32 Key) { return *Map.Find(Key); }, [&](int32 Lower, int32 Upper)
+		{
+			int64 Result = 0;
+			Map.ForEachRange(Lower, Upper, [&](const int32&, int32& Value) { Result += Value; });
+			return Result;
+		});
+		Bench(1, [&](int32 Key) { return *Flat.Find(Key); }, [&](int32 Lower, int32 Upper)
+		{
+			int64 Result = 0;
+			for (const PairType& Pair : Flat.Range(Lower, Upper)) Result += Pair.Value;
+			return Result;
+		});
+		Bench(2, [&](int32 Key) { return Ref.find(Key)->second; }, [&](int32 Lower, int32 Upper)
+		{
+			int64 Result = 0;
+			for (auto It = Ref.lower_bound(Lower), Last = Ref.lower_bound(Upper); It != Last; ++It) Result += It->second;
+			return Result;
+		});
+		always_check(Sum[0] == Sum[2] && Sum[1] == Sum[2]);
+		std::cout << "find and range scan, btree map : " << Time[0] << " ms, sorted flat map : " << Time[1] << " ms, std::map : " << Time[2] << " ms" << std::endl;
+	}
+}
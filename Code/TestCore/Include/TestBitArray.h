@@ -1,8 +1,111 @@
 #pragma once
 #include <Containers/BitArray.h>
+#include <iostream>
+#include <chrono>
+#include <random>
 
 using Fuko::TBitArray;
 
+// bulk ops against a bit by bit reference, sizes cross every kernel tail
+static void _TestBitArrayBulk()
+{
+	std::mt19937 Rand(1234);
+	const int Sizes[] = { 1, 31, 32, 33, 63, 64, 65, 255, 256, 257, 1000, 2048 + 17, 4096, 10007 };
+	for (int SizeA : Sizes)
+	{
+		for (int SizeB : Sizes)
+		{
+			TBitArray<> A(false, SizeA);
+			TBitArray<> B(false, SizeB);
+			for (int i = 0; i < SizeA; ++i) A[i] = (Rand() & 3) == 0;
+			for (int i = 0; i < SizeB; ++i) B[i] = (Rand() & 1) == 0;
+
+			// count 
+			int Count = 0;
+			for (int i = 0; i < SizeA; ++i) Count += A[i] ? 1 : 0;
+			always_check(A.CountSetBits() == Count);
+			const int Index = (int)(Rand() % SizeA);
+			const int Num = (int)(Rand() % (SizeA - Index + 1));
+			int RangeCount = 0;
+			for (int i = Index; i < Index + Num; ++i) RangeCount += A[i] ? 1 : 0;
+			always_check(A.CountSetBits(Index, Num) == RangeCount);
+
+			// find next 
+			for (int Start = 0; Start <= SizeA; Start += 1 + (int)(Rand() % 97))
+			{
+				for (int Value = 0; Value < 2; ++Value)
+				{
+					int Expect = INDEX_NONE;
+					for (int i = Start; i < SizeA; ++i)
+					{
+						if (A[i] == (Value != 0))
+						{
+							Expect = i;
+							break;
+						}
+					}
+					always_check(A.FindNext(Value != 0, Start) == Expect);
+				}
+			}
+
+			// bitwise 
+			for (int Op = 0; Op < 4; ++Op)
+			{
+				TBitArray<> R(A);
+				switch (Op)
+				{
+				case 0: R &= B; break;
+				case 1: R |= B; break;
+				case 2: R ^= B; break;
+				case 3: R.BitwiseAndNot(B); break;
+				}
+				always_check(R.Num() == SizeA);
+				for (int i = 0; i < SizeA; ++i)
+				{
+					const bool a = A[i];
+					const bool b = i < SizeB ? (bool)B[i] : false;
+					const bool Expect = Op == 0 ? (a & b) : Op == 1 ? (a | b) : Op == 2 ? (a ^ b) : (a & !b);
+					always_check(R[i] == Expect);
+				}
+			}
+		}
+	}
+
+	// sparse mask, the skip of empty words is what find is for 
+	TBitArray<> Sparse(false, 1000000);
+	Sparse[999999] = true;
+	always_check(Sparse.Find(true) == 999999);
+	always_check(Sparse.FindNext(true, 500000) == 999999);
+	Sparse.Init(true, 1000000);
+	Sparse[777777] = false;
+	always_check(Sparse.FindAndSetFirstZeroBit() == 777777);
+	always_check(!Sparse.Contains(false));
+	Sparse.SetRange(100, 100000, false);
+	always_check(Sparse.CountSetBits() == 1000000 - 100000);
+	always_check(Sparse.Find(false) == 100 && Sparse.FindNext(true, 100) == 100100);
+
+	// throughput on visibility sized masks 
+	static constexpr int MaskNum = 1 << 24;
+	TBitArray<> X(false, MaskNum);
+	TBitArray<> Y(false, MaskNum);
+	TBitArray<> Z(false, MaskNum);
+	for (int i = 0; i < MaskNum; i += 3) X[i] = true;
+	for (int i = 0; i < MaskNum; i += 7) Y[i] = true;
+	auto Bench = [](auto&& Func)
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < 20; ++r) Func();
+		auto end = std::chrono::high_resolution_clock::now();
+		return 20.0 * (MaskNum / 8) / std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	};
+	int64 Sink = 0;
+	double AndSpeed = Bench([&] { X &= Y; X |= Y; });
+	double CountSpeed = Bench([&] { Sink += X.CountSetBits(); });
+	double FindSpeed = Bench([&] { Sink += Z.Find(true); });
+	std::cout << "BitArray (" << Fuko::Algo::GetBitOpsIsa() << ") and+or " << AndSpeed * 2 << " GB/s, count " << CountSpeed
+		<< " GB/s, find " << FindSpeed << " GB/s " << (Sink & 1) << std::endl;
+}
+
 void TestBitArray()
 {
 	TBitArray A;
@@ -165,4 +268,5 @@ void TestBitArray()
 	}
 	always_check(count == 7);
 
+	_TestBitArrayBulk();
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#pragma once
+#include <Containers/ConcurrentMap.h>
+#include <Containers/Map.h>
+#include <Memory/ProfilingAllocator.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <string>
+
+using Fuko::TConcurrentMap;
+
+// two halves always written together, a torn read break A == ~B
+struct ConcurrentPayload
+{
+	uint64 A = 0;
+	uint64 B = ~0ull;
+};
+
+template<typename TFunc>
+static void _ConcurrentRun(int ThreadNum, TFunc&& Func)
+{
+	std::vector<std::thread> Threads;
+	for (int i = 0; i < ThreadNum; ++i) Threads.emplace_back([&Func, i] { Func(i); });
+	for (auto& Thread : Threads) Thread.join();
+}
+
+// one mutex around a TMap, what shared caches did before
+template<typename K, typename V>
+struct ConcurrentMutexMap
+{
+	std::mutex		Mtx;
+	Fuko::TMap<K, V> Map;
+
+	bool Find(const K& Key, V& OutValue)
+	{
+		std::lock_guard<std::mutex> Guard(Mtx);
+		const V* Value = Map.Find(Key);
+		if (Value) OutValue = *Value;
+		return Value != nullptr;
+	}
+	void Add(const K& Key, const V& Value)
+	{
+		std::lock_guard<std::mutex> Guard(Mtx);
+		Map.Add(Key, Value);
+	}
+	bool Remove(const K& Key)
+	{
+		std::lock_guard<std::mutex> Guard(Mtx);
+		return Map.Remove(Key) != 0;
+	}
+};
+
+// million ops per second, each thread run OpNum ops, ReadPercent of them are finds
+template<typename MapType>
+static double _ConcurrentBench(MapType& Map, int ThreadNum, int KeyNum, int OpNum, int ReadPercent)
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+	std::atomic<int64> Sink = 0;
+	_ConcurrentRun(ThreadNum, [&](int Thread)
+	{
+		uint64 Rand = 88172645463325252ull + Thread * 0x9E3779B97F4A7C15ull;
+		int64 Found = 0;
+		for (int i = 0; i < OpNum; ++i)
+		{
+			Rand ^= Rand << 13; Rand ^= Rand >> 7; Rand ^= Rand << 17;
+			int32 Key = (int32)(Rand % (uint64)KeyNum);
+			int Dice = (int)((Rand >> 40) % 100);
+			int64 Value;
+			if (Dice < ReadPercent) Found += Map.Find(Key, Value) ? 1 : 0;
+			else if (Dice & 1) Map.Add(Key, (int64)Key);
+			else Map.Remove(Key);
+		}
+		Sink += Found;
+	});
+	auto end = std::chrono::high_resolution_clock::now();
+	return (double)ThreadNum * OpNum / std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+}
+
+void TestConcurrentMap()
+{
+	// single thread behaviour, against TMap
+	{
+		TConcurrentMap<int32, int32> Map(8);
+		Fuko::TMap<int32, int32> Ref;
+		always_check(Map.NumShards() == 8 && Map.Num() == 0);
+		always_check(!Map.Contains(1));
+		for (int i = 0; i < 100000; ++i)
+		{
+			int32 Key = (int32)((uint32)i * 2654435761u) % 50000;
+			switch (i % 5)
+			{
+			case 0: Map.Add(Key, i); Ref.Add(Key, i); break;
+			case 1: always_check(Map.FindOrAdd(Key, i) == Ref.FindOrAdd(Key, i)); break;
+			case 2: always_check(Map.Update(Key, -i) == Ref.Contains(Key)); if (Ref.Contains(Key)) Ref[Key] = -i; break;
+			case 3: always_check(Map.Remove(Key) == (Ref.Remove(Key) != 0)); break;
+			case 4:
+			{
+				int32 Value = 0;
+				const int32* RefValue = Ref.Find(Key);
+				always_check(Map.Find(Key, Value) == (RefValue != nullptr));
+				if (RefValue) always_check(Value == *RefValue);
+				break;
+			}
+			}
+		}
+		always_check(Map.Num() == Ref.Num());
+		int Visit = 0;
+		Map.ForEach([&](const int32& Key, const int32& Value) { always_check(Ref[Key] == Value); ++Visit; });
+		always_check(Visit == Ref.Num());
+		int32 Removed = 0;
+		for (auto& Pair : Ref)
+		{
+			always_check(Map.RemoveAndCopyValue(Pair.Key, Removed) && Removed == Pair.Value);
+		}
+		always_check(Map.Num() == 0);
+		Map.Reclaim();
+		Map.Add(7, 7);
+		Map.Empty();
+		always_check(Map.Num() == 0 && !Map.Contains(7));
+	}
+
+	// remove and add at a steady Num, removed slots are rehashed in place and no table is retired
+	{
+		Fuko::ProfilingAllocator Profiler(Fuko::DefaultAllocator());
+		{
+			TConcurrentMap<int32, int32> Map(1, Fuko::PmrAlloc(&Profiler));
+			for (int32 Key = 0; Key < 1000; ++Key) Map.Add(Key, Key);
+			const int64 WarmBytes = Profiler.GetLiveBytes();
+			for (int32 Key = 1000; Key < 1000000; ++Key)
+			{
+				always_check(Map.Remove(Key - 1000));
+				Map.Add(Key, Key);
+			}
+			always_check(Map.Num() == 1000 && Map.Contains(999999) && !Map.Contains(998999));
+			for (int32 Key = 999000; Key < 1000000; ++Key) always_check(Map.FindOrAdd(Key) == Key);
+			always_check(Profiler.GetLiveBytes() <= WarmBytes * 2);
+		}
+		always_check(Profiler.GetLiveBytes() == 0);
+	}
+
+	// pairs not trivially copyable are read under lock
+	{
+		TConcurrentMap<std::string, std::string> Map;
+		always_check(!Map.bLockFreeRead);
+		for (int i = 0; i < 1000; ++i) Map.Add(std::to_string(i), std::string(40, (char)('a' + i % 26)));
+		std::string Value;
+		always_check(Map.Find("999", Value) && Value == std::string(40, 'a' + 999 % 26));
+		always_check(Map.UpdateWith("5", [](std::string& InValue) { InValue += "!"; }));
+		always_check(Map.FindOrAdd("5").back() == '!');
+		always_check(Map.Remove("5") && !Map.Contains("5") && Map.Num() == 999);
+	}
+
+	// readers never see a torn payload while writers grow, update, remove and add back
+	{
+		static constexpr int KeyNum = 20000;
+		TConcurrentMap<int32, ConcurrentPayload> Map(16);
+		std::atomic<bool> bStop = false;
+		std::atomic<int64> Torn = 0;
+		const int ThreadNum = Fuko::Math::Max((int)std::thread::hardware_concurrency(), 4);
+		_ConcurrentRun(ThreadNum, [&](int Thread)
+		{
+			if (Thread < ThreadNum / 2)
+			{
+				for (int Round = 0; Round < 4; ++Round)
+				{
+					for (int Key = Thread; Key < KeyNum; Key += ThreadNum / 2)
+					{
+						uint64 A = (uint64)Key * 31 + Round;
+						if (!Map.Update(Key, { A, ~A })) Map.FindOrAdd(Key, { A, ~A });
+						if ((Key + Round) % 7 == 0) Map.Remove(Key);
+					}
+				}
+				if (Thread == 0) bStop = true;
+			}
+			else
+			{
+				ConcurrentPayload Value;
+				while (!bStop)
+				{
+					for (int Key = Thread; Key < KeyNum; Key += 13)
+					{
+						if (Map.Find(Key, Value) && Value.A != ~Value.B) ++Torn;
+					}
+				}
+			}
+		});
+		always_check(Torn == 0);
+		int Visit = 0;
+		Map.ForEach([&](const int32& Key, const ConcurrentPayload& Value) { always_check(Value.A == ~Value.B && Value.A / 31 == (uint64)Key); ++Visit; });
+		always_check(Visit == Map.Num());
+	}
+
+	// scalability, read heavy and write heavy, against one mutex around a TMap
+	static constexpr int BenchKeyNum = 1 << 16;
+	static constexpr int BenchOpNum = 200000;
+	const int MaxThreads = Fuko::Math::Max((int)std::thread::hardware_concurrency(), 1);
+	std::cout << "threads\tread95 concurrent\tread95 mutex\twrite50 concurrent\twrite50 mutex (Mops/s)" << std::endl;
+	for (int ThreadNum = 1; ; ThreadNum *= 2)
+	{
+		ThreadNum = Fuko::Math::Min(ThreadNum, MaxThreads);
+		double Result[4];
+		for (int Case = 0; Case < 4; ++Case)
+		{
+			const int ReadPercent = Case < 2 ? 95 : 50;
+			if (Case & 1)
+			{
+				ConcurrentMutexMap<int32, int64> Map;
+				for (int i = 0; i < BenchKeyNum; i += 2) Map.Add(i, i);
+				Result[Case] = _ConcurrentBench(Map, ThreadNum, BenchKeyNum, BenchOpNum, ReadPercent);
+			}
+			else
+			{
+				TConcurrentMap<int32, int64> Map;
+				for (int i = 0; i < BenchKeyNum; i += 2) Map.Add(i, i);
+				Result[Case] = _ConcurrentBench(Map, ThreadNum, BenchKeyNum, BenchOpNum, ReadPercent);
+			}
+		}
+		std::cout.precision(3);
+		std::cout << ThreadNum << "\t" << Result[0] << "\t" << Result[1] << "\t" << Result[2] << "\t" << Result[3] << std::endl;
+		if (ThreadNum == MaxThreads) break;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Misc/Crc.h>
+#include <Containers/Array.h>
+#include <iostream>
+#include <chrono>
+
+// bit by bit reference, reflected polynomial
+static uint32 _CrcReference(const uint8* Data, int32 Length, uint32 CRC, uint32 Poly)
+{
+	CRC = ~CRC;
+	for (int32 i = 0; i < Length; ++i)
+	{
+		CRC ^= Data[i];
+		for (int Bit = 0; Bit < 8; ++Bit) CRC = (CRC >> 1) ^ (Poly & (0u - (CRC & 1)));
+	}
+	return ~CRC;
+}
+
+void TestCrc()
+{
+	using Fuko::Crc::MemCrc32;
+	using Fuko::Crc::MemCrc32C;
+
+	// check values
+	always_check(MemCrc32("123456789", 9) == 0xcbf43926);
+	always_check(MemCrc32C("123456789", 9) == 0xe3069283);
+	always_check(MemCrc32("", 0) == 0 && MemCrc32C("", 0) == 0);
+
+	// every length around the fold sizes and every misalignment, chained crc too
+	Fuko::TArray<uint8> Data;
+	Data.SetNumUninitialized(1024 + 16);
+	for (int i = 0; i < Data.Num(); ++i) Data[i] = (uint8)((uint32)i * 2654435761u >> 13);
+	for (int Offset = 0; Offset < 16; ++Offset)
+	{
+		for (int32 Length = 0; Length <= 1024; Length += (Length < 300 ? 1 : 37))
+		{
+			const uint8* Ptr = Data.GetData() + Offset;
+			always_check(MemCrc32(Ptr, Length, 7) == _CrcReference(Ptr, Length, 7, 0xedb88320u));
+			always_check(MemCrc32C(Ptr, Length, 7) == _CrcReference(Ptr, Length, 7, 0x82f63b78u));
+		}
+	}
+	always_check(MemCrc32(Data.GetData() + 100, 900, MemCrc32(Data.GetData(), 100)) == MemCrc32(Data.GetData(), 1000));
+
+	// throughput, the tables run about 1 byte per cycle
+	static constexpr int32 CrcBytes = 4 << 20;
+	Fuko::TArray<uint8> Big;
+	Big.SetNumUninitialized(CrcBytes);
+	for (int32 i = 0; i < CrcBytes; ++i) Big[i] = (uint8)(i * 7);
+	uint32 Sink = 0;
+	auto Bench = [&](auto&& Func)
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < 50; ++r) Sink += Func();
+		auto end = std::chrono::high_resolution_clock::now();
+		return 50.0 * CrcBytes / std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	};
+	double Crc32Speed = Bench([&] { return MemCrc32(Big.GetData(), CrcBytes); });
+	double Crc32CSpeed = Bench([&] { return MemCrc32C(Big.GetData(), CrcBytes); });
+	std::cout << "MemCrc32 (" << Fuko::Crc::GetCrcIsa() << ") " << Crc32Speed << " GB/s, MemCrc32C " << Crc32CSpeed << " GB/s " << (Sink & 1) << std::endl;
+}
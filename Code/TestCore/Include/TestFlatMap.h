@@ -0,0 +1,199 @@
+#pragma once
+#include <Containers/FlatMap.h>
+#include <Containers/Map.h>
+#include <iostream>
+#include <chrono>
+#include <unordered_map>
+
+using Fuko::TFlatSet;
+using Fuko::TFlatMap;
+
+struct FlatCounted
+{
+	static int LiveNum;
+	int Value;
+
+	FlatCounted(int InValue = 0) : Value(InValue) { ++LiveNum; }
+	FlatCounted(const FlatCounted& Other) : Value(Other.Value) { ++LiveNum; }
+	FlatCounted& operator=(const FlatCounted& Other) = default;
+	~FlatCounted() { --LiveNum; }
+};
+int FlatCounted::LiveNum = 0;
+
+template<typename TFunc>
+static double _FlatBenchNs(int OpNum, TFunc&& Func)
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+	Func();
+	auto end = std::chrono::high_resolution_clock::now();
+	return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / OpNum;
+}
+
+// distinct keys spread over the whole int range, miss keys use indices past Num
+FORCEINLINE int32 _FlatBenchKey(int Index) { return (int32)((uint32)Index * 2654435761u); }
+
+// random visit order, TMap keeps elements in insertion order and would get a cache friendly walk otherwise
+static void _FlatBenchShuffle(Fuko::TArray<int32>& Order, int Num)
+{
+	Order.SetNumUninitialized(Num);
+	for (int i = 0; i < Num; ++i) Order[i] = _FlatBenchKey(i);
+	uint64 Rand = 88172645463325252ull;
+	for (int i = Num - 1; i > 0; --i)
+	{
+		Rand ^= Rand << 13; Rand ^= Rand >> 7; Rand ^= Rand << 17;
+		std::swap(Order[i], Order[(int)(Rand % (uint64)(i + 1))]);
+	}
+}
+
+template<typename MapType>
+static void _FlatBenchMap(const char* Name, int Num)
+{
+	// small maps repeat lookups to get a stable time
+	int Repeat = Fuko::Math::Max(1, 1000000 / Num);
+	int64 Sum = 0;
+	MapType Map;
+	Fuko::TArray<int32> Order;
+	_FlatBenchShuffle(Order, Num);
+
+	double Insert = _FlatBenchNs(Num, [&] { for (int i = 0; i < Num; ++i) Map.Add(_FlatBenchKey(i), i); });
+	double Hit = _FlatBenchNs(Num * Repeat, [&]
+	{
+		for (int r = 0; r < Repeat; ++r)
+			for (int i = 0; i < Num; ++i) Sum += *Map.Find(Order[i]);
+	});
+	// misses go through a volatile sink, the optimizer fold the whole miss loop of TMap otherwise
+	const void* volatile MissSink = nullptr;
+	double Miss = _FlatBenchNs(Num * Repeat, [&]
+	{
+		for (int r = 0; r < Repeat; ++r)
+			for (int i = Num; i < Num * 2; ++i) MissSink = Map.Find(_FlatBenchKey(i));
+	});
+	always_check(MissSink == nullptr);
+	double Erase = _FlatBenchNs(Num, [&] { for (int i = 0; i < Num; ++i) Sum += Map.Remove(Order[i]); });
+	always_check(Map.Num() == 0 && Sum == (int64)Repeat * Num * (Num - 1) / 2 + Num);
+
+	std::cout.precision(3);
+	std::cout << Name << "\t" << Num << "\t" << Insert << "\t" << Hit << "\t" << Miss << "\t" << Erase << std::endl;
+}
+
+void TestFlatMap()
+{
+	// set
+	{
+		TFlatSet<int> A = { 1,2,3,4,5 };
+		always_check(A.Num() == 5 && A.Max() >= 5);
+		always_check(A.Contains(3) && !A.Contains(6));
+		bool bIsAlreadyInSet = false;
+		A.Add(3, &bIsAlreadyInSet);
+		always_check(bIsAlreadyInSet && A.Num() == 5);
+
+		TFlatSet<int> B(A);
+		TFlatSet<int> C(std::move(B));
+		always_check(B.Num() == 0 && C == A);
+		B = C;
+		always_check(B == A);
+		always_check(C.Remove(1) == 1 && C.Remove(1) == 0 && C != A);
+
+		int Sum = 0;
+		for (int Value : C) Sum += Value;
+		always_check(Sum == 2 + 3 + 4 + 5);
+		always_check(C.Array().Num() == 4);
+
+		int32 Capacity = A.GetCapacity();
+		A.Reset();
+		always_check(A.Num() == 0 && A.GetCapacity() == Capacity && !A.Contains(3));
+		A.Reset();
+		always_check(A.GetCapacity() == Capacity);
+		A.Empty();
+		always_check(A.GetCapacity() == 0 && !A.Contains(3));
+	}
+
+	// map
+	{
+		TFlatMap<int, int> M;
+		for (int i = 0; i < 10000; ++i) M[i] = i * 15;
+		always_check(M.Num() == 10000);
+		for (int i = 0; i < 10000; ++i) always_check(M[i] == i * 15);
+
+		M.Add(5, 1);
+		always_check(M.Num() == 10000 && M[5] == 1);
+		always_check(M.FindOrAdd(5, 2) == 1 && M.FindOrAdd(10000, 2) == 2);
+
+		int Removed = 0;
+		always_check(M.RemoveAndCopyValue(6, Removed) && Removed == 90 && !M.Contains(6));
+		always_check(M.FindAndRemoveChecked(7) == 105);
+		always_check(M.Find(7) == nullptr);
+
+		// remove while iterating, odd keys
+		for (auto It = M.begin(); It; ++It)
+		{
+			if (It.Key() & 1) It.RemoveCurrent();
+		}
+		for (const auto& Pair : M) always_check((Pair.Key & 1) == 0);
+		always_check(M.Num() == 5000);
+
+		Fuko::TArray<int> Keys;
+		M.GenerateKeyArray(Keys);
+		always_check(Keys.Num() == M.Num());
+
+		M.Shrink();
+		always_check(M.Num() == 5000 && M.Max() >= 5000 && M.Max() < 10000);
+	}
+
+	// random ops against std::unordered_map, small key range so tombstones pile up
+	{
+		TFlatMap<int, int> M;
+		std::unordered_map<int, int> Shadow;
+		uint32 Rand = 7;
+		for (int i = 0; i < 300000; ++i)
+		{
+			Rand = Rand * 1664525u + 1013904223u;
+			int Key = (int)((Rand >> 8) % 4096);
+			switch ((Rand >> 28) % 3)
+			{
+			case 0:
+				M.Add(Key, i);
+				Shadow[Key] = i;
+				break;
+			case 1:
+				always_check(M.Remove(Key) == (int)Shadow.erase(Key));
+				break;
+			default:
+			{
+				auto It = Shadow.find(Key);
+				int* Found = M.Find(Key);
+				always_check((It == Shadow.end()) == (Found == nullptr));
+				if (Found) always_check(*Found == It->second);
+			}
+			}
+		}
+		always_check(M.Num() == (int)Shadow.size());
+		for (auto& Pair : Shadow) always_check(M[Pair.first] == Pair.second);
+	}
+
+	// element lifetime over rehash, replace, copy and remove
+	{
+		{
+			TFlatMap<int, FlatCounted> M;
+			for (int i = 0; i < 1000; ++i) M.Add(i, FlatCounted(i));
+			always_check(FlatCounted::LiveNum == 1000);
+			M.Add(1, FlatCounted(-1));
+			always_check(FlatCounted::LiveNum == 1000 && M[1].Value == -1);
+			TFlatMap<int, FlatCounted> Copy(M);
+			always_check(FlatCounted::LiveNum == 2000);
+			for (int i = 0; i < 1000; i += 2) M.Remove(i);
+			always_check(FlatCounted::LiveNum == 1500);
+			M.Reset();
+			always_check(FlatCounted::LiveNum == 1000);
+		}
+		always_check(FlatCounted::LiveNum == 0);
+	}
+
+	// insert, hit, miss and erase against the chained TMap
+	std::cout << "map\tnum\tinsert\thit\tmiss\terase (ns/op)" << std::endl;
+	for (int Num = 1000; Num <= 10000000; Num *= 10)
+	{
+		_FlatBenchMap<Fuko::TMap<int32, int32>>("TMap", Num);
+		_FlatBenchMap<TFlatMap<int32, int32>>("TFlatMap", Num);
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include <Containers/FrozenMap.h>
+#include <Containers/FlatMap.h>
+#include <FileSystem/MappedFile.h>
+#include <Containers/Array.h>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+using Fuko::TFrozenMap;
+
+void TestFrozenMap()
+{
+	using PairType = Fuko::TPair<uint32, uint32>;
+
+	// every key found at a dense index, absent keys missed, last pair of a key win
+	{
+		TFrozenMap<uint32, uint32> Map;
+		always_check(Map.IsEmpty() && Map.Find(1) == nullptr && Map.IndexOf(1) == (uint32)INDEX_NONE);
+
+		for (uint32 Num : { 1u, 2u, 7u, 100u, 5000u, 100000u })
+		{
+			Fuko::TArray<PairType> Pairs;
+			for (uint32 i = 0; i < Num; ++i) Pairs.Add(PairType(i * 2654435761u, i));
+			for (uint32 i = 0; i < Num; i += 3) Pairs.Add(PairType(i * 2654435761u, i + Num));
+			Map.Build(Pairs);
+			always_check(Map.Num() == Num && !Map.IsView());
+
+			Fuko::TArray<bool> Seen(false, Num);
+			for (uint32 i = 0; i < Num; ++i)
+			{
+				uint32 Key = i * 2654435761u;
+				uint32 Index = Map.IndexOf(Key);
+				always_check(Index < Num && !Seen[Index]);
+				Seen[Index] = true;
+				always_check(Map.KeyAt(Index) == Key && Map.ValueAt(Index) == (i % 3 ? i : i + Num));
+				always_check(Map.FindChecked(Key) == Map.ValueAt(Index));
+			}
+			for (uint32 i = Num; i < Num + 1000; ++i) always_check(!Map.Contains(i * 2654435761u) && Map.FindRef(i * 2654435761u) == 0);
+		}
+
+		TFrozenMap<uint32, uint32> Init{ { 5, 50 }, { 1, 10 }, { 3, 30 }, { 1, 11 } };
+		always_check(Init.Num() == 3 && Init.FindChecked(1) == 11 && Init.FindChecked(5) == 50 && !Init.Contains(2));
+		Init.Empty();
+		always_check(Init.IsEmpty() && !Init.Contains(1));
+	}
+
+	// name table, string keys live in the image
+	{
+		Fuko::TArray<char> Names;
+		Fuko::TArray<uint32> NameBegin;
+		for (uint32 i = 0; i < 20000; ++i)
+		{
+			char Buffer[32];
+			int Len = snprintf(Buffer, sizeof(Buffer), "Actor_%u", i * 7);
+			NameBegin.Add(Names.Num());
+			Names.Insert(Buffer, (uint32)Len + 1, Names.Num());
+		}
+		Fuko::TArray<Fuko::TPair<const char*, uint32>> Pairs;
+		for (uint32 i = 0; i < NameBegin.Num(); ++i) Pairs.Add({ Names.GetData() + NameBegin[i], i });
+
+		TFrozenMap<const char*, uint32> Map;
+		Map.Build(Pairs);
+		always_check(Map.Num() == 20000);
+		for (uint32 i = 0; i < Pairs.Num(); ++i) always_check(Map.FindChecked(Pairs[i].Key) == i);
+		always_check(Map.FindChecked({ "Actor_140xyz", 9 }) == 20 && !Map.Contains("Actor_141") && !Map.Contains("") && !Map.Contains({ "Actor_14", 7 }));
+
+		// keys read back from the image are terminated
+		uint32 Visited = 0;
+		Map.ForEach([&](Fuko::TFrozenStringView<char> Key, uint32 Value)
+		{
+			always_check(!strcmp(Key.Data, Pairs[Value].Key) && Key.Len == strlen(Key.Data));
+			++Visited;
+		});
+		always_check(Visited == 20000);
+		Fuko::TFrozenStringView<char> Key = Map.KeyAt(Map.IndexOf("Actor_700"));
+		always_check(Key.Len == 9 && !strcmp(Key.Data, "Actor_700"));
+
+		TFrozenMap<const WIDECHAR*, int32> Wide{ { L"alpha", 1 }, { L"beta", 2 }, { L"gamma", 3 } };
+		always_check(Wide.FindChecked(L"beta") == 2 && !Wide.Contains(L"delta") && !Wide.Contains(L"bet"));
+
+		// image is the same bytes for the same pairs, so an offline build is reproducible
+		TFrozenMap<const char*, uint32> Again;
+		Again.Build(Pairs);
+		always_check(Again.GetImageSize() == Map.GetImageSize() && !memcmp(Again.GetImage(), Map.GetImage(), (size_t)Map.GetImageSize()));
+
+		// view and load of a copied image, a copy of a view is a view
+		Fuko::TArray<uint64> Buffer;
+		Buffer.SetNumUninitialized((uint32)(Map.GetImageSize() + 7) / 8);
+		memcpy(Buffer.GetData(), Map.GetImage(), (size_t)Map.GetImageSize());
+		TFrozenMap<const char*, uint32> View;
+		always_check(View.View(Buffer.GetData(), Map.GetImageSize()) && View.IsView() && View.Num() == Map.Num());
+		TFrozenMap<const char*, uint32> ViewCopy = View;
+		always_check(ViewCopy.IsView() && ViewCopy.GetImage() == Buffer.GetData());
+		TFrozenMap<const char*, uint32> Loaded;
+		always_check(Loaded.Load(Buffer.GetData(), Map.GetImageSize()) && !Loaded.IsView());
+		for (uint32 i = 0; i < Pairs.Num(); i += 7) always_check(View.FindChecked(Pairs[i].Key) == i && Loaded.FindChecked(Pairs[i].Key) == i);
+
+		// refused images, the map is left empty
+		always_check(!View.View(Buffer.GetData(), Map.GetImageSize() - 1) && View.IsEmpty());
+		TFrozenMap<const char*, uint64> OtherValue;
+		always_check(!OtherValue.View(Buffer.GetData(), Map.GetImageSize()));
+		TFrozenMap<uint64, uint32> OtherKey;
+		always_check(!OtherKey.View(Buffer.GetData(), Map.GetImageSize()));
+		((uint32*)Buffer.GetData())[0] ^= 1;
+		always_check(!View.View(Buffer.GetData(), Map.GetImageSize()));
+
+		// from a mapped file, no load step
+		std::filesystem::path FilePath = std::filesystem::temp_directory_path() / "FukoFrozenMapTest.bin";
+		FILE* File = fopen(FilePath.string().c_str(), "wb");
+		always_check(File != nullptr);
+		always_check(fwrite(Map.GetImage(), 1, (size_t)Map.GetImageSize(), File) == Map.GetImageSize());
+		fclose(File);
+		{
+			Fuko::MappedFile Mapped;
+			always_check(Mapped.Open(FilePath.string().c_str()) && Mapped.GetSize() == Map.GetImageSize());
+			TFrozenMap<const char*, uint32> FileMap;
+			always_check(FileMap.View(Mapped.GetData(), Mapped.GetSize()));
+			for (uint32 i = 0; i < Pairs.Num(); ++i) always_check(FileMap.FindChecked(Pairs[i].Key) == i);
+		}
+		std::filesystem::remove(FilePath);
+		Fuko::MappedFile Missing;
+		always_check(!Missing.Open(FilePath.string().c_str()) && !Missing.IsOpen());
+	}
+
+	// lookup of 1M keys, against the flat map and std::unordered_map
+	{
+		static constexpr uint32 KeyNum = 1 << 20;
+		Fuko::TArray<PairType> Pairs;
+		Pairs.Reserve(KeyNum);
+		for (uint32 i = 0; i < KeyNum; ++i) Pairs.Add(PairType(i * 2654435761u + 1, i));
+
+		TFrozenMap<uint32, uint32> Map;
+		auto begin = std::chrono::high_resolution_clock::now();
+		Map.Build(Pairs);
+		auto end = std::chrono::high_resolution_clock::now();
+		std::cout << "build 1M, frozen map : " << std::chrono::duration<double, std::milli>(end - begin).count()
+			<< " ms, image " << Map.GetImageSize() / 1024 << " KB" << std::endl;
+
+		Fuko::TFlatMap<uint32, uint32> Flat;
+		std::unordered_map<uint32, uint32> Ref;
+		for (const PairType& Pair : Pairs)
+		{
+			Flat.Add(Pair.Key, Pair.Value);
+			Ref.emplace(Pair.Key, Pair.Value);
+		}
+
+		uint64 Sum[3] = {};
+		double Time[3];
+		auto Bench = [&](int Index, auto&& Find)
+		{
+			auto BenchBegin = std::chrono::high_resolution_clock::now();
+			for (uint32 i = 0; i < KeyNum; ++i) Sum[Index] += Find(Pairs[(i * 7919u) & (KeyNum - 1)].Key);
+			for (uint32 i = 0; i < KeyNum; i += 4) Sum[Index] += Find(i * 2654435761u);
+			auto BenchEnd = std::chrono::high_resolution_clock::now();
+			Time[Index] = std::chrono::duration<double, std::milli>(BenchEnd - BenchBegin).count();
+		};
+		Bench(0, [&](uint32 Key) { return Map.FindRef(Key); });
+		Bench(1, [&](uint32 Key) { const uint32* Value = Flat.Find(Key); return Value ? *Value : 0u; });
+		Bench(2, [&](uint32 Key) { auto It = Ref.find(Key); return It != Ref.end() ? It->second : 0u; });
+		always_check(Sum[0] == Sum[2] && Sum[1] == Sum[2]);
+		std::cout << "find 1M hit + 256K miss, frozen map : " << Time[0] << " ms, flat map : " << Time[1]
+			<< " ms, std::unordered_map : " << Time[2] << " ms" << std::endl;
+
+		// startup, a prebuilt image is viewed instead of inserting every name again
+		Fuko::TArray<uint64> Image((const uint64*)Map.GetImage(), (uint32)(Map.GetImageSize() / 8));
+		begin = std::chrono::high_resolution_clock::now();
+		TFrozenMap<uint32, uint32> Viewed;
+		Viewed.View(Image.GetData(), Map.GetImageSize());
+		auto mid = std::chrono::high_resolution_clock::now();
+		Fuko::TFlatMap<uint32, uint32> Rebuilt;
+		for (const PairType& Pair : Pairs) Rebuilt.Add(Pair.Key, Pair.Value);
+		end = std::chrono::high_resolution_clock::now();
+		always_check(Viewed.Num() == KeyNum && Viewed.FindChecked(Pairs[12345].Key) == 12345);
+		std::cout << "startup 1M, frozen map view : " << std::chrono::duration<double, std::micro>(mid - begin).count()
+			<< " us, flat map rebuild : " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+	}
+}
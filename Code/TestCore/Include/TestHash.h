@@ -0,0 +1,134 @@
+#pragma once
+#include <Misc/Hash.h>
+#include <Misc/Crc.h>
+#include <Templates/TypeHash.h>
+#include <Containers/Map.h>
+#include <iostream>
+#include <chrono>
+#include <string>
+
+using Fuko::MemHash64;
+using Fuko::StrHash;
+
+// key of the typed pointer map
+struct HashTestNode
+{
+	int64 Payload[4];
+};
+
+// longest and mean chain when Num keys go to the bucket count TSet would pick
+template<typename HashPolicy, typename TFunc>
+static void _HashChainLength(int Num, TFunc&& KeyOf, int& OutMaxChain, double& OutMeanChain)
+{
+	int BucketNum = (int)Fuko::Math::RoundUpToPowerOfTwo((uint32)(Num / 2 + 8));
+	Fuko::TArray<int> Buckets;
+	Buckets.SetNumZeroed(BucketNum);
+	for (int i = 0; i < Num; ++i) ++Buckets[HashPolicy::Hash(KeyOf(i)) & (BucketNum - 1)];
+
+	// mean seen by a lookup, so each element count its own chain
+	int64 Visit = 0;
+	OutMaxChain = 0;
+	for (int Chain : Buckets)
+	{
+		OutMaxChain = Fuko::Math::Max(OutMaxChain, Chain);
+		Visit += (int64)Chain * Chain;
+	}
+	OutMeanChain = (double)Visit / Num;
+}
+
+template<typename TFunc>
+static void _HashCompareChain(const char* Name, int Num, TFunc&& KeyOf)
+{
+	int TypeMax, MixMax;
+	double TypeMean, MixMean;
+	_HashChainLength<Fuko::TypeHashPolicy>(Num, KeyOf, TypeMax, TypeMean);
+	_HashChainLength<Fuko::MixHashPolicy>(Num, KeyOf, MixMax, MixMean);
+
+	std::cout.precision(3);
+	std::cout << Name << "\t" << TypeMax << "\t" << TypeMean << "\t" << MixMax << "\t" << MixMean << std::endl;
+
+	// 2 elements per bucket on average, a good hash never build long chains
+	always_check(MixMax <= 16 && MixMean < 4.0);
+}
+
+void TestHash()
+{
+	alignas(64) static uint8 Data[8192 + 64];
+	for (int i = 0; i < (int)sizeof(Data); ++i) Data[i] = (uint8)(i * 131 + 7);
+
+	// same bytes at any alignment hash the same, every length and every seed hash different
+	for (size_t Length = 0; Length <= 2048; ++Length)
+	{
+		uint64 Hash = MemHash64(Data, Length);
+		always_check(MemHash64(Data, Length) == Hash);
+		if (Length)
+		{
+			Fuko::Memcpy(Data + 8192 - Length + 7, Data, Length);
+			always_check(MemHash64(Data + 8192 - Length + 7, Length) == Hash);
+			always_check(MemHash64(Data, Length - 1) != Hash);
+		}
+		always_check(MemHash64(Data, Length, 1) != Hash);
+	}
+
+	// one flipped bit anywhere change the long hash
+	uint64 LongHash = MemHash64(Data, 4096);
+	for (int Bit = 0; Bit < 4096 * 8; Bit += 61)
+	{
+		Data[Bit / 8] ^= (uint8)(1 << (Bit & 7));
+		always_check(MemHash64(Data, 4096) != LongHash);
+		Data[Bit / 8] ^= (uint8)(1 << (Bit & 7));
+	}
+
+	// string hash
+	always_check(StrHash("FukoCore") == StrHash("FukoCore", 8));
+	always_check(StrHash(L"FukoCore") != StrHash(L"FukoCorf"));
+	always_check(Fuko::MixHash64(1) != Fuko::MixHash64(2));
+
+	// containers on the mixed policy
+	{
+		Fuko::TSet<int, Fuko::PmrAlloc, Fuko::DefaultKeyFuncs<int, false, Fuko::MixHashPolicy>> S;
+		for (int i = 0; i < 10000; ++i) S.Add(i * 16);
+		always_check(S.Num() == 10000 && S.Contains(160) && !S.Contains(161));
+
+		Fuko::TMap<const void*, int, Fuko::PmrAlloc, Fuko::TDefaultMapKeyFuncs<const void*, int, false, Fuko::MixHashPolicy>> M;
+		for (int i = 0; i < 1000; ++i) M.Add(Data + i * 8, i);
+		for (int i = 0; i < 1000; ++i) always_check(M[Data + i * 8] == i);
+
+		// typed pointer keys hash like their address
+		static HashTestNode Nodes[1000];
+		always_check(Fuko::GetMixedTypeHash(Nodes + 3) == Fuko::GetMixedTypeHash((const void*)(Nodes + 3)));
+		Fuko::TMap<HashTestNode*, int, Fuko::PmrAlloc, Fuko::TDefaultMapKeyFuncs<HashTestNode*, int, false, Fuko::MixHashPolicy>> NodeMap;
+		for (int i = 0; i < 1000; ++i) NodeMap.Add(Nodes + i, i);
+		for (int i = 0; i < 1000; ++i) always_check(NodeMap[Nodes + i] == i);
+		always_check(NodeMap.Num() == 1000 && !NodeMap.Contains(nullptr));
+	}
+
+	// chain length, strided ids and aligned pointers pile up with identity hash
+	std::cout << "keys\ttype max\ttype mean\tmix max\tmix mean" << std::endl;
+	static constexpr int KeyNum = 100000;
+	_HashCompareChain("id", KeyNum, [](int i) { return (int32)i; });
+	_HashCompareChain("id*16", KeyNum, [](int i) { return (int32)i * 16; });
+	_HashCompareChain("id*1024", KeyNum, [](int i) { return (int32)i * 1024; });
+	_HashCompareChain("ptr/64", KeyNum, [](int i) { return (const void*)((size_t)0x10000000 + (size_t)i * 64); });
+	_HashCompareChain("int64<<32", KeyNum, [](int i) { return (int64)i << 32; });
+	Fuko::TArray<std::string> Names;
+	for (int i = 0; i < KeyNum; ++i) Names.Add("Actor_" + std::to_string(i));
+	_HashCompareChain("string", KeyNum, [&](int i) { return Names[i].c_str(); });
+
+	// throughput against crc
+	static constexpr int HashBytes = 1 << 20;
+	Fuko::TArray<uint8> Big;
+	Big.SetNumUninitialized(HashBytes);
+	for (int i = 0; i < HashBytes; ++i) Big[i] = (uint8)i;
+	uint64 Sink = 0;
+	auto Bench = [&](auto&& Func)
+	{
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < 200; ++r) Sink += Func();
+		auto end = std::chrono::high_resolution_clock::now();
+		return 200.0 * HashBytes / std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+	};
+	double MemHashSpeed = Bench([&] { return MemHash64(Big.GetData(), HashBytes); });
+	double CrcSpeed = Bench([&] { return (uint64)Fuko::Crc::MemCrc32(Big.GetData(), HashBytes); });
+	std::cout << "MemHash64 (" << Fuko::GetHashIsa() << ") " << MemHashSpeed << " GB/s, MemCrc32 " << CrcSpeed << " GB/s " << (Sink & 1) << std::endl;
+}
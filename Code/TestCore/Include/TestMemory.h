@@ -0,0 +1,623 @@
+#pragma once
+#include <Memory/MemoryPolicy.h>
+#include <Memory/ArenaAllocator.h>
+#include <Memory/ProfilingAllocator.h>
+#include <Memory/MemoryOps.h>
+#include <Misc/CpuInfo.h>
+#include <Containers/Array.h>
+
+using Fuko::PoolMAlloc;
+using Fuko::PoolFree;
+
+void TestPoolMAllocSize()
+{
+	// block size comes from the slab page, no header in front of small block
+	for (size_t Size = 1; Size <= 2048; ++Size)
+	{
+		char* Ptr = (char*)PoolMAlloc(Size, 8);
+		always_check(Fuko::PoolMSize(Ptr) >= Size);
+		always_check(Fuko::PoolMSize(Ptr) - Size < Size / 4 + 16);
+		for (size_t i = 0; i < Size; ++i) Ptr[i] = (char)i;
+
+		Ptr = (char*)Fuko::PoolRealloc(Ptr, Size * 3, 8);
+		always_check(Fuko::PoolMSize(Ptr) >= Size * 3);
+		for (size_t i = 0; i < Size; ++i) always_check(Ptr[i] == (char)i);
+		PoolFree(Ptr);
+	}
+	void* Small = PoolMAlloc(16, 8);
+	always_check(Fuko::PoolMSize(Small) == 16);
+	PoolFree(Small);
+	PoolFree(nullptr);
+}
+
+void TestPoolFragmentation()
+{
+	static constexpr int AllocNum = 20000;
+	std::vector<void*> Blocks(AllocNum);
+	uint32 Rand = 12345;
+
+	// mostly small objects, some strings and buffers in slab tier, a few large ones
+	for (int i = 0; i < AllocNum; ++i)
+	{
+		Rand = Rand * 1664525u + 1013904223u;
+		uint32 Pick = (Rand >> 8) % 100;
+		size_t Size;
+		if (Pick < 70) Size = (Rand >> 16) % 128 + 1;
+		else if (Pick < 95) Size = (Rand >> 16) % 1024 + 129;
+		else if (Pick < 99) Size = (Rand >> 16) % (32 * 1024 - 1152) + 1153;
+		else Size = 64 * 1024;
+		Blocks[i] = PoolMAlloc(Size, 8);
+	}
+	std::cout << "PoolMAlloc fragmentation, all live:" << std::endl;
+	Fuko::PoolDumpStats();
+
+	Fuko::PoolStats Stats;
+	Fuko::PoolGetStats(Stats);
+	always_check(Stats.ClassNum > 0 && Stats.LargeCount >= 1);
+
+	for (int i = 0; i < AllocNum; i += 2)
+	{
+		PoolFree(Blocks[i]);
+	}
+	std::cout << "PoolMAlloc fragmentation, half freed:" << std::endl;
+	Fuko::PoolDumpStats();
+
+	for (int i = 1; i < AllocNum; i += 2)
+	{
+		PoolFree(Blocks[i]);
+	}
+}
+
+void TestArenaAllocator()
+{
+	Fuko::ArenaAllocator Arena(1024);
+
+	// raw alloc, alignment and in place grow of the last allocation
+	void* First = Arena.Alloc(10, 4);
+	void* Aligned = Arena.Alloc(32, 64);
+	always_check(First && ((size_t)Aligned & 63) == 0);
+	always_check(Arena.Realloc(Aligned, 64, 64) == Aligned);
+	always_check(Arena.Size(Aligned) == 64);
+
+	// container on arena, grows across chunks
+	{
+		Fuko::ArenaScope Scope(Arena);
+		Fuko::TArray<int, Fuko::PmrAlloc> Arr{ Fuko::PmrAlloc(&Arena) };
+		for (int i = 0; i < 2000; ++i) Arr.Add(i);
+		for (int i = 0; i < 2000; ++i) always_check(Arr[i] == i);
+		always_check(Arena.ReservedBytes() > 1024);
+	}
+
+	// mark and rewind give back the same memory
+	auto Mark = Arena.GetMark();
+	void* A = Arena.Alloc(100, 8);
+	Arena.Rewind(Mark);
+	void* B = Arena.Alloc(100, 8);
+	always_check(A == B);
+
+	// a non last allocation grow by copy, only its own bytes follow it
+	{
+		Fuko::ArenaScope Scope(Arena);
+		uint8* Old = (uint8*)Arena.Alloc(64, 8);
+		uint8* Next = (uint8*)Arena.Alloc(16, 8);
+		for (int i = 0; i < 64; ++i) Old[i] = (uint8)i;
+		memset(Next, 0xCD, 16);
+		uint8* Grown = (uint8*)Arena.Realloc(Old, 128, 8);
+		always_check(Grown != Old && Grown != Next);
+		for (int i = 0; i < 64; ++i) always_check(Grown[i] == (uint8)i);
+		always_check(Next[0] == 0xCD && Next[15] == 0xCD);
+
+		// past the end of the chunk, the last allocation move too
+		uint8* Big = (uint8*)Arena.Realloc(Grown, 4000, 8);
+		always_check(Big != Grown);
+		for (int i = 0; i < 64; ++i) always_check(Big[i] == (uint8)i);
+	}
+
+	// reset keep chunks, trim drops the unused ones
+	size_t Reserved = Arena.ReservedBytes();
+	Arena.Reset();
+	always_check(Arena.UsedBytes() == 0 && Arena.ReservedBytes() == Reserved);
+	Arena.Trim();
+	always_check(Arena.ReservedBytes() <= Reserved);
+
+	// per frame usage, no chunk allocation after warm up
+	static constexpr int FrameNum = 10000;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (int Frame = 0; Frame < FrameNum; ++Frame)
+	{
+		Fuko::ArenaScope Scope(Arena);
+		Fuko::TArray<int, Fuko::PmrAlloc> Arr{ Fuko::PmrAlloc(&Arena) };
+		for (int i = 0; i < 64; ++i) Arr.Add(i);
+	}
+	auto mid = std::chrono::high_resolution_clock::now();
+	for (int Frame = 0; Frame < FrameNum; ++Frame)
+	{
+		Fuko::TArray<int, Fuko::PmrAlloc> Arr;
+		for (int i = 0; i < 64; ++i) Arr.Add(i);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	std::cout << "Arena frame: " << std::chrono::duration_cast<std::chrono::microseconds>(mid - begin).count() << " us, "
+		<< "Heap frame: " << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << " us" << std::endl;
+}
+
+void _PoolMAllocWorker(int Seed, int LoopNum, std::atomic<uint64>* OpCount)
+{
+	static constexpr int BatchNum = 64;
+	void* Blocks[BatchNum];
+	uint32 Rand = Seed * 2654435761u + 1;
+	uint64 Ops = 0;
+
+	for (int Loop = 0; Loop < LoopNum; ++Loop)
+	{
+		for (int i = 0; i < BatchNum; ++i)
+		{
+			Rand = Rand * 1664525u + 1013904223u;
+			size_t Size = (Rand >> 16) % 512 + 1;
+			Blocks[i] = PoolMAlloc(Size, 8);
+			*(char*)Blocks[i] = (char)i;
+		}
+		for (int i = BatchNum - 1; i >= 0; --i)
+		{
+			always_check(*(char*)Blocks[i] == (char)i);
+			PoolFree(Blocks[i]);
+		}
+		Ops += BatchNum * 2;
+	}
+	OpCount->fetch_add(Ops);
+}
+
+void TestPoolMAllocScaling()
+{
+	static constexpr int LoopNum = 20000;
+	uint64 SingleOps = 0;
+
+	for (int ThreadNum = 1; ThreadNum <= 16; ThreadNum *= 2)
+	{
+		std::vector<std::thread> Threads;
+		std::atomic<uint64> Count = 0;
+
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < ThreadNum; ++i)
+		{
+			Threads.emplace_back(&_PoolMAllocWorker, i + 1, LoopNum, &Count);
+		}
+		for (auto& Thread : Threads)
+		{
+			Thread.join();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+		uint64 OpsPerSecond = (uint64)((double)Count.load() / (us ? us : 1) * 1000000.0);
+		if (ThreadNum == 1) SingleOps = OpsPerSecond;
+
+		std::cout << "PoolMAlloc " << ThreadNum << " threads: " << OpsPerSecond << " ops/s"
+			<< " (x" << (double)OpsPerSecond / (SingleOps ? SingleOps : 1) << ")" << std::endl;
+	}
+}
+
+static const Fuko::AllocSiteStats* _FindSite(const Fuko::AllocSiteStats* Sites, uint32 SiteNum, const char* Tag)
+{
+	for (uint32 i = 0; i < SiteNum; ++i)
+	{
+		if (Sites[i].Tag == Tag) return &Sites[i];
+	}
+	return nullptr;
+}
+
+FORCENOINLINE void* _ProfileCallsiteA(Fuko::IAllocator* Allocator) { return Allocator->Alloc(32, 8); }
+FORCENOINLINE void* _ProfileCallsiteB(Fuko::IAllocator* Allocator) { return Allocator->Alloc(64, 8); }
+
+// realloc hand the old address to another allocation before it return, as another thread could
+class _ReallocReuseAllocator : public Fuko::IAllocator
+{
+public:
+	Fuko::IAllocator*	Outer = nullptr;
+	const char*			OtherTag = nullptr;
+	void*				FreeSlot = nullptr;
+
+	void* Alloc(size_t InSize, size_t Alignment) override
+	{
+		if (void* Slot = FreeSlot)
+		{
+			FreeSlot = nullptr;
+			return Slot;
+		}
+		return Fuko::DefaultAllocator()->Alloc(InSize < 64 ? 64 : InSize, Alignment);
+	}
+	void* Realloc(void* InPtr, size_t InSize, size_t Alignment) override
+	{
+		void* NewPtr = Fuko::DefaultAllocator()->Alloc(InSize, Alignment);
+		Fuko::Memcpy(NewPtr, InPtr, 64);
+		FreeSlot = InPtr;
+		{
+			Fuko::AllocTagScope Scope(OtherTag);
+			Outer->Free(Outer->Alloc(16, 8));
+		}
+		return NewPtr;
+	}
+	void Free(void* InPtr) override { Fuko::DefaultAllocator()->Free(InPtr); }
+	size_t Size(void* Ptr, size_t Alignment) override { return Fuko::DefaultAllocator()->Size(Ptr, Alignment); }
+	void Trim() override {}
+};
+
+void TestProfilingAllocator()
+{
+	static const char* const TagMesh = "Mesh";
+	static const char* const TagAudio = "Audio";
+	std::vector<Fuko::AllocSiteStats> Sites(Fuko::ProfilingAllocator::MaxSiteNum);
+
+	// tag mode over default allocator
+	{
+		Fuko::ProfilingAllocator Profiler(Fuko::DefaultAllocator());
+		void* Mesh[10];
+		{
+			Fuko::AllocTagScope Scope(TagMesh);
+			for (int i = 0; i < 10; ++i) Mesh[i] = Profiler.Alloc(100, 8);
+			Mesh[0] = Profiler.Realloc(Mesh[0], 1000, 8);
+		}
+		void* Audio = nullptr;
+		std::thread Worker([&]
+		{
+			Fuko::AllocTagScope Scope(TagAudio);
+			Audio = Profiler.Alloc(4096, 16);
+		});
+		Worker.join();
+		always_check(Fuko::GetAllocTag() != TagMesh);
+
+		uint32 SiteNum = Profiler.GetSiteStats(Sites.data(), (uint32)Sites.size());
+		const Fuko::AllocSiteStats* MeshSite = _FindSite(Sites.data(), SiteNum, TagMesh);
+		const Fuko::AllocSiteStats* AudioSite = _FindSite(Sites.data(), SiteNum, TagAudio);
+		always_check(MeshSite && AudioSite);
+		always_check(MeshSite->AllocCount == 10 && MeshSite->ReallocCount == 1 && MeshSite->LiveBytes == 1900);
+		always_check(MeshSite->SizeHistogram[6] == 10 && MeshSite->SizeHistogram[9] == 1);
+		always_check(AudioSite->LiveCount == 1 && AudioSite->LiveBytes == 4096);
+		always_check(Profiler.GetLiveBytes() == 1900 + 4096);
+
+		// free on another thread than alloc
+		for (int i = 0; i < 10; ++i) Profiler.Free(Mesh[i]);
+		Profiler.Free(Audio);
+		SiteNum = Profiler.GetSiteStats(Sites.data(), (uint32)Sites.size());
+		MeshSite = _FindSite(Sites.data(), SiteNum, TagMesh);
+		always_check(MeshSite->FreeCount == 10 && MeshSite->LiveCount == 0 && MeshSite->PeakBytes == 1900);
+		uint64 LifetimeNum = 0;
+		for (uint64 Count : MeshSite->LifetimeHistogram) LifetimeNum += Count;
+		always_check(LifetimeNum == 10);
+		always_check(Profiler.GetLiveBytes() == 0 && Profiler.GetPeakBytes() == 1900 + 4096);
+
+		// unknown pointers pass through
+		void* Raw = Fuko::DefaultAllocator()->Alloc(16, 8);
+		Profiler.Free(Raw);
+		always_check(Profiler.GetLiveBytes() == 0);
+
+		Profiler.DumpReport();
+		always_check(Profiler.ExportCSV("ProfilingAllocator.csv"));
+		std::remove("ProfilingAllocator.csv");
+	}
+
+	// callsite mode
+	{
+		Fuko::ProfilingAllocator Profiler(Fuko::DefaultAllocator(), Fuko::EAllocProfileKey::Callsite);
+		void* Blocks[6];
+		for (int i = 0; i < 3; ++i)
+		{
+			Blocks[i * 2] = _ProfileCallsiteA(&Profiler);
+			Blocks[i * 2 + 1] = _ProfileCallsiteB(&Profiler);
+		}
+		uint32 SiteNum = Profiler.GetSiteStats(Sites.data(), (uint32)Sites.size());
+		uint32 UsedSiteNum = 0;
+		for (uint32 i = 0; i < SiteNum; ++i)
+		{
+			if (Sites[i].AllocCount == 0) continue;
+			always_check(Sites[i].AllocCount == 3 && Sites[i].Callsite != nullptr);
+			++UsedSiteNum;
+		}
+		always_check(UsedSiteNum == 2);
+		for (void* Block : Blocks) Profiler.Free(Block);
+	}
+
+	// wrap pool entry points, blocks allocated before are freed through the profiler
+	{
+		Fuko::TArray<int, Fuko::BlockAlloc> Before;
+		Before.Add(1);
+		Fuko::ProfilingAllocator Profiler(Fuko::PoolAllocator());
+		Fuko::SetPoolAllocator(&Profiler);
+		{
+			Fuko::AllocTagScope Scope(TagMesh);
+			Fuko::TArray<int, Fuko::BlockAlloc> Arr;
+			for (int i = 0; i < 1000; ++i) Arr.Add(i);
+			Before.Empty();
+		}
+		Fuko::SetPoolAllocator(nullptr);
+
+		uint32 SiteNum = Profiler.GetSiteStats(Sites.data(), (uint32)Sites.size());
+		const Fuko::AllocSiteStats* MeshSite = _FindSite(Sites.data(), SiteNum, TagMesh);
+		always_check(MeshSite && MeshSite->AllocCount == 1 && MeshSite->ReallocCount > 0 && MeshSite->LiveCount == 0);
+	}
+
+	// the old address of a realloc is reused by another allocation before the realloc return
+	{
+		_ReallocReuseAllocator Inner;
+		Fuko::ProfilingAllocator Profiler(&Inner);
+		Inner.Outer = &Profiler;
+		Inner.OtherTag = TagAudio;
+		void* Block;
+		{
+			Fuko::AllocTagScope Scope(TagMesh);
+			Block = Profiler.Alloc(64, 8);
+			Block = Profiler.Realloc(Block, 256, 8);
+		}
+
+		uint32 SiteNum = Profiler.GetSiteStats(Sites.data(), (uint32)Sites.size());
+		const Fuko::AllocSiteStats* MeshSite = _FindSite(Sites.data(), SiteNum, TagMesh);
+		const Fuko::AllocSiteStats* OtherSite = _FindSite(Sites.data(), SiteNum, TagAudio);
+		always_check(MeshSite && MeshSite->AllocCount == 1 && MeshSite->ReallocCount == 1 && MeshSite->FreeCount == 0 && MeshSite->LiveBytes == 256);
+		always_check(OtherSite && OtherSite->AllocCount == 1 && OtherSite->FreeCount == 1 && OtherSite->LiveCount == 0);
+		Profiler.Free(Block);
+		always_check(Profiler.GetLiveBytes() == 0);
+	}
+
+	// overhead
+	{
+		static constexpr int LoopNum = 100000;
+		Fuko::ProfilingAllocator Profiler(Fuko::PoolAllocator());
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < LoopNum; ++i) PoolFree(PoolMAlloc(64, 8));
+		auto mid = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < LoopNum; ++i) Profiler.Free(Profiler.Alloc(64, 8));
+		auto end = std::chrono::high_resolution_clock::now();
+		std::cout << "Pool alloc/free: " << std::chrono::duration_cast<std::chrono::nanoseconds>(mid - begin).count() / LoopNum << " ns, "
+			<< "profiled: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count() / LoopNum << " ns" << std::endl;
+	}
+}
+
+FORCENOINLINE void _HeapSampleMAlloc(std::vector<void*>& Blocks) { for (int i = 0; i < 4096; ++i) Blocks.push_back(Fuko::MAlloc(1000, 8)); }
+FORCENOINLINE void _HeapSamplePool(std::vector<void*>& Blocks) { for (int i = 0; i < 2048; ++i) Blocks.push_back(PoolMAlloc(2000, 8)); }
+
+void TestHeapSampling()
+{
+	Fuko::IAllocator* Default = Fuko::DefaultAllocator();
+	Fuko::StartHeapSampling(64 * 1024);
+	always_check(Fuko::IsHeapSampling() && Fuko::DefaultAllocator() != Default);
+
+	// ~4 MB from each stack, ~64 samples each, estimate within a wide margin
+	std::vector<void*> MAllocBlocks, PoolBlocks;
+	_HeapSampleMAlloc(MAllocBlocks);
+	_HeapSamplePool(PoolBlocks);
+
+	std::vector<Fuko::HeapSampleStack> Stacks(64);
+	uint32 StackNum = Fuko::GetHeapSampleSnapshot(Stacks.data(), (uint32)Stacks.size());
+	always_check(StackNum >= 2);
+	for (uint32 i = 0; i < 2; ++i)
+	{
+		always_check(Stacks[i].Depth > 0 && Stacks[i].SampleCount > 0);
+		always_check(Stacks[i].EstimatedBytes > 2 * 1024 * 1024 && Stacks[i].EstimatedBytes < 6 * 1024 * 1024);
+	}
+	Fuko::DumpHeapSampleSnapshot(2);
+
+	// realloc and free forget the samples
+	for (void*& Block : MAllocBlocks) Block = Fuko::Realloc(Block, 10, 8);
+	for (void* Block : MAllocBlocks) Fuko::Free(Block);
+	for (void* Block : PoolBlocks) PoolFree(Block);
+	uint64 LiveBytes = 0;
+	StackNum = Fuko::GetHeapSampleSnapshot(Stacks.data(), (uint32)Stacks.size());
+	for (uint32 i = 0; i < Fuko::Math::Min<uint32>(StackNum, (uint32)Stacks.size()); ++i) LiveBytes += Stacks[i].SampleBytes;
+	always_check(LiveBytes < 64 * 1024);
+
+	// overhead at the default interval on the smallest path
+	{
+		static constexpr int LoopNum = 2000000;
+		Fuko::StartHeapSampling();
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < LoopNum; ++i) PoolFree(PoolMAlloc(64, 8));
+		auto mid = std::chrono::high_resolution_clock::now();
+		Fuko::StopHeapSampling();
+		for (int i = 0; i < LoopNum; ++i) PoolFree(PoolMAlloc(64, 8));
+		auto end = std::chrono::high_resolution_clock::now();
+		double Sampled = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(mid - begin).count() / LoopNum;
+		double Plain = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count() / LoopNum;
+		std::cout << "Pool alloc/free: " << Plain << " ns, sampled: " << Sampled << " ns" << std::endl;
+	}
+
+	always_check(!Fuko::IsHeapSampling() && Fuko::DefaultAllocator() == Default);
+	always_check(Fuko::GetHeapSampleSnapshot(Stacks.data(), (uint32)Stacks.size()) == 0);
+}
+
+void TestPoolTrim()
+{
+	static constexpr int AllocNum = 20000;
+	static constexpr size_t BlockSize = 384;
+	auto GetClass = [](Fuko::PoolStats& Stats) -> Fuko::PoolClassStats&
+	{
+		Fuko::PoolGetStats(Stats);
+		for (uint32 i = 0; i < Stats.ClassNum; ++i)
+		{
+			if (Stats.Classes[i].BlockSize == BlockSize) return Stats.Classes[i];
+		}
+		return Stats.Classes[0];
+	};
+
+	std::vector<void*> Blocks(AllocNum);
+	for (void*& Block : Blocks) Block = PoolMAlloc(BlockSize, 8);
+	Fuko::PoolStats Stats;
+	size_t PeakSlab = GetClass(Stats).SlabBytes;
+	always_check(PeakSlab >= AllocNum * BlockSize);
+
+	// keep one block per 64, slabs stay alive
+	for (int i = 0; i < AllocNum; ++i)
+	{
+		if (i % 64) PoolFree(Blocks[i]);
+	}
+	Fuko::PoolTrim();
+	always_check(GetClass(Stats).SlabBytes == PeakSlab);
+
+	for (int i = 0; i < AllocNum; i += 64) PoolFree(Blocks[i]);
+	Fuko::PoolTrim();
+	Fuko::PoolClassStats& Class = GetClass(Stats);
+	always_check(Class.SlabBytes < PeakSlab / 4 && Class.SpareBytes == 0);
+	std::cout << "PoolTrim: " << PeakSlab / 1024 << " KB -> " << Class.SlabBytes / 1024 << " KB" << std::endl;
+
+	// trimmed class is still usable
+	for (void*& Block : Blocks) Block = PoolMAlloc(BlockSize, 8);
+	for (void*& Block : Blocks) PoolFree(Block);
+}
+
+void TestHeapAllocator()
+{
+	// alignment, usable size and data kept across grow, up to blocks big enough for mremap
+	for (size_t Alignment = 4; Alignment <= 4096; Alignment *= 2)
+	{
+		char* Ptr = (char*)Fuko::HeapMAlloc(100, Alignment);
+		always_check(IsAligned(Ptr, Alignment) && Fuko::HeapMSize(Ptr, Alignment) >= 100);
+		for (int i = 0; i < 100; ++i) Ptr[i] = (char)i;
+
+		for (size_t Size = 400; Size <= 16 * 1024 * 1024; Size *= 4)
+		{
+			Ptr = (char*)Fuko::HeapRealloc(Ptr, Size, Alignment);
+			always_check(IsAligned(Ptr, Alignment) && Fuko::HeapMSize(Ptr, Alignment) >= Size);
+			for (int i = 0; i < 100; ++i) always_check(Ptr[i] == (char)i);
+		}
+		Ptr = (char*)Fuko::HeapRealloc(Ptr, 50, Alignment);
+		for (int i = 0; i < 50; ++i) always_check(Ptr[i] == (char)i);
+		Fuko::HeapFree(Ptr);
+	}
+	always_check(Fuko::HeapMSize(nullptr, 8) == 0);
+
+	// failed aligned realloc keep the old block
+	{
+		char* Ptr = (char*)Fuko::HeapMAlloc(100, 64);
+		for (int i = 0; i < 100; ++i) Ptr[i] = (char)i;
+		always_check(Fuko::HeapRealloc(Ptr, (size_t)1 << 62, 64) == nullptr);
+		for (int i = 0; i < 100; ++i) always_check(Ptr[i] == (char)i);
+		Fuko::HeapFree(Ptr);
+	}
+
+	// capacity reported by Reserve is the usable block
+	Fuko::TArray<int, Fuko::BaseAlloc> Arr;
+	Arr.Reserve(13);
+	always_check(Arr.Max() >= 13 && Arr.Max() == Fuko::HeapMSize(Arr.GetData(), alignof(int)) / sizeof(int));
+
+	// grow count and moves of a growing array
+	int GrowNum = 0;
+	int MoveNum = 0;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < 4 * 1024 * 1024; ++i)
+	{
+		int* LastData = Arr.GetData();
+		int LastMax = Arr.Max();
+		Arr.Add(i);
+		if (Arr.Max() != LastMax) ++GrowNum;
+		if (Arr.GetData() != LastData) ++MoveNum;
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < Arr.Num(); i += 4096) always_check(Arr[i] == i);
+	std::cout << "BaseAlloc 4M adds: " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << " us, "
+		<< GrowNum << " grows, " << MoveNum << " moves" << std::endl;
+}
+
+template<typename Func>
+static double _MemOpsGBps(size_t Size, Func&& Op)
+{
+	// repeat small op until enough bytes are touched to get a stable time
+	size_t LoopNum = Fuko::Math::Max<size_t>(256 * 1024 * 1024 / Size, 4);
+	Op();
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < LoopNum; ++i) Op();
+	auto end = std::chrono::high_resolution_clock::now();
+	double Seconds = std::chrono::duration<double>(end - begin).count();
+	return (double)Size * LoopNum / (Seconds > 0 ? Seconds : 1e-9) / (1024.0 * 1024.0 * 1024.0);
+}
+
+void TestMemoryOps()
+{
+	std::cout << "MemoryOps isa: " << Fuko::GetMemOpsIsa() << ", stream threshold: "
+		<< Fuko::GetMemStreamThreshold() / 1024 << " KB, llc: " << Fuko::GetCpuInfo().LastLevelCacheSize / 1024 << " KB" << std::endl;
+
+	// swap, copy and zero against byte loops, all sizes and misalignments that hit head and tail paths
+	{
+		static constexpr size_t MaxSize = 1100;
+		std::vector<uint8> A(MaxSize + 64), B(MaxSize + 64), RefA, RefB;
+		for (size_t Size = 0; Size <= MaxSize; Size += (Size < 300 ? 1 : 37))
+		{
+			for (size_t OffsetA = 0; OffsetA < 8; OffsetA += 3)
+			{
+				for (size_t OffsetB = 0; OffsetB < 8; OffsetB += 5)
+				{
+					for (size_t i = 0; i < A.size(); ++i) { A[i] = (uint8)(i * 7 + Size); B[i] = (uint8)(i * 13 + 1); }
+					RefA = A;
+					RefB = B;
+					for (size_t i = 0; i < Size; ++i) std::swap(RefA[OffsetA + i], RefB[OffsetB + i]);
+					Fuko::Memswap(A.data() + OffsetA, B.data() + OffsetB, Size);
+					always_check(A == RefA && B == RefB);
+
+					for (size_t i = 0; i < Size; ++i) RefA[OffsetA + i] = RefB[OffsetB + i];
+					Fuko::MemcpyStream(A.data() + OffsetA, B.data() + OffsetB, Size);
+					always_check(A == RefA);
+
+					for (size_t i = 0; i < Size; ++i) RefB[OffsetB + i] = 0;
+					Fuko::MemzeroStream(B.data() + OffsetB, Size);
+					always_check(B == RefB);
+				}
+			}
+		}
+	}
+
+	// Memcpy/Memzero above the threshold stream, result is the same
+	{
+		size_t OldThreshold = Fuko::GetMemStreamThreshold();
+		Fuko::SetMemStreamThreshold(Fuko::MemStreamMinSize);
+		always_check(Fuko::GetMemStreamThreshold() == Fuko::MemStreamMinSize);
+		size_t Size = Fuko::MemStreamMinSize * 3 + 5;
+		std::vector<uint8> Src(Size + 1), Dst(Size + 1, 0xCD);
+		for (size_t i = 0; i < Src.size(); ++i) Src[i] = (uint8)(i * 31);
+		Fuko::Memcpy(Dst.data() + 1, Src.data(), Size);
+		always_check(!memcmp(Dst.data() + 1, Src.data(), Size) && Dst[0] == 0xCD);
+		Fuko::Memzero(Dst.data(), Size);
+		always_check(Dst[Size] == (uint8)((Size - 1) * 31));
+		for (size_t i = 0; i < Size; i += 4093) always_check(Dst[i] == 0);
+		Fuko::SetMemStreamThreshold(0);
+		always_check(Fuko::GetMemStreamThreshold() == OldThreshold);
+	}
+
+	// throughput from 16 B to 256 MB, crt and scalar swap as base line
+	{
+		static constexpr size_t MaxSize = 256 * 1024 * 1024;
+		std::vector<uint8> Src(MaxSize, 1), Dst(MaxSize, 2);
+		std::cout << "size\tcrt cpy\tMemcpy\tstream\tcrt set\tMemzero\tstream\tswap64\tMemswap (GB/s)" << std::endl;
+		for (size_t Size = 16; Size <= MaxSize; Size *= 4)
+		{
+			uint8* S = Src.data();
+			uint8* D = Dst.data();
+			double CrtCopy = _MemOpsGBps(Size, [&] { memcpy(D, S, Size); });
+			double Copy = _MemOpsGBps(Size, [&] { Fuko::Memcpy(D, S, Size); });
+			double StreamCopy = _MemOpsGBps(Size, [&] { Fuko::MemcpyStream(D, S, Size); });
+			double CrtZero = _MemOpsGBps(Size, [&] { memset(D, 0, Size); });
+			double Zero = _MemOpsGBps(Size, [&] { Fuko::Memzero(D, Size); });
+			double StreamZero = _MemOpsGBps(Size, [&] { Fuko::MemzeroStream(D, Size); });
+			double ScalarSwap = _MemOpsGBps(Size, [&]
+			{
+				for (size_t i = 0; i < Size; i += 8) Fuko::Valswap(*(uint64*)(S + i), *(uint64*)(D + i));
+			});
+			double Swap = _MemOpsGBps(Size, [&] { Fuko::Memswap(D, S, Size); });
+
+			std::cout.precision(3);
+			std::cout << (Size >= 1024 * 1024 ? Size / (1024 * 1024) : Size >= 1024 ? Size / 1024 : Size)
+				<< (Size >= 1024 * 1024 ? " MB" : Size >= 1024 ? " KB" : " B") << "\t"
+				<< CrtCopy << "\t" << Copy << "\t" << StreamCopy << "\t"
+				<< CrtZero << "\t" << Zero << "\t" << StreamZero << "\t"
+				<< ScalarSwap << "\t" << Swap << std::endl;
+		}
+	}
+}
+
+void TestMemory()
+{
+	TestMemoryOps();
+	TestHeapAllocator();
+	TestPoolMAllocSize();
+	TestPoolFragmentation();
+	TestPoolTrim();
+	TestArenaAllocator();
+	TestProfilingAllocator();
+	TestHeapSampling();
+	TestPoolMAllocScaling();
+}
@@ -51,74 +51,161 @@ void _PoolWorker(int N, bool* bExit, bool* bStart, std::atomic<uint32>* OpCount,
 	delete BlockArr;
 }
 
-void TestPool()
+template<typename LockPolicy>
+void _TestPoolTrim()
 {
-	TPool<MemBlock, Fuko::LockFree> Pool(100, 30);
-	Pool.ValidateData();
+	static constexpr int BlockSize = 64;
+	static constexpr int BlockNum = 8;
+	TPool<MemBlock, LockPolicy> Pool(BlockSize, 1);
+	MemBlock* Blocks[BlockSize * BlockNum];
+	for (MemBlock*& Block : Blocks) Block = Pool.Alloc();
+	always_check(Pool.NumBlocks() == BlockNum && Pool.NumUsed() == BlockSize * BlockNum);
+
+	// a block with one live node can't be released
+	for (int i = 1; i < BlockSize * BlockNum; ++i) Pool.Free(Blocks[i]);
+	always_check(Pool.Trim(2) == BlockNum - 3);
+	always_check(Pool.NumBlocks() == 3 && Pool.NumUsed() == 1);
+	Pool.Free(Blocks[0]);
+	always_check(Pool.Trim() == 3 && Pool.NumBlocks() == 0);
+
+	// auto trim keeps low free blocks after reaching high
+	Pool.SetAutoTrim(4, 1);
+	for (MemBlock*& Block : Blocks) Block = Pool.Alloc();
+	for (MemBlock*& Block : Blocks) Pool.Free(Block);
+	always_check(Pool.NumBlocks() < BlockNum && Pool.NumUsed() == 0);
+
+	// still usable after trim
+	for (MemBlock*& Block : Blocks) Block = Pool.Alloc();
+	for (MemBlock*& Block : Blocks) Pool.Free(Block);
+}
 
-	static constexpr int ThreadNum = 16;
+template<typename LockPolicy>
+void _TestPoolBatch()
+{
+	static constexpr int BlockSize = 64;
+	TPool<MemBlock, LockPolicy> Pool(BlockSize, 1);
+
+	// reserve grow once, batch alloc after it don't grow
+	Pool.ReserveFree(BlockSize * 3 + 1);
+	always_check(Pool.NumBlocks() == 4);
+	MemBlock* Blocks[BlockSize * 4];
+	Pool.AllocN(Blocks, BlockSize * 3);
+	Pool.AllocN(Blocks + BlockSize * 3, BlockSize);
+	always_check(Pool.NumBlocks() == 4 && Pool.NumUsed() == BlockSize * 4);
+	for (int i = 0; i < BlockSize * 4; ++i)
+	{
+		for (int j = i + 1; j < BlockSize * 4; ++j) always_check(Blocks[i] != Blocks[j]);
+	}
 
-	std::thread WorkThreadArr[ThreadNum];
-	bool Exit = false;
-    bool Start = false;
-	std::atomic<uint32> Count = 0;
-    size_t time_per_second;
+	// alloc past the free nodes grows
+	MemBlock* Extra[10];
+	Pool.AllocN(Extra, 10);
+	always_check(Pool.NumBlocks() == 5 && Pool.NumUsed() == BlockSize * 4 + 10);
+
+	// free in batches and singles mix
+	Pool.FreeN(Blocks, BlockSize * 2);
+	Pool.FreeN(Extra, 10);
+	for (int i = BlockSize * 2; i < BlockSize * 4; ++i) Pool.Free(Blocks[i]);
+	Pool.FreeN(Blocks, 0);
+	always_check(Pool.NumUsed() == 0);
+	always_check(Pool.Trim() == 5);
+}
+
+// alloc and free in batches, one lock or CAS per batch
+template<typename LockPolicy>
+void _PoolBatchWorker(int N, bool* bExit, bool* bStart, std::atomic<uint32>* OpCount, TPool<MemBlock, LockPolicy>* InPool)
+{
+	// hold about as many nodes as _PoolWorker
+	static constexpr int BatchNum = 16;
+	const int LoopNum = N / BatchNum + 1;
+	MemBlock** BlockArr = new MemBlock*[LoopNum * BatchNum];
+
+	while (!(*bStart)) std::this_thread::yield();
 
+	while (!(*bExit))
 	{
-		for (int i = 0; i < ThreadNum; ++i)
+		for (int i = 0; i < LoopNum; ++i)
 		{
-			WorkThreadArr[i] = std::thread(&_PoolWorker<Fuko::LockFree>, i * 16 + 5, &Exit, &Start, &Count, &Pool);
+			InPool->AllocN(BlockArr + i * BatchNum, BatchNum);
 		}
-
+		for (int i = LoopNum - 1; i >= 0; --i)
 		{
-			using namespace std::chrono_literals;
-            auto begin = std::chrono::high_resolution_clock::now();
-            Start = true;
-			std::this_thread::sleep_for(3s);
-		    Exit = true;
-            for (int i = 0; i < ThreadNum; ++i)
-            {
-                WorkThreadArr[i].join();
-            }
-            auto end = std::chrono::high_resolution_clock::now();
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
-            time_per_second = (size_t)((float)Count.load() / ms * 1000.0f);
+			InPool->FreeN(BlockArr + i * BatchNum, BatchNum);
 		}
-
-		Pool.ValidateData();
-		std::cout << "LockFree Count: " << time_per_second << std::endl;
+		OpCount->fetch_add(LoopNum * BatchNum * 2);
 	}
+	delete[] BlockArr;
+}
 
-	Count.store(0);
-	Exit = false;
-    Start = false;
-	TPool<MemBlock, Fuko::MutexLock> MtPool(100, 30);
+template<typename LockPolicy, typename Worker>
+size_t _PoolStress(TPool<MemBlock, LockPolicy>& Pool, Worker&& InWorker)
+{
+	static constexpr int ThreadNum = 16;
+	std::thread WorkThreadArr[ThreadNum];
+	bool Exit = false;
+	bool Start = false;
+	std::atomic<uint32> Count = 0;
 
+	for (int i = 0; i < ThreadNum; ++i)
 	{
-		for (int i = 0; i < ThreadNum; ++i)
-		{
-			WorkThreadArr[i] = std::thread(&_PoolWorker<Fuko::MutexLock>, i * 16 + 5, &Exit, &Start, &Count, &MtPool);
-		}
+		WorkThreadArr[i] = std::thread(InWorker, i * 16 + 5, &Exit, &Start, &Count, &Pool);
+	}
+
+	using namespace std::chrono_literals;
+	auto begin = std::chrono::high_resolution_clock::now();
+	Start = true;
+	std::this_thread::sleep_for(3s);
+	Exit = true;
+	for (int i = 0; i < ThreadNum; ++i)
+	{
+		WorkThreadArr[i].join();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+	return (size_t)((double)Count.load() / ms * 1000.0);
+}
 
+void TestPool()
+{
+	_TestPoolTrim<Fuko::NoLock>();
+	_TestPoolTrim<Fuko::MutexLock>();
+	_TestPoolBatch<Fuko::NoLock>();
+	_TestPoolBatch<Fuko::MutexLock>();
+
+	// batch api hand out distinct nodes
+	{
+		TPool<MemBlock, Fuko::LockFree> Pool(16, 1);
+		Pool.ReserveFree(100);
+		MemBlock* Blocks[100];
+		Pool.AllocN(Blocks, 100);
+		for (int i = 0; i < 100; ++i)
 		{
-            using namespace std::chrono_literals;
-            auto begin = std::chrono::high_resolution_clock::now();
-            Start = true;
-            std::this_thread::sleep_for(3s);
-            Exit = true;
-            for (int i = 0; i < ThreadNum; ++i)
-            {
-                WorkThreadArr[i].join();
-            }
-            auto end = std::chrono::high_resolution_clock::now();
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
-            time_per_second = (size_t)((float)Count.load() / ms * 1000.0f);
+			for (int j = i + 1; j < 100; ++j) always_check(Blocks[i] != Blocks[j]);
+			always_check(Pool.IsInPool(Blocks[i]));
 		}
-
-		MtPool.ValidateData();
-		std::cout << "Mutex Count:    " << time_per_second << std::endl;
+		MemBlock Outside;
+		always_check(!Pool.IsInPool(&Outside));
+		Pool.FreeN(Blocks, 50);
+		for (int i = 50; i < 100; ++i) Pool.Free(Blocks[i]);
+		Pool.ValidateData();
 	}
 
+	// 16 threads stress, ops/s
+	TPool<MemBlock, Fuko::LockFree> Pool(100, 30);
+	Pool.ValidateData();
+	size_t LockFreeOps = _PoolStress(Pool, &_PoolWorker<Fuko::LockFree>);
+	Pool.ValidateData();
+	size_t BatchOps = _PoolStress(Pool, &_PoolBatchWorker<Fuko::LockFree>);
+	Pool.ValidateData();
 
-
+	TPool<MemBlock, Fuko::MutexLock> MtPool(100, 30);
+	size_t MutexOps = _PoolStress(MtPool, &_PoolWorker<Fuko::MutexLock>);
+	MtPool.ValidateData();
+	size_t MutexBatchOps = _PoolStress(MtPool, &_PoolBatchWorker<Fuko::MutexLock>);
+	MtPool.ValidateData();
+
+	std::cout << "LockFree: " << LockFreeOps << " ops/s" << std::endl;
+	std::cout << "LockFree batch: " << BatchOps << " ops/s" << std::endl;
+	std::cout << "Mutex: " << MutexOps << " ops/s" << std::endl;
+	std::cout << "Mutex batch: " << MutexBatchOps << " ops/s" << std::endl;
 }
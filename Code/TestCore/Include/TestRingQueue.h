@@ -38,6 +38,28 @@ struct SlowObj
 void TestRingQueue()
 {
 	int a = 0;
+	// inline allocator
+	{
+		TRingQueue<int, Fuko::NoLock, Fuko::TInlineAlloc<16>> A;
+		for (int Loop = 0; Loop < 100; ++Loop)
+		{
+			A.Enqueue(Loop);
+			if (Loop % 3 == 0) A.Dequeue();
+		}
+		TRingQueue<int, Fuko::NoLock, Fuko::TInlineAlloc<16>> B;
+		B = std::move(A);
+		always_check(A.Num() == 0);
+		int Expect = 34, Out = 0;
+		while (B.Dequeue(Out)) always_check(Out == Expect++);
+		always_check(Expect == 100);
+
+		// empty shrink back to inline storage
+		B.Empty();
+		for (int i = 0; i < 10; ++i) B.Enqueue(i);
+		A = std::move(B);
+		always_check(A.Num() == 10 && A.GetAllocator().IsInline(A.Head()));
+		for (int i = 0; i < 10; ++i) always_check(A.Dequeue(Out) && Out == i);
+	}
 	// no lock queue 
 	{
 		TRingQueue<int> A;
@@ -81,12 +103,12 @@ void TestRingQueue()
 			A.Enqueue(i);
 		}
 		A.Reserve(100);
-		always_check(A.Max() == 100);
+		always_check(A.Max() == 128);
 		for (int i = 10; i < 100; ++i)
 		{
 			A.Enqueue(i);
 		}
-		always_check(A.Max() == 100);
+		always_check(A.Max() == 128);
 		always_check(A.Num() == 100);
 		for (int i = 0; i < 100; i++)
 		{
@@ -94,6 +116,34 @@ void TestRingQueue()
 		}
 	}
 
+	// batch and span, no lock queue 
+	{
+		TRingQueue<int> A(8);
+		int In[32], Out[32];
+		for (int i = 0; i < 32; ++i) In[i] = i;
+
+		// head at 5, so 6 elements wrap around the end of storage 
+		A.EnqueueRange(In, 5);
+		always_check(A.DequeueRange(Out, 5) == 5 && Out[4] == 4);
+		A.EnqueueRange(In, 6);
+		Fuko::TRingSpans<int> Spans = A.PeekContiguous();
+		always_check(Spans.First.Num == 3 && Spans.Second.Num == 3 && Spans.Num() == 6);
+		int Expect = 0;
+		for (int n : Spans.First) always_check(n == Expect++);
+		for (int n : Spans.Second) always_check(n == Expect++);
+		always_check(A.DequeueRange(4) == 4 && *A.Head() == 4);
+
+		// grow keep order and power of two 
+		A.EnqueueRange(In + 6, 26);
+		always_check(A.Num() == 28 && A.Max() >= 28 && Fuko::Math::IsPowerOfTwo(A.Max()));
+		always_check(A.DequeueRange(Out, 32) == 28);
+		for (int i = 0; i < 28; ++i) always_check(Out[i] == i + 4);
+		always_check(A.IsEmpty() && A.PeekContiguous().IsEmpty());
+
+		A.EnqueueRange({ 7, 8, 9 });
+		always_check(A.Num() == 3 && *A.Tail() == 9);
+	}
+
 	// lock queue
 	{
 		TArray<std::atomic<int>>		CountArray;
@@ -158,6 +208,140 @@ void TestRingQueue()
 			CountArray[i] = 0;
 		}
 		std::cout << "Mutex lock cost time : " << std::chrono::duration<double, std::milli>(End - Begin).count() << " ms" << std::endl;
+
+		// test lock free, same load as the lock queues 
+		TRingQueue<SlowObj, Fuko::LockFree> LockFreeQueue(64);
+		always_check(LockFreeQueue.Max() == 64 && LockFreeQueue.IsEmpty());
+		Begin = std::chrono::system_clock::now();
+		for (int i = 0; i < ThreadCount; ++i)
+		{
+			ThreadArr[i] = std::thread(EnqueueThread, std::ref(LockFreeQueue));
+			ThreadArr[ThreadCount + i] = std::thread(DequeueThread, std::ref(LockFreeQueue));
+		}
+		for (int i = 0; i < ThreadCount * 2; ++i)
+		{
+			ThreadArr[i].join();
+		}
+		End = std::chrono::system_clock::now();
+		for (int i = 0; i < LoopCount; ++i)
+		{
+			always_check(CountArray[i] == ThreadCount);
+			CountArray[i] = 0;
+		}
+		always_check(LockFreeQueue.IsEmpty());
+		std::cout << "Lock free cost time : " << std::chrono::duration<double, std::milli>(End - Begin).count() << " ms" << std::endl;
+	}
+
+	// lock free queue, single thread behaviour 
+	{
+		TRingQueue<int, Fuko::LockFree> A(5);
+		always_check(A.Max() == 8);
+		int Out = 0;
+		always_check(!A.TryDequeue(Out));
+		for (int Loop = 0; Loop < 3; ++Loop)
+		{
+			for (int i = 0; i < 8; ++i) always_check(A.TryEnqueue(i));
+			always_check(!A.TryEnqueue(8));
+			always_check(A.Num() == 8);
+			for (int i = 0; i < 8; ++i) always_check(A.TryDequeue(Out) && Out == i);
+			always_check(!A.TryDequeue(Out) && A.IsEmpty());
+		}
+
+		TRingQueue<SlowObj, Fuko::LockFreeSPSC> B(4);
+		always_check(B.Max() == 4 && B.Head() == nullptr);
+		for (int i = 0; i < 4; ++i) always_check(B.TryEnqueue(i));
+		always_check(!B.TryEnqueue(4) && B.Num() == 4);
+		always_check(B.Head()->Val == 0);
+		SlowObj Obj;
+		always_check(B.TryDequeue(Obj) && Obj.Val == 0 && B.TryEnqueue(4));
+		always_check(B.TryDequeue() && B.Head()->Val == 2);
+	}
+
+	// batch through lock queue and spsc queue, per element against per batch 
+	{
+		static constexpr int BatchSize = 64;
+		static constexpr int TransferCount = 100'0000;
+		static_assert(TransferCount % BatchSize == 0);
+		TRingQueue<int, Fuko::TSpinLock<>> SpinLockQueue(1024);
+		TRingQueue<int, Fuko::LockFreeSPSC> SPSCQueue(1024);
+
+		int Out[BatchSize];
+		SpinLockQueue.EnqueueRange(Out, 0);
+		always_check(SpinLockQueue.TryDequeueRange(Out, BatchSize) == 0);
+		int In[BatchSize];
+		for (int i = 0; i < BatchSize; ++i) In[i] = i;
+		always_check(SPSCQueue.TryEnqueueRange(In, BatchSize) == BatchSize);
+		always_check(SPSCQueue.PeekContiguous().Num() == BatchSize && SPSCQueue.DequeueRange(BatchSize) == BatchSize);
+
+		auto Transfer = [&](auto& Queue, bool bBatch)
+		{
+			bool bOrdered = true;
+			auto Begin = std::chrono::system_clock::now();
+			std::thread Producer([&]
+			{
+				int Buffer[BatchSize];
+				for (int i = 0; i < TransferCount; i += BatchSize)
+				{
+					for (int j = 0; j < BatchSize; ++j) Buffer[j] = i + j;
+					if (bBatch) Queue.EnqueueRange(Buffer, BatchSize);
+					else for (int j = 0; j < BatchSize; ++j) Queue.Enqueue(Buffer[j]);
+				}
+			});
+			std::thread Consumer([&]
+			{
+				int Buffer[BatchSize];
+				int Expect = 0;
+				while (Expect < TransferCount)
+				{
+					if (bBatch) Queue.DequeueRange(Buffer, BatchSize);
+					else for (int j = 0; j < BatchSize; ++j) Queue.Dequeue(Buffer[j]);
+					for (int j = 0; j < BatchSize; ++j) bOrdered &= Buffer[j] == Expect++;
+				}
+			});
+			Producer.join();
+			Consumer.join();
+			auto End = std::chrono::system_clock::now();
+			always_check(bOrdered && Queue.IsEmpty());
+			return std::chrono::duration<double, std::milli>(End - Begin).count();
+		};
+		double SpinSingle = Transfer(SpinLockQueue, false);
+		double SpinBatch = Transfer(SpinLockQueue, true);
+		double SPSCSingle = Transfer(SPSCQueue, false);
+		double SPSCBatch = Transfer(SPSCQueue, true);
+		std::cout << "Spin lock per element : " << SpinSingle << " ms, per batch : " << SpinBatch << " ms" << std::endl;
+		std::cout << "SPSC per element : " << SPSCSingle << " ms, per batch : " << SPSCBatch << " ms" << std::endl;
+	}
+
+	// single producer single consumer, order is kept, against spin lock queue 
+	{
+		static constexpr int TransferCount = 100'0000;
+		TRingQueue<int, Fuko::LockFreeSPSC> SPSCQueue(256);
+		TRingQueue<int, Fuko::TSpinLock<>> SpinLockQueue(256);
+
+		auto Transfer = [&](auto& Queue)
+		{
+			bool bOrdered = true;
+			auto Begin = std::chrono::system_clock::now();
+			std::thread Producer([&] { for (int i = 0; i < TransferCount; ++i) Queue.Enqueue(i); });
+			std::thread Consumer([&]
+			{
+				for (int i = 0; i < TransferCount; ++i)
+				{
+					int n;
+					Queue.Dequeue(n);
+					bOrdered &= n == i;
+				}
+			});
+			Producer.join();
+			Consumer.join();
+			auto End = std::chrono::system_clock::now();
+			always_check(bOrdered);
+			return std::chrono::duration<double, std::milli>(End - Begin).count();
+		};
+		double SPSCTime = Transfer(SPSCQueue);
+		double SpinTime = Transfer(SpinLockQueue);
+		always_check(SPSCQueue.IsEmpty());
+		std::cout << "SPSC cost time : " << SPSCTime << " ms, spin lock : " << SpinTime << " ms" << std::endl;
 	}
 }
 
@@ -0,0 +1,107 @@
+#pragma once
+#include <Containers/SlotMap.h>
+#include <iostream>
+
+using Fuko::TSlotMap;
+using Fuko::SlotHandle;
+
+struct SlotMapCounted
+{
+	static int LiveNum;
+	int Value;
+
+	SlotMapCounted(int InValue) : Value(InValue) { ++LiveNum; }
+	SlotMapCounted(const SlotMapCounted& Other) : Value(Other.Value) { ++LiveNum; }
+	~SlotMapCounted() { --LiveNum; }
+};
+int SlotMapCounted::LiveNum = 0;
+
+void TestSlotMap()
+{
+	TSlotMap<int> A;
+	SlotHandle H0 = A.Add(10);
+	SlotHandle H1 = A.Add(11);
+	SlotHandle H2 = A.Emplace(12);
+	always_check(A.Num() == 3);
+	always_check(A[H0] == 10 && A[H1] == 11 && A[H2] == 12);
+	always_check(SlotHandle().IsNull() && !A.Contains(SlotHandle()));
+
+	// remove the first, the last is swapped into the hole, handles still work
+	always_check(A.Remove(H0));
+	always_check(!A.Remove(H0));
+	always_check(A.Num() == 2 && !A.Contains(H0) && A.Find(H0) == nullptr);
+	always_check(A[H1] == 11 && A[H2] == 12);
+	always_check(A.GetDenseIndex(H2) == 0 && A.GetHandle(0) == H2);
+
+	// reused slot gets a new generation, stale handle don't see the new element
+	SlotHandle H3 = A.Add(13);
+	always_check(H3.Index == H0.Index && H3.Generation != H0.Generation);
+	always_check(!A.Contains(H0) && A[H3] == 13);
+	always_check(A.NumSlots() == 3);
+
+	// dense iteration
+	int Sum = 0;
+	for (int Value : A) Sum += Value;
+	always_check(Sum == 11 + 12 + 13);
+
+	// handle round trip
+	always_check(SlotHandle::FromUInt64(H3.ToUInt64()) == H3);
+
+	// copy keep handles, move empty the source
+	TSlotMap<int> B(A);
+	always_check(B.Num() == 3 && B[H1] == 11 && B[H3] == 13 && !B.Contains(H0));
+	TSlotMap<int> C(std::move(B));
+	always_check(B.Num() == 0 && C.Num() == 3 && C[H2] == 12);
+	B = C;
+	always_check(B[H1] == 11);
+	A = std::move(C);
+	always_check(C.IsEmpty() && A[H3] == 13);
+
+	// empty invalidate all handles, slots are reused
+	A.Empty();
+	always_check(A.Num() == 0 && !A.Contains(H1) && !A.Contains(H2) && !A.Contains(H3));
+	SlotHandle H4 = A.Add(14);
+	always_check(H4.Index < 3 && A.NumSlots() == 3 && A[H4] == 14);
+	always_check(!A.Contains(H1) && !A.Contains(H2) && !A.Contains(H3));
+
+	// random add and remove against a shadow
+	{
+		static constexpr int LoopNum = 20000;
+		TSlotMap<int> M;
+		std::vector<std::pair<SlotHandle, int>> Live;
+		std::vector<SlotHandle> Dead;
+		uint32 Rand = 1;
+		for (int i = 0; i < LoopNum; ++i)
+		{
+			Rand = Rand * 1664525u + 1013904223u;
+			if (Live.empty() || (Rand >> 16) % 3)
+			{
+				Live.emplace_back(M.Add(i), i);
+			}
+			else
+			{
+				size_t Pick = (Rand >> 8) % Live.size();
+				always_check(M.Remove(Live[Pick].first));
+				Dead.push_back(Live[Pick].first);
+				Live[Pick] = Live.back();
+				Live.pop_back();
+			}
+		}
+		always_check(M.Num() == (int)Live.size());
+		for (auto& Pair : Live) always_check(M[Pair.first] == Pair.second);
+		for (SlotHandle Handle : Dead) always_check(!M.Contains(Handle));
+		for (int i = 0; i < M.Num(); ++i) always_check(M.Find(M.GetHandle(i)) == M.GetData() + i);
+	}
+
+	// element lifetime
+	{
+		TSlotMap<SlotMapCounted> M;
+		SlotHandle Handles[10];
+		for (int i = 0; i < 10; ++i) Handles[i] = M.Emplace(i);
+		for (int i = 0; i < 10; i += 2) M.Remove(Handles[i]);
+		always_check(SlotMapCounted::LiveNum == 5);
+		for (int i = 1; i < 10; i += 2) always_check(M[Handles[i]].Value == i);
+		M.Reset();
+		always_check(SlotMapCounted::LiveNum == 0);
+	}
+}
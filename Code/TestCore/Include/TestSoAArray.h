@@ -0,0 +1,137 @@
+#pragma once
+#include <Containers/SoAArray.h>
+#include <Containers/Array.h>
+#include <iostream>
+#include <chrono>
+
+using Fuko::TSoAArray;
+
+// the array of structs the soa array replace
+struct SoAParticle
+{
+	float	Position[3];
+	float	Velocity[3];
+	float	Life;
+	int32	Id;
+	uint8	Payload[32];
+};
+
+// a column that own memory, so copy, move and destruct are checked
+static Fuko::TArray<int32> _SoATags(int32 Id)
+{
+	Fuko::TArray<int32> Tags;
+	for (int32 i = 0; i <= Id % 5; ++i) Tags.Add(Id + i);
+	return Tags;
+}
+
+void TestSoAArray()
+{
+	using ParticleArray = TSoAArray<float, int32, Fuko::TArray<int32>>;
+
+	// behaviour, against TArray of struct
+	{
+		struct RefElement { float Life; int32 Id; Fuko::TArray<int32> Tags; };
+		ParticleArray A;
+		Fuko::TArray<RefElement> Ref;
+		always_check(A.Num() == 0 && A.IsEmpty() && A.Column<0>().IsEmpty());
+
+		uint32 Rand = 12345;
+		for (int i = 0; i < 5000; ++i)
+		{
+			Rand = Rand * 1664525u + 1013904223u;
+			if (Ref.Num() && (Rand >> 28) < 5)
+			{
+				int32 Index = (int32)((Rand >> 8) % (uint32)Ref.Num());
+				A.RemoveAtSwap(Index);
+				Ref.RemoveAtSwap(Index);
+			}
+			else
+			{
+				Fuko::TArray<int32> Tags = _SoATags(i);
+				always_check(A.Add((float)i * 0.5f, i, Tags) == (uint32)Ref.Num());
+				Ref.Add({ (float)i * 0.5f, i, Tags });
+			}
+		}
+		always_check(A.Num() == (uint32)Ref.Num());
+		for (int32 i = 0; i < Ref.Num(); ++i)
+		{
+			always_check(A.Get<0>(i) == Ref[i].Life && A.Get<1>(i) == Ref[i].Id && A.Get<2>(i) == Ref[i].Tags);
+		}
+
+		// every column on its own cache line
+		always_check(((size_t)A.GetData<0>() & 63) == 0);
+		always_check(((size_t)A.GetData<1>() & 63) == 0);
+		always_check(((size_t)A.GetData<2>() & 63) == 0);
+		always_check(A.Column<int32>().GetData() == A.GetData<1>() && A.Column<Fuko::TArray<int32>>().Num == A.Num());
+
+		// copy and move keep every column
+		ParticleArray B = A;
+		always_check(B.Num() == A.Num() && B.GetData<2>() != A.GetData<2>());
+		ParticleArray C = std::move(B);
+		always_check(B.Num() == 0 && B.GetData<0>() == nullptr && C.Num() == A.Num());
+		B = C;
+		C = std::move(A);
+		for (uint32 i = 0; i < C.Num(); ++i) always_check(C.GetElement(i) == B.GetElement(i));
+		always_check(A.Num() == 0 && A.Max() == 0);
+
+		// remove a range, add by tuple, default, shrink
+		B.RemoveAtSwap(0, 10);
+		always_check(B.Num() == C.Num() - 10);
+		B.AddElement(Fuko::MakeTuple(1.f, 7, _SoATags(7)));
+		always_check(B.Get<2>(B.Num() - 1) == _SoATags(7));
+		uint32 First = B.AddDefaulted(3);
+		always_check(B.Get<1>(First + 2) == 0 && B.Get<2>(First + 2).Num() == 0);
+		B.SetNum(5);
+		B.Shrink();
+		always_check(B.Num() == 5 && B.Max() == 5);
+		B.Empty();
+		always_check(B.Num() == 0 && B.Max() == 0);
+	}
+
+	// sort rows by one column, other columns follow
+	{
+		ParticleArray A;
+		for (int i = 0; i < 1000; ++i) A.Add((float)((i * 7919) % 1000), i, _SoATags(i));
+		A.Sort<0>();
+		for (uint32 i = 0; i < A.Num(); ++i)
+		{
+			always_check(A.Get<0>(i) == (float)i);
+			always_check((A.Get<1>(i) * 7919) % 1000 == (int32)i && A.Get<2>(i) == _SoATags(A.Get<1>(i)));
+		}
+
+		// stable sort by key of few values keep order of id
+		TSoAArray<int32, int32> B;
+		for (int i = 0; i < 1000; ++i) B.Add(i % 7, i);
+		B.StableSort<0>(TGreater<int32>());
+		for (uint32 i = 1; i < B.Num(); ++i)
+		{
+			always_check(B.Get<0>(i - 1) > B.Get<0>(i) || (B.Get<0>(i - 1) == B.Get<0>(i) && B.Get<1>(i - 1) < B.Get<1>(i)));
+		}
+		B.SortBy([&](uint32 X, uint32 Y) { return B.Get<1>(X) < B.Get<1>(Y); });
+		for (uint32 i = 0; i < B.Num(); ++i) always_check(B.Get<1>(i) == (int32)i);
+	}
+
+	// one field loop, array of struct against soa column
+	{
+		static constexpr int ParticleNum = 1 << 20;
+		Fuko::TArray<SoAParticle> AoS;
+		AoS.SetNumZeroed(ParticleNum);
+		TSoAArray<float, float, float, float, float, float, float, int32> SoA;
+		SoA.Reserve(ParticleNum);
+		for (int i = 0; i < ParticleNum; ++i)
+		{
+			AoS[i].Life = (float)(i & 1023);
+			SoA.Add(0.f, 0.f, 0.f, 0.f, 0.f, 0.f, (float)(i & 1023), i);
+		}
+
+		// age every particle, vectorizable only when lifes are contiguous
+		auto begin = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < 20; ++r) for (SoAParticle& Particle : AoS) Particle.Life = Particle.Life * 0.99f - 0.5f;
+		auto mid = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < 20; ++r) for (float& Life : SoA.Column<6>()) Life = Life * 0.99f - 0.5f;
+		auto end = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < ParticleNum; i += 997) always_check(AoS[i].Life == SoA.Get<6>(i));
+		std::cout << "update one field, array of struct : " << std::chrono::duration<double, std::milli>(mid - begin).count()
+			<< " ms, soa column : " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+	}
+}
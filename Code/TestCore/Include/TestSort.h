@@ -0,0 +1,163 @@
+#pragma once
+#include <Containers/Array.h>
+#include <Algo/ParallelSort.h>
+#include <Algo/RadixSort.h>
+#include <Templates/Pair.h>
+#include <JobSystem/JobSystem.h>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+enum class ESortTestKind : int8 { Low = -3, Mid = 0, High = 5 };
+
+void TestSort()
+{
+	Fuko::Job::JobExecuter Executer(4);
+	std::mt19937 Random(1234);
+	using PairType = Fuko::TPair<uint32, uint32>;
+	auto ByKey = [](const PairType& A, const PairType& B) { return A.Key < B.Key; };
+
+	// parallel sort, every size and chunk count give the std::sort order
+	for (uint32 Num : { 0u, 1u, 100u, 20000u, 100003u, 1u << 20 })
+	{
+		TArray<uint32> Source;
+		for (uint32 i = 0; i < Num; ++i) Source.Add(Random() % (Num + 1));
+		std::vector<uint32> Expect(Source.begin(), Source.end());
+		std::sort(Expect.begin(), Expect.end());
+
+		for (uint32 ChunkNum : { 0u, 2u, 3u, 8u })
+		{
+			TArray<uint32> Arr(Source);
+			Fuko::Algo::ParallelSort(Executer, Arr, TLess<uint32>(), ChunkNum);
+			always_check(std::equal(Arr.begin(), Arr.end(), Expect.begin(), Expect.end()));
+
+			TArray<uint32> Greater(Source);
+			Fuko::Algo::ParallelSort(Executer, Greater, TGreater<uint32>(), ChunkNum);
+			always_check(std::equal(Greater.begin(), Greater.end(), Expect.rbegin(), Expect.rend()));
+		}
+	}
+
+	// parallel stable sort keep the order of equal keys
+	for (uint32 Num : { 5u, 1000u, 70001u, 1u << 20 })
+	{
+		for (uint32 ChunkNum : { 1u, 5u, 8u })
+		{
+			TArray<PairType> Arr;
+			for (uint32 i = 0; i < Num; ++i) Arr.Add(PairType(Random() % 97, i));
+			Fuko::Algo::ParallelStableSort(Executer, Arr, ByKey, ChunkNum);
+			for (uint32 i = 1; i < Num; ++i)
+			{
+				always_check(Arr[i - 1].Key < Arr[i].Key || (Arr[i - 1].Key == Arr[i].Key && Arr[i - 1].Value < Arr[i].Value));
+			}
+		}
+	}
+
+	// radix sort of integer, float and enum, small arrays go by insertion sort
+	for (uint32 Num : { 0u, 1u, 63u, 64u, 5000u, 300000u })
+	{
+		TArray<uint32> U32;
+		TArray<int32> I32;
+		TArray<int64> I64;
+		TArray<uint8> U8;
+		TArray<float> F32;
+		TArray<double> F64;
+		for (uint32 i = 0; i < Num; ++i)
+		{
+			const uint64 Bits = ((uint64)Random() << 32) | Random();
+			U32.Add((uint32)Bits);
+			I32.Add((int32)Bits >> (i % 20));
+			I64.Add((int64)Bits);
+			U8.Add((uint8)Bits);
+			F32.Add((float)(int32)Bits * 1e-3f);
+			F64.Add((double)(int64)Bits / 7.0);
+		}
+		if (Num > 10)
+		{
+			F32[3] = -0.0f;
+			F32[5] = 0.0f;
+			F64[7] = -1e300;
+			F64[9] = 1e-300;
+		}
+
+		auto CheckSorted = [](auto& Arr)
+		{
+			auto Expect = Arr;
+			std::sort(Expect.begin(), Expect.end());
+			Arr.RadixSort();
+			always_check(std::equal(Arr.begin(), Arr.end(), Expect.begin(), Expect.end()));
+		};
+		CheckSorted(U32);
+		CheckSorted(I32);
+		CheckSorted(I64);
+		CheckSorted(U8);
+		CheckSorted(F32);
+		CheckSorted(F64);
+	}
+	{
+		TArray<float> Zeros{ 0.0f, -0.0f, 1.0f, -0.0f, -1.0f };
+		Zeros.RadixSort();
+		always_check(Zeros[0] == -1.0f && std::signbit(Zeros[1]) && std::signbit(Zeros[2]) && !std::signbit(Zeros[3]) && Zeros[4] == 1.0f);
+
+		TArray<ESortTestKind> Kinds;
+		for (uint32 i = 0; i < 1000; ++i) Kinds.Add(i % 3 == 0 ? ESortTestKind::High : i % 3 == 1 ? ESortTestKind::Low : ESortTestKind::Mid);
+		Kinds.RadixSort();
+		always_check(Kinds[0] == ESortTestKind::Low && Kinds[332] == ESortTestKind::Low && Kinds[333] == ESortTestKind::Mid && Kinds[666] == ESortTestKind::High);
+	}
+
+	// radix sort by key is stable
+	for (uint32 Num : { 50u, 200000u })
+	{
+		TArray<PairType> Arr;
+		for (uint32 i = 0; i < Num; ++i) Arr.Add(PairType(Random() % 1000, i));
+		Arr.RadixSort([](const PairType& Pair) { return (int16)(Pair.Key - 500); });
+		for (uint32 i = 1; i < Num; ++i)
+		{
+			always_check(Arr[i - 1].Key < Arr[i].Key || (Arr[i - 1].Key == Arr[i].Key && Arr[i - 1].Value < Arr[i].Value));
+		}
+	}
+
+	// sort 4M integers and 4M pairs
+	{
+		static constexpr uint32 Num = 1 << 22;
+		TArray<uint32> Source;
+		Source.Reserve(Num);
+		for (uint32 i = 0; i < Num; ++i) Source.Add(Random());
+
+		double Time[4];
+		auto Bench = [&](int Index, auto&& Sort)
+		{
+			TArray<uint32> Arr(Source);
+			auto BenchBegin = std::chrono::high_resolution_clock::now();
+			Sort(Arr);
+			auto BenchEnd = std::chrono::high_resolution_clock::now();
+			Time[Index] = std::chrono::duration<double, std::milli>(BenchEnd - BenchBegin).count();
+			always_check(std::is_sorted(Arr.begin(), Arr.end()));
+		};
+		Bench(0, [](TArray<uint32>& Arr) { Arr.Sort(); });
+		Bench(1, [&](TArray<uint32>& Arr) { Fuko::Algo::ParallelSort(Executer, Arr); });
+		Bench(2, [](TArray<uint32>& Arr) { Arr.RadixSort(); });
+		Bench(3, [](TArray<uint32>& Arr) { std::sort(Arr.begin(), Arr.end()); });
+		std::cout << "sort 4M uint32, sort : " << Time[0] << " ms, parallel sort : " << Time[1]
+			<< " ms, radix sort : " << Time[2] << " ms, std::sort : " << Time[3] << " ms" << std::endl;
+
+		TArray<PairType> Pairs;
+		Pairs.Reserve(Num);
+		for (uint32 i = 0; i < Num; ++i) Pairs.Add(PairType(Random() % 100000, i));
+		auto BenchStable = [&](int Index, auto&& Sort)
+		{
+			TArray<PairType> Arr(Pairs);
+			auto BenchBegin = std::chrono::high_resolution_clock::now();
+			Sort(Arr);
+			auto BenchEnd = std::chrono::high_resolution_clock::now();
+			Time[Index] = std::chrono::duration<double, std::milli>(BenchEnd - BenchBegin).count();
+			always_check(std::is_sorted(Arr.begin(), Arr.end(), ByKey));
+		};
+		BenchStable(0, [&](TArray<PairType>& Arr) { Fuko::Algo::ParallelStableSort(Executer, Arr, ByKey); });
+		BenchStable(1, [](TArray<PairType>& Arr) { Arr.RadixSort([](const PairType& Pair) { return Pair.Key; }); });
+		BenchStable(2, [&](TArray<PairType>& Arr) { std::stable_sort(Arr.begin(), Arr.end(), ByKey); });
+		std::cout << "stable sort 4M pairs, parallel stable sort : " << Time[0] << " ms, radix sort : " << Time[1]
+			<< " ms, std::stable_sort : " << Time[2] << " ms" << std::endl;
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <Containers/SortedFlatMap.h>
+#include <Containers/Array.h>
+#include <iostream>
+#include <chrono>
+#include <map>
+
+using Fuko::TSortedFlatMap;
+
+void TestSortedFlatMap()
+{
+	using PairType = Fuko::TPair<int32, int32>;
+
+	// behaviour, against std::map
+	{
+		TSortedFlatMap<int32, int32> Map;
+		std::map<int32, int32> Ref;
+		always_check(Map.IsEmpty() && !Map.Contains(1) && Map.Find(1) == nullptr);
+
+		uint32 Rand = 12345;
+		for (int i = 0; i < 20000; ++i)
+		{
+			Rand = Rand * 1664525u + 1013904223u;
+			int32 Key = (int32)((Rand >> 8) % 3000);
+			switch ((Rand >> 28) % 4)
+			{
+			case 0: Map.Add(Key, i); Ref[Key] = i; break;
+			case 1: always_check(Map.FindOrAdd(Key, i) == Ref.emplace(Key, i).first->second); break;
+			case 2: always_check(Map.Remove(Key) == (uint32)Ref.erase(Key)); break;
+			case 3:
+			{
+				auto It = Ref.find(Key);
+				const int32* Value = Map.Find(Key);
+				always_check((Value != nullptr) == (It != Ref.end()));
+				if (Value) always_check(*Value == It->second);
+				break;
+			}
+			}
+		}
+		always_check(Map.Num() == (uint32)Ref.size());
+		auto It = Ref.begin();
+		for (const PairType& Pair : Map)
+		{
+			always_check(Pair.Key == It->first && Pair.Value == It->second);
+			++It;
+		}
+
+		// bounds and range scan
+		for (int32 Key = -5; Key < 3005; Key += 7)
+		{
+			uint32 Lower = Map.LowerBound(Key);
+			always_check(Lower == (uint32)std::distance(Ref.begin(), Ref.lower_bound(Key)));
+			always_check(Map.UpperBound(Key) == (uint32)std::distance(Ref.begin(), Ref.upper_bound(Key)));
+			auto Range = Map.Range(Key, Key + 100);
+			always_check(Range.Num() == (uint32)std::distance(Ref.lower_bound(Key), Ref.lower_bound(Key + 100)));
+			for (const PairType& Pair : Range) always_check(Pair.Key >= Key && Pair.Key < Key + 100);
+			always_check(Map.From(Key).Num() == Map.Num() - Lower);
+		}
+		always_check(Map.Range(100, 50).IsEmpty());
+
+		// remove a range of keys
+		uint32 Removed = Map.RemoveRange(1000, 2000);
+		always_check(Removed == (uint32)std::distance(Ref.lower_bound(1000), Ref.lower_bound(2000)));
+		Ref.erase(Ref.lower_bound(1000), Ref.lower_bound(2000));
+		always_check(Map.Num() == (uint32)Ref.size() && Map.First().Key == Ref.begin()->first && Map.Last().Key == Ref.rbegin()->first);
+
+		int32 Value = 0;
+		always_check(Map.RemoveAndCopyValue(Ref.begin()->first, Value) && Value == Ref.begin()->second);
+		always_check(!Map.RemoveAndCopyValue(1500, Value));
+	}
+
+	// bulk build and merge insert, the last pair of a key win
+	{
+		Fuko::TArray<PairType> Pairs;
+		for (int i = 0; i < 1000; ++i) Pairs.Add(PairType((i * 7919) % 500, i));
+		TSortedFlatMap<int32, int32> Map(std::move(Pairs));
+		always_check(Map.Num() == 500);
+		for (int32 Key = 0; Key < 500; ++Key)
+		{
+			// key k is written at i and i + 500, later one is kept
+			int32 Last = 0;
+			for (int i = 0; i < 1000; ++i) if ((i * 7919) % 500 == Key) Last = i;
+			always_check(Map.FindChecked(Key) == Last);
+		}
+
+		// merge overlapping, before and after, batch replace existing values
+		Fuko::TArray<PairType> Batch;
+		for (int32 Key = -100; Key < 700; Key += 3) Batch.Add(PairType(Key, -Key));
+		Map.Merge(Batch.GetData(), Batch.Num());
+		for (int32 Key = -100; Key < 700; ++Key)
+		{
+			bool bInBatch = (Key + 100) % 3 == 0;
+			bool bInMap = bInBatch || (Key >= 0 && Key < 500);
+			always_check(Map.Contains(Key) == bInMap);
+			if (bInBatch) always_check(Map.ValueAt(Map.LowerBound(Key)) == -Key);
+		}
+		for (uint32 i = 1; i < Map.Num(); ++i) always_check(Map.KeyAt(i - 1) < Map.KeyAt(i));
+
+		// append only batch, descending compare
+		TSortedFlatMap<int32, Fuko::TArray<int32>, Fuko::PmrAlloc, TGreater<int32>> Desc{ { 3, { 3 } }, { 1, { 1 } } };
+		Fuko::TArray<Fuko::TPair<int32, Fuko::TArray<int32>>> Tail;
+		Tail.Add({ 0, { 0 } });
+		Tail.Add({ 2, { 2, 2 } });
+		Desc.Merge(std::move(Tail));
+		always_check(Desc.Num() == 4 && Desc.KeyAt(0) == 3 && Desc.KeyAt(3) == 0 && Desc.FindChecked(2).Num() == 2);
+	}
+
+	// lookup and range scan, against std::map
+	{
+		static constexpr int KeyNum = 1 << 20;
+		Fuko::TArray<PairType> Pairs;
+		Pairs.Reserve(KeyNum);
+		for (int i = 0; i < KeyNum; ++i) Pairs.Add(PairType((int32)((uint32)i * 2654435761u & 0x3FFFFFFF), i));
+
+		auto begin = std::chrono::high_resolution_clock::now();
+		TSortedFlatMap<int32, int32> Map;
+		Map.Build(Pairs.GetData(), Pairs.Num());
+		auto mid = std::chrono::high_resolution_clock::now();
+		std::map<int32, int32> Ref;
+		for (const PairType& Pair : Pairs) Ref.emplace(Pair.Key, Pair.Value);
+		auto end = std::chrono::high_resolution_clock::now();
+		std::cout << "build 1M, sorted flat map : " << std::chrono::duration<double, std::milli>(mid - begin).count()
+			<< " ms, std::map : " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+
+		// visit out of insertion order, std::map nodes are allocated in that order and would get a cache friendly walk otherwise
+		int64 Sum = 0;
+		begin = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < KeyNum; i += 3) Sum += *Map.Find(Pairs[((uint32)i * 7919u) & (KeyNum - 1)].Key);
+		for (int i = 0; i < KeyNum; i += 1024) for (const PairType& Pair : Map.Range(Pairs[i].Key, Pairs[i].Key + (1 << 20))) Sum += Pair.Value;
+		mid = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < KeyNum; i += 3) Sum -= Ref.find(Pairs[((uint32)i * 7919u) & (KeyNum - 1)].Key)->second;
+		for (int i = 0; i < KeyNum; i += 1024)
+		{
+			for (auto It = Ref.lower_bound(Pairs[i].Key), Last = Ref.lower_bound(Pairs[i].Key + (1 << 20)); It != Last; ++It) Sum -= It->second;
+		}
+		end = std::chrono::high_resolution_clock::now();
+		always_check(Sum == 0);
+		std::cout << "find and range scan, sorted flat map : " << std::chrono::duration<double, std::milli>(mid - begin).count()
+			<< " ms, std::map : " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+	}
+}
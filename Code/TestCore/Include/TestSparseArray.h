@@ -1,6 +1,9 @@
 #pragma once
 #include <Containers/SparseArray.h>
+#include <Containers/SparseArrayParallel.h>
 #include <iostream>
+#include <chrono>
+#include <JobSystem/JobSystem.h>
 
 using Fuko::TSparseArray;
 void TestSparseArray()
@@ -109,4 +112,53 @@ void TestSparseArray()
 	}
 	A.StableSort();
 
-}
\ No newline at end of file
+
+	// set bit iteration at low occupancy, every 10th slot and a long empty run
+	{
+		TSparseArray<int> S;
+		for (int i = 0; i < 100000; ++i) S.Add(i);
+		for (int i = 0; i < 100000; ++i)
+		{
+			if (i % 10 != 3 || (i >= 20000 && i < 60000)) S.RemoveAt(i);
+		}
+		always_check(S.Num() == 6000);
+
+		int Count = 0;
+		int Last = -1;
+		for (int n : S)
+		{
+			always_check(n % 10 == 3 && n > Last);
+			Last = n;
+			++Count;
+		}
+		always_check(Count == S.Num());
+
+		// const range and start index
+		const TSparseArray<int>& ConstS = S;
+		Count = 0;
+		for (int n : ConstS) Count += n % 10 == 3;
+		always_check(Count == S.Num());
+		TSparseArray<int>::TIterator It(S, 59990);
+		always_check(It && *It == 60003);
+
+		// parallel visit sum every element once
+		Fuko::Job::JobExecuter Executer(4);
+		std::atomic<int64> Sum = 0;
+		std::atomic<int> Visited = 0;
+		Fuko::ParallelForEachAllocated(Executer, S, [&](int& n) { Sum += n; ++Visited; });
+		int64 Expect = 0;
+		for (int n : S) Expect += n;
+		always_check(Visited == S.Num() && Sum == Expect);
+
+		// iterate time at 10% occupancy
+		auto begin = std::chrono::high_resolution_clock::now();
+		int64 IterSum = 0;
+		for (int r = 0; r < 100; ++r)
+		{
+			for (int n : S) IterSum += n;
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		always_check(IterSum == Expect * 100);
+		std::cout << "TSparseArray iterate 10%: " << (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / (100.0 * S.GetMaxIndex()) << " ns/slot" << std::endl;
+	}
+}
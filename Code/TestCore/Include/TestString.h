@@ -46,5 +46,19 @@ void TestString()
 
 	TMap<Fuko::TString<ANSICHAR>, Fuko::TString<ANSICHAR>> Maps;
 
+	// inline allocator, short string never touch the pool
+	{
+		using SmallString = Fuko::TString<ANSICHAR, Fuko::TInlineAlloc<16, Fuko::BlockAlloc>>;
+		SmallString S("short");
+		SmallString Copy(S);
+		always_check(Copy == S && Copy.GetData() != S.GetData());
+		S.Append(" and now a much longer tail", 27);
+		always_check(Copy == "short");
+		SmallString Moved(std::move(S));
+		always_check(S.Len() == 0 && Moved.Len() == 32);
+		Copy = Moved;
+		always_check(Copy == Moved);
+	}
+
 	std::wcout << 100 << std::endl;
 }
\ No newline at end of file
@@ -5,15 +5,26 @@
 #include <atomic>
 
 #include <TestArray.h>
+#include <TestSort.h>
 #include <TestBitArray.h>
 #include <TestSparseArray.h>
+#include <TestSlotMap.h>
+#include <TestSoAArray.h>
 #include <TestSet.h>
+#include <TestFlatMap.h>
+#include <TestSortedFlatMap.h>
+#include <TestBTreeMap.h>
+#include <TestFrozenMap.h>
+#include <TestConcurrentMap.h>
+#include <TestHash.h>
+#include <TestCrc.h>
 #include <TestMap.h>
 #include <TestRingQueue.h>
 #include <TestDelegate.h>
 #include <TestName.h>
 #include <TestString.h>
 #include <TestPool.h>
+#include <TestMemory.h>
 #include <JobSystem/JobSystem.h>
 #include <filesystem>
 #include <Misc/SmartPtr.h>
@@ -21,14 +32,25 @@
 int main()
 {
     TestArray();
+    TestSort();
     TestBitArray();
     TestSparseArray();
+    TestSlotMap();
+    TestSoAArray();
     TestSet();
     TestMap();
+    TestFlatMap();
+    TestSortedFlatMap();
+    TestBTreeMap();
+    TestFrozenMap();
+    TestConcurrentMap();
+    TestHash();
+    TestCrc();
     TestRingQueue();
 
     TestDelegate();
     TestPool();
+    TestMemory();
     TestName();
     TestString();
 